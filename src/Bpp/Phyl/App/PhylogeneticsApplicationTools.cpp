@@ -49,6 +49,7 @@
 #include "../Mapping/DecompositionSubstitutionCount.h"
 #include "../Mapping/NaiveSubstitutionCount.h"
 #include "../Mapping/OneJumpSubstitutionCount.h"
+#include "../MultiStartOptimizer.h"
 #include "../OptimizationTools.h"
 #include "../Tree.h"
 #include "../Io/BppOTreeReaderFormat.h"
@@ -1032,6 +1033,10 @@ TreeLikelihood* PhylogeneticsApplicationTools::optimizeParameters(
   {
     optMethodDeriv = OptimizationTools::OPTIMIZATION_BFGS;
   }
+  else if (order == "BranchNewton")
+  {
+    optMethodDeriv = OptimizationTools::OPTIMIZATION_BRANCH_NEWTON;
+  }
   else
     throw Exception("Unknown derivatives algorithm: '" + order + "'.");
   if (verbose)
@@ -1055,14 +1060,16 @@ TreeLikelihood* PhylogeneticsApplicationTools::optimizeParameters(
     ApplicationTools::displayResult("Molecular clock", clock);
 
   unsigned int n = 0;
-  if ((optName == "D-Brent") || (optName == "D-BFGS"))
+  if ((optName == "D-Brent") || (optName == "D-BFGS") || (optName == "L-BFGS"))
   {
-    // Uses Newton-Brent method or Newton-BFGS method
+    // Uses Newton-Brent method, Newton-BFGS method, or joint L-BFGS
     string optMethodModel;
     if (optName == "D-Brent")
       optMethodModel = OptimizationTools::OPTIMIZATION_BRENT;
-    else
+    else if (optName == "D-BFGS")
       optMethodModel = OptimizationTools::OPTIMIZATION_BFGS;
+    else
+      optMethodModel = OptimizationTools::OPTIMIZATION_LBFGS;
 
     unsigned int nstep = ApplicationTools::getParameter<unsigned int>("nstep", optArgs, 1, "", true, warn + 1);
 
@@ -1158,6 +1165,109 @@ TreeLikelihood* PhylogeneticsApplicationTools::optimizeParameters(
 
 /******************************************************************************/
 
+NNIHomogeneousTreeLikelihood* PhylogeneticsApplicationTools::optimizeParametersMultiStart(
+  const Tree& tree,
+  const SiteContainer& data,
+  TransitionModel* model,
+  DiscreteDistribution* rDist,
+  std::map<std::string, std::string>& params,
+  const std::string& suffix,
+  bool suffixIsOptional,
+  bool verbose,
+  int warn)
+{
+  string optimization = ApplicationTools::getStringParameter("optimization", params, "D-Brent(derivatives=Newton)", suffix, suffixIsOptional, warn);
+  string optName;
+  map<string, string> optArgs;
+  KeyvalTools::parseProcedure(optimization, optName, optArgs);
+  string optMethodModel;
+  if (optName == "D-Brent")
+    optMethodModel = OptimizationTools::OPTIMIZATION_BRENT;
+  else if (optName == "D-BFGS")
+    optMethodModel = OptimizationTools::OPTIMIZATION_BFGS;
+  else if (optName == "L-BFGS")
+    optMethodModel = OptimizationTools::OPTIMIZATION_LBFGS;
+  else
+    throw Exception("PhylogeneticsApplicationTools::optimizeParametersMultiStart. Unsupported optimization method: " + optName);
+  string order = ApplicationTools::getStringParameter("derivatives", optArgs, "Newton", "", true, warn + 1);
+  string optMethodDeriv;
+  if (order == "Gradient")
+    optMethodDeriv = OptimizationTools::OPTIMIZATION_GRADIENT;
+  else if (order == "Newton")
+    optMethodDeriv = OptimizationTools::OPTIMIZATION_NEWTON;
+  else if (order == "BFGS")
+    optMethodDeriv = OptimizationTools::OPTIMIZATION_BFGS;
+  else if (order == "BranchNewton")
+    optMethodDeriv = OptimizationTools::OPTIMIZATION_BRANCH_NEWTON;
+  else
+    throw Exception("Unknown derivatives algorithm: '" + order + "'.");
+  if (verbose)
+  {
+    ApplicationTools::displayResult("Optimization method", optName);
+    ApplicationTools::displayResult("Algorithm used for derivable parameters", order);
+  }
+
+  unsigned int nbEvalMax = ApplicationTools::getParameter<unsigned int>("optimization.max_number_f_eval", params, 1000000, suffix, suffixIsOptional, warn + 1);
+  double tolerance = ApplicationTools::getDoubleParameter("optimization.tolerance", params, .000001, suffix, suffixIsOptional, warn + 1);
+  bool optimizeTopo = ApplicationTools::getBooleanParameter("optimization.topology", params, false, suffix, suffixIsOptional, warn + 1);
+  unsigned int nbThreads = ApplicationTools::getParameter<unsigned int>("optimization.multistart.threads", params, 0, suffix, suffixIsOptional, warn + 1);
+  unsigned int nbRandom = ApplicationTools::getParameter<unsigned int>("optimization.multistart.random", params, 0, suffix, suffixIsOptional, warn + 1);
+  bool parsimony = ApplicationTools::getBooleanParameter("optimization.multistart.parsimony", params, false, suffix, suffixIsOptional, warn + 1);
+  bool bionj = ApplicationTools::getBooleanParameter("optimization.multistart.bionj", params, false, suffix, suffixIsOptional, warn + 1);
+  if (verbose)
+  {
+    ApplicationTools::displayResult("Max # ML evaluations", TextTools::toString(nbEvalMax));
+    ApplicationTools::displayResult("Tolerance", TextTools::toString(tolerance));
+    ApplicationTools::displayResult("Optimize topology", optimizeTopo ? "yes" : "no");
+    ApplicationTools::displayResult("# of random starting trees", TextTools::toString(nbRandom));
+    ApplicationTools::displayResult("Parsimony starting tree", parsimony ? "yes" : "no");
+    ApplicationTools::displayResult("BioNJ starting tree", bionj ? "yes" : "no");
+  }
+
+  MultiStartOptimizer driver(data, *model, *rDist, nbThreads);
+  driver.addStartingTree(tree, "input");
+  driver.addRandomStartingTrees(nbRandom);
+  if (parsimony)
+    driver.addParsimonyStartingTree();
+  if (bionj)
+    driver.addBioNJStartingTree();
+  driver.setOptimizeTopology(optimizeTopo);
+  driver.setTolerance(tolerance);
+  driver.setMaximumNumberOfEvaluations(nbEvalMax);
+  driver.setOptimizationMethods(optMethodDeriv, optMethodModel);
+
+  string checkpointFile = ApplicationTools::getAFilePath("optimization.checkpoint.file", params, false, false, suffix, suffixIsOptional, "none", warn + 1);
+  if (checkpointFile != "none")
+  {
+    double interval = ApplicationTools::getDoubleParameter("optimization.checkpoint.interval", params, 600, suffix, suffixIsOptional, warn + 1);
+    driver.setCheckpointFile(checkpointFile, interval);
+    if (verbose)
+    {
+      ApplicationTools::displayResult("Checkpoint file", checkpointFile);
+      ApplicationTools::displayResult("Checkpoint interval (s)", TextTools::toString(interval));
+      if (FileTools::fileExists(checkpointFile))
+        ApplicationTools::displayMessage("A checkpoint file was found! Resume from previous run...");
+    }
+  }
+
+  size_t best = driver.optimize();
+  if (verbose)
+  {
+    for (size_t i = 0; i < driver.getNumberOfStartingPoints(); ++i)
+    {
+      ApplicationTools::displayResult("Log-likelihood from start " + TextTools::toString(i) + " (" + driver.getStartingPointDescription(i) + ")", TextTools::toString(-driver.getValue(i), 15));
+    }
+    ApplicationTools::displayResult("Best starting point", TextTools::toString(best));
+  }
+
+  NNIHomogeneousTreeLikelihood* tl = new NNIHomogeneousTreeLikelihood(driver.getTree(best), data, model, rDist, true, false);
+  tl->initialize();
+  tl->matchParametersValues(driver.getParameters(best));
+  return tl;
+}
+
+/******************************************************************************/
+
 void PhylogeneticsApplicationTools::optimizeParameters(
   DiscreteRatesAcrossSitesClockTreeLikelihood* tl,
   const ParameterList& parameters,
@@ -48,6 +48,7 @@
 #include "../Model/MarkovModulatedSubstitutionModel.h"
 #include "../Likelihood/HomogeneousTreeLikelihood.h"
 #include "../Likelihood/ClockTreeLikelihood.h"
+#include "../Likelihood/NNIHomogeneousTreeLikelihood.h"
 #include "../Mapping/SubstitutionCount.h"
 #include <Bpp/Text/TextTools.h>
 #include <Bpp/Text/StringTokenizer.h>
@@ -516,6 +517,38 @@ public:
     bool verbose = true,
     int warn = 1);
 
+  /**
+   * @brief Optimize a homogeneous likelihood from several starting trees according to options.
+   *
+   * Starting points are the input tree, plus random, parsimony and BioNJ trees as requested by the
+   * 'optimization.multistart.*' options. They are optimized concurrently using a MultiStartOptimizer,
+   * possibly with checkpoints ('optimization.checkpoint.file' and 'optimization.checkpoint.interval'),
+   * and the best one is kept.
+   * Only the 'D-Brent', 'D-BFGS' and 'L-BFGS' optimization methods are supported.
+   *
+   * @param tree             The input tree, used as a first starting point.
+   * @param data             The alignment to use.
+   * @param model            The substitution model. Its parameters are set to the best estimates.
+   * @param rDist            The rate distribution. Its parameters are set to the best estimates.
+   * @param params           The attribute map where options may be found.
+   * @param suffix           A suffix to be applied to each attribute name.
+   * @param suffixIsOptional Tell if the suffix is absolutely required.
+   * @param verbose          Print some info to the 'message' output stream.
+   * @param warn             Set the warning level (0: always display warnings, >0 display warnings on demand).
+   * @throw Exception        Any exception that may happen during the optimization process.
+   * @return A new likelihood object for the best tree, using model and rDist.
+   */
+  static NNIHomogeneousTreeLikelihood* optimizeParametersMultiStart(
+    const Tree& tree,
+    const SiteContainer& data,
+    TransitionModel* model,
+    DiscreteDistribution* rDist,
+    std::map<std::string, std::string>& params,
+    const std::string& suffix = "",
+    bool suffixIsOptional = true,
+    bool verbose = true,
+    int warn = 1);
+
   /**
    * @brief Optimize parameters according to options, with a molecular clock.
    *
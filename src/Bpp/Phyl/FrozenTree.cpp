@@ -0,0 +1,707 @@
+//
+// File: FrozenTree.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "FrozenTree.h"
+#include "TreeTools.h"
+
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+// From the STL:
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+/******************************************************************************/
+
+int FrozenTree::NameTable::intern(const string& name)
+{
+  map<string, int>::const_iterator it = indices_.find(name);
+  if (it != indices_.end())
+    return it->second;
+  int index = static_cast<int>(names_.size());
+  names_.push_back(name);
+  indices_[name] = index;
+  return index;
+}
+
+/******************************************************************************/
+
+FrozenTree::FrozenTree(size_t nbNodes, shared_ptr<NameTable> names) :
+  name_(),
+  ids_(nbNodes),
+  fathers_(nbNodes, -1),
+  firstSons_(nbNodes, -1),
+  nextBrothers_(nbNodes, -1),
+  lengths_(nbNodes, numeric_limits<double>::quiet_NaN()),
+  nameIndices_(nbNodes, -1),
+  names_(names ? names : shared_ptr<NameTable>(new NameTable())),
+  indexOfIds_(),
+  sortedIds_(),
+  nodeProperties_(),
+  branchProperties_()
+{}
+
+/******************************************************************************/
+
+FrozenTree::FrozenTree(const TreeTemplate<Node>& tree, shared_ptr<NameTable> names) :
+  FrozenTree(TreeTemplateTools::getNumberOfNodes(*tree.getRootNode()), names)
+{
+  name_ = tree.getName();
+  // Preorder traversal, sons are pushed backward so that they are numbered in order:
+  vector< pair<const Node*, int> > stack(1, pair<const Node*, int>(tree.getRootNode(), -1));
+  vector<int> lastSons(ids_.size(), -1);
+  size_t index = 0;
+  while (!stack.empty())
+  {
+    const Node* node = stack.back().first;
+    int father = stack.back().second;
+    stack.pop_back();
+    ids_[index] = node->getId();
+    if (node->hasName())
+      nameIndices_[index] = names_->intern(node->getName());
+    if (node->hasDistanceToFather())
+      lengths_[index] = node->getDistanceToFather();
+    vector<string> properties = node->getNodePropertyNames();
+    for (size_t i = 0; i < properties.size(); i++)
+    {
+      nodeProperties_.setProperty(index, properties[i], *node->getNodeProperty(properties[i]));
+    }
+    properties = node->getBranchPropertyNames();
+    for (size_t i = 0; i < properties.size(); i++)
+    {
+      branchProperties_.setProperty(index, properties[i], *node->getBranchProperty(properties[i]));
+    }
+    if (father >= 0)
+    {
+      fathers_[index] = father;
+      if (lastSons[static_cast<size_t>(father)] < 0)
+        firstSons_[static_cast<size_t>(father)] = static_cast<int>(index);
+      else
+        nextBrothers_[static_cast<size_t>(lastSons[static_cast<size_t>(father)])] = static_cast<int>(index);
+      lastSons[static_cast<size_t>(father)] = static_cast<int>(index);
+    }
+    for (size_t i = node->getNumberOfSons(); i > 0; i--)
+    {
+      stack.push_back(pair<const Node*, int>(node->getSon(i - 1), static_cast<int>(index)));
+    }
+    index++;
+  }
+  indexIds_();
+}
+
+/******************************************************************************/
+
+FrozenTree::FrozenTree(const Tree& tree, shared_ptr<NameTable> names) :
+  FrozenTree(tree.getNumberOfNodes(), names)
+{
+  name_ = tree.getName();
+  vector< pair<int, int> > stack(1, pair<int, int>(tree.getRootId(), -1));
+  vector<int> lastSons(ids_.size(), -1);
+  size_t index = 0;
+  while (!stack.empty())
+  {
+    int id = stack.back().first;
+    int father = stack.back().second;
+    stack.pop_back();
+    ids_[index] = id;
+    if (tree.hasNodeName(id))
+      nameIndices_[index] = names_->intern(tree.getNodeName(id));
+    if (tree.hasDistanceToFather(id))
+      lengths_[index] = tree.getDistanceToFather(id);
+    vector<string> properties = tree.getNodePropertyNames(id);
+    for (size_t i = 0; i < properties.size(); i++)
+    {
+      nodeProperties_.setProperty(index, properties[i], *tree.getNodeProperty(id, properties[i]));
+    }
+    properties = tree.getBranchPropertyNames(id);
+    for (size_t i = 0; i < properties.size(); i++)
+    {
+      branchProperties_.setProperty(index, properties[i], *tree.getBranchProperty(id, properties[i]));
+    }
+    if (father >= 0)
+    {
+      fathers_[index] = father;
+      if (lastSons[static_cast<size_t>(father)] < 0)
+        firstSons_[static_cast<size_t>(father)] = static_cast<int>(index);
+      else
+        nextBrothers_[static_cast<size_t>(lastSons[static_cast<size_t>(father)])] = static_cast<int>(index);
+      lastSons[static_cast<size_t>(father)] = static_cast<int>(index);
+    }
+    vector<int> sons = tree.getSonsId(id);
+    for (size_t i = sons.size(); i > 0; i--)
+    {
+      stack.push_back(pair<int, int>(sons[i - 1], static_cast<int>(index)));
+    }
+    index++;
+  }
+  indexIds_();
+}
+
+/******************************************************************************/
+
+FrozenTree::FrozenTree(
+    const vector<int>& ids,
+    const vector<int>& fathers,
+    const vector<double>& lengths,
+    const vector<int>& nameIndices,
+    shared_ptr<NameTable> names) :
+  FrozenTree(ids.size(), names)
+{
+  size_t nbNodes = ids.size();
+  if (nbNodes == 0 || fathers.size() != nbNodes || lengths.size() != nbNodes || nameIndices.size() != nbNodes)
+    throw Exception("FrozenTree::FrozenTree. Empty tree or vectors of different sizes.");
+  if (fathers[0] != -1)
+    throw Exception("FrozenTree::FrozenTree. The first node must be the root.");
+  ids_ = ids;
+  lengths_ = lengths;
+  nameIndices_ = nameIndices;
+  // In preorder, the father of each node is on the path from the root to the previous node:
+  vector<int> path(1, 0);
+  vector<int> lastSons(nbNodes, -1);
+  for (size_t i = 1; i < nbNodes; i++)
+  {
+    while (!path.empty() && path.back() != fathers[i])
+      path.pop_back();
+    if (path.empty())
+      throw Exception("FrozenTree::FrozenTree. Nodes are not in preorder, at index " + TextTools::toString(i) + ".");
+    size_t father = static_cast<size_t>(fathers[i]);
+    fathers_[i] = fathers[i];
+    if (lastSons[father] < 0)
+      firstSons_[father] = static_cast<int>(i);
+    else
+      nextBrothers_[static_cast<size_t>(lastSons[father])] = static_cast<int>(i);
+    lastSons[father] = static_cast<int>(i);
+    path.push_back(static_cast<int>(i));
+  }
+  for (size_t i = 0; i < nbNodes; i++)
+  {
+    if (nameIndices_[i] < -1 || nameIndices_[i] >= static_cast<int>(names_->size()))
+      throw Exception("FrozenTree::FrozenTree. Name index out of range: " + TextTools::toString(nameIndices_[i]) + ".");
+  }
+  indexIds_();
+}
+
+/******************************************************************************/
+
+void FrozenTree::indexIds_()
+{
+  indexOfIds_.clear();
+  sortedIds_.clear();
+  int minId = *min_element(ids_.begin(), ids_.end());
+  int maxId = *max_element(ids_.begin(), ids_.end());
+  if (minId >= 0 && static_cast<size_t>(maxId) < 4 * ids_.size() + 1024)
+  {
+    indexOfIds_.assign(static_cast<size_t>(maxId) + 1, -1);
+    for (size_t i = 0; i < ids_.size(); i++)
+    {
+      // In case of duplicated ids, the first node is kept:
+      int& index = indexOfIds_[static_cast<size_t>(ids_[i])];
+      if (index < 0)
+        index = static_cast<int>(i);
+    }
+  }
+  else
+  {
+    sortedIds_.resize(ids_.size());
+    for (size_t i = 0; i < ids_.size(); i++)
+    {
+      sortedIds_[i] = pair<int, int>(ids_[i], static_cast<int>(i));
+    }
+    sort(sortedIds_.begin(), sortedIds_.end());
+  }
+}
+
+/******************************************************************************/
+
+int FrozenTree::findNodeIndex_(int nodeId) const
+{
+  if (sortedIds_.empty())
+  {
+    if (nodeId < 0 || static_cast<size_t>(nodeId) >= indexOfIds_.size())
+      return -1;
+    return indexOfIds_[static_cast<size_t>(nodeId)];
+  }
+  vector< pair<int, int> >::const_iterator it = lower_bound(sortedIds_.begin(), sortedIds_.end(), pair<int, int>(nodeId, -1));
+  if (it == sortedIds_.end() || it->first != nodeId)
+    return -1;
+  return it->second;
+}
+
+/******************************************************************************/
+
+vector<size_t> FrozenTree::getPostorderIndices_() const
+{
+  vector<size_t> indices;
+  indices.reserve(ids_.size());
+  int node = 0;
+  while (true)
+  {
+    // Go down to the first leaf of the subtree:
+    while (firstSons_[static_cast<size_t>(node)] >= 0)
+      node = firstSons_[static_cast<size_t>(node)];
+    indices.push_back(static_cast<size_t>(node));
+    // Go up until a brother is found:
+    while (nextBrothers_[static_cast<size_t>(node)] < 0)
+    {
+      node = fathers_[static_cast<size_t>(node)];
+      if (node < 0)
+        return indices;
+      indices.push_back(static_cast<size_t>(node));
+    }
+    node = nextBrothers_[static_cast<size_t>(node)];
+  }
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* FrozenTree::toTreeTemplate() const
+{
+  // Nodes are in preorder, so that each son is added after its father and its elder brothers:
+  vector<Node*> nodes(ids_.size());
+  for (size_t i = 0; i < ids_.size(); i++)
+  {
+    Node* node = new Node(ids_[i]);
+    if (nameIndices_[i] >= 0)
+      node->setName(names_->getName(static_cast<size_t>(nameIndices_[i])));
+    if (!std::isnan(lengths_[i]))
+      node->setDistanceToFather(lengths_[i]);
+    vector<string> properties = nodeProperties_.getPropertyNames(i);
+    for (size_t j = 0; j < properties.size(); j++)
+    {
+      node->setNodeProperty(properties[j], *nodeProperties_.getProperty(i, properties[j]));
+    }
+    properties = branchProperties_.getPropertyNames(i);
+    for (size_t j = 0; j < properties.size(); j++)
+    {
+      node->setBranchProperty(properties[j], *branchProperties_.getProperty(i, properties[j]));
+    }
+    if (fathers_[i] >= 0)
+      nodes[static_cast<size_t>(fathers_[i])]->addSon(node);
+    nodes[i] = node;
+  }
+  TreeTemplate<Node>* tree = new TreeTemplate<Node>(nodes[0]);
+  tree->setName(name_);
+  return tree;
+}
+
+/******************************************************************************/
+
+vector<double> FrozenTree::getHeights() const
+{
+  vector<double> heights(ids_.size(), 0.);
+  for (size_t i = ids_.size() - 1; i > 0; i--)
+  {
+    if (std::isnan(lengths_[i]))
+      throw NodePException("FrozenTree::getHeights. No branch length.", ids_[i]);
+    double& fatherHeight = heights[static_cast<size_t>(fathers_[i])];
+    fatherHeight = max(fatherHeight, heights[i] + lengths_[i]);
+  }
+  return heights;
+}
+
+/******************************************************************************/
+
+vector<size_t> FrozenTree::getDepths() const
+{
+  vector<size_t> depths(ids_.size(), 0);
+  for (size_t i = ids_.size() - 1; i > 0; i--)
+  {
+    size_t& fatherDepth = depths[static_cast<size_t>(fathers_[i])];
+    fatherDepth = max(fatherDepth, depths[i] + 1);
+  }
+  return depths;
+}
+
+/******************************************************************************/
+
+DistanceMatrix* FrozenTree::getDistanceMatrix() const
+{
+  size_t nbNodes = ids_.size();
+  // Distances from the root, subtree sizes and leaf ranks:
+  vector<double> rootDistances(nbNodes, 0.);
+  for (size_t i = 1; i < nbNodes; i++)
+  {
+    if (std::isnan(lengths_[i]))
+      throw NodePException("FrozenTree::getDistanceMatrix. No branch length.", ids_[i]);
+    rootDistances[i] = rootDistances[static_cast<size_t>(fathers_[i])] + lengths_[i];
+  }
+  vector<size_t> sizes(nbNodes, 1);
+  for (size_t i = nbNodes - 1; i > 0; i--)
+  {
+    sizes[static_cast<size_t>(fathers_[i])] += sizes[i];
+  }
+  vector<size_t> leaves;
+  vector<size_t> ranks(nbNodes, 0);
+  for (size_t i = 0; i < nbNodes; i++)
+  {
+    if (getDegree(i) <= 1)
+    {
+      ranks[i] = leaves.size();
+      leaves.push_back(i);
+    }
+  }
+
+  DistanceMatrix* matrix = new DistanceMatrix(getLeavesNames());
+  for (size_t l = 0; l < leaves.size(); l++)
+  {
+    size_t leaf = leaves[l];
+    (*matrix)(l, l) = 0;
+    // The subtree of each ancestor is contiguous: leaves are visited once, the common ancestor
+    // with this leaf being the first ancestor whose subtree contains them.
+    size_t previous = leaf;
+    for (int ancestor = fathers_[leaf]; ancestor >= 0; ancestor = fathers_[static_cast<size_t>(ancestor)])
+    {
+      size_t a = static_cast<size_t>(ancestor);
+      double d = rootDistances[leaf] - 2. * rootDistances[a];
+      for (size_t i = a; i < a + sizes[a]; i++)
+      {
+        if (i == previous)
+        {
+          i += sizes[previous] - 1;
+          continue;
+        }
+        if (getDegree(i) <= 1)
+          (*matrix)(l, ranks[i]) = d + rootDistances[i];
+      }
+      previous = a;
+    }
+    // A root of degree 1 is also a leaf, which is the ancestor of all others:
+    if (leaf == 0)
+    {
+      for (size_t i = 1; i < nbNodes; i++)
+      {
+        if (getDegree(i) <= 1)
+          (*matrix)(l, ranks[i]) = rootDistances[i];
+      }
+    }
+  }
+  return matrix;
+}
+
+/******************************************************************************/
+
+FrozenTree* FrozenTree::cloneSubtree(int newRootId) const
+{
+  size_t root = getIndex_(newRootId);
+  // The subtree is contiguous, it ends before the first node which is not a descendant:
+  size_t end = root + 1;
+  while (end < ids_.size())
+  {
+    int ancestor = fathers_[end];
+    while (ancestor >= 0 && static_cast<size_t>(ancestor) > root)
+      ancestor = fathers_[static_cast<size_t>(ancestor)];
+    if (ancestor < 0 || static_cast<size_t>(ancestor) != root)
+      break;
+    end++;
+  }
+  FrozenTree* tree = new FrozenTree(end - root, names_);
+  int offset = static_cast<int>(root);
+  for (size_t i = root; i < end; i++)
+  {
+    size_t j = i - root;
+    tree->ids_[j] = ids_[i];
+    tree->lengths_[j] = lengths_[i];
+    tree->nameIndices_[j] = nameIndices_[i];
+    vector<string> properties = nodeProperties_.getPropertyNames(i);
+    for (size_t k = 0; k < properties.size(); k++)
+    {
+      tree->nodeProperties_.setProperty(j, properties[k], *nodeProperties_.getProperty(i, properties[k]));
+    }
+    properties = branchProperties_.getPropertyNames(i);
+    for (size_t k = 0; k < properties.size(); k++)
+    {
+      tree->branchProperties_.setProperty(j, properties[k], *branchProperties_.getProperty(i, properties[k]));
+    }
+    tree->firstSons_[j] = firstSons_[i] < 0 ? -1 : firstSons_[i] - offset;
+    if (j > 0)
+    {
+      tree->fathers_[j] = fathers_[i] - offset;
+      tree->nextBrothers_[j] = nextBrothers_[i] < 0 ? -1 : nextBrothers_[i] - offset;
+    }
+  }
+  tree->indexIds_();
+  return tree;
+}
+
+/******************************************************************************/
+
+size_t FrozenTree::getNumberOfLeaves() const
+{
+  size_t nbLeaves = 0;
+  for (size_t i = 0; i < ids_.size(); i++)
+  {
+    if (getDegree(i) <= 1)
+      nbLeaves++;
+  }
+  return nbLeaves;
+}
+
+/******************************************************************************/
+
+vector<double> FrozenTree::getBranchLengths() const
+{
+  vector<double> brLen(ids_.size() - 1);
+  for (size_t i = 1; i < ids_.size(); i++)
+  {
+    if (std::isnan(lengths_[i]))
+      throw NodePException("FrozenTree::getBranchLengths. No branch length.", ids_[i]);
+    brLen[i - 1] = lengths_[i];
+  }
+  return brLen;
+}
+
+/******************************************************************************/
+
+vector<string> FrozenTree::getLeavesNames() const
+{
+  vector<string> names;
+  for (size_t i = 0; i < ids_.size(); i++)
+  {
+    if (getDegree(i) <= 1)
+    {
+      if (nameIndices_[i] < 0)
+        throw NodePException("FrozenTree::getLeavesNames: no name associated to this node.", ids_[i]);
+      names.push_back(names_->getName(static_cast<size_t>(nameIndices_[i])));
+    }
+  }
+  return names;
+}
+
+/******************************************************************************/
+
+int FrozenTree::getLeafId(const string& name) const
+{
+  int nameIndex = names_->getIndex(name);
+  if (nameIndex >= 0)
+  {
+    // Like TreeTemplateTools::getLeafId, the last leaf with this name is returned:
+    for (size_t i = ids_.size(); i > 0; i--)
+    {
+      if (nameIndices_[i - 1] == nameIndex && getDegree(i - 1) <= 1)
+        return ids_[i - 1];
+    }
+  }
+  throw NodeNotFoundException("FrozenTree::getLeafId().", name);
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getLeavesId() const
+{
+  vector<int> ids;
+  for (size_t i = 0; i < ids_.size(); i++)
+  {
+    if (getDegree(i) <= 1)
+      ids.push_back(ids_[i]);
+  }
+  return ids;
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getNodesId() const
+{
+  vector<size_t> indices = getPostorderIndices_();
+  vector<int> ids(indices.size());
+  for (size_t i = 0; i < indices.size(); i++)
+  {
+    ids[i] = ids_[indices[i]];
+  }
+  return ids;
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getInnerNodesId() const
+{
+  vector<size_t> indices = getPostorderIndices_();
+  vector<int> ids;
+  for (size_t i = 0; i < indices.size(); i++)
+  {
+    if (getDegree(indices[i]) > 1)
+      ids.push_back(ids_[indices[i]]);
+  }
+  return ids;
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getBranchesId() const
+{
+  vector<int> ids = getNodesId();
+  ids.pop_back(); // Remove the root node.
+  return ids;
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getSonsId(int parentId) const
+{
+  vector<int> ids;
+  for (int son = firstSons_[getIndex_(parentId)]; son >= 0; son = nextBrothers_[static_cast<size_t>(son)])
+  {
+    ids.push_back(ids_[static_cast<size_t>(son)]);
+  }
+  return ids;
+}
+
+/******************************************************************************/
+
+vector<int> FrozenTree::getAncestorsId(int nodeId) const
+{
+  vector<int> ids;
+  for (int father = fathers_[getIndex_(nodeId)]; father >= 0; father = fathers_[static_cast<size_t>(father)])
+  {
+    ids.push_back(ids_[static_cast<size_t>(father)]);
+  }
+  return ids;
+}
+
+/******************************************************************************/
+
+int FrozenTree::getFatherId(int parentId) const
+{
+  int father = fathers_[getIndex_(parentId)];
+  if (father < 0)
+    throw NodePException("FrozenTree::getFatherId: node has no father.", parentId);
+  return ids_[static_cast<size_t>(father)];
+}
+
+/******************************************************************************/
+
+string FrozenTree::getNodeName(int nodeId) const
+{
+  int nameIndex = nameIndices_[getIndex_(nodeId)];
+  if (nameIndex < 0)
+    throw NodePException("FrozenTree::getNodeName: no name associated to this node.", nodeId);
+  return names_->getName(static_cast<size_t>(nameIndex));
+}
+
+/******************************************************************************/
+
+double FrozenTree::getDistanceToFather(int nodeId) const
+{
+  double length = lengths_[getIndex_(nodeId)];
+  if (std::isnan(length))
+    throw NodePException("FrozenTree::getDistanceToFather: Node has no distance.", nodeId);
+  return length;
+}
+
+/******************************************************************************/
+
+bool FrozenTree::hasBootstrapValue(int nodeId) const
+{
+  size_t index = getIndex_(nodeId);
+  int key = branchProperties_.findKey(TreeTools::BOOTSTRAP);
+  if (key < 0 || !branchProperties_.hasValue(static_cast<size_t>(key), index))
+    return false;
+  if (branchProperties_.getType(static_cast<size_t>(key)) == PropertyTable::DOUBLE)
+    return true;
+  return dynamic_cast<const Number<double>*>(branchProperties_.getProperty(index, TreeTools::BOOTSTRAP)) != 0;
+}
+
+/******************************************************************************/
+
+double FrozenTree::getBootstrapValue(int nodeId) const
+{
+  size_t index = getIndex_(nodeId);
+  int key = branchProperties_.findKey(TreeTools::BOOTSTRAP);
+  if (key >= 0 && branchProperties_.hasValue(static_cast<size_t>(key), index))
+  {
+    if (branchProperties_.getType(static_cast<size_t>(key)) == PropertyTable::DOUBLE)
+      return branchProperties_.getDouble(static_cast<size_t>(key), index);
+    const Number<double>* value = dynamic_cast<const Number<double>*>(branchProperties_.getProperty(index, TreeTools::BOOTSTRAP));
+    if (value)
+      return value->getValue();
+  }
+  throw PropertyNotFoundException("FrozenTree::getBootstrapValue.", TreeTools::BOOTSTRAP, nodeId);
+}
+
+/******************************************************************************/
+
+void FrozenTree::setBootstrapValue(int nodeId, double value)
+{
+  size_t index = getIndex_(nodeId);
+  size_t key = branchProperties_.getKey(TreeTools::BOOTSTRAP, PropertyTable::DOUBLE);
+  if (branchProperties_.getType(key) == PropertyTable::DOUBLE)
+    branchProperties_.setDouble(key, index, value);
+  else
+    branchProperties_.setProperty(index, TreeTools::BOOTSTRAP, Number<double>(value));
+}
+
+/******************************************************************************/
+
+bool FrozenTree::isMultifurcating() const
+{
+  if (getNumberOfSons(0) > 3)
+    return true;
+  for (size_t i = 1; i < ids_.size(); i++)
+  {
+    if (getNumberOfSons(i) > 2)
+      return true;
+  }
+  return false;
+}
+
+/******************************************************************************/
+
+double FrozenTree::getTotalLength()
+{
+  double length = 0;
+  for (size_t i = 1; i < ids_.size(); i++)
+  {
+    if (std::isnan(lengths_[i]))
+      throw NodePException("FrozenTree::getTotalLength(). No branch length.", ids_[i]);
+    length += lengths_[i];
+  }
+  return length;
+}
+
+/******************************************************************************/
+
+int FrozenTree::getNextId()
+{
+  return TreeTools::getMPNUId(*this, getRootId());
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,485 @@
+//
+// File: FrozenTree.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _FROZENTREE_H_
+#define _FROZENTREE_H_
+
+#include "Tree.h"
+#include "TreeTemplate.h"
+#include "TreeExceptions.h"
+#include "Node.h"
+#include "PropertyTable.h"
+
+#include <Bpp/Seq/DistanceMatrix.h>
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cmath>
+
+namespace bpp
+{
+
+/**
+ * @brief A compact, immutable tree.
+ *
+ * The topology is stored in a few arrays indexed by node, instead of one heap allocated
+ * object per node: the index of the father, of the first son and of the next brother
+ * of each node (-1 if none), together with the node ids, the branch lengths
+ * (NaN if none) and the indices of the node names.
+ * Nodes are stored in preorder: the root has index 0, and the nodes of each subtree
+ * are contiguous. Looping backward over the indices therefore visits sons before their
+ * father, which is all most bottom-up computations need.
+ *
+ * Names are interned in a NameTable, which can be shared between trees:
+ * when many trees on the same taxa are frozen with the same table, each name is stored
+ * only once whatever the number of trees.
+ *
+ * The class implements the Tree interface, so that all the TreeTools methods (distances,
+ * bipartitions, consensus, ...) work on frozen trees. Methods modifying the tree throw
+ * a TreeException, except setName() and the methods on properties: node and branch
+ * properties are annotations which are kept and can be modified. They are stored by node
+ * index in two PropertyTable objects, which can be accessed directly for typed, faster access.
+ * Use toTreeTemplate() to get a modifiable copy.
+ */
+class FrozenTree :
+  public Tree
+{
+  public:
+    /**
+     * @brief A table of interned names.
+     *
+     * Each distinct name is stored once, and referred to by its index in the table.
+     * Tables are not thread-safe: trees frozen concurrently must use different tables.
+     */
+    class NameTable
+    {
+      private:
+        std::vector<std::string> names_;
+        std::map<std::string, int> indices_;
+
+      public:
+        NameTable() : names_(), indices_() {}
+
+      public:
+        /**
+         * @return The index of the name, which is added to the table if needed.
+         */
+        int intern(const std::string& name);
+
+        /**
+         * @return The index of the name, or -1 if it is not in the table.
+         */
+        int getIndex(const std::string& name) const
+        {
+          std::map<std::string, int>::const_iterator it = indices_.find(name);
+          return it == indices_.end() ? -1 : it->second;
+        }
+
+        const std::string& getName(size_t index) const { return names_[index]; }
+
+        size_t size() const { return names_.size(); }
+    };
+
+  private:
+    std::string name_;
+    std::vector<int> ids_;
+    std::vector<int> fathers_;
+    std::vector<int> firstSons_;
+    std::vector<int> nextBrothers_;
+    std::vector<double> lengths_;
+    std::vector<int> nameIndices_;
+    std::shared_ptr<NameTable> names_;
+
+    /**
+     * @brief Index of each node id, -1 for unused ids.
+     *
+     * Ids are looked up in sortedIds_ instead when they are not dense enough.
+     */
+    std::vector<int> indexOfIds_;
+    std::vector< std::pair<int, int> > sortedIds_;
+
+    PropertyTable nodeProperties_;
+    PropertyTable branchProperties_;
+
+  public:
+    /**
+     * @brief Freeze a tree.
+     *
+     * @param tree  The tree to freeze.
+     * @param names The table where node names are interned. A new table is created if none is given.
+     */
+    FrozenTree(const TreeTemplate<Node>& tree, std::shared_ptr<NameTable> names = std::shared_ptr<NameTable>());
+
+    /**
+     * @brief Freeze any tree, through the Tree interface.
+     *
+     * @param tree  The tree to freeze.
+     * @param names The table where node names are interned. A new table is created if none is given.
+     */
+    FrozenTree(const Tree& tree, std::shared_ptr<NameTable> names = std::shared_ptr<NameTable>());
+
+    /**
+     * @brief Build a tree from its flat representation.
+     *
+     * Nodes must be given in preorder: the root first, and each node after its father
+     * and the whole subtrees of its elder brothers.
+     *
+     * @param ids         The id of each node.
+     * @param fathers     The index of the father of each node, -1 for the root.
+     * @param lengths     The length of the branch above each node, NaN if none.
+     * @param nameIndices The index of the name of each node in the name table, -1 if none.
+     * @param names       The table the name indices refer to.
+     * @throw Exception If the vectors have different sizes or the nodes are not in preorder.
+     */
+    FrozenTree(
+        const std::vector<int>& ids,
+        const std::vector<int>& fathers,
+        const std::vector<double>& lengths,
+        const std::vector<int>& nameIndices,
+        std::shared_ptr<NameTable> names);
+
+    FrozenTree(const FrozenTree& tree) :
+      name_(tree.name_),
+      ids_(tree.ids_),
+      fathers_(tree.fathers_),
+      firstSons_(tree.firstSons_),
+      nextBrothers_(tree.nextBrothers_),
+      lengths_(tree.lengths_),
+      nameIndices_(tree.nameIndices_),
+      names_(tree.names_),
+      indexOfIds_(tree.indexOfIds_),
+      sortedIds_(tree.sortedIds_),
+      nodeProperties_(tree.nodeProperties_),
+      branchProperties_(tree.branchProperties_)
+    {}
+
+    FrozenTree& operator=(const FrozenTree& tree)
+    {
+      name_         = tree.name_;
+      ids_          = tree.ids_;
+      fathers_      = tree.fathers_;
+      firstSons_    = tree.firstSons_;
+      nextBrothers_ = tree.nextBrothers_;
+      lengths_      = tree.lengths_;
+      nameIndices_  = tree.nameIndices_;
+      names_        = tree.names_;
+      indexOfIds_   = tree.indexOfIds_;
+      sortedIds_    = tree.sortedIds_;
+      nodeProperties_   = tree.nodeProperties_;
+      branchProperties_ = tree.branchProperties_;
+      return *this;
+    }
+
+    FrozenTree* clone() const { return new FrozenTree(*this); }
+
+    virtual ~FrozenTree() {}
+
+  private:
+    /**
+     * @brief Build an empty tree with the given number of nodes, to be filled by the constructors.
+     */
+    FrozenTree(size_t nbNodes, std::shared_ptr<NameTable> names);
+
+    void indexIds_();
+
+    static void throwFrozen_(const std::string& method, const Tree* tree)
+    {
+      throw TreeException("FrozenTree::" + method + ". Frozen trees can not be modified.", tree);
+    }
+
+  public:
+    /**
+     * @name Flat representation
+     *
+     * Nodes are designated by their index, from 0 (the root) to getNumberOfNodes() - 1.
+     *
+     * @{
+     */
+
+    /**
+     * @return The index of the node with the given id.
+     * @throw NodeNotFoundException If no node has this id.
+     */
+    size_t getNodeIndex(int nodeId) const
+    {
+      int index = findNodeIndex_(nodeId);
+      if (index < 0)
+        throw NodeNotFoundException("FrozenTree::getNodeIndex.", nodeId);
+      return static_cast<size_t>(index);
+    }
+
+    int getNodeId(size_t index) const { return ids_[index]; }
+
+    int getFatherIndex(size_t index) const { return fathers_[index]; }
+
+    int getFirstSonIndex(size_t index) const { return firstSons_[index]; }
+
+    int getNextBrotherIndex(size_t index) const { return nextBrothers_[index]; }
+
+    size_t getNumberOfSons(size_t index) const
+    {
+      size_t nbSons = 0;
+      for (int son = firstSons_[index]; son >= 0; son = nextBrothers_[son]) nbSons++;
+      return nbSons;
+    }
+
+    /**
+     * @return The length of the branch above a node, NaN if it has none.
+     */
+    double getBranchLength(size_t index) const { return lengths_[index]; }
+
+    /**
+     * @return The index of the name of a node in the name table, -1 if it has none.
+     */
+    int getNameIndex(size_t index) const { return nameIndices_[index]; }
+
+    /**
+     * @return The degree of a node, following Node::degree().
+     */
+    size_t getDegree(size_t index) const { return getNumberOfSons(index) + (fathers_[index] >= 0 ? 1 : 0); }
+
+    std::shared_ptr<NameTable> getNameTable() const { return names_; }
+
+    /**
+     * @return The node properties, indexed by node index.
+     */
+    PropertyTable& getNodeProperties() { return nodeProperties_; }
+
+    const PropertyTable& getNodeProperties() const { return nodeProperties_; }
+
+    /**
+     * @return The branch properties, indexed by node index.
+     */
+    PropertyTable& getBranchProperties() { return branchProperties_; }
+
+    const PropertyTable& getBranchProperties() const { return branchProperties_; }
+
+    /** @} */
+
+    /**
+     * @name Algorithms on the flat representation
+     *
+     * @{
+     */
+
+    /**
+     * @brief Convert to a modifiable tree.
+     *
+     * Ids, names, branch lengths and properties are kept, and the sons are in the same order.
+     *
+     * @return A new TreeTemplate object.
+     */
+    TreeTemplate<Node>* toTreeTemplate() const;
+
+    /**
+     * @return The height of each node, that is the maximum distance to a leaf of its subtree, by index.
+     * @throw NodePException If a branch has no length.
+     */
+    std::vector<double> getHeights() const;
+
+    /**
+     * @return The depth of each node, that is the maximum number of branches to a leaf of its subtree, by index.
+     */
+    std::vector<size_t> getDepths() const;
+
+    /**
+     * @brief Compute the patristic distances between all pairs of leaves.
+     *
+     * This does the same as TreeTools::getDistanceMatrix, in quadratic time.
+     *
+     * @return A new DistanceMatrix object, with leaves in the same order as getLeavesNames().
+     * @throw NodePException If a branch has no length.
+     */
+    DistanceMatrix* getDistanceMatrix() const;
+
+    /** @} */
+
+  private:
+    int findNodeIndex_(int nodeId) const;
+
+    size_t getIndex_(int nodeId) const
+    {
+      int index = findNodeIndex_(nodeId);
+      if (index < 0)
+        throw NodeNotFoundException("FrozenTree: node not found.", nodeId);
+      return static_cast<size_t>(index);
+    }
+
+    /**
+     * @brief Get the index of a node, checking that it has the given property.
+     */
+    size_t getPropertyIndex_(const PropertyTable& table, int nodeId, const std::string& name, const std::string& method) const
+    {
+      size_t index = getIndex_(nodeId);
+      if (!table.hasProperty(index, name))
+        throw PropertyNotFoundException("FrozenTree::" + method + ".", name, nodeId);
+      return index;
+    }
+
+    /**
+     * @brief Get the indices of the nodes in postorder, as TreeTemplateTools::getNodes does.
+     */
+    std::vector<size_t> getPostorderIndices_() const;
+
+  public:
+    /**
+     * @name The Tree interface
+     *
+     * @{
+     */
+    FrozenTree* cloneSubtree(int newRootId) const;
+
+    std::string getName() const { return name_; }
+
+    void setName(const std::string& name) { name_ = name; }
+
+    size_t getNumberOfLeaves() const;
+
+    size_t getNumberOfNodes() const { return ids_.size(); }
+
+    std::vector<double> getBranchLengths() const;
+
+    std::vector<std::string> getLeavesNames() const;
+
+    int getRootId() const { return ids_[0]; }
+
+    int getLeafId(const std::string& name) const;
+
+    std::vector<int> getLeavesId() const;
+
+    std::vector<int> getNodesId() const;
+
+    std::vector<int> getInnerNodesId() const;
+
+    std::vector<int> getBranchesId() const;
+
+    std::vector<int> getSonsId(int parentId) const;
+
+    std::vector<int> getAncestorsId(int nodeId) const;
+
+    int getFatherId(int parentId) const;
+
+    bool hasFather(int nodeId) const { return fathers_[getIndex_(nodeId)] >= 0; }
+
+    std::string getNodeName(int nodeId) const;
+
+    void setNodeName(int, const std::string&) { throwFrozen_("setNodeName", this); }
+
+    void deleteNodeName(int) { throwFrozen_("deleteNodeName", this); }
+
+    bool hasNodeName(int nodeId) const { return nameIndices_[getIndex_(nodeId)] >= 0; }
+
+    bool hasNode(int nodeId) const { return findNodeIndex_(nodeId) >= 0; }
+
+    bool isLeaf(int nodeId) const { return getDegree(getIndex_(nodeId)) <= 1; }
+
+    bool isRoot(int nodeId) const { return getIndex_(nodeId) == 0; }
+
+    double getDistanceToFather(int nodeId) const;
+
+    void setDistanceToFather(int, double) { throwFrozen_("setDistanceToFather", this); }
+
+    void deleteDistanceToFather(int) { throwFrozen_("deleteDistanceToFather", this); }
+
+    bool hasDistanceToFather(int nodeId) const { return !std::isnan(lengths_[getIndex_(nodeId)]); }
+
+    bool hasNodeProperty(int nodeId, const std::string& name) const { return nodeProperties_.hasProperty(getIndex_(nodeId), name); }
+
+    void setNodeProperty(int nodeId, const std::string& name, const Clonable& property) { nodeProperties_.setProperty(getIndex_(nodeId), name, property); }
+
+    Clonable* getNodeProperty(int nodeId, const std::string& name) { return nodeProperties_.getProperty(getPropertyIndex_(nodeProperties_, nodeId, name, "getNodeProperty"), name); }
+
+    const Clonable* getNodeProperty(int nodeId, const std::string& name) const { return nodeProperties_.getProperty(getPropertyIndex_(nodeProperties_, nodeId, name, "getNodeProperty"), name); }
+
+    Clonable* removeNodeProperty(int nodeId, const std::string& name) { return nodeProperties_.removeProperty(getPropertyIndex_(nodeProperties_, nodeId, name, "removeNodeProperty"), name); }
+
+    std::vector<std::string> getNodePropertyNames(int nodeId) const { return nodeProperties_.getPropertyNames(getIndex_(nodeId)); }
+
+    bool hasBranchProperty(int nodeId, const std::string& name) const { return branchProperties_.hasProperty(getIndex_(nodeId), name); }
+
+    void setBranchProperty(int nodeId, const std::string& name, const Clonable& property) { branchProperties_.setProperty(getIndex_(nodeId), name, property); }
+
+    Clonable* getBranchProperty(int nodeId, const std::string& name) { return branchProperties_.getProperty(getPropertyIndex_(branchProperties_, nodeId, name, "getBranchProperty"), name); }
+
+    const Clonable* getBranchProperty(int nodeId, const std::string& name) const { return branchProperties_.getProperty(getPropertyIndex_(branchProperties_, nodeId, name, "getBranchProperty"), name); }
+
+    Clonable* removeBranchProperty(int nodeId, const std::string& name) { return branchProperties_.removeProperty(getPropertyIndex_(branchProperties_, nodeId, name, "removeBranchProperty"), name); }
+
+    std::vector<std::string> getBranchPropertyNames(int nodeId) const { return branchProperties_.getPropertyNames(getIndex_(nodeId)); }
+
+    bool hasBootstrapValue(int nodeId) const;
+
+    double getBootstrapValue(int nodeId) const;
+
+    void setBootstrapValue(int nodeId, double value);
+
+    void rootAt(int) { throwFrozen_("rootAt", this); }
+
+    void newOutGroup(int) { throwFrozen_("newOutGroup", this); }
+
+    bool isRooted() const { return getNumberOfSons(0) == 2; }
+
+    bool unroot() { throwFrozen_("unroot", this); return false; }
+
+    void resetNodesId() { throwFrozen_("resetNodesId", this); }
+
+    bool isMultifurcating() const;
+
+    std::vector<double> getBranchLengths() { return const_cast<const FrozenTree*>(this)->getBranchLengths(); }
+
+    double getTotalLength();
+
+    void setBranchLengths(double) { throwFrozen_("setBranchLengths", this); }
+
+    void setVoidBranchLengths(double) { throwFrozen_("setVoidBranchLengths", this); }
+
+    void scaleTree(double) { throwFrozen_("scaleTree", this); }
+
+    int getNextId();
+
+    /** @} */
+};
+
+} //end of namespace bpp.
+
+#endif //_FROZENTREE_H_
+
@@ -141,16 +141,15 @@ void BootstrapValuesTreeDrawingListener::afterDrawBranch(const DrawBranchEvent&
   {
     //Pointer-based event (efficient):
     const DrawINodeEvent& eventC = dynamic_cast<const DrawINodeEvent&>(event);
-    if (eventC.getINode()->hasBranchProperty(TreeTools::BOOTSTRAP))
+    if (eventC.getINode()->hasBootstrapValue())
     {
-      const Clonable* b = eventC.getINode()->getBranchProperty(TreeTools::BOOTSTRAP);
       GraphicDevice* gd = event.getGraphicDevice();
       Cursor cursor     = event.getCursor();
       Font fontBck      = gd->getCurrentFont();
       if (settings_)
         gd->setCurrentFont(settings_->fontBranchLengths);
       gd->drawText(cursor.getX(), cursor.getY(),
-          TextTools::toString(dynamic_cast<const Number<double> *>(b)->getValue()),
+          TextTools::toString(eventC.getINode()->getBootstrapValue()),
           cursor.getHPos(), GraphicDevice::TEXT_VERTICAL_CENTER, cursor.getAngle());
       gd->setCurrentFont(fontBck);
     }
@@ -159,16 +158,15 @@ void BootstrapValuesTreeDrawingListener::afterDrawBranch(const DrawBranchEvent&
   {
     //Id-based event (less-efficient):
     const TreeDrawing* td = event.getTreeDrawing();
-    if (td->getTree()->hasBranchProperty(event.getNodeId(), TreeTools::BOOTSTRAP))
+    if (td->getTree()->hasBootstrapValue(event.getNodeId()))
     {
-      const Clonable* b = td->getTree()->getBranchProperty(event.getNodeId(), TreeTools::BOOTSTRAP);
       GraphicDevice* gd = event.getGraphicDevice();
       Cursor cursor     = event.getCursor();
       Font fontBck      = gd->getCurrentFont();
       if (settings_)
         gd->setCurrentFont(settings_->fontLeafNames);
       gd->drawText(cursor.getX(), cursor.getY(),
-          TextTools::toString(dynamic_cast<const Number<double> *>(b)->getValue()),
+          TextTools::toString(td->getTree()->getBootstrapValue(event.getNodeId())),
           cursor.getHPos(), GraphicDevice::TEXT_VERTICAL_CENTER, cursor.getAngle());
       gd->setCurrentFont(fontBck);
     }
@@ -0,0 +1,479 @@
+//
+// File: BinaryTreeSet.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "BinaryTreeSet.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+// From the STL:
+#include <sstream>
+#include <cstring>
+
+using namespace std;
+
+/******************************************************************************/
+
+const char BinaryTreeSet::MAGIC[8] = { 'B', 'P', 'P', 'T', 'R', 'E', 'E', 'S' };
+
+/******************************************************************************/
+
+const string BinaryTreeSet::getFormatName() const { return "Binary tree set"; }
+
+/******************************************************************************/
+
+const string BinaryTreeSet::getFormatDescription() const
+{
+  return string("Bio++ binary format for sets of trees, with a shared name table and an index for random access.");
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::writeUInt32_(ostream& out, uint32_t value)
+{
+  char bytes[4];
+  for (size_t i = 0; i < 4; i++)
+  {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+  out.write(bytes, 4);
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::writeUInt64_(ostream& out, uint64_t value)
+{
+  char bytes[8];
+  for (size_t i = 0; i < 8; i++)
+  {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+  out.write(bytes, 8);
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::writeDouble_(ostream& out, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  writeUInt64_(out, bits);
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::writeString_(ostream& out, const string& value)
+{
+  writeUInt32_(out, static_cast<uint32_t>(value.size()));
+  out.write(value.data(), static_cast<streamsize>(value.size()));
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::writeProperties_(ostream& out, const PropertyTable& properties, size_t nbNodes)
+{
+  vector<size_t> keys;
+  for (size_t key = 0; key < properties.getNumberOfKeys(); key++)
+  {
+    if (properties.getType(key) != PropertyTable::OBJECT)
+      keys.push_back(key);
+  }
+  writeUInt32_(out, static_cast<uint32_t>(keys.size()));
+  for (size_t k = 0; k < keys.size(); k++)
+  {
+    size_t key = keys[k];
+    writeUInt32_(out, static_cast<uint32_t>(properties.getType(key)));
+    writeString_(out, properties.getKeyName(key));
+    vector<uint32_t> indices;
+    for (size_t i = 0; i < nbNodes; i++)
+    {
+      if (properties.hasValue(key, i))
+        indices.push_back(static_cast<uint32_t>(i));
+    }
+    writeUInt32_(out, static_cast<uint32_t>(indices.size()));
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      writeUInt32_(out, indices[i]);
+      switch (properties.getType(key))
+      {
+      case PropertyTable::DOUBLE:
+        writeDouble_(out, properties.getDouble(key, indices[i]));
+        break;
+      case PropertyTable::INT:
+        writeUInt32_(out, static_cast<uint32_t>(properties.getInt(key, indices[i])));
+        break;
+      case PropertyTable::STRING:
+        writeString_(out, properties.getString(key, indices[i]));
+        break;
+      case PropertyTable::OBJECT:
+        break;
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::readBytes_(istream& in, char* bytes, size_t size)
+{
+  in.read(bytes, static_cast<streamsize>(size));
+  if (static_cast<size_t>(in.gcount()) != size)
+    throw IOException("BinaryTreeSet: unexpected end of file.");
+}
+
+/******************************************************************************/
+
+uint32_t BinaryTreeSet::decodeUInt32_(const unsigned char* bytes)
+{
+  uint32_t value = 0;
+  for (size_t i = 0; i < 4; i++)
+  {
+    value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+/******************************************************************************/
+
+uint64_t BinaryTreeSet::decodeUInt64_(const unsigned char* bytes)
+{
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; i++)
+  {
+    value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+/******************************************************************************/
+
+double BinaryTreeSet::decodeDouble_(const unsigned char* bytes)
+{
+  uint64_t bits = decodeUInt64_(bytes);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/******************************************************************************/
+
+uint32_t BinaryTreeSet::readUInt32_(istream& in)
+{
+  unsigned char bytes[4];
+  readBytes_(in, reinterpret_cast<char*>(bytes), 4);
+  return decodeUInt32_(bytes);
+}
+
+/******************************************************************************/
+
+uint64_t BinaryTreeSet::readUInt64_(istream& in)
+{
+  unsigned char bytes[8];
+  readBytes_(in, reinterpret_cast<char*>(bytes), 8);
+  return decodeUInt64_(bytes);
+}
+
+/******************************************************************************/
+
+double BinaryTreeSet::readDouble_(istream& in)
+{
+  unsigned char bytes[8];
+  readBytes_(in, reinterpret_cast<char*>(bytes), 8);
+  return decodeDouble_(bytes);
+}
+
+/******************************************************************************/
+
+string BinaryTreeSet::readString_(istream& in)
+{
+  uint32_t size = readUInt32_(in);
+  string value(size, '\0');
+  if (size > 0)
+    readBytes_(in, &value[0], size);
+  return value;
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::readProperties_(istream& in, PropertyTable& properties, size_t nbNodes)
+{
+  uint32_t nbKeys = readUInt32_(in);
+  for (uint32_t k = 0; k < nbKeys; k++)
+  {
+    uint32_t type = readUInt32_(in);
+    if (type >= PropertyTable::OBJECT)
+      throw IOException("BinaryTreeSet: unknown property type " + TextTools::toString(type) + ".");
+    size_t key = properties.getKey(readString_(in), static_cast<PropertyTable::Type>(type));
+    uint32_t nbValues = readUInt32_(in);
+    for (uint32_t i = 0; i < nbValues; i++)
+    {
+      uint32_t index = readUInt32_(in);
+      if (index >= nbNodes)
+        throw IOException("BinaryTreeSet: property of an unknown node.");
+      switch (type)
+      {
+      case PropertyTable::DOUBLE:
+        properties.setDouble(key, index, readDouble_(in));
+        break;
+      case PropertyTable::INT:
+        properties.setInt(key, index, static_cast<int>(readUInt32_(in)));
+        break;
+      case PropertyTable::STRING:
+        properties.setString(key, index, readString_(in));
+        break;
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::write(const vector<Tree*>& trees, const string& path, bool overwrite) const
+{
+  if (!overwrite)
+    throw IOException("BinaryTreeSet::write: trees can not be appended to an existing file.");
+  ofstream output(path.c_str(), ios::out | ios::binary);
+  write(trees, output);
+  output.close();
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::write(const vector<Tree*>& trees, ostream& out) const
+{
+  // Checking the existence of specified file, and possibility to open it in write mode
+  if (! out) { throw IOException ("BinaryTreeSet::write: failed to write to stream"); }
+
+  // All names are interned first, so that the table can be written before the trees:
+  shared_ptr<FrozenTree::NameTable> names(new FrozenTree::NameTable());
+  for (size_t i = 0; i < trees.size(); i++)
+  {
+    vector<int> ids = trees[i]->getNodesId();
+    for (size_t j = 0; j < ids.size(); j++)
+    {
+      if (trees[i]->hasNodeName(ids[j]))
+        names->intern(trees[i]->getNodeName(ids[j]));
+    }
+  }
+
+  out.write(MAGIC, sizeof(MAGIC));
+  writeUInt32_(out, 1); // Version
+  writeUInt32_(out, static_cast<uint32_t>(names->size()));
+  uint64_t offset = sizeof(MAGIC) + 8;
+  for (size_t i = 0; i < names->size(); i++)
+  {
+    writeString_(out, names->getName(i));
+    offset += 4 + names->getName(i).size();
+  }
+
+  // Trees are frozen one at a time, with the same name table:
+  vector<uint64_t> offsets(trees.size());
+  for (size_t i = 0; i < trees.size(); i++)
+  {
+    const TreeTemplate<Node>* treeTemplate = dynamic_cast<const TreeTemplate<Node>*>(trees[i]);
+    unique_ptr<FrozenTree> frozen(treeTemplate ? new FrozenTree(*treeTemplate, names) : new FrozenTree(*trees[i], names));
+    size_t nbNodes = frozen->getNumberOfNodes();
+    ostringstream record(ios::out | ios::binary);
+    writeUInt32_(record, static_cast<uint32_t>(nbNodes));
+    writeString_(record, frozen->getName());
+    for (size_t j = 0; j < nbNodes; j++)
+    {
+      writeUInt32_(record, static_cast<uint32_t>(frozen->getNodeId(j)));
+    }
+    for (size_t j = 0; j < nbNodes; j++)
+    {
+      writeUInt32_(record, static_cast<uint32_t>(frozen->getFatherIndex(j)));
+    }
+    for (size_t j = 0; j < nbNodes; j++)
+    {
+      writeUInt32_(record, static_cast<uint32_t>(frozen->getNameIndex(j)));
+    }
+    for (size_t j = 0; j < nbNodes; j++)
+    {
+      writeDouble_(record, frozen->getBranchLength(j));
+    }
+    writeProperties_(record, frozen->getNodeProperties(), nbNodes);
+    writeProperties_(record, frozen->getBranchProperties(), nbNodes);
+
+    string data = record.str();
+    out.write(data.data(), static_cast<streamsize>(data.size()));
+    offsets[i] = offset;
+    offset += data.size();
+  }
+
+  // The index, then its position, are at the end of the file:
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    writeUInt64_(out, offsets[i]);
+  }
+  writeUInt64_(out, offsets.size());
+  writeUInt64_(out, offset);
+  if (! out) { throw IOException ("BinaryTreeSet::write: failed to write to stream"); }
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::read(const string& path, vector<Tree*>& trees) const
+{
+  Reader reader(path);
+  for (size_t i = 0; i < reader.getNumberOfTrees(); i++)
+  {
+    trees.push_back(reader.getTree(i));
+  }
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::read(istream& in, vector<Tree*>& trees) const
+{
+  Reader reader(in);
+  for (size_t i = 0; i < reader.getNumberOfTrees(); i++)
+  {
+    trees.push_back(reader.getTree(i));
+  }
+}
+
+/******************************************************************************/
+
+BinaryTreeSet::Reader::Reader(const string& path) :
+  file_(new ifstream(path.c_str(), ios::in | ios::binary)),
+  in_(file_.get()),
+  start_(0),
+  names_(),
+  offsets_(),
+  indexOffset_(0)
+{
+  readHeader_();
+}
+
+/******************************************************************************/
+
+BinaryTreeSet::Reader::Reader(istream& in) :
+  file_(),
+  in_(&in),
+  start_(0),
+  names_(),
+  offsets_(),
+  indexOffset_(0)
+{
+  readHeader_();
+}
+
+/******************************************************************************/
+
+void BinaryTreeSet::Reader::readHeader_()
+{
+  if (! *in_) { throw IOException ("BinaryTreeSet::Reader: failed to read from stream"); }
+  start_ = in_->tellg();
+  char magic[sizeof(MAGIC)];
+  readBytes_(*in_, magic, sizeof(MAGIC));
+  if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    throw IOException("BinaryTreeSet::Reader: not a binary tree set.");
+  uint32_t version = readUInt32_(*in_);
+  if (version != 1)
+    throw IOException("BinaryTreeSet::Reader: unsupported version " + TextTools::toString(version) + ".");
+  uint32_t nbNames = readUInt32_(*in_);
+  names_.reset(new FrozenTree::NameTable());
+  for (uint32_t i = 0; i < nbNames; i++)
+  {
+    if (names_->intern(readString_(*in_)) != static_cast<int>(i))
+      throw IOException("BinaryTreeSet::Reader: duplicated name in table.");
+  }
+
+  // Read the index, from the end of the file:
+  in_->seekg(0, ios::end);
+  streamoff size = static_cast<streamoff>(in_->tellg()) - start_;
+  if (size < 16)
+    throw IOException("BinaryTreeSet::Reader: unexpected end of file.");
+  in_->seekg(start_ + size - 16);
+  uint64_t nbTrees = readUInt64_(*in_);
+  indexOffset_ = readUInt64_(*in_);
+  if (nbTrees > static_cast<uint64_t>(size) / 8 || indexOffset_ + 8 * nbTrees + 16 != static_cast<uint64_t>(size))
+    throw IOException("BinaryTreeSet::Reader: corrupted index.");
+  in_->seekg(start_ + static_cast<streamoff>(indexOffset_));
+  offsets_.resize(static_cast<size_t>(nbTrees));
+  for (size_t i = 0; i < offsets_.size(); i++)
+  {
+    offsets_[i] = readUInt64_(*in_);
+    if (offsets_[i] >= indexOffset_)
+      throw IOException("BinaryTreeSet::Reader: corrupted index.");
+  }
+}
+
+/******************************************************************************/
+
+FrozenTree* BinaryTreeSet::Reader::getTree(size_t index)
+{
+  if (index >= offsets_.size())
+    throw IndexOutOfBoundsException("BinaryTreeSet::Reader::getTree.", index, 0, offsets_.size());
+  in_->clear();
+  in_->seekg(start_ + static_cast<streamoff>(offsets_[index]));
+  size_t nbNodes = readUInt32_(*in_);
+  if (offsets_[index] + 20 * static_cast<uint64_t>(nbNodes) > indexOffset_)
+    throw IOException("BinaryTreeSet::Reader: corrupted tree.");
+  string name = readString_(*in_);
+
+  // The four arrays are contiguous, they are read at once:
+  vector<unsigned char> buffer(20 * nbNodes);
+  readBytes_(*in_, reinterpret_cast<char*>(buffer.data()), buffer.size());
+  const unsigned char* idBytes     = buffer.data();
+  const unsigned char* fatherBytes = idBytes + 4 * nbNodes;
+  const unsigned char* nameBytes   = fatherBytes + 4 * nbNodes;
+  const unsigned char* lengthBytes = nameBytes + 4 * nbNodes;
+  vector<int> ids(nbNodes), fathers(nbNodes), nameIndices(nbNodes);
+  vector<double> lengths(nbNodes);
+  for (size_t i = 0; i < nbNodes; i++)
+  {
+    ids[i]         = static_cast<int>(decodeUInt32_(idBytes + 4 * i));
+    fathers[i]     = static_cast<int>(decodeUInt32_(fatherBytes + 4 * i));
+    nameIndices[i] = static_cast<int>(decodeUInt32_(nameBytes + 4 * i));
+    lengths[i]     = decodeDouble_(lengthBytes + 8 * i);
+  }
+
+  unique_ptr<FrozenTree> tree(new FrozenTree(ids, fathers, lengths, nameIndices, names_));
+  tree->setName(name);
+  readProperties_(*in_, tree->getNodeProperties(), nbNodes);
+  readProperties_(*in_, tree->getBranchProperties(), nbNodes);
+  return tree.release();
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,192 @@
+//
+// File: BinaryTreeSet.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _BINARYTREESET_H_
+#define _BINARYTREESET_H_
+
+#include "IoTree.h"
+#include "../FrozenTree.h"
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+namespace bpp
+{
+
+/**
+ * @brief A compact binary format for sets of trees.
+ *
+ * Unlike text formats, nothing needs to be parsed or formatted: names are stored once
+ * in a table at the beginning of the file, and each tree is stored as flat arrays,
+ * in preorder, of node ids, father indices, name indices and branch lengths, followed by
+ * its DOUBLE, INT and STRING node and branch properties (see PropertyTable).
+ * Other properties are not written. An index of the trees is stored at the end of the
+ * file, so that any tree can be read directly with a BinaryTreeSet::Reader:
+ * @code
+ * BinaryTreeSet::Reader reader("trees.bin");
+ * for (size_t i = 0; i < reader.getNumberOfTrees(); i += 10)
+ * {
+ *   std::unique_ptr<FrozenTree> tree(reader.getTree(i));
+ *   ...
+ * }
+ * @endcode
+ *
+ * Trees are read as FrozenTree objects, all sharing the name table of the file.
+ * Numbers are stored in little-endian order, so that files can be exchanged between platforms.
+ */
+class BinaryTreeSet:
+  public AbstractIMultiTree,
+  public AbstractOMultiTree
+{
+  public:
+    /**
+     * @brief Random access to the trees of a binary file.
+     *
+     * Only the name table and the index are loaded when the reader is created.
+     * Readers are not thread-safe: threads must use distinct readers.
+     */
+    class Reader
+    {
+      private:
+        std::unique_ptr<std::ifstream> file_;
+        std::istream* in_;
+        std::streamoff start_;
+        std::shared_ptr<FrozenTree::NameTable> names_;
+        std::vector<uint64_t> offsets_;
+        uint64_t indexOffset_;
+
+      public:
+        /**
+         * @param path The path of the file to read.
+         * @throw IOException If the file can not be read or is not a binary tree set.
+         */
+        Reader(const std::string& path);
+
+        /**
+         * @param in A seekable input stream, which must outlive the reader.
+         * @throw IOException If the stream can not be read or is not a binary tree set.
+         */
+        Reader(std::istream& in);
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        virtual ~Reader() {}
+
+      public:
+        size_t getNumberOfTrees() const { return offsets_.size(); }
+
+        std::shared_ptr<FrozenTree::NameTable> getNameTable() const { return names_; }
+
+        /**
+         * @param index The index of the tree in the file.
+         * @return A new tree.
+         * @throw IndexOutOfBoundsException If there is no such tree.
+         * @throw IOException If the file is corrupted.
+         */
+        FrozenTree* getTree(size_t index);
+
+      private:
+        void readHeader_();
+    };
+
+  public:
+    BinaryTreeSet() {}
+    virtual ~BinaryTreeSet() {}
+
+  public:
+    /**
+     * @name The IOTree interface
+     *
+     * @{
+     */
+    const std::string getFormatName() const;
+    const std::string getFormatDescription() const;
+    /* @} */
+
+    /**
+     * @name The IMultiTree interface
+     *
+     * Trees are read as FrozenTree objects.
+     *
+     * @{
+     */
+    void read(const std::string& path, std::vector<Tree*>& trees) const;
+    void read(std::istream& in, std::vector<Tree*>& trees) const;
+    /**@}*/
+
+    /**
+     * @name The OMultiTree interface
+     *
+     * Appending to an existing file is not supported.
+     *
+     * @{
+     */
+    void write(const std::vector<Tree*>& trees, const std::string& path, bool overwrite = true) const;
+    void write(const std::vector<Tree*>& trees, std::ostream& out) const;
+    /** @} */
+
+  private:
+    static const char MAGIC[8];
+
+    static void writeUInt32_(std::ostream& out, uint32_t value);
+    static void writeUInt64_(std::ostream& out, uint64_t value);
+    static void writeDouble_(std::ostream& out, double value);
+    static void writeString_(std::ostream& out, const std::string& value);
+    static void writeProperties_(std::ostream& out, const PropertyTable& properties, size_t nbNodes);
+
+    static uint32_t decodeUInt32_(const unsigned char* bytes);
+    static uint64_t decodeUInt64_(const unsigned char* bytes);
+    static double decodeDouble_(const unsigned char* bytes);
+    static uint32_t readUInt32_(std::istream& in);
+    static uint64_t readUInt64_(std::istream& in);
+    static double readDouble_(std::istream& in);
+    static std::string readString_(std::istream& in);
+    static void readBytes_(std::istream& in, char* bytes, size_t size);
+    static void readProperties_(std::istream& in, PropertyTable& properties, size_t nbNodes);
+};
+
+} //end of namespace bpp.
+
+#endif //_BINARYTREESET_H_
+
@@ -40,6 +40,9 @@
 // From the STL
 #include <vector>
 #include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
 
 // From Bio++
 #include <Bpp/Text/TextTools.h>
@@ -274,3 +277,136 @@ vector<double> IOPhymlPairedSiteLikelihoods::read(const std::string& path)
   return loglikelihoods;
 }
 
+namespace
+{
+const char BINARY_MAGIC[8] = { 'B', 'p', 'p', 'P', 'S', 'L', '1', '\n' };
+const uint32_t BINARY_BYTE_ORDER = 0x01020304;
+
+template<class T>
+void swapBytes(T& x)
+{
+  char* bytes = reinterpret_cast<char*>(&x);
+  reverse(bytes, bytes + sizeof(T));
+}
+
+template<class T>
+void readBinary(istream& is, T& x, bool swap)
+{
+  is.read(reinterpret_cast<char*>(&x), sizeof(T));
+  if (!is)
+    throw Exception("IOBinaryPairedSiteLikelihoods::read: Unexpected end of stream.");
+  if (swap)
+    swapBytes(x);
+}
+
+template<class T>
+void writeBinary(ostream& os, const T& x)
+{
+  os.write(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+}
+
+/*
+ * Read from a stream in binary format
+ */
+PairedSiteLikelihoods IOBinaryPairedSiteLikelihoods::read(std::istream& is)
+{
+  char magic[8];
+  is.read(magic, 8);
+  if (!is || !equal(magic, magic + 8, BINARY_MAGIC))
+    throw Exception("IOBinaryPairedSiteLikelihoods::read: Not a binary paired-site likelihoods stream.");
+
+  uint32_t byteOrder;
+  readBinary(is, byteOrder, false);
+  bool swap = false;
+  if (byteOrder != BINARY_BYTE_ORDER)
+  {
+    swapBytes(byteOrder);
+    if (byteOrder != BINARY_BYTE_ORDER)
+      throw Exception("IOBinaryPairedSiteLikelihoods::read: Unrecognized byte order mark.");
+    swap = true;
+  }
+
+  uint64_t nmodels, nsites;
+  readBinary(is, nmodels, swap);
+  readBinary(is, nsites, swap);
+
+  vector<string> names;
+  for (uint64_t i = 0; i < nmodels; ++i)
+  {
+    uint64_t length;
+    readBinary(is, length, swap);
+    string name(static_cast<size_t>(length), ' ');
+    if (length > 0)
+      is.read(&name[0], static_cast<streamsize>(length));
+    if (!is)
+      throw Exception("IOBinaryPairedSiteLikelihoods::read: Unexpected end of stream.");
+    names.push_back(name);
+  }
+
+  vector<vector<double> > loglikelihoods(static_cast<size_t>(nmodels), vector<double>(static_cast<size_t>(nsites)));
+  for (size_t i = 0; i < loglikelihoods.size(); ++i)
+  {
+    vector<double>& row = loglikelihoods[i];
+    if (row.empty())
+      continue;
+    is.read(reinterpret_cast<char*>(&row[0]), static_cast<streamsize>(row.size() * sizeof(double)));
+    if (!is)
+      throw Exception("IOBinaryPairedSiteLikelihoods::read: Unexpected end of stream.");
+    if (swap)
+      for_each(row.begin(), row.end(), swapBytes<double>);
+  }
+
+  PairedSiteLikelihoods psl (loglikelihoods, names);
+
+  return psl;
+}
+
+/*
+ * Read from a file in binary format
+ */
+PairedSiteLikelihoods IOBinaryPairedSiteLikelihoods::read(const std::string& path)
+{
+  ifstream iF (path.c_str(), ios::in | ios::binary);
+  if (!iF)
+    throw Exception("IOBinaryPairedSiteLikelihoods::read: Could not open file " + path);
+  PairedSiteLikelihoods psl (IOBinaryPairedSiteLikelihoods::read(iF));
+  return psl;
+}
+
+/*
+ * Write to a stream in binary format
+ */
+void IOBinaryPairedSiteLikelihoods::write(const bpp::PairedSiteLikelihoods& psl, ostream& os)
+{
+  if (psl.getLikelihoods().size() == 0)
+    throw Exception("Writing an empty PairedSiteLikelihoods object to file.");
+
+  os.write(BINARY_MAGIC, 8);
+  writeBinary(os, BINARY_BYTE_ORDER);
+  writeBinary(os, static_cast<uint64_t>(psl.getNumberOfModels()));
+  writeBinary(os, static_cast<uint64_t>(psl.getNumberOfSites()));
+  for (size_t i = 0; i < psl.getNumberOfModels(); ++i)
+  {
+    const string& name = psl.getModelNames().at(i);
+    writeBinary(os, static_cast<uint64_t>(name.size()));
+    os.write(name.data(), static_cast<streamsize>(name.size()));
+  }
+  for (size_t i = 0; i < psl.getNumberOfModels(); ++i)
+  {
+    const vector<double>& row = psl.getLikelihoods().at(i);
+    if (!row.empty())
+      os.write(reinterpret_cast<const char*>(&row[0]), static_cast<streamsize>(row.size() * sizeof(double)));
+  }
+  if (!os)
+    throw Exception("IOBinaryPairedSiteLikelihoods::write: Error while writing.");
+}
+
+/*
+ * Write to a file in binary format
+ */
+void IOBinaryPairedSiteLikelihoods::write(const bpp::PairedSiteLikelihoods& psl, const std::string& path)
+{
+  ofstream oF (path.c_str(), ios::out | ios::binary);
+  IOBinaryPairedSiteLikelihoods::write(psl, oF);
+}
@@ -122,5 +122,52 @@ public:
    */
   static std::vector<double> read(const std::string& path);
 };
+
+/**
+ * @brief This class provides I/O for a binary paired-site likelihoods format.
+ *
+ * The binary format is much faster to read and write than the text ones, and stores
+ * log-likelihoods without any loss of precision. It is made of:
+ * - the eight characters "BppPSL1\n",
+ * - the 32 bits integer 0x01020304, used to detect the byte order of the writer,
+ * - the number of models and the number of sites, as 64 bits integers,
+ * - for each model, the length of its name as a 64 bits integer, followed by the name,
+ * - all site log-likelihoods, as IEEE doubles in [model][site] order.
+ *
+ * Numbers are written in the byte order of the writer, and swapped if needed when read.
+ */
+class IOBinaryPairedSiteLikelihoods : public virtual IOPairedSiteLikelihoods
+{
+public:
+  /**
+   * @brief Read paired-site likelihoods from a binary stream.
+   *
+   * @throw Exception If the format is not recognized or the stream is truncated.
+   */
+  static PairedSiteLikelihoods read(std::istream& is);
+
+  /**
+   * @brief Read paired-site likelihoods from a binary file.
+   *
+   * @throw Exception If the format is not recognized or the file is truncated.
+   */
+  static PairedSiteLikelihoods read(const std::string& path);
+
+  /**
+   * @brief Write paired-site likelihoods to a binary stream.
+   *
+   * @param psl The PairedSiteLikelihoods object to write.
+   * @param os The output stream.
+   */
+  static void write(const PairedSiteLikelihoods& psl, std::ostream& os);
+
+  /**
+   * @brief Write paired-site likelihoods to a binary file.
+   *
+   * @param psl The PairedSiteLikelihoods object to write.
+   * @param path The path of the output file.
+   */
+  static void write(const PairedSiteLikelihoods& psl, const std::string& path);
+};
 } // namespace bpp
 #endif
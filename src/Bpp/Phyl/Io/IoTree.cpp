@@ -0,0 +1,178 @@
+//
+// File: IoTree.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "IoTree.h"
+#include "../ParallelTools.h"
+
+using namespace bpp;
+
+// From the STL:
+#include <thread>
+#include <exception>
+
+using namespace std;
+
+/******************************************************************************/
+
+void AbstractIMultiTree::parseInParallel_(
+    const function<bool (string&)>& nextDescription,
+    const function<Tree* (const string&)>& parse,
+    vector<Tree*>& trees,
+    unsigned int nbThreads)
+{
+  nbThreads = ParallelTools::getNumberOfThreads(nbThreads);
+  string description;
+  if (nbThreads == 1)
+  {
+    while (nextDescription(description))
+      trees.push_back(parse(description));
+    return;
+  }
+
+  // Batches are large enough for the threads to share the work evenly:
+  size_t batchSize = 64 * static_cast<size_t>(nbThreads);
+  vector<string> current, next;
+  while (current.size() < batchSize && nextDescription(description))
+    current.push_back(description);
+  while (!current.empty())
+  {
+    vector<Tree*> parsed(current.size(), 0);
+    vector<exception_ptr> errors(current.size());
+    thread parser([&]() {
+      ParallelTools::runInParallel(current.size(), nbThreads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+          try
+          {
+            parsed[i] = parse(current[i]);
+          }
+          catch (...)
+          {
+            errors[i] = current_exception();
+          }
+        }
+      });
+    });
+
+    // Read the next batch meanwhile:
+    exception_ptr readError;
+    next.clear();
+    try
+    {
+      while (next.size() < batchSize && nextDescription(description))
+        next.push_back(description);
+    }
+    catch (...)
+    {
+      readError = current_exception();
+    }
+    parser.join();
+
+    for (size_t i = 0; i < parsed.size(); i++)
+    {
+      if (errors[i])
+      {
+        for (size_t j = i + 1; j < parsed.size(); j++)
+        {
+          delete parsed[j];
+        }
+        rethrow_exception(errors[i]);
+      }
+      trees.push_back(parsed[i]);
+    }
+    if (readError)
+      rethrow_exception(readError);
+    current.swap(next);
+  }
+}
+
+/******************************************************************************/
+
+void AbstractOMultiTree::writeInParallel_(
+    const vector<Tree*>& trees,
+    const function<void (const Tree&, ostream&)>& format,
+    ostream& out,
+    unsigned int nbThreads)
+{
+  nbThreads = ParallelTools::getNumberOfThreads(nbThreads);
+  if (nbThreads == 1)
+  {
+    for (size_t i = 0; i < trees.size(); i++)
+    {
+      format(*trees[i], out);
+    }
+    return;
+  }
+
+  size_t batchSize = 64 * static_cast<size_t>(nbThreads);
+  // Buffers are indexed by the first tree of the range they contain:
+  vector<string> buffers(min(batchSize, trees.size()));
+  vector<exception_ptr> errors(buffers.size());
+  for (size_t first = 0; first < trees.size(); first += batchSize)
+  {
+    size_t n = min(batchSize, trees.size() - first);
+    ParallelTools::runInParallel(n, nbThreads, [&](size_t begin, size_t end) {
+      ostringstream buffer;
+      buffer.precision(out.precision());
+      buffer.flags(out.flags());
+      try
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          format(*trees[first + i], buffer);
+        }
+      }
+      catch (...)
+      {
+        errors[begin] = current_exception();
+      }
+      buffers[begin] = buffer.str();
+    });
+    for (size_t i = 0; i < n; i++)
+    {
+      out << buffers[i];
+      buffers[i].clear();
+      if (errors[i])
+        rethrow_exception(errors[i]);
+    }
+  }
+}
+
+/******************************************************************************/
+
@@ -47,6 +47,10 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
 
 #include <Bpp/Exceptions.h>
 #include <Bpp/Io/IoFormat.h>
@@ -266,6 +270,25 @@ class AbstractIMultiTree:
       input.close();
     }
 
+  protected:
+    /**
+     * @brief Parse trees in parallel, in the order of their descriptions.
+     *
+     * Descriptions are read by batches in the current thread, while the previous batch is parsed
+     * by a pool of threads. If an error occurs, the trees before the faulty one are added to
+     * the vector and the exception is rethrown.
+     *
+     * @param nextDescription Get the next tree description, or return false if none is left.
+     * @param parse           Parse a description into a new tree. Must be thread-safe.
+     * @param trees           The output trees container.
+     * @param nbThreads       The number of parsing threads. 0 means as many as the hardware supports.
+     */
+    static void parseInParallel_(
+        const std::function<bool (std::string&)>& nextDescription,
+        const std::function<Tree* (const std::string&)>& parse,
+        std::vector<Tree*>& trees,
+        unsigned int nbThreads);
+
 };
 
 /**
@@ -287,6 +310,155 @@ class AbstractOMultiTree:
       write(trees, output);
       output.close();
     }
+
+  protected:
+    /**
+     * @brief Format trees in parallel and write them in their original order.
+     *
+     * Trees are processed by batches: each thread formats a contiguous range of the batch into its
+     * own buffer, and the buffers are then written to the stream in order. Buffers use the
+     * precision and format flags of the output stream. If an error occurs, the trees before the
+     * faulty one are written and the exception is rethrown.
+     *
+     * @param trees     The trees to write.
+     * @param format    Write a single tree to a stream. Must be thread-safe.
+     * @param out       The output stream.
+     * @param nbThreads The number of formatting threads. 0 means as many as the hardware supports.
+     */
+    static void writeInParallel_(
+        const std::vector<Tree*>& trees,
+        const std::function<void (const Tree&, std::ostream&)>& format,
+        std::ostream& out,
+        unsigned int nbThreads);
+};
+
+/**
+ * @brief General interface for readers parsing the trees of a stream one at a time.
+ *
+ * Unlike IMultiTree::read, which loads all the trees of a file in a vector, only the tree
+ * being read is kept in memory, so that files with millions of trees, such as the output
+ * of MCMC samplers, can be processed.
+ */
+class ITreeStream:
+  public virtual IOTree
+{
+  public:
+    ITreeStream() {}
+    virtual ~ITreeStream() {}
+
+  public:
+    /**
+     * @brief Read the next tree of a stream.
+     *
+     * @param in The input stream.
+     * @return A new tree object, or 0 if there is no tree left in the stream.
+     * @throw Exception If an error occured.
+     */
+    virtual Tree* readNextTree(std::istream& in) const = 0;
+
+    /**
+     * @brief Skip the next tree of a stream, without parsing it.
+     *
+     * @param in The input stream.
+     * @return False if there was no tree left in the stream.
+     */
+    virtual bool skipNextTree(std::istream& in) const = 0;
+};
+
+/**
+ * @brief Partial implementation of the ITreeStream interface.
+ */
+class AbstractITreeStream:
+  public virtual ITreeStream
+{
+  public:
+    AbstractITreeStream() {}
+    virtual ~AbstractITreeStream() {}
+
+  public:
+    /**
+     * @brief Read the trees of a stream one at a time.
+     *
+     * Each tree is passed to the handler, then deleted. For instance, with the trees sampled by MrBayes:
+     * @code
+     * NexusIOTree nexus;
+     * std::ifstream file("run1.t");
+     * nexus.readTrees(file, [&](const Tree& tree) { ... }, 1000, 10);
+     * @endcode
+     *
+     * @param in       The input stream.
+     * @param handler  A function or functor called with a reference to each tree.
+     * @param burnin   The number of trees to skip at the beginning of the stream. They are not parsed.
+     * @param thinning Only one tree every 'thinning' trees is read after the burn-in. The others are not parsed.
+     * @return The number of trees passed to the handler.
+     * @throw Exception If an error occured.
+     */
+    template<class Handler>
+    size_t readTrees(std::istream& in, Handler handler, size_t burnin = 0, size_t thinning = 1) const
+    {
+      if (thinning == 0)
+        throw Exception("AbstractITreeStream::readTrees. Thinning must be at least 1.");
+      for (size_t i = 0; i < burnin; i++)
+      {
+        if (!skipNextTree(in))
+          return 0;
+      }
+      size_t nbTrees = 0;
+      while (true)
+      {
+        std::unique_ptr<Tree> tree(readNextTree(in));
+        if (!tree.get())
+          return nbTrees;
+        handler(*tree);
+        nbTrees++;
+        for (size_t i = 1; i < thinning; i++)
+        {
+          if (!skipNextTree(in))
+            return nbTrees;
+        }
+      }
+    }
+
+  protected:
+    /**
+     * @brief Get the description of the next tree, up to its final semicolon.
+     *
+     * Semicolons in comments, between brackets, or in quoted labels do not end the tree.
+     * Line breaks are removed.
+     *
+     * @param in          The input stream.
+     * @param description The output description.
+     * @return False if there is no complete tree left in the stream.
+     */
+    static bool readNextDescription_(std::istream& in, std::string& description)
+    {
+      description.clear();
+      std::string chunk;
+      bool quoted = false;
+      size_t commentDepth = 0;
+      while (std::getline(in, chunk, ';'))
+      {
+        // No semicolon was found before the end of the stream:
+        if (in.eof())
+          return false;
+        for (size_t i = 0; i < chunk.size(); i++)
+        {
+          if (chunk[i] == '\'' && commentDepth == 0)
+            quoted = !quoted;
+          else if (chunk[i] == '[' && !quoted)
+            commentDepth++;
+          else if (chunk[i] == ']' && !quoted && commentDepth > 0)
+            commentDepth--;
+        }
+        description += chunk;
+        description += ';';
+        if (quoted || commentDepth > 0)
+          continue;
+        description.erase(std::remove(description.begin(), description.end(), '\n'), description.end());
+        return true;
+      }
+      return false;
+    }
 };
 
 } //end of namespace bpp.
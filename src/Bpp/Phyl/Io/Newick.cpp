@@ -70,25 +70,11 @@ TreeTemplate<Node> * Newick::read(istream& in) const
 {
   // Checking the existence of specified file
   if (! in) { throw IOException ("Newick::read: failed to read from stream"); }
-  
-  //We concatenate all line in file till we reach the ending semi colon:
-  string temp, description;// Initialization
-  // Main loop : for all file lines
-  while (getline(in, temp, '\n'))
-  {
-    string::size_type index = temp.find(";");
-    if(index != string::npos)
-    {
-      description += temp.substr(0, index + 1);
-      break;
-    }
-    else description += temp;
-  }
 
-  if (allowComments_) description = TextTools::removeSubstrings(description, '[', ']');
-  if (TextTools::isEmpty(description))
+  TreeTemplate<Node>* tree = readNextTree(in);
+  if (!tree)
     throw IOException("Newick::read: no tree was found!");
-  return TreeTemplateTools::parenthesisToTree(description, useBootstrap_, bootstrapPropertyName_, false, verbose_);
+  return tree;
 }
 
 /******************************************************************************/
@@ -97,7 +83,13 @@ void Newick::write_(const Tree& tree, ostream& out) const
 {
   // Checking the existence of specified file, and possibility to open it in write mode
   if (! out) { throw IOException ("Newick::writeTree: failed to write to stream"); }
-  if(useBootstrap_)
+  // Trees made of nodes are written directly to the stream:
+  const TreeTemplate<Node>* treeTemplate = dynamic_cast<const TreeTemplate<Node>*>(&tree);
+  if (treeTemplate)
+  {
+    write_(*treeTemplate, out);
+  }
+  else if(useBootstrap_)
   {
     out << TreeTools::treeToParenthesis(tree, writeId_);
   }
@@ -116,11 +108,11 @@ void Newick::write_(const TreeTemplate<N>& tree, ostream& out) const
   if (! out) { throw IOException ("Newick::writeTree: failed to write to stream"); }
   if(useBootstrap_)
   {
-    out << TreeTemplateTools::treeToParenthesis(tree, writeId_);
+    TreeTemplateTools::treeToParenthesis(tree, out, writeId_);
   }
   else
   {
-    out << TreeTemplateTools::treeToParenthesis(tree, false, bootstrapPropertyName_);
+    TreeTemplateTools::treeToParenthesis(tree, out, false, bootstrapPropertyName_);
   }
 }
 
@@ -130,24 +122,44 @@ void Newick::read(istream& in, vector<Tree*>& trees) const
 {
   // Checking the existence of specified file
   if (! in) { throw IOException ("Newick::read: failed to read from stream"); }
-  
-  // Main loop : for all file lines
-  string temp, description;// Initialization
-  string::size_type index;
-  //We concatenate all line in file till we reach the ending semi colon:
-  while (getline(in, temp, '\n'))
-  {
-    index = temp.find(";");
-    if (index != string::npos)
-    {
-      description += temp.substr(0, index + 1);
-      if (allowComments_) description = TextTools::removeSubstrings(description, '[', ']');
-      trees.push_back(TreeTemplateTools::parenthesisToTree(description, useBootstrap_, bootstrapPropertyName_, false, verbose_));
-      description = temp.substr(index + 1);
-    }
-    else description += temp;
-  }
-  //In case the file is empty, the method will not add any neww tree to the vector.
+
+  TreeTemplate<Node>* tree;
+  while ((tree = readNextTree(in)))
+    trees.push_back(tree);
+  //In case the file is empty, the method will not add any new tree to the vector.
+}
+
+/******************************************************************************/
+
+void Newick::read(istream& in, vector<Tree*>& trees, unsigned int nbThreads) const
+{
+  // Checking the existence of specified file
+  if (! in) { throw IOException ("Newick::read: failed to read from stream"); }
+
+  parseInParallel_(
+      [&](string& description) { return readNextDescription_(in, description); },
+      [this](const string& description) { return parseTree_(description); },
+      trees, nbThreads);
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* Newick::readNextTree(istream& in) const
+{
+  //We concatenate all lines till we reach the ending semi colon:
+  string description;
+  if (!readNextDescription_(in, description))
+    return 0;
+  return parseTree_(description);
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* Newick::parseTree_(const string& description) const
+{
+  if (allowComments_)
+    return TreeTemplateTools::parenthesisToTree(TextTools::removeSubstrings(description, '[', ']'), useBootstrap_, bootstrapPropertyName_, false, verbose_);
+  return TreeTemplateTools::parenthesisToTree(description, useBootstrap_, bootstrapPropertyName_, false, verbose_);
 }
 
 /******************************************************************************/
@@ -158,19 +170,24 @@ void Newick::write_(const vector<Tree*>& trees, ostream& out) const
   if (! out) { throw IOException ("Newick::write: failed to write to stream"); }
   for(unsigned int i = 0; i < trees.size(); i++)
   {
-    if(useBootstrap_)
-    {
-      out << TreeTools::treeToParenthesis(*trees[i], writeId_);
-    }
-    else
-    {
-      out << TreeTools::treeToParenthesis(*trees[i], false, bootstrapPropertyName_);
-    }
+    write_(*trees[i], out);
   }
 }
 
 /******************************************************************************/
 
+void Newick::write(const vector<Tree*>& trees, ostream& out, unsigned int nbThreads) const
+{
+  // Checking the existence of specified file, and possibility to open it in write mode
+  if (! out) { throw IOException ("Newick::write: failed to write to stream"); }
+  writeInParallel_(
+      trees,
+      [this](const Tree& tree, ostream& buffer) { write_(tree, buffer); },
+      out, nbThreads);
+}
+
+/******************************************************************************/
+
 template<class N>
 void Newick::write_(const vector<TreeTemplate<N>*>& trees, ostream& out) const
 {
@@ -178,14 +195,7 @@ void Newick::write_(const vector<TreeTemplate<N>*>& trees, ostream& out) const
   if (! out) { throw IOException ("Newick::write: failed to write to stream"); }
   for(unsigned int i = 0; i < trees.size(); i++)
   {
-    if(useBootstrap_)
-    {
-      out << TreeTemplateTools::treeToParenthesis(*trees[i], writeId_);
-    }
-    else
-    {
-      out << TreeTemplateTools::treeToParenthesis(*trees[i], false, bootstrapPropertyName_);
-    }
+    write_(*trees[i], out);
   }
 }
 
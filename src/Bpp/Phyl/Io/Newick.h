@@ -84,7 +84,8 @@ class Newick:
   public AbstractITree,
   public AbstractOTree,
   public AbstractIMultiTree,
-  public AbstractOMultiTree
+  public AbstractOMultiTree,
+  public AbstractITreeStream
 {
   protected:
     bool allowComments_;
@@ -176,6 +177,32 @@ class Newick:
     void read(std::istream& in, std::vector<Tree*>& trees) const;
     /**@}*/
 
+    /**
+     * @brief Read trees from a stream, parsing them in parallel.
+     *
+     * The trees are added in the same order as in the stream.
+     *
+     * @param in        The input stream.
+     * @param trees     The output trees container.
+     * @param nbThreads The number of parsing threads. 0 means as many as the hardware supports.
+     * @throw Exception If an error occured.
+     */
+    void read(std::istream& in, std::vector<Tree*>& trees, unsigned int nbThreads) const;
+
+    /**
+     * @name The ITreeStream interface
+     *
+     * @{
+     */
+    TreeTemplate<Node>* readNextTree(std::istream& in) const;
+
+    bool skipNextTree(std::istream& in) const
+    {
+      std::string description;
+      return readNextDescription_(in, description);
+    }
+    /** @} */
+
     /**
      * @name The OMultiTree interface
      *
@@ -191,7 +218,24 @@ class Newick:
     }
     /** @} */
 
+    /**
+     * @brief Write trees to a stream, formatting them in parallel.
+     *
+     * The output is the same as with write(const std::vector<Tree*>&, std::ostream&).
+     *
+     * @param trees     The trees to write.
+     * @param out       The output stream.
+     * @param nbThreads The number of formatting threads. 0 means as many as the hardware supports.
+     * @throw Exception If an error occured.
+     */
+    void write(const std::vector<Tree*>& trees, std::ostream& out, unsigned int nbThreads) const;
+
   protected:
+    /**
+     * @brief Parse a tree description read by readNextDescription_.
+     */
+    TreeTemplate<Node>* parseTree_(const std::string& description) const;
+
     void write_(const Tree& tree, std::ostream& out) const;
     
     template<class N>
@@ -74,18 +74,76 @@ const string NexusIOTree::getFormatDescription() const
 
 TreeTemplate<Node> * NexusIOTree::read(istream &in) const
 {
-  vector<Tree*> trees;
-  read(in, trees);
-  if (trees.size() == 0)
+  TreesBlock block;
+  beginBlock_(in, block);
+  string description;
+  if (!nextDescription_(in, block, description))
     throw IOException("NexusIOTree::read(). No tree found in file.");
-  for (size_t i = trees.size() - 1; i > 0; i--)
-    delete trees[i];
-  return dynamic_cast<TreeTemplate<Node>*>(trees[0]);
+  return parseTree_(description, block);
 }
 
 /******************************************************************************/
 
 void NexusIOTree::read(std::istream& in, std::vector<Tree*>& trees) const
+{
+  read(in, trees, 1);
+}
+
+/******************************************************************************/
+
+void NexusIOTree::read(std::istream& in, std::vector<Tree*>& trees, unsigned int nbThreads) const
+{
+  TreesBlock block;
+  beginBlock_(in, block);
+
+  //Now parse the trees, the translation being only read by the parsing threads:
+  auto nextDescription = [&](string& description) {
+    return nextDescription_(in, block, description);
+  };
+  auto parse = [&](const string& description) {
+    return parseTree_(description, block);
+  };
+  parseInParallel_(nextDescription, parse, trees, nbThreads);
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* NexusIOTree::readNextTree(istream& in) const
+{
+  string description;
+  if (!nextStreamDescription_(in, description))
+    return 0;
+  return parseTree_(description, block_);
+}
+
+/******************************************************************************/
+
+atomic<long> NexusIOTree::lastBlockId_(0);
+
+int NexusIOTree::streamIndex_()
+{
+  static const int index = ios_base::xalloc();
+  return index;
+}
+
+/******************************************************************************/
+
+bool NexusIOTree::nextStreamDescription_(istream& in, string& description) const
+{
+  //The translation table is read on the first call for this stream:
+  if (in.iword(streamIndex_()) == 0 || in.iword(streamIndex_()) != block_.id)
+  {
+    block_ = TreesBlock();
+    beginBlock_(in, block_);
+    block_.id = ++lastBlockId_;
+    in.iword(streamIndex_()) = block_.id;
+  }
+  return nextDescription_(in, block_, description);
+}
+
+/******************************************************************************/
+
+void NexusIOTree::beginBlock_(istream& in, TreesBlock& block)
 {
 	// Checking the existence of specified file
 	if (! in) { throw IOException ("NexusIOTree::read(). Failed to read from stream"); }
@@ -99,19 +157,18 @@ void NexusIOTree::read(std::istream& in, std::vector<Tree*>& trees) const
     line = TextTools::removeSurroundingWhiteSpaces(FileTools::getNextLine(in));
   }
   
-  string cmdName = "", cmdArgs = "";
-  bool cmdFound = NexusTools::getNextCommand(in, cmdName, cmdArgs, false);
-  if (! cmdFound)
+  block.cmdFound = NexusTools::getNextCommand(in, block.cmdName, block.cmdArgs, false);
+  if (! block.cmdFound)
     throw Exception("NexusIOTree::read(). Missing tree command.");
-  cmdName = TextTools::toUpper(cmdName);
+  block.cmdName = TextTools::toUpper(block.cmdName);
 
   //Look for the TRANSLATE command:
-  map<string, string> translation;
-  bool hasTranslation = false;
-  if (cmdName == "TRANSLATE")
+  block.translation.clear();
+  block.hasTranslation = false;
+  if (block.cmdName == "TRANSLATE")
   {
     //Parse translation:
-    StringTokenizer st(cmdArgs, ",");
+    StringTokenizer st(block.cmdArgs, ",");
     while (st.hasMoreToken())
     {
       string tok = TextTools::removeSurroundingWhiteSpaces(st.nextToken());
@@ -120,46 +177,58 @@ void NexusIOTree::read(std::istream& in, std::vector<Tree*>& trees) const
         throw Exception("NexusIOTree::read(). Unvalid translation description.");
       string name = nst.nextToken();
       string tln  = nst.nextToken();
-      translation[name] = tln;
+      block.translation[name] = tln;
     }
-    hasTranslation = true;
-    cmdFound = NexusTools::getNextCommand(in, cmdName, cmdArgs, false);
-    if (! cmdFound)
+    block.hasTranslation = true;
+    block.cmdFound = NexusTools::getNextCommand(in, block.cmdName, block.cmdArgs, false);
+    if (! block.cmdFound)
       throw Exception("NexusIOTree::read(). Missing tree command.");
     else
-      cmdName = TextTools::toUpper(cmdName);
+      block.cmdName = TextTools::toUpper(block.cmdName);
   }
+}
+
+/******************************************************************************/
+
+bool NexusIOTree::nextDescription_(istream& in, TreesBlock& block, string& description)
+{
+  if (!block.cmdFound || block.cmdName == "END")
+    return false;
+  if (block.cmdName != "TREE")
+    throw Exception("NexusIOTree::read(). Unvalid command found: " + block.cmdName);
+  string::size_type pos = block.cmdArgs.find("=");
+  if (pos == string::npos)
+    throw Exception("NexusIOTree::read(). unvalid format, should be tree-name=tree-description");
+  description = block.cmdArgs.substr(pos + 1) + ";";
+  block.cmdFound = NexusTools::getNextCommand(in, block.cmdName, block.cmdArgs, false);
+  if (block.cmdFound) block.cmdName = TextTools::toUpper(block.cmdName);
+  return true;
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* NexusIOTree::parseTree_(const string& description, const TreesBlock& block)
+{
+  TreeTemplate<Node>* tree = TreeTemplateTools::parenthesisToTree(description, true);
 
-  //Now parse the trees:
-  while (cmdFound && cmdName != "END")
+  //Now translate leaf names if there is a translation:
+  //(we assume that all trees share the same translation! ===> check!)
+  if (block.hasTranslation)
   {
-    if (cmdName != "TREE")
-      throw Exception("NexusIOTree::read(). Unvalid command found: " + cmdName);
-    string::size_type pos = cmdArgs.find("=");
-    if (pos == string::npos)
-      throw Exception("NexusIOTree::read(). unvalid format, should be tree-name=tree-description");
-    string description = cmdArgs.substr(pos + 1);
-	  TreeTemplate<Node>* tree = TreeTemplateTools::parenthesisToTree(description + ";", true);
-
-    //Now translate leaf names if there is a translation:
-    //(we assume that all trees share the same translation! ===> check!)
-    if (hasTranslation)
+    vector<Node*> leaves = tree->getLeaves();
+    for (size_t i = 0; i < leaves.size(); i++)
     {
-      vector<Node*> leaves = tree->getLeaves();
-      for (size_t i = 0; i < leaves.size(); i++)
+      map<string, string>::const_iterator it = block.translation.find(leaves[i]->getName());
+      if (it == block.translation.end())
       {
         string name = leaves[i]->getName();
-        if (translation.find(name) == translation.end())
-        {
-          throw Exception("NexusIOTree::read(). No translation was given for this leaf: " + name);
-        }
-        leaves[i]->setName(translation[name]);
+        delete tree;
+        throw Exception("NexusIOTree::read(). No translation was given for this leaf: " + name);
       }
+      leaves[i]->setName(it->second);
     }
-    trees.push_back(tree);
-    cmdFound = NexusTools::getNextCommand(in, cmdName, cmdArgs, false);
-    if (cmdFound) cmdName = TextTools::toUpper(cmdName);
   }
+  return tree;
 }
 
 /******************************************************************************/
@@ -43,6 +43,11 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "IoTree.h"
 #include "../TreeTemplate.h"
 
+// From the STL:
+#include <atomic>
+#include <map>
+#include <string>
+
 namespace bpp
 {
 
@@ -56,20 +61,52 @@ namespace bpp
  * This format is described in the following paper:
  * Maddison D, Swofford D, and Maddison W (1997), _Syst Biol_ 46(4):590-621
  *
+ * Trees can be read one at a time with readNextTree() and readTrees(). The TRANSLATE table
+ * of the TREES block is then read on the first call for a stream, and kept by the reader
+ * until another stream is passed. Streams can hence not be interleaved with the same reader,
+ * and these methods are not thread-safe: use one reader per stream being read.
+ *
  * @author Julien Dutheil
  */
 class NexusIOTree:
   public virtual AbstractITree,
   public virtual AbstractOTree,
   public virtual AbstractIMultiTree,
-  public virtual AbstractOMultiTree
+  public virtual AbstractOMultiTree,
+  public virtual AbstractITreeStream
 {
+  private:
+    /**
+     * @brief A TREES block being read: its translation table, and the next command of the block.
+     */
+    struct TreesBlock
+    {
+      long id;
+      bool hasTranslation;
+      std::map<std::string, std::string> translation;
+      bool cmdFound;
+      std::string cmdName;
+      std::string cmdArgs;
+
+      TreesBlock() :
+        id(0), hasTranslation(false), translation(), cmdFound(false), cmdName(), cmdArgs() {}
+    };
+
+    /**
+     * @brief The block read by readNextTree() and skipNextTree().
+     *
+     * Its id is also stored in the stream, so that a new block is read when another stream is passed.
+     */
+    mutable TreesBlock block_;
+
+    static std::atomic<long> lastBlockId_;
+
   public:
     
     /**
      * @brief Build a new Nexus tree parser.
      */
-    NexusIOTree() {}
+    NexusIOTree() : block_() {}
 
     virtual ~NexusIOTree() {}
   
@@ -124,6 +161,32 @@ class NexusIOTree:
     void read(std::istream& in, std::vector<Tree*>& trees) const;
     /**@}*/
 
+    /**
+     * @brief Read trees from a stream, parsing them in parallel.
+     *
+     * The trees are added in the same order as in the stream.
+     *
+     * @param in        The input stream.
+     * @param trees     The output trees container.
+     * @param nbThreads The number of parsing threads. 0 means as many as the hardware supports.
+     * @throw Exception If an error occured.
+     */
+    void read(std::istream& in, std::vector<Tree*>& trees, unsigned int nbThreads) const;
+
+    /**
+     * @name The ITreeStream interface
+     *
+     * @{
+     */
+    TreeTemplate<Node>* readNextTree(std::istream& in) const;
+
+    bool skipNextTree(std::istream& in) const
+    {
+      std::string description;
+      return nextStreamDescription_(in, description);
+    }
+    /** @} */
+
     /**
      * @name The OMultiTree interface
      *
@@ -150,6 +213,36 @@ class NexusIOTree:
     template<class N>
     void write_(const std::vector<TreeTemplate<N>*>& trees, std::ostream& out) const;
 
+  private:
+    /**
+     * @brief Look for the next TREES block of a stream, and read its TRANSLATE command if any.
+     *
+     * @throw Exception If no TREES block is found.
+     */
+    static void beginBlock_(std::istream& in, TreesBlock& block);
+
+    /**
+     * @brief Get the description of the next tree of a block.
+     *
+     * @return False if there is no tree left in the block.
+     */
+    static bool nextDescription_(std::istream& in, TreesBlock& block, std::string& description);
+
+    /**
+     * @brief Get the description of the next tree of a stream, starting a new block if this is another stream.
+     */
+    bool nextStreamDescription_(std::istream& in, std::string& description) const;
+
+    /**
+     * @brief Parse a tree description, and translate its leaf names.
+     */
+    static TreeTemplate<Node>* parseTree_(const std::string& description, const TreesBlock& block);
+
+    /**
+     * @return The index of the stream word holding the id of the block being read.
+     */
+    static int streamIndex_();
+
 };
 
 } //end of namespace bpp.
@@ -100,25 +100,11 @@ TreeTemplate<Node>* Nhx::read(istream& in) const
 {
   // Checking the existence of specified file
   if (! in) { throw IOException ("Nhx ::read: failed to read from stream"); }
-  
-  //We concatenate all line in file till we reach the ending semi colon:
-  string temp, description;// Initialization
-  // Main loop : for all file lines
-  while (! in.eof())
-  {
-    getline(in, temp, '\n');  // Copy current line in temporary string
-    string::size_type index = temp.find(";");
-    if (index != string::npos)
-    {
-      description += temp.substr(0, index + 1);
-      break;
-    }
-    else description += temp;
-  }
-  vector<string> beginnings, endings;
-  beginnings.push_back("[&&NHX:");
-  description = TextTools::removeSubstrings(description, '[', ']', beginnings, endings);
-  return parenthesisToTree(description);
+
+  TreeTemplate<Node>* tree = readNextTree(in);
+  if (!tree)
+    throw IOException("Nhx::read: no tree was found!");
+  return tree;
 }
 
 /******************************************************************************/
@@ -146,29 +132,24 @@ void Nhx::read(istream& in, vector<Tree*>& trees) const
 {
   // Checking the existence of specified file
   if (! in) { throw IOException ("Nhx::read: failed to read from stream"); }
-  
-  // Main loop : for all file lines
-  string temp, description;// Initialization
-  string::size_type index;
-  vector <string > beginnings, endings;
+
+  TreeTemplate<Node>* tree;
+  while ((tree = readNextTree(in)))
+    trees.push_back(tree);
+}
+
+/******************************************************************************/
+
+TreeTemplate<Node>* Nhx::readNextTree(istream& in) const
+{
+  //We concatenate all lines till we reach the ending semi colon:
+  string description;
+  if (!readNextDescription_(in, description))
+    return 0;
+  vector<string> beginnings, endings;
   beginnings.push_back("[&&NHX:");
-  while (!in.eof())
-  {
-    //We concatenate all line in file till we reach the ending semi colon:
-    while (!in.eof())
-    {
-      getline(in, temp, '\n');  // Copy current line in temporary string
-      index = temp.find(";");
-      if (index != string::npos)
-      {
-        description += temp.substr(0, index + 1);
-        description = TextTools::removeSubstrings(description, '[', ']', beginnings, endings);
-        trees.push_back(parenthesisToTree(description));
-        description = temp.substr(index + 1);
-      }
-      else description += temp;
-    }
-  }
+  description = TextTools::removeSubstrings(description, '[', ']', beginnings, endings);
+  return parenthesisToTree(description);
 }
 
 /******************************************************************************/
@@ -402,7 +383,10 @@ string Nhx::propertiesToParenthesis(const Node& node) const
   s << "[&&NHX";
   for (set<Property>::iterator it = supportedProperties_.begin(); it != supportedProperties_.end(); ++it) {
     string ppt = (useTagsAsPropertyNames_ ? it->tag : it->name);
-    if (it->onBranch) {
+    if (ppt == TreeTools::BOOTSTRAP && node.hasBootstrapValue()) {
+      //Typed access, without looking up the property:
+      s << ":" << it->tag << "=" << TextTools::toString(node.getBootstrapValue());
+    } else if (it->onBranch) {
       if (node.hasBranchProperty(ppt)) {
         const Clonable* pptObject = node.getBranchProperty(ppt);
         s << ":" << it->tag << "=" << propertyToString_(pptObject, it->type);
@@ -502,7 +486,9 @@ bool Nhx::setNodeProperties(Node& node, const string properties) const
     if (props.find(it->tag) != props.end()) {
       //Property found
       string ppt = (useTagsAsPropertyNames_ ? it->tag : it->name);
-      if (it->onBranch) {
+      if (ppt == TreeTools::BOOTSTRAP) {
+        node.setBootstrapValue(TextTools::toDouble(props[it->tag]));
+      } else if (it->onBranch) {
         node.setBranchProperty(ppt, *unique_ptr<Clonable>(stringToProperty_(props[it->tag], it->type)));
       } else {
         node.setNodeProperty(ppt, *unique_ptr<Clonable>(stringToProperty_(props[it->tag], it->type)));
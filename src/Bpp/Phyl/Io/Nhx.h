@@ -88,7 +88,8 @@ namespace bpp
     public AbstractITree,
     public AbstractOTree,
     public AbstractIMultiTree,
-    public AbstractOMultiTree
+    public AbstractOMultiTree,
+    public AbstractITreeStream
   {
   private:
     struct Element
@@ -203,6 +204,20 @@ namespace bpp
     void read(std::istream& in, std::vector<Tree*>& trees) const;
     /**@}*/
 
+    /**
+     * @name The ITreeStream interface
+     *
+     * @{
+     */
+    TreeTemplate<Node>* readNextTree(std::istream& in) const;
+
+    bool skipNextTree(std::istream& in) const
+    {
+      std::string description;
+      return readNextDescription_(in, description);
+    }
+    /** @} */
+
     /**
      * @name The OMultiTree interface
      *
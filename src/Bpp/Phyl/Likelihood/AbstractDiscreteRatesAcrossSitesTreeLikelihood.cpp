@@ -60,6 +60,15 @@ AbstractDiscreteRatesAcrossSitesTreeLikelihood::AbstractDiscreteRatesAcrossSites
 
 /******************************************************************************/
 
+void AbstractDiscreteRatesAcrossSitesTreeLikelihood::setRateDistribution(DiscreteDistribution* rDist)
+{
+  if (rDist->getNumberOfCategories() != rateDistribution_->getNumberOfCategories())
+    throw Exception("AbstractDiscreteRatesAcrossSitesTreeLikelihood::setRateDistribution(). The number of categories does not match the current distribution.");
+  rateDistribution_ = rDist;
+}
+
+/******************************************************************************/
+
 ParameterList AbstractDiscreteRatesAcrossSitesTreeLikelihood::getRateDistributionParameters() const
 {
   if (!initialized_)
@@ -105,6 +105,19 @@ class AbstractDiscreteRatesAcrossSitesTreeLikelihood:
      */
     const DiscreteDistribution* getRateDistribution() const { return rateDistribution_; }
           DiscreteDistribution* getRateDistribution()       { return rateDistribution_; }
+
+    /**
+     * @brief Use another instance of the rate distribution.
+     *
+     * The likelihood is not recomputed: the new distribution is expected to be a copy of the
+     * current one, with the same parameter values. This allows copies of a likelihood object
+     * to be used in different threads, each with its own distribution.
+     * The distribution is not owned by this object.
+     *
+     * @param rDist The rate distribution to use.
+     * @throw Exception If the number of categories differs from the current one.
+     */
+    void setRateDistribution(DiscreteDistribution* rDist);
     size_t getNumberOfClasses() const { return rateDistribution_->getNumberOfCategories(); } 
     ParameterList getRateDistributionParameters() const;
     VVdouble getLikelihoodForEachSiteForEachRateClass() const;
@@ -194,7 +194,7 @@ void AbstractHomogeneousTreeLikelihood::setModel(TransitionModel* model)
     // For each son node,i
     Node* son = nodes_[l];
 
-    VVVdouble* pxy__son = &pxy_[son->getId()];
+    VVVdouble* pxy__son = &pxy_[son->getId()].modify();
     pxy__son->resize(nbClasses_);
     for (unsigned int c = 0; c < nbClasses_; c++)
     {
@@ -206,7 +206,7 @@ void AbstractHomogeneousTreeLikelihood::setModel(TransitionModel* model)
       }
     }
 
-    VVVdouble* dpxy__son = &dpxy_[son->getId()];
+    VVVdouble* dpxy__son = &dpxy_[son->getId()].modify();
     dpxy__son->resize(nbClasses_);
     for (unsigned int c = 0; c < nbClasses_; c++)
     {
@@ -218,7 +218,7 @@ void AbstractHomogeneousTreeLikelihood::setModel(TransitionModel* model)
       }
     }
 
-    VVVdouble* d2pxy__son = &d2pxy_[son->getId()];
+    VVVdouble* d2pxy__son = &d2pxy_[son->getId()].modify();
     d2pxy__son->resize(nbClasses_);
     for (unsigned int c = 0; c < nbClasses_; c++)
     {
@@ -357,13 +357,17 @@ void AbstractHomogeneousTreeLikelihood::computeTransitionProbabilitiesForNode(co
 {
   double l = node->getDistanceToFather();
 
-  // Computes all pxy and pyx once for all:
-  VVVdouble* pxy__node = &pxy_[node->getId()];
+  // Computes all pxy and pyx once for all, and their derivatives.
+  // Each class is dealt with at once, as models may share computations
+  // between the probabilities and the derivatives at a given time:
+  VVVdouble* pxy__node = &pxy_[node->getId()].modify();
+  VVVdouble* dpxy__node = computeFirstOrderDerivatives_ ? &dpxy_[node->getId()].modify() : 0;
+  VVVdouble* d2pxy__node = computeSecondOrderDerivatives_ ? &d2pxy_[node->getId()].modify() : 0;
   for (unsigned int c = 0; c < nbClasses_; c++)
   {
+    double rc = rateDistribution_->getCategory(c);
     VVdouble* pxy__node_c = &(*pxy__node)[c];
-    RowMatrix<double> Q = model_->getPij_t(l * rateDistribution_->getCategory(c));
-
+    RowMatrix<double> Q = model_->getPij_t(l * rc);
     for (unsigned int x = 0; x < nbStates_; x++)
     {
       Vdouble* pxy__node_c_x = &(*pxy__node_c)[x];
@@ -372,16 +376,11 @@ void AbstractHomogeneousTreeLikelihood::computeTransitionProbabilitiesForNode(co
         (*pxy__node_c_x)[y] = Q(x, y);
       }
     }
-  }
 
-  if (computeFirstOrderDerivatives_)
-  {
-    // Computes all dpxy/dt once for all:
-    VVVdouble* dpxy__node = &dpxy_[node->getId()];
-    for (unsigned int c = 0; c < nbClasses_; c++)
+    if (dpxy__node)
     {
+      // Computes all dpxy/dt once for all:
       VVdouble* dpxy__node_c = &(*dpxy__node)[c];
-      double rc = rateDistribution_->getCategory(c);
       RowMatrix<double> dQ = model_->getdPij_dt(l * rc);
       for (unsigned int x = 0; x < nbStates_; x++)
       {
@@ -392,16 +391,11 @@ void AbstractHomogeneousTreeLikelihood::computeTransitionProbabilitiesForNode(co
         }
       }
     }
-  }
 
-  if (computeSecondOrderDerivatives_)
-  {
-    // Computes all d2pxy/dt2 once for all:
-    VVVdouble* d2pxy__node = &d2pxy_[node->getId()];
-    for (unsigned int c = 0; c < nbClasses_; c++)
+    if (d2pxy__node)
     {
+      // Computes all d2pxy/dt2 once for all:
       VVdouble* d2pxy__node_c = &(*d2pxy__node)[c];
-      double rc =  rateDistribution_->getCategory(c);
       RowMatrix<double> d2Q = model_->getd2Pij_dt2(l * rc);
       for (unsigned int x = 0; x < nbStates_; x++)
       {
@@ -42,6 +42,7 @@
 
 #include "AbstractDiscreteRatesAcrossSitesTreeLikelihood.h"
 #include "HomogeneousTreeLikelihood.h"
+#include "CopyOnWrite.h"
 
 // From STL:
 #include <memory>
@@ -86,11 +87,19 @@ protected:
   TransitionModel* model_;
   ParameterList brLenParameters_;
 
-  mutable std::map<int, VVVdouble> pxy_;
+  /**
+   * @brief Transition probabilities and their derivatives, for each node id.
+   *
+   * The arrays are shared with clones until one of them recomputes them,
+   * and must be read through get() so that read-only methods never unshare them.
+   * @{
+   */
+  std::map<int, CopyOnWrite<VVVdouble> > pxy_;
 
-  mutable std::map<int, VVVdouble> dpxy_;
+  std::map<int, CopyOnWrite<VVVdouble> > dpxy_;
 
-  mutable std::map<int, VVVdouble> d2pxy_;
+  std::map<int, CopyOnWrite<VVVdouble> > d2pxy_;
+  /** @} */
 
   std::vector<double> rootFreqs_;
 
@@ -169,6 +178,12 @@ public:
 
   ParameterList getBranchLengthsParameters() const;
 
+  /**
+   * @param brI The index of a branch, as in the parameter name "BrLen<brI>".
+   * @return The node under this branch.
+   */
+  const Node* getBranchNode(size_t brI) const { return nodes_[brI]; }
+
   ParameterList getSubstitutionModelParameters() const;
 
   ParameterList getRateDistributionParameters() const
@@ -178,7 +193,14 @@ public:
 
   const std::vector<double>& getRootFrequencies(size_t siteIndex) const { return model_->getFrequencies(); }
 
-  VVVdouble getTransitionProbabilitiesPerRateClass(int nodeId, size_t siteIndex) const { return pxy_[nodeId]; }
+  VVVdouble getTransitionProbabilitiesPerRateClass(int nodeId, size_t siteIndex) const { return pxy_.at(nodeId).get(); }
+
+  /**
+   * @return True if the transition probabilities of the branch leading to the given node
+   * are still shared with a copy of this object.
+   * @param nodeId The id of the node.
+   */
+  bool hasSharedTransitionProbabilities(int nodeId) const { return pxy_.at(nodeId).isShared(); }
 
   ConstBranchModelIterator* getNewBranchModelIterator(int nodeId) const
   {
@@ -43,6 +43,9 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "TreeLikelihoodData.h"
 
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
 //From the STL:
 #include <vector>
 #include <map>
@@ -133,6 +136,22 @@ class AbstractTreeLikelihoodData :
 			return rootWeights_;
 		}
 
+		/**
+		 * @brief Change the number of sites with each pattern.
+		 *
+		 * No likelihood array is modified: the weights are only used when summing over patterns.
+		 * This allows to compute bootstrap replicates by reweighting patterns of the original data.
+		 *
+		 * @param weights The new weights, one per array position.
+		 * @throw Exception If the size of the vector does not match the number of patterns.
+		 */
+		void setWeights(const std::vector<unsigned int>& weights)
+		{
+			if (weights.size() != rootWeights_.size())
+				throw Exception("AbstractTreeLikelihoodData::setWeights. Wrong number of weights: " + TextTools::toString(weights.size()) + ", expected " + TextTools::toString(rootWeights_.size()) + ".");
+			rootWeights_ = weights;
+		}
+
 		const Alphabet* getAlphabet() const { return alphabet_; }
 
 		const TreeTemplate<Node>* getTree() const { return tree_; }  
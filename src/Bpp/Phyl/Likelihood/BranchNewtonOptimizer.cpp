@@ -0,0 +1,231 @@
+//
+// File: BranchNewtonOptimizer.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "BranchNewtonOptimizer.h"
+#include "NNIHomogeneousTreeLikelihood.h"
+#include "../ParallelTools.h"
+
+#include <Bpp/Text/TextTools.h>
+
+// From the STL:
+#include <set>
+#include <memory>
+#include <cmath>
+#include <typeinfo>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+BranchNewtonOptimizer::BranchNewtonOptimizer(DRHomogeneousTreeLikelihood* tl, unsigned int nbThreads) :
+  AbstractOptimizer(tl),
+  branches_(),
+  schedule_(),
+  maxCorrection_(10),
+  nbThreads_(nbThreads),
+  savedDerivatives_(false),
+  firstOrderDerivatives_(false),
+  secondOrderDerivatives_(false)
+{
+  setDefaultStopCondition_(new FunctionStopCondition(this));
+  setStopCondition(*getDefaultStopCondition());
+}
+
+/******************************************************************************/
+
+void BranchNewtonOptimizer::doInit(const ParameterList& params)
+{
+  DRHomogeneousTreeLikelihood* tl = getLikelihood_();
+  if (!isSupported(tl))
+    throw Exception("BranchNewtonOptimizer::doInit. The function must be a DRHomogeneousTreeLikelihood or a NNIHomogeneousTreeLikelihood.");
+  size_t n = getParameters().size();
+  branches_.resize(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    string name = getParameters()[i].getName();
+    if (name.substr(0, 5) != "BrLen")
+      throw Exception("BranchNewtonOptimizer::doInit. Not a branch length parameter: " + name);
+    branches_[i] = TextTools::to<size_t>(name.substr(5));
+  }
+
+  // Greedy edge coloring: each branch goes to the first set not containing any of its nodes.
+  schedule_.clear();
+  vector< set<int> > setNodes;
+  for (size_t i = 0; i < n; i++)
+  {
+    const Node* node = tl->getBranchNode(branches_[i]);
+    int id = node->getId();
+    int fatherId = node->getFather()->getId();
+    size_t s = 0;
+    while (s < schedule_.size() && (setNodes[s].count(id) || setNodes[s].count(fatherId)))
+    {
+      s++;
+    }
+    if (s == schedule_.size())
+    {
+      schedule_.push_back(vector<size_t>());
+      setNodes.push_back(set<int>());
+    }
+    schedule_[s].push_back(i);
+    setNodes[s].insert(id);
+    setNodes[s].insert(fatherId);
+  }
+
+  // Derivatives arrays are not used:
+  if (!savedDerivatives_)
+  {
+    firstOrderDerivatives_ = tl->enableFirstOrderDerivatives();
+    secondOrderDerivatives_ = tl->enableSecondOrderDerivatives();
+    savedDerivatives_ = true;
+  }
+  tl->enableDerivatives(false);
+  tl->setParameters(getParameters());
+}
+
+/******************************************************************************/
+
+double BranchNewtonOptimizer::optimize()
+{
+  try
+  {
+    AbstractOptimizer::optimize();
+  }
+  catch (...)
+  {
+    restoreDerivatives_();
+    throw;
+  }
+  restoreDerivatives_();
+  return currentValue_;
+}
+
+/******************************************************************************/
+
+void BranchNewtonOptimizer::restoreDerivatives_()
+{
+  DRHomogeneousTreeLikelihood* tl = getLikelihood_();
+  if (!savedDerivatives_ || !tl)
+    return;
+  savedDerivatives_ = false;
+  if (!firstOrderDerivatives_ && !secondOrderDerivatives_)
+    return;
+  tl->enableFirstOrderDerivatives(firstOrderDerivatives_);
+  if (secondOrderDerivatives_)
+    tl->enableSecondOrderDerivatives(true);
+  // Transition probabilities derivatives and derivative arrays were not computed for the new lengths:
+  tl->setParameters(tl->getBranchLengthsParameters());
+}
+
+/******************************************************************************/
+
+bool BranchNewtonOptimizer::isSupported(const TreeLikelihood* tl)
+{
+  if (!tl)
+    return false;
+  return typeid(*tl) == typeid(DRHomogeneousTreeLikelihood)
+      || typeid(*tl) == typeid(NNIHomogeneousTreeLikelihood);
+}
+
+/******************************************************************************/
+
+double BranchNewtonOptimizer::doStep()
+{
+  DRHomogeneousTreeLikelihood* tl = getLikelihood_();
+  double tolerance = getStopCondition()->getTolerance();
+  double value = currentValue_;
+  for (size_t s = 0; s < schedule_.size(); s++)
+  {
+    const vector<size_t>& branchSet = schedule_[s];
+    size_t n = branchSet.size();
+    Vdouble lengths(n);
+    // Models cache transition probabilities, each worker gets its own copy:
+    const DRHomogeneousTreeLikelihood* ctl = tl;
+    ParallelTools::runInParallel(n, nbThreads_, [&](size_t begin, size_t end)
+    {
+      unique_ptr<TransitionModel> model(ctl->getModel()->clone());
+      for (size_t k = begin; k < end; k++)
+      {
+        lengths[k] = ctl->optimizeBranchLength(branches_[branchSet[k]], *model, tolerance, maxCorrection_);
+      }
+    });
+
+    ParameterList previous;
+    ParameterList moved;
+    for (size_t k = 0; k < n; k++)
+    {
+      Parameter& p = getParameters_()[branchSet[k]];
+      previous.addParameter(p);
+      p.setValue(lengths[k]);
+      moved.addParameter(p);
+    }
+    double newValue = getFunction_()->f(moved);
+
+    if (newValue > value + tolerance || std::isnan(newValue))
+    {
+      printMessage("!!! Simultaneous moves did not improve the likelihood: " + TextTools::toString(newValue) + ">" + TextTools::toString(value) + ". Optimizing branches sequentially.");
+      getFunction_()->setParameters(previous);
+      newValue = value;
+      for (size_t k = 0; k < n; k++)
+      {
+        Parameter& p = getParameters_()[branchSet[k]];
+        p.setValue(previous[k].getValue());
+        double length = tl->optimizeBranchLength(branches_[branchSet[k]], *tl->getModel(), tolerance, maxCorrection_);
+        ParameterList single;
+        single.addParameter(p);
+        single[0].setValue(length);
+        double singleValue = getFunction_()->f(single);
+        if (singleValue > newValue + tolerance || std::isnan(singleValue))
+        {
+          getFunction_()->setParameters(previous.subList(k));
+        }
+        else
+        {
+          p.setValue(length);
+          newValue = singleValue;
+        }
+      }
+    }
+    value = newValue;
+  }
+  return value;
+}
+
+/******************************************************************************/
+
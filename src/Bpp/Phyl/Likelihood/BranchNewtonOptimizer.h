@@ -0,0 +1,158 @@
+//
+// File: BranchNewtonOptimizer.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _BRANCHNEWTONOPTIMIZER_H_
+#define _BRANCHNEWTONOPTIMIZER_H_
+
+#include "DRHomogeneousTreeLikelihood.h"
+
+#include <Bpp/Numeric/Function/AbstractOptimizer.h>
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Optimize branch lengths one at a time, using Newton's algorithm.
+ *
+ * Unlike PseudoNewtonOptimizer, which moves all branch lengths together,
+ * each branch is optimized separately given the double-recursive conditional
+ * likelihood arrays on each side of it (see DRHomogeneousTreeLikelihood::optimizeBranchLength()),
+ * with its own Felsenstein and Churchill (1996) correction.
+ *
+ * Branches are processed by sets of branches which do not share any node.
+ * Branches of a set are optimized in parallel, from the same likelihood arrays,
+ * and the new lengths are applied together. If the likelihood then happens to decrease,
+ * the branches of the set are optimized again one after the other.
+ * Likelihood arrays are updated after each set.
+ *
+ * Only branch length parameters can be optimized, and the function must be a
+ * DRHomogeneousTreeLikelihood or a NNIHomogeneousTreeLikelihood (see isSupported()).
+ * Derivative arrays are not computed during the optimization, and are brought up to date
+ * again when optimize() returns.
+ */
+class BranchNewtonOptimizer:
+  public AbstractOptimizer
+{
+  private:
+    /**
+     * @brief For each parameter, the index of the corresponding branch.
+     */
+    std::vector<size_t> branches_;
+
+    /**
+     * @brief Sets of parameters whose branches are not adjacent.
+     */
+    std::vector< std::vector<size_t> > schedule_;
+
+    unsigned int maxCorrection_;
+
+    unsigned int nbThreads_;
+
+    /**
+     * @brief The derivative flags of the function before doInit() disabled them.
+     */
+    bool savedDerivatives_;
+    bool firstOrderDerivatives_;
+    bool secondOrderDerivatives_;
+
+  public:
+    /**
+     * @param tl        The likelihood function to optimize.
+     * @param nbThreads The maximum number of threads to use. 0 means as many as the hardware supports.
+     * Branches are optimized in the calling thread by default.
+     */
+    BranchNewtonOptimizer(DRHomogeneousTreeLikelihood* tl, unsigned int nbThreads = 1);
+
+    virtual ~BranchNewtonOptimizer() {}
+
+    BranchNewtonOptimizer* clone() const { return new BranchNewtonOptimizer(*this); }
+
+  public:
+    /**
+     * @name The Optimizer interface.
+     *
+     * @{
+     */
+    double getFunctionValue() const { return currentValue_; }
+    /** @} */
+
+    void doInit(const ParameterList& params);
+
+    double doStep();
+
+    /**
+     * @brief Optimize, and then restore the derivative flags of the function.
+     */
+    double optimize();
+
+    void setMaximumNumberOfCorrections(unsigned int mx) { maxCorrection_ = mx; }
+
+    void setNumberOfThreads(unsigned int nbThreads) { nbThreads_ = nbThreads; }
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @return The sets of parameter indices optimized together.
+     */
+    const std::vector< std::vector<size_t> >& getSchedule() const { return schedule_; }
+
+    /**
+     * @return True if the likelihood function can be optimized by this class.
+     *
+     * Classes deriving from DRHomogeneousTreeLikelihood, such as DRHomogeneousMixedTreeLikelihood,
+     * may not fill the arrays read by DRHomogeneousTreeLikelihood::optimizeBranchLength(), so only
+     * DRHomogeneousTreeLikelihood and NNIHomogeneousTreeLikelihood instances are supported.
+     *
+     * @param tl The likelihood function.
+     */
+    static bool isSupported(const TreeLikelihood* tl);
+
+  private:
+    DRHomogeneousTreeLikelihood* getLikelihood_()
+    {
+      return dynamic_cast<DRHomogeneousTreeLikelihood*>(AbstractOptimizer::getFunction_());
+    }
+
+    void restoreDerivatives_();
+};
+} // end of namespace bpp.
+
+#endif // _BRANCHNEWTONOPTIMIZER_H_
+
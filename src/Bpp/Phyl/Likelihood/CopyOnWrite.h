@@ -0,0 +1,142 @@
+//
+// File: CopyOnWrite.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _COPYONWRITE_H_
+#define _COPYONWRITE_H_
+
+// From the STL:
+#include <atomic>
+#include <memory>
+
+namespace bpp
+{
+
+/**
+ * @brief A value shared between copies until one of them is modified.
+ *
+ * Copying a CopyOnWrite object only copies a pointer: the underlying value is
+ * shared by all copies, and is only duplicated when modify() is called on a
+ * copy that does not own it alone. This makes cloning of likelihood data structures
+ * cheap, the large conditional likelihood arrays being actually copied only when
+ * one of the clones recomputes them.
+ *
+ * A reference obtained from modify() must not be used once the object has been copied:
+ * the copy shares the same value, and writing through the old reference would change
+ * both of them. Call modify() again after any copy instead of keeping references.
+ * Copies of the same object may be modified in different threads,
+ * but a single object should not be accessed from several threads without locking.
+ */
+template<class T>
+class CopyOnWrite
+{
+  private:
+    std::shared_ptr<T> data_;
+
+  public:
+    CopyOnWrite() : data_(std::make_shared<T>()) {}
+
+    CopyOnWrite(const T& value) : data_(std::make_shared<T>(value)) {}
+
+    CopyOnWrite(const CopyOnWrite& cow) : data_(cow.data_) {}
+
+    CopyOnWrite& operator=(const CopyOnWrite& cow)
+    {
+      data_ = cow.data_;
+      return *this;
+    }
+
+    CopyOnWrite& operator=(const T& value)
+    {
+      if (data_.use_count() > 1)
+        data_ = std::make_shared<T>(value);
+      else
+        *data_ = value;
+      return *this;
+    }
+
+    virtual ~CopyOnWrite() {}
+
+  public:
+    /**
+     * @return A read-only reference to the value, which may be shared.
+     */
+    const T& get() const { return *data_; }
+
+    /**
+     * @return A modifiable reference to the value.
+     *
+     * The value is duplicated first if it is shared with other copies.
+     *
+     * @warning The reference must not outlive any copy of this object made afterwards,
+     * whether by copy construction or assignment: the copy shares the value, so that
+     * writing through the reference would also change the copy. The reference is also
+     * invalidated by reset(), by assignment into this object and by its destruction.
+     */
+    T& modify()
+    {
+      if (data_.use_count() > 1)
+        data_ = std::make_shared<T>(*data_);
+      else
+        // Synchronizes with the release of the last other owner, so that
+        // its reads of the value are finished before we write into it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+      return *data_;
+    }
+
+    /**
+     * @brief Replace the value by a default-constructed one, without copying the current one.
+     */
+    void reset()
+    {
+      if (data_.use_count() > 1)
+        data_ = std::make_shared<T>();
+      else
+        *data_ = T();
+    }
+
+    /**
+     * @return True if the value is currently shared with another copy.
+     */
+    bool isShared() const { return data_.use_count() > 1; }
+};
+
+} //end of namespace bpp.
+
+#endif //_COPYONWRITE_H_
+
@@ -40,6 +40,7 @@
 
 #include "DRASDRTreeLikelihoodData.h"
 #include "../PatternTools.h"
+#include "../TreeTemplateTools.h"
 
 // From SeqLib:
 #include <Bpp/Seq/SiteTools.h>
@@ -74,17 +75,20 @@ void DRASDRTreeLikelihoodData::initLikelihoods(const SiteContainer& sites, const
   // Init data:
   // Clone data for more efficiency on sequences access:
   const SiteContainer* sequences = new AlignedSequenceContainer(*shrunkData_);
+  initLeafStateCodes_(*sequences, model);
   initLikelihoods(tree_->getRootNode(), *sequences, model);
   delete sequences;
 
   // Now initialize root likelihoods and derivatives:
-  rootLikelihoods_.resize(nbDistinctSites_);
-  rootLikelihoodsS_.resize(nbDistinctSites_);
-  rootLikelihoodsSR_.resize(nbDistinctSites_);
+  VVVdouble* rootLikelihoods = &rootLikelihoods_.modify();
+  VVdouble* rootLikelihoodsS = &rootLikelihoodsS_.modify();
+  rootLikelihoods->resize(nbDistinctSites_);
+  rootLikelihoodsS->resize(nbDistinctSites_);
+  rootLikelihoodsSR_.modify().resize(nbDistinctSites_);
   for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    VVdouble* rootLikelihoods_i_ = &rootLikelihoods_[i];
-    Vdouble* rootLikelihoodsS_i_ = &rootLikelihoodsS_[i];
+    VVdouble* rootLikelihoods_i_ = &(*rootLikelihoods)[i];
+    Vdouble* rootLikelihoodsS_i_ = &(*rootLikelihoodsS)[i];
     rootLikelihoods_i_->resize(nbClasses_);
     rootLikelihoodsS_i_->resize(nbClasses_);
     for (size_t c = 0; c < nbClasses_; c++)
@@ -101,163 +105,250 @@ void DRASDRTreeLikelihoodData::initLikelihoods(const SiteContainer& sites, const
 
 /******************************************************************************/
 
-void DRASDRTreeLikelihoodData::initLikelihoods(const Node* node, const SiteContainer& sites, const TransitionModel& model)
+void DRASDRTreeLikelihoodData::initLikelihoods(const Node* subtree, const SiteContainer& sites, const TransitionModel& model)
 {
-  if (node->isLeaf())
+  // Nodes are initialized independently, in postorder to avoid recursion:
+  std::vector<const Node*> nodes;
+  TreeTemplateTools::getPostorderNodes(*subtree, nodes);
+  for (size_t k = 0; k < nodes.size(); k++)
+  {
+    const Node* node = nodes[k];
+    if (node->isLeaf() && !hasLeafStateCodes())
+    {
+      // Init leaves likelihoods:
+      const Sequence* seq;
+      try
+      {
+        seq = &sites.getSequence(node->getName());
+      }
+      catch (SequenceNotFoundException& snfe)
+      {
+        throw SequenceNotFoundException("DRASDRTreeLikelihoodData::initlikelihoods. Leaf name in tree not found in site container: ", (node->getName()));
+      }
+      DRASDRTreeLikelihoodLeafData* leafData = &leafData_[node->getId()];
+      VVdouble* leavesLikelihoods_leaf = &leafData->getLikelihoodArray();
+      leafData->setNode(node);
+      leafData->getStateCodes().clear();
+      leavesLikelihoods_leaf->resize(nbDistinctSites_);
+      for (size_t i = 0; i < nbDistinctSites_; i++)
+      {
+        Vdouble* leavesLikelihoods_leaf_i = &(*leavesLikelihoods_leaf)[i];
+        leavesLikelihoods_leaf_i->resize(nbStates_);
+        int state = seq->getValue(i);
+        double test = 0.;
+
+        for (size_t s = 0; s < nbStates_; s++)
+        {
+          // Leaves likelihood are set to 1 if the char correspond to the site in the sequence,
+          // otherwise value set to 0:
+          ( *leavesLikelihoods_leaf_i)[s] = model.getInitValue(s, state);
+          test += ( *leavesLikelihoods_leaf_i)[s];
+        }
+        if (test < 0.000001)
+          std::cerr << "WARNING!!! Likelihood will be 0 for site " << i << std::endl;
+      }
+    }
+
+    // Initialize likelihood vector:
+    DRASDRTreeLikelihoodNodeData* nodeData = &nodeData_[node->getId()];
+    std::map<int, VVVdouble>* likelihoods_node_ = &nodeData->getLikelihoodArrays();
+    nodeData->setNode(node);
+
+    int nbSons = static_cast<int>(node->getNumberOfSons());
+
+    for (int n = (node->hasFather() ? -1 : 0); n < nbSons; n++)
+    {
+      const Node* neighbor = (*node)[n];
+      // No array toward leaf sons, their likelihoods are read directly:
+      if (n >= 0 && neighbor->isLeaf())
+        continue;
+      initLikelihoodArray_((*likelihoods_node_)[neighbor->getId()]);
+    }
+
+    // Initialize d and d2 likelihoods:
+    Vdouble* dLikelihoods_node_ = &nodeData->getDLikelihoodArray();
+    Vdouble* d2Likelihoods_node_ = &nodeData->getD2LikelihoodArray();
+    dLikelihoods_node_->resize(nbDistinctSites_);
+    d2Likelihoods_node_->resize(nbDistinctSites_);
+  }
+}
+
+/******************************************************************************/
+
+void DRASDRTreeLikelihoodData::reInit()
+{
+  reInit(tree_->getRootNode());
+}
+
+void DRASDRTreeLikelihoodData::reInit(const Node* subtree)
+{
+  std::vector<const Node*> nodes;
+  TreeTemplateTools::getPostorderNodes(*subtree, nodes);
+  for (size_t k = 0; k < nodes.size(); k++)
+  {
+    const Node* node = nodes[k];
+    if (node->isLeaf())
+    {
+      DRASDRTreeLikelihoodLeafData* leafData = &leafData_[node->getId()];
+      leafData->setNode(node);
+    }
+
+    DRASDRTreeLikelihoodNodeData* nodeData = &nodeData_[node->getId()];
+    nodeData->setNode(node);
+    nodeData->eraseNeighborArrays();
+
+    int nbSons = static_cast<int>(node->getNumberOfSons());
+
+    for (int n = (node->hasFather() ? -1 : 0); n < nbSons; n++)
+    {
+      const Node* neighbor = (*node)[n];
+      // No array toward leaf sons, their likelihoods are read directly:
+      if (n >= 0 && neighbor->isLeaf())
+        continue;
+      initLikelihoodArray_(nodeData->getLikelihoodArrayForNeighbor(neighbor->getId()));
+    }
+
+    nodeData->getDLikelihoodArray().resize(nbDistinctSites_);
+    nodeData->getD2LikelihoodArray().resize(nbDistinctSites_);
+  }
+}
+
+/******************************************************************************/
+
+void DRASDRTreeLikelihoodData::initLeafStateCodes_(const SiteContainer& sites, const TransitionModel& model)
+{
+  leafCodeLikelihoods_.clear();
+  std::vector<const Node*> leaves = tree_->getLeaves();
+  std::vector<const Sequence*> sequences(leaves.size());
+  std::map<int, unsigned char> codes;
+  for (size_t l = 0; l < leaves.size(); l++)
   {
-    // Init leaves likelihoods:
-    const Sequence* seq;
     try
     {
-      seq = &sites.getSequence(node->getName());
+      sequences[l] = &sites.getSequence(leaves[l]->getName());
     }
     catch (SequenceNotFoundException& snfe)
     {
-      throw SequenceNotFoundException("DRASDRTreeLikelihoodData::initlikelihoods. Leaf name in tree not found in site container: ", (node->getName()));
+      throw SequenceNotFoundException("DRASDRTreeLikelihoodData::initlikelihoods. Leaf name in tree not found in site container: ", (leaves[l]->getName()));
     }
-    DRASDRTreeLikelihoodLeafData* leafData = &leafData_[node->getId()];
-    VVdouble* leavesLikelihoods_leaf = &leafData->getLikelihoodArray();
-    leafData->setNode(node);
-    leavesLikelihoods_leaf->resize(nbDistinctSites_);
     for (size_t i = 0; i < nbDistinctSites_; i++)
     {
-      Vdouble* leavesLikelihoods_leaf_i = &(*leavesLikelihoods_leaf)[i];
-      leavesLikelihoods_leaf_i->resize(nbStates_);
-      int state = seq->getValue(i);
-      double test = 0.;
-
-      for (size_t s = 0; s < nbStates_; s++)
-      {
-        // Leaves likelihood are set to 1 if the char correspond to the site in the sequence,
-        // otherwise value set to 0:
-        ( *leavesLikelihoods_leaf_i)[s] = model.getInitValue(s, state);
-        test += ( *leavesLikelihoods_leaf_i)[s];
-      }
-      if (test < 0.000001)
-        std::cerr << "WARNING!!! Likelihood will be 0 for site " << i << std::endl;
+      codes[sequences[l]->getValue(i)] = 0;
     }
   }
+  if (codes.size() > 256)
+    return; // Leaves will be stored as expanded arrays.
 
-  // We initialize each son node first:
-  size_t nbSonNodes = node->getNumberOfSons();
-  for (size_t l = 0; l < nbSonNodes; l++)
+  std::vector<bool> nullCode(codes.size());
+  for (std::map<int, unsigned char>::iterator it = codes.begin(); it != codes.end(); it++)
   {
-    // For each son node,
-    initLikelihoods(node->getSon(l), sites, model);
+    size_t code = leafCodeLikelihoods_.size();
+    it->second = static_cast<unsigned char>(code);
+    Vdouble likelihoods(nbStates_);
+    double test = 0.;
+    for (size_t s = 0; s < nbStates_; s++)
+    {
+      // Leaves likelihood are set to 1 if the char correspond to the site in the sequence,
+      // otherwise value set to 0:
+      likelihoods[s] = model.getInitValue(s, it->first);
+      test += likelihoods[s];
+    }
+    nullCode[code] = (test < 0.000001);
+    leafCodeLikelihoods_.push_back(likelihoods);
   }
 
-  // Initialize likelihood vector:
-  DRASDRTreeLikelihoodNodeData* nodeData = &nodeData_[node->getId()];
-  std::map<int, VVVdouble>* likelihoods_node_ = &nodeData->getLikelihoodArrays();
-  nodeData->setNode(node);
-
-  int nbSons = static_cast<int>(node->getNumberOfSons());
-
-  for (int n = (node->hasFather() ? -1 : 0); n < nbSons; n++)
+  for (size_t l = 0; l < leaves.size(); l++)
   {
-    const Node* neighbor = (*node)[n];
-    VVVdouble* likelihoods_node_neighbor_ = &(*likelihoods_node_)[neighbor->getId()];
+    DRASDRTreeLikelihoodLeafData* leafData = &leafData_[leaves[l]->getId()];
+    leafData->setNode(leaves[l]);
+    leafData->getLikelihoodArray().clear();
+    std::vector<unsigned char>* stateCodes = &leafData->getStateCodes();
+    stateCodes->resize(nbDistinctSites_);
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      (*stateCodes)[i] = codes[sequences[l]->getValue(i)];
+      if (nullCode[(*stateCodes)[i]])
+        std::cerr << "WARNING!!! Likelihood will be 0 for site " << i << std::endl;
+    }
+  }
+}
 
-    likelihoods_node_neighbor_->resize(nbDistinctSites_);
+/******************************************************************************/
 
-    if (neighbor->isLeaf())
+void DRASDRTreeLikelihoodData::getLeafLikelihoods(int nodeId, std::vector<const Vdouble*>& likelihoods) const
+{
+  std::map<int, DRASDRTreeLikelihoodLeafData>::const_iterator it = leafData_.find(nodeId);
+  if (it == leafData_.end())
+    throw NodeNotFoundException("DRASDRTreeLikelihoodData::getLeafLikelihoods. No data for this leaf.", nodeId);
+  likelihoods.resize(nbDistinctSites_);
+  if (hasLeafStateCodes())
+  {
+    const std::vector<unsigned char>* stateCodes = &it->second.getStateCodes();
+    for (size_t i = 0; i < nbDistinctSites_; i++)
     {
-      VVdouble* leavesLikelihoods_leaf_ = &leafData_[neighbor->getId()].getLikelihoodArray();
-      for (size_t i = 0; i < nbDistinctSites_; i++)
-      {
-        Vdouble* leavesLikelihoods_leaf_i_ = &(*leavesLikelihoods_leaf_)[i];
-        VVdouble* likelihoods_node_neighbor_i_ = &(*likelihoods_node_neighbor_)[i];
-        likelihoods_node_neighbor_i_->resize(nbClasses_);
-        for (size_t c = 0; c < nbClasses_; c++)
-        {
-          Vdouble* likelihoods_node_neighbor_i_c_ = &(*likelihoods_node_neighbor_i_)[c];
-          likelihoods_node_neighbor_i_c_->resize(nbStates_);
-          for (size_t s = 0; s < nbStates_; s++)
-          {
-            (*likelihoods_node_neighbor_i_c_)[s] = (*leavesLikelihoods_leaf_i_)[s];
-          }
-        }
-      }
+      likelihoods[i] = &leafCodeLikelihoods_[(*stateCodes)[i]];
     }
-    else
+  }
+  else
+  {
+    const VVdouble* leafLikelihoods = &it->second.getLikelihoodArray();
+    for (size_t i = 0; i < nbDistinctSites_; i++)
     {
-      for (size_t i = 0; i < nbDistinctSites_; i++)
-      {
-        VVdouble* likelihoods_node_neighbor_i_ = &(*likelihoods_node_neighbor_)[i];
-        likelihoods_node_neighbor_i_->resize(nbClasses_);
-        for (size_t c = 0; c < nbClasses_; c++)
-        {
-          Vdouble* likelihoods_node_neighbor_i_c_ = &(*likelihoods_node_neighbor_i_)[c];
-          likelihoods_node_neighbor_i_c_->resize(nbStates_);
-          for (size_t s = 0; s < nbStates_; s++)
-          {
-            (*likelihoods_node_neighbor_i_c_)[s] = 1.; // All likelihoods are initialized to 1.
-          }
-        }
-      }
+      likelihoods[i] = &(*leafLikelihoods)[i];
     }
   }
-
-  // Initialize d and d2 likelihoods:
-  Vdouble* dLikelihoods_node_ = &nodeData->getDLikelihoodArray();
-  Vdouble* d2Likelihoods_node_ = &nodeData->getD2LikelihoodArray();
-  dLikelihoods_node_->resize(nbDistinctSites_);
-  d2Likelihoods_node_->resize(nbDistinctSites_);
 }
 
 /******************************************************************************/
 
-void DRASDRTreeLikelihoodData::reInit()
+VVdouble& DRASDRTreeLikelihoodData::getLeafLikelihoods(int nodeId)
 {
-  reInit(tree_->getRootNode());
+  std::map<int, DRASDRTreeLikelihoodLeafData>::iterator it = leafData_.find(nodeId);
+  if (it == leafData_.end())
+    throw NodeNotFoundException("DRASDRTreeLikelihoodData::getLeafLikelihoods. No data for this leaf.", nodeId);
+  if (hasLeafStateCodes())
+    expandLeafStateCodes_();
+  return it->second.getLikelihoodArray();
 }
 
-void DRASDRTreeLikelihoodData::reInit(const Node* node)
+/******************************************************************************/
+
+void DRASDRTreeLikelihoodData::expandLeafStateCodes_()
 {
-  if (node->isLeaf())
+  for (std::map<int, DRASDRTreeLikelihoodLeafData>::iterator it = leafData_.begin(); it != leafData_.end(); it++)
   {
-    DRASDRTreeLikelihoodLeafData* leafData = &leafData_[node->getId()];
-    leafData->setNode(node);
+    const DRASDRTreeLikelihoodLeafData* leafData = &it->second;
+    const std::vector<unsigned char>* stateCodes = &leafData->getStateCodes();
+    VVdouble* leafLikelihoods = &it->second.getLikelihoodArray();
+    leafLikelihoods->resize(nbDistinctSites_);
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      (*leafLikelihoods)[i] = leafCodeLikelihoods_[(*stateCodes)[i]];
+    }
+    it->second.getStateCodes().clear();
   }
+  leafCodeLikelihoods_.clear();
+}
 
-  DRASDRTreeLikelihoodNodeData* nodeData = &nodeData_[node->getId()];
-  nodeData->setNode(node);
-  nodeData->eraseNeighborArrays();
-
-  int nbSons = static_cast<int>(node->getNumberOfSons());
+/******************************************************************************/
 
-  for (int n = (node->hasFather() ? -1 : 0); n < nbSons; n++)
+void DRASDRTreeLikelihoodData::initLikelihoodArray_(VVVdouble& array) const
+{
+  array.resize(nbDistinctSites_);
+  for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    const Node* neighbor = (*node)[n];
-    VVVdouble* array = &nodeData->getLikelihoodArrayForNeighbor(neighbor->getId());
-
-    array->resize(nbDistinctSites_);
-    for (size_t i = 0; i < nbDistinctSites_; i++)
+    VVdouble* array_i = &array[i];
+    array_i->resize(nbClasses_);
+    for (size_t c = 0; c < nbClasses_; c++)
     {
-      VVdouble* array_i = &(*array)[i];
-      array_i->resize(nbClasses_);
-      for (size_t c = 0; c < nbClasses_; c++)
+      Vdouble* array_i_c = &(*array_i)[c];
+      array_i_c->resize(nbStates_);
+      for (size_t s = 0; s < nbStates_; s++)
       {
-        Vdouble* array_i_c = &(*array_i)[c];
-        array_i_c->resize(nbStates_);
-        for (size_t s = 0; s < nbStates_; s++)
-        {
-          (*array_i_c)[s] = 1.; // All likelihoods are initialized to 1.
-        }
+        (*array_i_c)[s] = 1.; // All likelihoods are initialized to 1.
       }
     }
   }
-
-  // We re-initialize each son node:
-  size_t nbSonNodes = node->getNumberOfSons();
-  for (size_t l = 0; l < nbSonNodes; l++)
-  {
-    // For each son node,
-    reInit(node->getSon(l));
-  }
-
-  nodeData->getDLikelihoodArray().resize(nbDistinctSites_);
-  nodeData->getD2LikelihoodArray().resize(nbDistinctSites_);
 }
 
 /******************************************************************************/
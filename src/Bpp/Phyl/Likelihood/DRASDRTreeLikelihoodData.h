@@ -42,6 +42,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _DRASDRHOMOGENEOUSTREELIKELIHOODDATA_H_
 
 #include "AbstractTreeLikelihoodData.h"
+#include "CopyOnWrite.h"
 #include "../Model/SubstitutionModel.h"
 #include "../PatternTools.h"
 #include "../SitePatterns.h"
@@ -61,6 +62,11 @@ namespace bpp
  * This class is for use with the DRASDRTreeLikelihoodData class.
  * 
  * Store the likelihoods arrays associated to a leaf.
+ * Whenever possible, the leaf is stored as a vector of compact state codes,
+ * one byte per site, which index a table of likelihood vectors shared by all leaves
+ * (see DRASDRTreeLikelihoodData::getLeafCodeLikelihoods()).
+ * In that case no likelihood array is stored for the leaf.
+ * Both arrays are shared with copies of this object until modified.
  * 
  * @see DRASDRTreeLikelihoodData
  */
@@ -68,18 +74,20 @@ class DRASDRTreeLikelihoodLeafData :
   public virtual TreeLikelihoodNodeData
 {
   private:
-    mutable VVdouble leafLikelihood_;
+    CopyOnWrite<VVdouble> leafLikelihood_;
+    CopyOnWrite< std::vector<unsigned char> > stateCodes_;
     const Node* leaf_;
 
   public:
-    DRASDRTreeLikelihoodLeafData() : leafLikelihood_(), leaf_(0) {}
+    DRASDRTreeLikelihoodLeafData() : leafLikelihood_(), stateCodes_(), leaf_(0) {}
 
     DRASDRTreeLikelihoodLeafData(const DRASDRTreeLikelihoodLeafData& data) :
-      leafLikelihood_(data.leafLikelihood_), leaf_(data.leaf_) {}
+      leafLikelihood_(data.leafLikelihood_), stateCodes_(data.stateCodes_), leaf_(data.leaf_) {}
     
     DRASDRTreeLikelihoodLeafData& operator=(const DRASDRTreeLikelihoodLeafData& data)
     {
       leafLikelihood_ = data.leafLikelihood_;
+      stateCodes_     = data.stateCodes_;
       leaf_           = data.leaf_;
       return *this;
     }
@@ -93,7 +101,11 @@ class DRASDRTreeLikelihoodLeafData :
     const Node* getNode() const { return leaf_; }
     void setNode(const Node* node) { leaf_ = node; }
 
-    VVdouble& getLikelihoodArray()  { return leafLikelihood_;  }
+    VVdouble& getLikelihoodArray()  { return leafLikelihood_.modify();  }
+    const VVdouble& getLikelihoodArray() const { return leafLikelihood_.get(); }
+
+    std::vector<unsigned char>& getStateCodes() { return stateCodes_.modify(); }
+    const std::vector<unsigned char>& getStateCodes() const { return stateCodes_.get(); }
 };
 
 /**
@@ -102,6 +114,10 @@ class DRASDRTreeLikelihoodLeafData :
  * This class is for use with the DRASDRTreeLikelihoodData class.
  * 
  * Store for each neighbor node an array with conditionnal likelihoods.
+ * No array is stored toward leaf sons: the likelihoods of the leaf are read instead
+ * (see DRASDRTreeLikelihoodData::getLeafLikelihoods()).
+ * The arrays are shared with copies of this object, and only duplicated
+ * when one of the copies accesses them for writing.
  *
  * @see DRASDRTreeLikelihoodData
  */
@@ -122,7 +138,7 @@ class DRASDRTreeLikelihoodNodeData :
      * We call this the <i>likelihood array</i> for each node.
      */
 
-    mutable std::map<int, VVVdouble> nodeLikelihoods_;
+    mutable CopyOnWrite< std::map<int, VVVdouble> > nodeLikelihoods_;
     /**
      * @brief This contains all likelihood first order derivatives values used for computation.
      *
@@ -132,7 +148,7 @@ class DRASDRTreeLikelihoodNodeData :
      * </pre> 
      * We call this the <i>dLikelihood array</i> for each node.
      */
-    mutable Vdouble nodeDLikelihoods_;
+    mutable CopyOnWrite<Vdouble> nodeDLikelihoods_;
   
     /**
      * @brief This contains all likelihood second order derivatives values used for computation.
@@ -143,7 +159,7 @@ class DRASDRTreeLikelihoodNodeData :
      * </pre> 
      * We call this the <i>d2Likelihood array</i> for each node.
      */
-    mutable Vdouble nodeD2Likelihoods_;
+    mutable CopyOnWrite<Vdouble> nodeD2Likelihoods_;
     
     const Node* node_;
 
@@ -178,38 +194,50 @@ class DRASDRTreeLikelihoodNodeData :
     
     void setNode(const Node* node) { node_ = node; }
 
-    const std::map<int, VVVdouble>& getLikelihoodArrays() const { return nodeLikelihoods_; }
+    const std::map<int, VVVdouble>& getLikelihoodArrays() const { return nodeLikelihoods_.get(); }
     
-    std::map<int, VVVdouble>& getLikelihoodArrays() { return nodeLikelihoods_; }
+    std::map<int, VVVdouble>& getLikelihoodArrays() { return nodeLikelihoods_.modify(); }
     
     VVVdouble& getLikelihoodArrayForNeighbor(int neighborId)
     {
-      return nodeLikelihoods_[neighborId];
+      return nodeLikelihoods_.modify()[neighborId];
     }
     
+    /**
+     * @brief Get the array toward a neighbor, without creating it.
+     *
+     * This accessor never modifies the data, and can hence be used concurrently.
+     *
+     * @throw NodeNotFoundException If there is no array toward this neighbor.
+     */
     const VVVdouble& getLikelihoodArrayForNeighbor(int neighborId) const
     {
-      return nodeLikelihoods_[neighborId];
+      std::map<int, VVVdouble>::const_iterator it = nodeLikelihoods_.get().find(neighborId);
+      if (it == nodeLikelihoods_.get().end())
+        throw NodeNotFoundException("DRASDRTreeLikelihoodNodeData::getLikelihoodArrayForNeighbor. No array toward this neighbor.", neighborId);
+      return it->second;
     }
     
-    Vdouble& getDLikelihoodArray() { return nodeDLikelihoods_;  }
+    Vdouble& getDLikelihoodArray() { return nodeDLikelihoods_.modify();  }
+    
+    const Vdouble& getDLikelihoodArray() const  {  return nodeDLikelihoods_.get();  }
     
-    const Vdouble& getDLikelihoodArray() const  {  return nodeDLikelihoods_;  }
+    Vdouble& getD2LikelihoodArray()  {  return nodeD2Likelihoods_.modify(); }
     
-    Vdouble& getD2LikelihoodArray()  {  return nodeD2Likelihoods_; }
+    const Vdouble& getD2LikelihoodArray() const  {  return nodeD2Likelihoods_.get(); }
     
-    const Vdouble& getD2LikelihoodArrayForNeighbor() const  { return nodeD2Likelihoods_; }
+    const Vdouble& getD2LikelihoodArrayForNeighbor() const  { return nodeD2Likelihoods_.get(); }
 
     bool isNeighbor(int neighborId) const
     {
-      return nodeLikelihoods_.find(neighborId) != nodeLikelihoods_.end();
+      return nodeLikelihoods_.get().find(neighborId) != nodeLikelihoods_.get().end();
     }
 
     void eraseNeighborArrays()
     {
-      nodeLikelihoods_.erase(nodeLikelihoods_.begin(), nodeLikelihoods_.end());
-      nodeDLikelihoods_.erase(nodeDLikelihoods_.begin(), nodeDLikelihoods_.end());
-      nodeD2Likelihoods_.erase(nodeD2Likelihoods_.begin(), nodeD2Likelihoods_.end());
+      nodeLikelihoods_.reset();
+      nodeDLikelihoods_.reset();
+      nodeD2Likelihoods_.reset();
     }
 };
 
@@ -223,9 +251,16 @@ class DRASDRTreeLikelihoodData :
 
     mutable std::map<int, DRASDRTreeLikelihoodNodeData> nodeData_;
     mutable std::map<int, DRASDRTreeLikelihoodLeafData> leafData_;
-    mutable VVVdouble rootLikelihoods_;
-    mutable VVdouble  rootLikelihoodsS_;
-    mutable Vdouble   rootLikelihoodsSR_;
+    mutable CopyOnWrite<VVVdouble> rootLikelihoods_;
+    mutable CopyOnWrite<VVdouble>  rootLikelihoodsS_;
+    mutable CopyOnWrite<Vdouble>   rootLikelihoodsSR_;
+
+    /**
+     * @brief Likelihood vectors for each leaf state code.
+     *
+     * Empty if leaves could not be coded on one byte.
+     */
+    VVdouble leafCodeLikelihoods_;
 
     SiteContainer* shrunkData_;
     size_t nbSites_; 
@@ -237,7 +272,7 @@ class DRASDRTreeLikelihoodData :
     DRASDRTreeLikelihoodData(const TreeTemplate<Node>* tree, size_t nbClasses) :
       AbstractTreeLikelihoodData(tree),
       nodeData_(), leafData_(), rootLikelihoods_(), rootLikelihoodsS_(), rootLikelihoodsSR_(),
-      shrunkData_(0), nbSites_(0), nbStates_(0), nbClasses_(nbClasses), nbDistinctSites_(0)
+      leafCodeLikelihoods_(), shrunkData_(0), nbSites_(0), nbStates_(0), nbClasses_(nbClasses), nbDistinctSites_(0)
     {}
 
     DRASDRTreeLikelihoodData(const DRASDRTreeLikelihoodData& data):
@@ -246,6 +281,7 @@ class DRASDRTreeLikelihoodData :
       rootLikelihoods_(data.rootLikelihoods_),
       rootLikelihoodsS_(data.rootLikelihoodsS_),
       rootLikelihoodsSR_(data.rootLikelihoodsSR_),
+      leafCodeLikelihoods_(data.leafCodeLikelihoods_),
       shrunkData_(0),
       nbSites_(data.nbSites_), nbStates_(data.nbStates_),
       nbClasses_(data.nbClasses_), nbDistinctSites_(data.nbDistinctSites_)
@@ -262,6 +298,7 @@ class DRASDRTreeLikelihoodData :
       rootLikelihoods_   = data.rootLikelihoods_;
       rootLikelihoodsS_  = data.rootLikelihoodsS_;
       rootLikelihoodsSR_ = data.rootLikelihoodsSR_;
+      leafCodeLikelihoods_ = data.leafCodeLikelihoods_;
       nbSites_           = data.nbSites_;
       nbStates_          = data.nbStates_;
       nbClasses_         = data.nbClasses_;
@@ -308,9 +345,20 @@ class DRASDRTreeLikelihoodData :
       return nodeData_[nodeId];
     }
     
+    /**
+     * @brief Get the data of a node, without creating it.
+     *
+     * This accessor, as all const accessors of this class, never modifies the data,
+     * and can hence be used concurrently.
+     *
+     * @throw NodeNotFoundException If there is no data for this node.
+     */
     const DRASDRTreeLikelihoodNodeData& getNodeData(int nodeId) const
     { 
-      return nodeData_[nodeId];
+      std::map<int, DRASDRTreeLikelihoodNodeData>::const_iterator it = nodeData_.find(nodeId);
+      if (it == nodeData_.end())
+        throw NodeNotFoundException("DRASDRTreeLikelihoodData::getNodeData. No data for this node.", nodeId);
+      return it->second;
     }
     
     DRASDRTreeLikelihoodLeafData& getLeafData(int nodeId)
@@ -318,9 +366,17 @@ class DRASDRTreeLikelihoodData :
       return leafData_[nodeId];
     }
     
+    /**
+     * @brief Get the data of a leaf, without creating it.
+     *
+     * @throw NodeNotFoundException If there is no data for this leaf.
+     */
     const DRASDRTreeLikelihoodLeafData& getLeafData(int nodeId) const
     { 
-      return leafData_[nodeId];
+      std::map<int, DRASDRTreeLikelihoodLeafData>::const_iterator it = leafData_.find(nodeId);
+      if (it == leafData_.end())
+        throw NodeNotFoundException("DRASDRTreeLikelihoodData::getLeafData. No data for this leaf.", nodeId);
+      return it->second;
     }
     
     size_t getArrayPosition(int parentId, int sonId, size_t currentPosition) const
@@ -330,7 +386,7 @@ class DRASDRTreeLikelihoodData :
 
     const std::map<int, VVVdouble>& getLikelihoodArrays(int nodeId) const 
     {
-      return nodeData_[nodeId].getLikelihoodArrays();
+      return getNodeData(nodeId).getLikelihoodArrays();
     }
     
     std::map<int, VVVdouble>& getLikelihoodArrays(int nodeId)
@@ -345,7 +401,7 @@ class DRASDRTreeLikelihoodData :
     
     const VVVdouble& getLikelihoodArray(int parentId, int neighborId) const
     {
-      return nodeData_[parentId].getLikelihoodArrayForNeighbor(neighborId);
+      return getNodeData(parentId).getLikelihoodArrayForNeighbor(neighborId);
     }
     
     Vdouble& getDLikelihoodArray(int nodeId)
@@ -355,7 +411,7 @@ class DRASDRTreeLikelihoodData :
     
     const Vdouble& getDLikelihoodArray(int nodeId) const
     {
-      return nodeData_[nodeId].getDLikelihoodArray();
+      return getNodeData(nodeId).getDLikelihoodArray();
     }
     
     Vdouble& getD2LikelihoodArray(int nodeId)
@@ -365,27 +421,66 @@ class DRASDRTreeLikelihoodData :
 
     const Vdouble& getD2LikelihoodArray(int nodeId) const
     {
-      return nodeData_[nodeId].getD2LikelihoodArray();
+      return getNodeData(nodeId).getD2LikelihoodArray();
     }
 
-    VVdouble& getLeafLikelihoods(int nodeId)
-    {
-      return leafData_[nodeId].getLikelihoodArray();
-    }
-    
-    const VVdouble& getLeafLikelihoods(int nodeId) const
+    /**
+     * @brief Get the likelihood vector of a leaf at each distinct site.
+     *
+     * If the leaf is stored as compact state codes, each pointer refers to
+     * the likelihood vector of the code at this site (see getLeafCodeLikelihoods()),
+     * so that no array is built.
+     *
+     * @param nodeId      The id of the leaf.
+     * @param likelihoods [out] For each distinct site, a pointer to the likelihood vector of the leaf.
+     * @throw NodeNotFoundException If the leaf has no data.
+     */
+    void getLeafLikelihoods(int nodeId, std::vector<const Vdouble*>& likelihoods) const;
+
+    /**
+     * @brief Get the likelihood array of a leaf, as a [site][state] array.
+     *
+     * If the leaves are stored as compact state codes, all of them are expanded
+     * to plain arrays at the first call, and the code table is dropped, so that
+     * modifications of the returned array are taken into account by the likelihood computations.
+     *
+     * @deprecated Use getLeafLikelihoods(int, std::vector<const Vdouble*>&) const,
+     * which does not expand the leaves.
+     *
+     * @param nodeId The id of the leaf.
+     * @throw NodeNotFoundException If the leaf has no data.
+     */
+    VVdouble& getLeafLikelihoods(int nodeId);
+
+    /**
+     * @return True if all leaves are stored as compact state codes.
+     */
+    bool hasLeafStateCodes() const { return leafCodeLikelihoods_.size() > 0; }
+
+    /**
+     * @brief Get the state code at each distinct site for a leaf.
+     *
+     * The likelihood vector corresponding to each code is given by getLeafCodeLikelihoods().
+     * The vector is empty if hasLeafStateCodes() returns false.
+     */
+    const std::vector<unsigned char>& getLeafStateCodes(int nodeId) const
     {
-      return leafData_[nodeId].getLikelihoodArray();
+      return getLeafData(nodeId).getStateCodes();
     }
+
+    /**
+     * @return The likelihood vector for each leaf state code, as a [code][state] array.
+     */
+    const VVdouble& getLeafCodeLikelihoods() const { return leafCodeLikelihoods_; }
     
-    VVVdouble& getRootLikelihoodArray() { return rootLikelihoods_; }
-    const VVVdouble & getRootLikelihoodArray() const { return rootLikelihoods_; }
+    VVVdouble& getRootLikelihoodArray() { return rootLikelihoods_.modify(); }
+    const VVVdouble & getRootLikelihoodArray() const { return rootLikelihoods_.get(); }
     
-    VVdouble& getRootSiteLikelihoodArray() { return rootLikelihoodsS_; }
-    const VVdouble& getRootSiteLikelihoodArray() const { return rootLikelihoodsS_; }
+    VVdouble& getRootSiteLikelihoodArray() { return rootLikelihoodsS_.modify(); }
+    const VVdouble& getRootSiteLikelihoodArray() const { return rootLikelihoodsS_.get(); }
     
-    Vdouble& getRootRateSiteLikelihoodArray() { return rootLikelihoodsSR_; }
-    const Vdouble& getRootRateSiteLikelihoodArray() const { return rootLikelihoodsSR_; }
+    Vdouble& getRootRateSiteLikelihoodArray() { return rootLikelihoodsSR_.modify(); }
+    const Vdouble& getRootRateSiteLikelihoodArray() const { return rootLikelihoodsSR_.get(); }
 
     size_t getNumberOfDistinctSites() const { return nbDistinctSites_; }
     
@@ -415,7 +510,10 @@ class DRASDRTreeLikelihoodData :
      */
     void reInit();
     
-    void reInit(const Node* node);
+    /**
+     * @brief Rebuild likelihood arrays in the subtree defined by a node, without recursion.
+     */
+    void reInit(const Node* subtree);
 
   protected:
     /**
@@ -428,13 +526,36 @@ class DRASDRTreeLikelihoodData :
      * All likelihood arrays at each nodes are initialized according to alphabet
      * size and sequences length, and filled with 1.
      *
-     * NB: This method is recursive.
+     * The subtree is traversed without recursion, so that deep trees do not exhaust the call stack.
+     *
+     * @param subtree The node defining the subtree to analyse.
+     * @param sites   The sequence container to use.
+     * @param model   The model, used for initializing leaves' likelihoods.
+     */
+    void initLikelihoods(const Node* subtree, const SiteContainer& sites, const TransitionModel& model);
+
+  private:
+    /**
+     * @brief Build the table of state codes and code all leaves.
+     *
+     * One code is created for each distinct character in the data set.
+     * If there are more than 256 of them, no table is created and leaves
+     * are stored as expanded likelihood arrays.
      *
-     * @param node  The node defining the subtree to analyse.
      * @param sites The sequence container to use.
      * @param model The model, used for initializing leaves' likelihoods.
      */
-    void initLikelihoods(const Node* node, const SiteContainer& sites, const TransitionModel& model);
+    void initLeafStateCodes_(const SiteContainer& sites, const TransitionModel& model);
+
+    /**
+     * @brief Expand the state codes of all leaves to plain likelihood arrays, and drop the code table.
+     */
+    void expandLeafStateCodes_();
+
+    /**
+     * @brief Resize an array of likelihoods and set all values to 1.
+     */
+    void initLikelihoodArray_(VVVdouble& array) const;
     
 };
 
@@ -167,7 +167,7 @@ void DRASRTreeLikelihoodData::initLikelihoods(const Node* node, const SiteContai
   else
   {
     // 'node' is an internal node.
-    std::map<int, std::vector<size_t> >* patternLinks__node = &patternLinks_[node->getId()];
+    std::map<int, std::vector<size_t> >* patternLinks__node = &patternLinks_.modify()[node->getId()];
     size_t nbSonNodes = node->getNumberOfSons();
     for (size_t l = 0; l < nbSonNodes; l++)
     {
@@ -270,7 +270,7 @@ SitePatterns* DRASRTreeLikelihoodData::initLikelihoodsWithPatterns(const Node* n
   else
   {
     // 'node' is an internal node.
-    std::map<int, std::vector<size_t> >* patternLinks__node = &patternLinks_[node->getId()];
+    std::map<int, std::vector<size_t> >* patternLinks__node = &patternLinks_.modify()[node->getId()];
 
     // Now initialize pattern links:
     size_t nbSonNodes = node->getNumberOfSons();
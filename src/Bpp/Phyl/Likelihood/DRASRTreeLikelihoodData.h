@@ -42,6 +42,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _DRASRHOMOGENEOUSTREELIKELIHOODDATA_H_
 
 #include "AbstractTreeLikelihoodData.h"
+#include "CopyOnWrite.h"
 #include "../Model/SubstitutionModel.h"
 #include "../SitePatterns.h"
 
@@ -67,6 +68,7 @@ namespace bpp
  * </pre> 
  * We call this the <i>likelihood array</i> for each node.
  * In the same way, we store first and second order derivatives.
+ * All three arrays are shared with copies of this object until modified.
  *
  * @see DRASRTreeLikelihoodData
  */
@@ -74,9 +76,9 @@ class DRASRTreeLikelihoodNodeData :
   public virtual TreeLikelihoodNodeData
 {
   private:
-    mutable VVVdouble nodeLikelihoods_;
-    mutable VVVdouble nodeDLikelihoods_;
-    mutable VVVdouble nodeD2Likelihoods_;
+    CopyOnWrite<VVVdouble> nodeLikelihoods_;
+    CopyOnWrite<VVVdouble> nodeDLikelihoods_;
+    CopyOnWrite<VVVdouble> nodeD2Likelihoods_;
     const Node* node_;
 
   public:
@@ -107,14 +109,14 @@ class DRASRTreeLikelihoodNodeData :
     const Node* getNode() const { return node_; }
     void setNode(const Node* node) { node_ = node; }
 
-    VVVdouble& getLikelihoodArray() { return nodeLikelihoods_; }
-    const VVVdouble& getLikelihoodArray() const { return nodeLikelihoods_; }
+    VVVdouble& getLikelihoodArray() { return nodeLikelihoods_.modify(); }
+    const VVVdouble& getLikelihoodArray() const { return nodeLikelihoods_.get(); }
     
-    VVVdouble& getDLikelihoodArray() { return nodeDLikelihoods_; }
-    const VVVdouble& getDLikelihoodArray() const { return nodeDLikelihoods_; }
+    VVVdouble& getDLikelihoodArray() { return nodeDLikelihoods_.modify(); }
+    const VVVdouble& getDLikelihoodArray() const { return nodeDLikelihoods_.get(); }
 
-    VVVdouble& getD2LikelihoodArray() { return nodeD2Likelihoods_; }
-    const VVVdouble& getD2LikelihoodArray() const { return nodeD2Likelihoods_; }
+    VVVdouble& getD2LikelihoodArray() { return nodeD2Likelihoods_.modify(); }
+    const VVVdouble& getD2LikelihoodArray() const { return nodeD2Likelihoods_.get(); }
 };
 
 /**
@@ -141,8 +143,9 @@ class DRASRTreeLikelihoodData :
      *
      * The double map contains the position of the site to use (second dimension)
      * of the likelihoods array.
+     * It is only modified when the data are initialized, and is shared by all copies.
      */
-    mutable std::map<int, std::map<int, std::vector<size_t> > > patternLinks_;
+    mutable CopyOnWrite< std::map<int, std::map<int, std::vector<size_t> > > > patternLinks_;
     SiteContainer* shrunkData_;
     size_t nbSites_; 
     size_t nbStates_;
@@ -222,7 +225,7 @@ class DRASRTreeLikelihoodData :
     }
     size_t getArrayPosition(int parentId, int sonId, size_t currentPosition) const
     {
-      return patternLinks_[parentId][sonId][currentPosition];
+      return getArrayPositions(parentId, sonId)[currentPosition];
     }
     size_t getRootArrayPosition(size_t currentPosition) const
     {
@@ -230,15 +233,15 @@ class DRASRTreeLikelihoodData :
     }
     const std::vector<size_t>& getArrayPositions(int parentId, int sonId) const
     {
-      return patternLinks_[parentId][sonId];
-    }
-    std::vector<size_t>& getArrayPositions(int parentId, int sonId)
-    {
-      return patternLinks_[parentId][sonId];
-    }
-    size_t getArrayPosition(int parentId, int sonId, size_t currentPosition)
-    {
-      return patternLinks_[parentId][sonId][currentPosition];
+      const std::map<int, std::map<int, std::vector<size_t> > >& links = patternLinks_.get();
+      std::map<int, std::map<int, std::vector<size_t> > >::const_iterator it = links.find(parentId);
+      if (it != links.end())
+      {
+        std::map<int, std::vector<size_t> >::const_iterator it2 = it->second.find(sonId);
+        if (it2 != it->second.end())
+          return it2->second;
+      }
+      return patternLinks_.modify()[parentId][sonId];
     }
 
     VVVdouble& getLikelihoodArray(int nodeId)
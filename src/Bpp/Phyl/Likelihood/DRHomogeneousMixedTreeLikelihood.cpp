@@ -508,6 +508,60 @@ double DRHomogeneousMixedTreeLikelihood::getSecondOrderDerivative(const std::str
   return -d;
 }
 
+/******************************************************************************/
+
+double DRHomogeneousMixedTreeLikelihood::getValueAndGradient(const ParameterList& parameters, Vdouble& gradient)
+{
+  // Derivatives are obtained from the derivative arrays of each model:
+  enableFirstOrderDerivatives(true);
+  setParameters(parameters);
+  gradient.resize(parameters.size());
+  for (size_t k = 0; k < parameters.size(); k++)
+  {
+    gradient[k] = getFirstOrderDerivative(parameters[k].getName());
+  }
+  return getValue();
+}
+
+/******************************************************************************/
+
+void DRHomogeneousMixedTreeLikelihood::getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const
+{
+  d1.resize(nbNodes_);
+  d2.resize(nbNodes_);
+  size_t nbModels = treeLikelihoodsContainer_.size();
+  vector<const DRASDRTreeLikelihoodData*> data(nbModels);
+  for (size_t j = 0; j < nbModels; j++)
+  {
+    data[j] = treeLikelihoodsContainer_[j]->likelihoodData_;
+  }
+  const vector<unsigned int>* w = &likelihoodData_->getWeights();
+  vector<const Vdouble*> dLikelihoods_branch(nbModels), d2Likelihoods_branch(nbModels);
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    int id = nodes_[k]->getId();
+    for (size_t j = 0; j < nbModels; j++)
+    {
+      dLikelihoods_branch[j] = &data[j]->getDLikelihoodArray(id);
+      d2Likelihoods_branch[j] = &data[j]->getD2LikelihoodArray(id);
+    }
+    double d1k = 0, d2k = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      double x = 0, x2 = 0;
+      for (size_t j = 0; j < nbModels; j++)
+      {
+        x += (*dLikelihoods_branch[j])[i] * probas_[j];
+        x2 += (*d2Likelihoods_branch[j])[i] * probas_[j];
+      }
+      d1k += (*w)[i] * x;
+      d2k += (*w)[i] * (x2 - x * x);
+    }
+    d1[k] = -d1k;
+    d2[k] = -d2k;
+  }
+}
+
 
 void DRHomogeneousMixedTreeLikelihood::displayLikelihood(const Node* node)
 {
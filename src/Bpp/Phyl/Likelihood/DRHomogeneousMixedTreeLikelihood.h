@@ -163,6 +163,13 @@ public:
    * @{
    */
   double getFirstOrderDerivative(const std::string& variable) const;
+
+  /**
+   * @return Branch lengths only: derivatives with respect to mixed model parameters are not available.
+   */
+  ParameterList getFirstOrderDerivableParameters() const { return getDerivableParameters(); }
+
+  double getValueAndGradient(const ParameterList& parameters, Vdouble& gradient);
   /** @} */
 
   /**
@@ -174,6 +181,8 @@ public:
   double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const { return 0; } // Not implemented for now.
   /** @} */
 
+  void getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const;
+
 public:
   // Specific methods:
   void initialize();
@@ -39,6 +39,7 @@
 
 #include "DRHomogeneousTreeLikelihood.h"
 #include "../PatternTools.h"
+#include "../Model/NumericalModelParameterDerivative.h"
 
 // From SeqLib:
 #include <Bpp/Seq/SiteTools.h>
@@ -47,11 +48,13 @@
 
 #include <Bpp/Text/TextTools.h>
 #include <Bpp/App/ApplicationTools.h>
+#include <Bpp/Numeric/Matrix/MatrixTools.h>
 
 using namespace bpp;
 
 // From the STL:
 #include <iostream>
+#include <cmath>
 
 using namespace std;
 
@@ -65,7 +68,8 @@ DRHomogeneousTreeLikelihood::DRHomogeneousTreeLikelihood(
   bool verbose) :
   AbstractHomogeneousTreeLikelihood(tree, model, rDist, checkRooted, verbose),
   likelihoodData_(0),
-  minusLogLik_(-1.)
+  minusLogLik_(-1.),
+  parameterDerivatives_()
 {
   init_();
 }
@@ -81,7 +85,8 @@ DRHomogeneousTreeLikelihood::DRHomogeneousTreeLikelihood(
   bool verbose) :
   AbstractHomogeneousTreeLikelihood(tree, model, rDist, checkRooted, verbose),
   likelihoodData_(0),
-  minusLogLik_(-1.)
+  minusLogLik_(-1.),
+  parameterDerivatives_()
 {
   init_();
   setData(data);
@@ -101,11 +106,13 @@ void DRHomogeneousTreeLikelihood::init_()
 DRHomogeneousTreeLikelihood::DRHomogeneousTreeLikelihood(const DRHomogeneousTreeLikelihood& lik) :
   AbstractHomogeneousTreeLikelihood(lik),
   likelihoodData_(0),
-  minusLogLik_(-1.)
+  minusLogLik_(-1.),
+  parameterDerivatives_()
 {
   likelihoodData_ = dynamic_cast<DRASDRTreeLikelihoodData*>(lik.likelihoodData_->clone());
   likelihoodData_->setTree(tree_);
   minusLogLik_ = lik.minusLogLik_;
+  parameterDerivatives_ = lik.parameterDerivatives_;
 }
 
 /******************************************************************************/
@@ -118,6 +125,7 @@ DRHomogeneousTreeLikelihood& DRHomogeneousTreeLikelihood::operator=(const DRHomo
   likelihoodData_ = dynamic_cast<DRASDRTreeLikelihoodData*>(lik.likelihoodData_->clone());
   likelihoodData_->setTree(tree_);
   minusLogLik_ = lik.minusLogLik_;
+  parameterDerivatives_ = lik.parameterDerivatives_;
   return *this;
 }
 
@@ -274,6 +282,17 @@ void DRHomogeneousTreeLikelihood::fireParameterChanged(const ParameterList& para
 
 /******************************************************************************/
 
+void DRHomogeneousTreeLikelihood::setPatternWeights(const std::vector<unsigned int>& weights)
+{
+  if (!isInitialized())
+    throw Exception("DRHomogeneousTreeLikelihood::setPatternWeights(). Instance is not initialized.");
+  likelihoodData_->setWeights(weights);
+  parameterDerivatives_.clear();
+  minusLogLik_ = -getLogLikelihood();
+}
+
+/******************************************************************************/
+
 double DRHomogeneousTreeLikelihood::getValue() const
 {
   if (!isInitialized())
@@ -287,9 +306,15 @@ double DRHomogeneousTreeLikelihood::getValue() const
 void DRHomogeneousTreeLikelihood::computeTreeDLikelihoodAtNode(const Node* node)
 {
   const Node* father = node->getFather();
-  VVVdouble* likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
+  // Nothing is stored toward a leaf, its likelihoods are the same for all rate classes:
+  const VVVdouble* likelihoods_father_node = 0;
+  vector<const Vdouble*> leafLikelihoods;
+  if (node->isLeaf())
+    likelihoodData_->getLeafLikelihoods(node->getId(), leafLikelihoods);
+  else
+    likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
   Vdouble* dLikelihoods_node = &likelihoodData_->getDLikelihoodArray(node->getId());
-  VVVdouble* dpxy_node = &dpxy_[node->getId()];
+  const VVVdouble* dpxy_node = &dpxy_.at(node->getId()).get();
   VVVdouble larray;
   computeLikelihoodAtNode_(father, larray, node);
   Vdouble* rootLikelihoodsSR = &likelihoodData_->getRootRateSiteLikelihoodArray();
@@ -298,18 +323,17 @@ void DRHomogeneousTreeLikelihood::computeTreeDLikelihoodAtNode(const Node* node)
 
   for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    VVdouble* likelihoods_father_node_i = &(*likelihoods_father_node)[i];
     VVdouble* larray_i = &larray[i];
     dLi = 0;
     for (size_t c = 0; c < nbClasses_; c++)
     {
-      Vdouble* likelihoods_father_node_i_c = &(*likelihoods_father_node_i)[c];
+      const Vdouble* likelihoods_father_node_i_c = likelihoods_father_node ? &(*likelihoods_father_node)[i][c] : leafLikelihoods[i];
       Vdouble* larray_i_c = &(*larray_i)[c];
-      VVdouble* dpxy_node_c = &(*dpxy_node)[c];
+      const VVdouble* dpxy_node_c = &(*dpxy_node)[c];
       dLic = 0;
       for (size_t x = 0; x < nbStates_; x++)
       {
-        Vdouble* dpxy_node_c_x = &(*dpxy_node_c)[x];
+        const Vdouble* dpxy_node_c_x = &(*dpxy_node_c)[x];
         dLicx = 0;
         for (size_t y = 0; y < nbStates_; y++)
         {
@@ -341,30 +365,377 @@ double DRHomogeneousTreeLikelihood::getFirstOrderDerivative(const std::string& v
 {
   if (!hasParameter(variable))
     throw ParameterNotFoundException("DRHomogeneousTreeLikelihood::getFirstOrderDerivative().", variable);
-  if (getRateDistributionParameters().hasParameter(variable))
+  if (computeFirstOrderDerivatives_ && variable.substr(0, 5) == "BrLen")
   {
-    throw Exception("Derivatives respective to rate distribution parameters are not implemented.");
+    // Derivative arrays are up to date:
+    const Node* branch = nodes_[TextTools::to<size_t>(variable.substr(5))];
+    Vdouble* dLikelihoods_branch = &likelihoodData_->getDLikelihoodArray(branch->getId());
+    double d = 0;
+    const vector<unsigned int>* w = &likelihoodData_->getWeights();
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      d += (*w)[i] * (*dLikelihoods_branch)[i];
+    }
+    return -d;
   }
-  if (getSubstitutionModelParameters().hasParameter(variable))
+
+  map<string, double>::const_iterator it = parameterDerivatives_.find(variable);
+  if (it == parameterDerivatives_.end())
   {
-    throw Exception("Derivatives respective to substitution model parameters are not implemented.");
+    // All first order derivatives share most of the computations, so they are cached in one pass.
+    // Branch lengths are left out when they are read from the derivative arrays:
+    ParameterList pl = getSubstitutionModelParameters();
+    pl.addParameters(getRateDistributionParameters());
+    if (!computeFirstOrderDerivatives_)
+      pl.addParameters(getDerivableParameters());
+    computeParameterDerivatives_(pl);
+    it = parameterDerivatives_.find(variable);
+    if (it == parameterDerivatives_.end())
+      throw Exception("DRHomogeneousTreeLikelihood::getFirstOrderDerivative. Parameter is not first order derivable: " + variable);
   }
+  return it->second;
+}
 
-  //
-  // Computation for branch lengths:
-  //
+ParameterList DRHomogeneousTreeLikelihood::getFirstOrderDerivableParameters() const
+{
+  ParameterList pl = getDerivableParameters();
+  pl.addParameters(getSubstitutionModelParameters());
+  pl.addParameters(getRateDistributionParameters());
+  return pl;
+}
 
-  // Get the node with the branch whose length must be derivated:
-  size_t brI = TextTools::to<size_t>(variable.substr(5));
-  const Node* branch = nodes_[brI];
-  Vdouble* dLikelihoods_branch = &likelihoodData_->getDLikelihoodArray(branch->getId());
-  double d = 0;
-  const vector<unsigned int>* w = &likelihoodData_->getWeights();
-  for (size_t i = 0; i < nbDistinctSites_; i++)
+/******************************************************************************/
+
+double DRHomogeneousTreeLikelihood::getValueAndGradient(const ParameterList& parameters, Vdouble& gradient)
+{
+  matchParametersValues(parameters);
+  computeParameterDerivatives_(parameters);
+  size_t n = parameters.size();
+  gradient.resize(n);
+  for (size_t k = 0; k < n; k++)
+  {
+    const string& name = parameters[k].getName();
+    map<string, double>::const_iterator it = parameterDerivatives_.find(name);
+    if (it == parameterDerivatives_.end())
+      throw Exception("DRHomogeneousTreeLikelihood::getValueAndGradient. Parameter is not first order derivable: " + name);
+    gradient[k] = it->second;
+  }
+  return getValue();
+}
+
+/******************************************************************************/
+
+void DRHomogeneousTreeLikelihood::computeParameterDerivatives_(const ParameterList& parameters) const
+{
+  ParameterList plm = getSubstitutionModelParameters().getCommonParametersWith(parameters);
+  size_t nbModelParameters = plm.size();
+  vector<NumericalModelParameterDerivative> mpd;
+  for (size_t k = 0; k < nbModelParameters; k++)
+  {
+    mpd.push_back(NumericalModelParameterDerivative(*model_, plm[k].getName()));
+  }
+  Vdouble p = rateDistribution_->getProbabilities();
+  Vdouble r = rateDistribution_->getCategories();
+
+  // Rate distribution parameters act on all branches. Once all branches are needed,
+  // the other rate distribution parameters and the branch lengths come at little cost:
+  ParameterList plr;
+  if (getRateDistributionParameters().getCommonParametersWith(parameters).size() > 0)
+    plr = getRateDistributionParameters();
+  size_t nbRateParameters = plr.size();
+  vector<bool> branches(nbNodes_, nbRateParameters > 0);
+  for (size_t k = 0; k < parameters.size(); k++)
+  {
+    const string& name = parameters[k].getName();
+    if (name.substr(0, 5) == "BrLen" && hasParameter(name))
+      branches[TextTools::to<size_t>(name.substr(5))] = true;
+  }
+
+  // Derivatives of the rates and probabilities of each class, by central differences when possible:
+  VVdouble dr(nbRateParameters), dp(nbRateParameters);
+  for (size_t k = 0; k < nbRateParameters; k++)
+  {
+    const Parameter& parameter = plr[k];
+    double value = parameter.getValue();
+    double h = 1e-6 * max(abs(value), 1.);
+    double upper = value + h;
+    double lower = value - h;
+    if (parameter.hasConstraint())
+    {
+      if (!parameter.getConstraint()->isCorrect(upper))
+        upper = value;
+      else if (!parameter.getConstraint()->isCorrect(lower))
+        lower = value;
+    }
+    unique_ptr<DiscreteDistribution> upperDist(rateDistribution_->clone());
+    unique_ptr<DiscreteDistribution> lowerDist(rateDistribution_->clone());
+    upperDist->setParameterValue(parameter.getName(), upper);
+    lowerDist->setParameterValue(parameter.getName(), lower);
+    Vdouble upperR = upperDist->getCategories();
+    Vdouble lowerR = lowerDist->getCategories();
+    Vdouble upperP = upperDist->getProbabilities();
+    Vdouble lowerP = lowerDist->getProbabilities();
+    dr[k].resize(nbClasses_);
+    dp[k].resize(nbClasses_);
+    for (size_t c = 0; c < nbClasses_; c++)
+    {
+      dr[k][c] = (upperR[c] - lowerR[c]) / (upper - lower);
+      dp[k][c] = (upperP[c] - lowerP[c]) / (upper - lower);
+    }
+  }
+
+  VVdouble dLm(nbModelParameters, Vdouble(nbDistinctSites_, 0.));
+  map<size_t, Vdouble> dLb;
+
+  // Derivative with respect to the rate of each class, for each site:
+  VVdouble dLr(nbRateParameters > 0 ? nbDistinctSites_ : 0, Vdouble(nbClasses_, 0.));
+
+  // Contribution of the equilibrium frequencies at the root:
+  const VVVdouble* rootLikelihoods = &getLikelihoodData()->getRootLikelihoodArray();
+  for (size_t k = 0; k < nbModelParameters; k++)
+  {
+    const Vdouble& dFreqs = mpd[k].getdFrequencies();
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      const VVdouble* rootLikelihoods_i = &(*rootLikelihoods)[i];
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        const Vdouble* rootLikelihoods_i_c = &(*rootLikelihoods_i)[c];
+        double dLic = 0;
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          dLic += dFreqs[x] * (*rootLikelihoods_i_c)[x];
+        }
+        dLm[k][i] += p[c] * dLic;
+      }
+    }
+  }
+
+  // Contribution of each branch.
+  // The likelihood arrays on both sides of each branch are those of the last traversal,
+  // the array toward the father being the likelihood of the rest of the tree:
+  RowMatrix<double> dP;
+  vector<const Vdouble*> leafLikelihoods;
+  for (size_t l = 0; l < nbNodes_; l++)
+  {
+    if (!branches[l] && nbModelParameters == 0)
+      continue;
+    const Node* node = nodes_[l];
+    const Node* father = node->getFather();
+    double t = node->getDistanceToFather();
+    const VVVdouble* likelihoods_node_father = &getLikelihoodData()->getLikelihoodArray(node->getId(), father->getId());
+    // Nothing is stored toward a leaf, its likelihoods are the same for all rate classes:
+    const VVVdouble* likelihoods_father_node = 0;
+    if (node->isLeaf())
+      getLikelihoodData()->getLeafLikelihoods(node->getId(), leafLikelihoods);
+    else
+      likelihoods_father_node = &getLikelihoodData()->getLikelihoodArray(father->getId(), node->getId());
+
+    // Branch length and rates:
+    if (branches[l])
+    {
+      Vdouble* dLb_l = &dLb[l];
+      dLb_l->resize(nbDistinctSites_);
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        dP = model_->getdPij_dt(t * r[c]);
+        for (size_t i = 0; i < nbDistinctSites_; i++)
+        {
+          const Vdouble* likelihoods_father_node_i_c = likelihoods_father_node ? &(*likelihoods_father_node)[i][c] : leafLikelihoods[i];
+          const Vdouble* likelihoods_node_father_i_c = &(*likelihoods_node_father)[i][c];
+          double dLic = 0;
+          for (size_t x = 0; x < nbStates_; x++)
+          {
+            double dLicx = 0;
+            for (size_t y = 0; y < nbStates_; y++)
+            {
+              dLicx += dP(x, y) * (*likelihoods_father_node_i_c)[y];
+            }
+            dLic += dLicx * (*likelihoods_node_father_i_c)[x];
+          }
+          (*dLb_l)[i] += p[c] * r[c] * dLic;
+          if (nbRateParameters > 0)
+            dLr[i][c] += p[c] * t * dLic;
+        }
+      }
+    }
+
+    // Model parameters:
+    for (size_t k = 0; k < nbModelParameters; k++)
+    {
+      Vdouble* dLm_k = &dLm[k];
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        mpd[k].getdPij_dParameter(t * r[c], dP);
+        for (size_t i = 0; i < nbDistinctSites_; i++)
+        {
+          const Vdouble* likelihoods_father_node_i_c = likelihoods_father_node ? &(*likelihoods_father_node)[i][c] : leafLikelihoods[i];
+          const Vdouble* likelihoods_node_father_i_c = &(*likelihoods_node_father)[i][c];
+          double dLic = 0;
+          for (size_t x = 0; x < nbStates_; x++)
+          {
+            double dLicx = 0;
+            for (size_t y = 0; y < nbStates_; y++)
+            {
+              dLicx += dP(x, y) * (*likelihoods_father_node_i_c)[y];
+            }
+            dLic += dLicx * (*likelihoods_node_father_i_c)[x];
+          }
+          (*dLm_k)[i] += p[c] * dLic;
+        }
+      }
+    }
+  }
+
+  // Rate distribution parameters:
+  const VVdouble* rootLikelihoodsS = &getLikelihoodData()->getRootSiteLikelihoodArray();
+  VVdouble dLd(nbRateParameters, Vdouble(nbDistinctSites_, 0.));
+  for (size_t k = 0; k < nbRateParameters; k++)
+  {
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        dLd[k][i] += dp[k][c] * (*rootLikelihoodsS)[i][c] + dr[k][c] * dLr[i][c];
+      }
+    }
+  }
+
+  // Derivatives of the negative log-likelihood:
+  const Vdouble* rootLikelihoodsSR = &getLikelihoodData()->getRootRateSiteLikelihoodArray();
+  const vector<unsigned int>* w = &getLikelihoodData()->getWeights();
+  for (size_t k = 0; k < nbModelParameters; k++)
+  {
+    double d = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      d += (*w)[i] * dLm[k][i] / (*rootLikelihoodsSR)[i];
+    }
+    parameterDerivatives_[plm[k].getName()] = -d;
+  }
+  for (size_t k = 0; k < nbRateParameters; k++)
+  {
+    double d = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      d += (*w)[i] * dLd[k][i] / (*rootLikelihoodsSR)[i];
+    }
+    parameterDerivatives_[plr[k].getName()] = -d;
+  }
+  for (map<size_t, Vdouble>::const_iterator it = dLb.begin(); it != dLb.end(); it++)
+  {
+    double d = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      d += (*w)[i] * it->second[i] / (*rootLikelihoodsSR)[i];
+    }
+    parameterDerivatives_["BrLen" + TextTools::toString(it->first)] = -d;
+  }
+}
+
+/******************************************************************************/
+
+double DRHomogeneousTreeLikelihood::optimizeBranchLength(size_t brI, const TransitionModel& model, double tolerance, unsigned int maxCorrection) const
+{
+  const Node* node = nodes_[brI];
+  const Node* father = node->getFather();
+  VVVdouble larray;
+  computeLikelihoodAtNode_(father, larray, node);
+  // Only read-only accessors are used, as several branches may be optimized concurrently:
+  const VVVdouble* likelihoods_father_node = 0;
+  vector<const Vdouble*> leafLikelihoods;
+  if (node->isLeaf())
+    getLikelihoodData()->getLeafLikelihoods(node->getId(), leafLikelihoods);
+  else
+    likelihoods_father_node = &getLikelihoodData()->getLikelihoodArray(father->getId(), node->getId());
+  const vector<unsigned int>* w = &getLikelihoodData()->getWeights();
+  Vdouble p = rateDistribution_->getProbabilities();
+  Vdouble r = rateDistribution_->getCategories();
+
+  vector< RowMatrix<double> > pxy(nbClasses_), dpxy(nbClasses_), d2pxy(nbClasses_);
+
+  // Compute the negative log-likelihood, and optionally its derivatives, for a given length:
+  auto evaluate = [&](double t, bool derivatives, double& f, double& d1, double& d2)
+  {
+    for (size_t c = 0; c < nbClasses_; c++)
+    {
+      pxy[c] = model.getPij_t(t * r[c]);
+      if (derivatives)
+      {
+        dpxy[c] = model.getdPij_dt(t * r[c]);
+        MatrixTools::scale(dpxy[c], r[c]);
+        d2pxy[c] = model.getd2Pij_dt2(t * r[c]);
+        MatrixTools::scale(d2pxy[c], r[c] * r[c]);
+      }
+    }
+    f = d1 = d2 = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      double li = 0, dli = 0, d2li = 0;
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        const Vdouble* larray_i_c = &larray[i][c];
+        const Vdouble* likelihoods_father_node_i_c = likelihoods_father_node ? &(*likelihoods_father_node)[i][c] : leafLikelihoods[i];
+        double lic = 0, dlic = 0, d2lic = 0;
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          double licx = 0, dlicx = 0, d2licx = 0;
+          for (size_t y = 0; y < nbStates_; y++)
+          {
+            double ly = (*likelihoods_father_node_i_c)[y];
+            licx += pxy[c](x, y) * ly;
+            if (derivatives)
+            {
+              dlicx += dpxy[c](x, y) * ly;
+              d2licx += d2pxy[c](x, y) * ly;
+            }
+          }
+          lic += (*larray_i_c)[x] * licx;
+          dlic += (*larray_i_c)[x] * dlicx;
+          d2lic += (*larray_i_c)[x] * d2licx;
+        }
+        li += p[c] * lic;
+        dli += p[c] * dlic;
+        d2li += p[c] * d2lic;
+      }
+      f -= (*w)[i] * log(li);
+      if (derivatives)
+      {
+        d1 -= (*w)[i] * dli / li;
+        d2 -= (*w)[i] * (d2li / li - pow(dli / li, 2));
+      }
+    }
+  };
+
+  double t = node->getDistanceToFather();
+  double f, d1, d2, fNew, tmp1, tmp2;
+  evaluate(t, true, f, d1, d2);
+  for (unsigned int it = 0; it < 100; it++)
   {
-    d += (*w)[i] * (*dLikelihoods_branch)[i];
+    if (d2 == 0)
+      break;
+    // Move in the descent direction, even if the second order derivative is negative:
+    double move = d1 / abs(d2);
+    if (std::isnan(move))
+      break;
+    double tNew = t - move;
+    if (!brLenConstraint_->isCorrect(tNew))
+      tNew = brLenConstraint_->getAcceptedLimit(tNew);
+    evaluate(tNew, false, fNew, tmp1, tmp2);
+    for (unsigned int count = 0; count < maxCorrection && (fNew > f || std::isnan(fNew)); count++)
+    {
+      tNew = (t + tNew) / 2.;
+      evaluate(tNew, false, fNew, tmp1, tmp2);
+    }
+    if (fNew > f || std::isnan(fNew))
+      break;
+    bool converged = (f - fNew < tolerance);
+    t = tNew;
+    if (converged)
+      break;
+    evaluate(t, true, f, d1, d2);
   }
-  return -d;
+  return t;
 }
 
 /******************************************************************************
@@ -373,9 +744,15 @@ double DRHomogeneousTreeLikelihood::getFirstOrderDerivative(const std::string& v
 void DRHomogeneousTreeLikelihood::computeTreeD2LikelihoodAtNode(const Node* node)
 {
   const Node* father = node->getFather();
-  VVVdouble* likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
+  // Nothing is stored toward a leaf, its likelihoods are the same for all rate classes:
+  const VVVdouble* likelihoods_father_node = 0;
+  vector<const Vdouble*> leafLikelihoods;
+  if (node->isLeaf())
+    likelihoodData_->getLeafLikelihoods(node->getId(), leafLikelihoods);
+  else
+    likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
   Vdouble* d2Likelihoods_node = &likelihoodData_->getD2LikelihoodArray(node->getId());
-  VVVdouble* d2pxy_node = &d2pxy_[node->getId()];
+  const VVVdouble* d2pxy_node = &d2pxy_.at(node->getId()).get();
   VVVdouble larray;
   computeLikelihoodAtNode_(father, larray, node);
   Vdouble* rootLikelihoodsSR = &likelihoodData_->getRootRateSiteLikelihoodArray();
@@ -384,18 +761,17 @@ void DRHomogeneousTreeLikelihood::computeTreeD2LikelihoodAtNode(const Node* node
 
   for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    VVdouble* likelihoods_father_node_i = &(*likelihoods_father_node)[i];
     VVdouble* larray_i = &larray[i];
     d2Li = 0;
     for (size_t c = 0; c < nbClasses_; c++)
     {
-      Vdouble* likelihoods_father_node_i_c = &(*likelihoods_father_node_i)[c];
+      const Vdouble* likelihoods_father_node_i_c = likelihoods_father_node ? &(*likelihoods_father_node)[i][c] : leafLikelihoods[i];
       Vdouble* larray_i_c = &(*larray_i)[c];
-      VVdouble* d2pxy_node_c = &(*d2pxy_node)[c];
+      const VVdouble* d2pxy_node_c = &(*d2pxy_node)[c];
       d2Lic = 0;
       for (size_t x = 0; x < nbStates_; x++)
       {
-        Vdouble* d2pxy_node_c_x = &(*d2pxy_node_c)[x];
+        const Vdouble* d2pxy_node_c_x = &(*d2pxy_node_c)[x];
         d2Licx = 0;
         for (size_t y = 0; y < nbStates_; y++)
         {
@@ -455,11 +831,38 @@ double DRHomogeneousTreeLikelihood::getSecondOrderDerivative(const std::string&
 
 /******************************************************************************/
 
+void DRHomogeneousTreeLikelihood::getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const
+{
+  d1.resize(nbNodes_);
+  d2.resize(nbNodes_);
+  const vector<unsigned int>* w = &likelihoodData_->getWeights();
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    int id = nodes_[k]->getId();
+    const Vdouble* dLikelihoods_branch = &getLikelihoodData()->getDLikelihoodArray(id);
+    const Vdouble* d2Likelihoods_branch = &getLikelihoodData()->getD2LikelihoodArray(id);
+    double d1k = 0, d2k = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      double dLi = (*dLikelihoods_branch)[i];
+      d1k += (*w)[i] * dLi;
+      d2k += (*w)[i] * ((*d2Likelihoods_branch)[i] - dLi * dLi);
+    }
+    d1[k] = -d1k;
+    d2[k] = -d2k;
+  }
+}
+
+/******************************************************************************/
+
 void DRHomogeneousTreeLikelihood::resetLikelihoodArrays(const Node* node)
 {
   for (size_t n = 0; n < node->getNumberOfSons(); n++)
   {
     const Node* subNode = node->getSon(n);
+    // No array is stored toward leaves:
+    if (subNode->isLeaf())
+      continue;
     resetLikelihoodArray(likelihoodData_->getLikelihoodArray(node->getId(), subNode->getId()));
   }
   if (node->hasFather())
@@ -473,8 +876,18 @@ void DRHomogeneousTreeLikelihood::resetLikelihoodArrays(const Node* node)
 
 void DRHomogeneousTreeLikelihood::computeTreeLikelihood()
 {
-  computeSubtreeLikelihoodPostfix(tree_->getRootNode());
-  computeSubtreeLikelihoodPrefix(tree_->getRootNode());
+  parameterDerivatives_.clear();
+  // The traversal orders are cached by the tree:
+  const vector<const Node*>& postorder = tree_->getPostorderNodes();
+  for (size_t i = 0; i < postorder.size(); i++)
+  {
+    computeNodeLikelihoodsPostfix_(postorder[i]);
+  }
+  const vector<const Node*>& preorder = tree_->getPreorderNodes();
+  for (size_t i = 0; i < preorder.size(); i++)
+  {
+    computeNodeLikelihoodsPrefix_(preorder[i]);
+  }
   computeRootLikelihood();
 }
 
@@ -482,8 +895,18 @@ void DRHomogeneousTreeLikelihood::computeTreeLikelihood()
 
 void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPostfix(const Node* node)
 {
-//  if(node->isLeaf()) return;
-// cout << node->getId() << "\t" << (node->hasName()?node->getName():"") << endl;
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPostorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    computeNodeLikelihoodsPostfix_(nodes[i]);
+  }
+}
+
+/******************************************************************************/
+
+void DRHomogeneousTreeLikelihood::computeNodeLikelihoodsPostfix_(const Node* node)
+{
   if (node->getNumberOfSons() == 0)
     return;
 
@@ -497,43 +920,37 @@ void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPostfix(const Node* no
     // For each son node...
 
     const Node* son = node->getSon(l);
-    VVVdouble* _likelihoods_node_son = &(*_likelihoods_node)[son->getId()];
 
-    if (son->isLeaf())
-    {
-      VVdouble* _likelihoods_leaf = &likelihoodData_->getLeafLikelihoods(son->getId());
-      for (size_t i = 0; i < nbDistinctSites_; i++)
-      {
-        // For each site in the sequence,
-        Vdouble* _likelihoods_leaf_i = &(*_likelihoods_leaf)[i];
-        VVdouble* _likelihoods_node_son_i = &(*_likelihoods_node_son)[i];
-        for (size_t c = 0; c < nbClasses_; c++)
-        {
-          // For each rate classe,
-          Vdouble* _likelihoods_node_son_i_c = &(*_likelihoods_node_son_i)[c];
-          for (size_t x = 0; x < nbStates_; x++)
-          {
-            // For each initial state,
-            (*_likelihoods_node_son_i_c)[x] = (*_likelihoods_leaf_i)[x];
-          }
-        }
-      }
-    }
-    else
+    // No array is stored toward leaves.
+    if (!son->isLeaf())
     {
-      computeSubtreeLikelihoodPostfix(son); // Recursive method:
+      VVVdouble* _likelihoods_node_son = &(*_likelihoods_node)[son->getId()];
       size_t nbSons = son->getNumberOfSons();
       map<int, VVVdouble>* _likelihoods_son = &likelihoodData_->getLikelihoodArrays(son->getId());
 
-      vector<const VVVdouble*> iLik(nbSons);
-      vector<const VVVdouble*> tProb(nbSons);
+      vector<const VVVdouble*> iLik;
+      vector<const VVVdouble*> tProb;
+      vector<const Node*> nodes;
+      vector<const Node*> leaves;
       for (size_t n = 0; n < nbSons; n++)
       {
         const Node* sonSon = son->getSon(n);
-        tProb[n] = &pxy_[sonSon->getId()];
-        iLik[n] = &(*_likelihoods_son)[sonSon->getId()];
+        if (sonSon->isLeaf())
+        {
+          leaves.push_back(sonSon);
+        }
+        else
+        {
+          tProb.push_back(&pxy_.at(sonSon->getId()).get());
+          iLik.push_back(&(*_likelihoods_son)[sonSon->getId()]);
+          nodes.push_back(sonSon);
+        }
       }
-      computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_son, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
+      if (getUniformizedModel_())
+        computeLikelihoodFromArraysByUniformization_(iLik, nodes, *_likelihoods_node_son);
+      else
+        computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_son, iLik.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
+      computeLikelihoodFromLeaves_(leaves, *_likelihoods_node_son);
     }
   }
 }
@@ -542,18 +959,20 @@ void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPostfix(const Node* no
 
 void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node* node)
 {
-  if (!node->hasFather())
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPreorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    // 'node' is the root of the tree.
-    // Just call the method on each son node:
-    size_t nbSons = node->getNumberOfSons();
-    for (size_t n = 0; n < nbSons; n++)
-    {
-      computeSubtreeLikelihoodPrefix(node->getSon(n));
-    }
-    return;
+    computeNodeLikelihoodsPrefix_(nodes[i]);
   }
-  else
+}
+
+/******************************************************************************/
+
+void DRHomogeneousTreeLikelihood::computeNodeLikelihoodsPrefix_(const Node* node)
+{
+  // Nothing to do for the root of the tree:
+  if (node->hasFather())
   {
     const Node* father = node->getFather();
     map<int, VVVdouble>* _likelihoods_node = &likelihoodData_->getLikelihoodArrays(node->getId());
@@ -567,11 +986,12 @@ void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node* nod
     if (father->isLeaf())
     {
       // If the tree is rooted by a leaf
-      VVdouble* _likelihoods_leaf = &likelihoodData_->getLeafLikelihoods(father->getId());
+      vector<const Vdouble*> _likelihoods_leaf;
+      likelihoodData_->getLeafLikelihoods(father->getId(), _likelihoods_leaf);
       for (size_t i = 0; i < nbDistinctSites_; i++)
       {
         // For each site in the sequence,
-        Vdouble* _likelihoods_leaf_i = &(*_likelihoods_leaf)[i];
+        const Vdouble* _likelihoods_leaf_i = _likelihoods_leaf[i];
         VVdouble* _likelihoods_node_father_i = &(*_likelihoods_node_father)[i];
         for (size_t c = 0; c < nbClasses_; c++)
         {
@@ -588,38 +1008,54 @@ void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node* nod
     else
     {
       vector<const Node*> nodes;
+      vector<const Node*> leaves;
       // Add brothers:
       size_t nbFatherSons = father->getNumberOfSons();
       for (size_t n = 0; n < nbFatherSons; n++)
       {
         const Node* son = father->getSon(n);
         if (son->getId() != node->getId())
-          nodes.push_back(son);  // This is a real brother, not current node!
+        {
+          // This is a real brother, not current node!
+          if (son->isLeaf())
+            leaves.push_back(son);
+          else
+            nodes.push_back(son);
+        }
       }
       // Now the real stuff... We've got to compute the likelihoods for the
       // subtree defined by node 'father'.
       // This is the same as postfix method, but with different subnodes.
 
-      size_t nbSons = nodes.size(); // In case of a bifurcating tree, this is equal to 1, excepted for the root.
+      size_t nbSons = nodes.size(); // In case of a bifurcating tree, this is equal to 1 (or 0 if the brother is a leaf), excepted for the root.
 
       vector<const VVVdouble*> iLik(nbSons);
       vector<const VVVdouble*> tProb(nbSons);
       for (size_t n = 0; n < nbSons; n++)
       {
         const Node* fatherSon = nodes[n];
-        tProb[n] = &pxy_[fatherSon->getId()];
+        tProb[n] = &pxy_.at(fatherSon->getId()).get();
         iLik[n] = &(*_likelihoods_father)[fatherSon->getId()];
       }
 
+      if (getUniformizedModel_())
+      {
+        computeLikelihoodFromArraysByUniformization_(iLik, nodes, *_likelihoods_node_father);
+        // The branch toward the root is traversed backward, with the transposed matrix:
+        iLik.clear();
+        tProb.clear();
+        nbSons = 0;
+      }
       if (father->hasFather())
       {
         const Node* fatherFather = father->getFather();
-        computeLikelihoodFromArrays(iLik, tProb, &(*_likelihoods_father)[fatherFather->getId()], &pxy_[father->getId()], *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
+        computeLikelihoodFromArrays(iLik, tProb, &(*_likelihoods_father)[fatherFather->getId()], &pxy_.at(father->getId()).get(), *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
       }
       else
       {
         computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
       }
+      computeLikelihoodFromLeaves_(leaves, *_likelihoods_node_father);
     }
 
     if (!father->hasFather())
@@ -638,13 +1074,6 @@ void DRHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node* nod
         }
       }
     }
-
-    // Call the method on each son node:
-    size_t nbNodeSons = node->getNumberOfSons();
-    for (size_t i = 0; i < nbNodeSons; i++)
-    {
-      computeSubtreeLikelihoodPrefix(node->getSon(i)); // Recursive method.
-    }
   }
 }
 
@@ -657,11 +1086,12 @@ void DRHomogeneousTreeLikelihood::computeRootLikelihood()
   // Set all likelihoods to 1 for a start:
   if (root->isLeaf())
   {
-    VVdouble* leavesLikelihoods_root = &likelihoodData_->getLeafLikelihoods(root->getId());
+    vector<const Vdouble*> leavesLikelihoods_root;
+    likelihoodData_->getLeafLikelihoods(root->getId(), leavesLikelihoods_root);
     for (size_t i = 0; i < nbDistinctSites_; i++)
     {
       VVdouble* rootLikelihoods_i = &(*rootLikelihoods)[i];
-      Vdouble* leavesLikelihoods_root_i = &(*leavesLikelihoods_root)[i];
+      const Vdouble* leavesLikelihoods_root_i = leavesLikelihoods_root[i];
       for (size_t c = 0; c < nbClasses_; c++)
       {
         Vdouble* rootLikelihoods_i_c = &(*rootLikelihoods_i)[c];
@@ -679,15 +1109,29 @@ void DRHomogeneousTreeLikelihood::computeRootLikelihood()
 
   map<int, VVVdouble>* likelihoods_root = &likelihoodData_->getLikelihoodArrays(root->getId());
   size_t nbNodes = root->getNumberOfSons();
-  vector<const VVVdouble*> iLik(nbNodes);
-  vector<const VVVdouble*> tProb(nbNodes);
+  vector<const VVVdouble*> iLik;
+  vector<const VVVdouble*> tProb;
+  vector<const Node*> nodes;
+  vector<const Node*> leaves;
   for (size_t n = 0; n < nbNodes; n++)
   {
     const Node* son = root->getSon(n);
-    tProb[n] = &pxy_[son->getId()];
-    iLik[n] = &(*likelihoods_root)[son->getId()];
+    if (son->isLeaf())
+    {
+      leaves.push_back(son);
+    }
+    else
+    {
+      tProb.push_back(&pxy_.at(son->getId()).get());
+      iLik.push_back(&(*likelihoods_root)[son->getId()]);
+      nodes.push_back(son);
+    }
   }
-  computeLikelihoodFromArrays(iLik, tProb, *rootLikelihoods, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
+  if (getUniformizedModel_())
+    computeLikelihoodFromArraysByUniformization_(iLik, nodes, *rootLikelihoods);
+  else
+    computeLikelihoodFromArrays(iLik, tProb, *rootLikelihoods, iLik.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
+  computeLikelihoodFromLeaves_(leaves, *rootLikelihoods);
 
   Vdouble p = rateDistribution_->getProbabilities();
   VVdouble* rootLikelihoodsS  = &likelihoodData_->getRootSiteLikelihoodArray();
@@ -725,16 +1169,17 @@ void DRHomogeneousTreeLikelihood::computeLikelihoodAtNode_(const Node* node, VVV
   // const Node * node = tree_->getNode(nodeId);
   int nodeId = node->getId();
   likelihoodArray.resize(nbDistinctSites_);
-  map<int, VVVdouble>* likelihoods_node = &likelihoodData_->getLikelihoodArrays(nodeId);
+  const map<int, VVVdouble>* likelihoods_node = &getLikelihoodData()->getLikelihoodArrays(nodeId);
 
   // Initialize likelihood array:
   if (node->isLeaf())
   {
-    VVdouble* leavesLikelihoods_node = &likelihoodData_->getLeafLikelihoods(nodeId);
+    vector<const Vdouble*> leavesLikelihoods_node;
+    getLikelihoodData()->getLeafLikelihoods(nodeId, leavesLikelihoods_node);
     for (size_t i = 0; i < nbDistinctSites_; i++)
     {
       VVdouble* likelihoodArray_i = &likelihoodArray[i];
-      Vdouble* leavesLikelihoods_node_i = &(*leavesLikelihoods_node)[i];
+      const Vdouble* leavesLikelihoods_node_i = leavesLikelihoods_node[i];
       likelihoodArray_i->resize(nbClasses_);
       for (size_t c = 0; c < nbClasses_; c++)
       {
@@ -771,28 +1216,29 @@ void DRHomogeneousTreeLikelihood::computeLikelihoodAtNode_(const Node* node, VVV
 
   vector<const VVVdouble*> iLik;
   vector<const VVVdouble*> tProb;
+  vector<const Node*> leaves;
   bool test = false;
   for (size_t n = 0; n < nbNodes; n++)
   {
     const Node* son = node->getSon(n);
-    if (son != sonNode) {
-      tProb.push_back(&pxy_[son->getId()]);
-      iLik.push_back(&(*likelihoods_node)[son->getId()]);
-    } else {
+    if (son == sonNode) {
       test = true;
+    } else if (son->isLeaf()) {
+      leaves.push_back(son);
+    } else {
+      tProb.push_back(&pxy_.at(son->getId()).get());
+      iLik.push_back(&likelihoods_node->at(son->getId()));
     }
   }
-  if (sonNode) {
-    if (test)
-      nbNodes--;
-    else
-      throw Exception("DRHomogeneousTreeLikelihood::computeLikelihoodAtNode_(...). 'sonNode' not found as a son of 'node'.");
-  }
+  if (sonNode && !test)
+    throw Exception("DRHomogeneousTreeLikelihood::computeLikelihoodAtNode_(...). 'sonNode' not found as a son of 'node'.");
+  nbNodes = iLik.size();
+  computeLikelihoodFromLeaves_(leaves, likelihoodArray);
 
   if (node->hasFather())
   {
     const Node* father = node->getFather();
-    computeLikelihoodFromArrays(iLik, tProb, &(*likelihoods_node)[father->getId()], &pxy_[nodeId], likelihoodArray, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
+    computeLikelihoodFromArrays(iLik, tProb, &likelihoods_node->at(father->getId()), &pxy_.at(nodeId).get(), likelihoodArray, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
   }
   else
   {
@@ -947,12 +1393,142 @@ void DRHomogeneousTreeLikelihood::computeLikelihoodFromArrays(
 
 /******************************************************************************/
 
+void DRHomogeneousTreeLikelihood::computeLikelihoodFromLeaves_(const vector<const Node*>& leaves, VVVdouble& oLik) const
+{
+  if (leaves.size() == 0)
+    return;
+  if (!getLikelihoodData()->hasLeafStateCodes())
+  {
+    // Leaves are stored as [site][state] arrays:
+    vector<const Vdouble*> leafLikelihoods;
+    for (size_t l = 0; l < leaves.size(); l++)
+    {
+      int leafId = leaves[l]->getId();
+      const VVVdouble* pxy_leaf = &pxy_.at(leafId).get();
+      getLikelihoodData()->getLeafLikelihoods(leafId, leafLikelihoods);
+      for (size_t i = 0; i < nbDistinctSites_; i++)
+      {
+        const Vdouble* leafLikelihoods_i = leafLikelihoods[i];
+        VVdouble* oLik_i = &oLik[i];
+        for (size_t c = 0; c < nbClasses_; c++)
+        {
+          const VVdouble* pxy_leaf_c = &(*pxy_leaf)[c];
+          Vdouble* oLik_i_c = &(*oLik_i)[c];
+          for (size_t x = 0; x < nbStates_; x++)
+          {
+            const Vdouble* pxy_leaf_c_x = &(*pxy_leaf_c)[x];
+            double likelihood = 0;
+            for (size_t y = 0; y < nbStates_; y++)
+            {
+              likelihood += (*pxy_leaf_c_x)[y] * (*leafLikelihoods_i)[y];
+            }
+            (*oLik_i_c)[x] *= likelihood;
+          }
+        }
+      }
+    }
+    return;
+  }
+  const VVdouble* codeLikelihoods = &getLikelihoodData()->getLeafCodeLikelihoods();
+  size_t nbCodes = codeLikelihoods->size();
+
+  // Conditional likelihood of each state code, for each rate class and each initial state:
+  Vdouble codeCondLikelihoods(nbClasses_ * nbCodes * nbStates_);
+  for (size_t l = 0; l < leaves.size(); l++)
+  {
+    int leafId = leaves[l]->getId();
+    const VVVdouble* pxy_leaf = &pxy_.at(leafId).get();
+    for (size_t c = 0; c < nbClasses_; c++)
+    {
+      const VVdouble* pxy_leaf_c = &(*pxy_leaf)[c];
+      for (size_t k = 0; k < nbCodes; k++)
+      {
+        const Vdouble* codeLikelihoods_k = &(*codeLikelihoods)[k];
+        double* codeCondLikelihoods_c_k = &codeCondLikelihoods[(c * nbCodes + k) * nbStates_];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          const Vdouble* pxy_leaf_c_x = &(*pxy_leaf_c)[x];
+          double likelihood = 0;
+          for (size_t y = 0; y < nbStates_; y++)
+          {
+            likelihood += (*pxy_leaf_c_x)[y] * (*codeLikelihoods_k)[y];
+          }
+          codeCondLikelihoods_c_k[x] = likelihood;
+        }
+      }
+    }
+
+    // Now each site only requires a lookup:
+    const vector<unsigned char>* codes = &getLikelihoodData()->getLeafStateCodes(leafId);
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      size_t k = (*codes)[i];
+      VVdouble* oLik_i = &oLik[i];
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        const double* codeCondLikelihoods_c_k = &codeCondLikelihoods[(c * nbCodes + k) * nbStates_];
+        Vdouble* oLik_i_c = &(*oLik_i)[c];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          (*oLik_i_c)[x] *= codeCondLikelihoods_c_k[x];
+        }
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+void DRHomogeneousTreeLikelihood::computeLikelihoodFromArraysByUniformization_(const vector<const VVVdouble*>& iLik, const vector<const Node*>& nodes, VVVdouble& oLik) const
+{
+  const AbstractSubstitutionModel* model = getUniformizedModel_();
+  VVdouble v(nbDistinctSites_);
+  VVdouble pv;
+  for (size_t n = 0; n < nodes.size(); n++)
+  {
+    const VVVdouble* iLik_n = iLik[n];
+    double l = nodes[n]->getDistanceToFather();
+    for (size_t c = 0; c < nbClasses_; c++)
+    {
+      // All sites are multiplied at once, for each rate class:
+      for (size_t i = 0; i < nbDistinctSites_; i++)
+      {
+        v[i] = (*iLik_n)[i][c];
+      }
+      model->multiplyPij_t(l * rateDistribution_->getCategory(c), v, pv);
+      for (size_t i = 0; i < nbDistinctSites_; i++)
+      {
+        Vdouble* oLik_i_c = &oLik[i][c];
+        const Vdouble* pv_i = &pv[i];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          (*oLik_i_c)[x] *= (*pv_i)[x];
+        }
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+const AbstractSubstitutionModel* DRHomogeneousTreeLikelihood::getUniformizedModel_() const
+{
+  const AbstractSubstitutionModel* model = dynamic_cast<const AbstractSubstitutionModel*>(model_);
+  if (model && model->enableUniformization())
+    return model;
+  return 0;
+}
+
+/******************************************************************************/
+
 void DRHomogeneousTreeLikelihood::displayLikelihood(const Node* node)
 {
   cout << "Likelihoods at node " << node->getId() << ": " << endl;
   for (size_t n = 0; n < node->getNumberOfSons(); n++)
   {
     const Node* subNode = node->getSon(n);
+    if (subNode->isLeaf())
+      continue; // No array is stored toward leaves.
     cout << "Array for sub-node " << subNode->getId() << endl;
     displayLikelihoodArray(likelihoodData_->getLikelihoodArray(node->getId(), subNode->getId()));
   }
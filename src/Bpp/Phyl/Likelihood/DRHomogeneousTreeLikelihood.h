@@ -43,6 +43,8 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "AbstractHomogeneousTreeLikelihood.h"
 #include "DRTreeLikelihood.h"
 #include "DRASDRTreeLikelihoodData.h"
+#include "ValueAndGradientFunction.h"
+#include "../Model/AbstractSubstitutionModel.h"
 
 #include <Bpp/Numeric/VectorTools.h>
 #include <Bpp/Numeric/Prob/DiscreteDistribution.h>
@@ -64,13 +66,22 @@ namespace bpp
 class DRHomogeneousTreeLikelihood:
   public virtual Clonable,
   public AbstractHomogeneousTreeLikelihood,
-  public DRTreeLikelihood
+  public DRTreeLikelihood,
+  public virtual ValueAndGradientFunction
 {
   private:
     mutable DRASDRTreeLikelihoodData* likelihoodData_;
 
   protected:
     double minusLogLik_;
+
+    /**
+     * @brief Derivatives of the likelihood function computed so far, by parameter name.
+     *
+     * Only requested derivatives are computed (see computeParameterDerivatives_()).
+     * They are reset when the likelihood is recomputed.
+     */
+    mutable std::map<std::string, double> parameterDerivatives_;
     
   public:
     /**
@@ -177,6 +188,27 @@ class DRHomogeneousTreeLikelihood:
      * @param parameters The parameter list to pass to the function.
      */
     void setParameters(const ParameterList & parameters);
+
+    /**
+     * @return Branch lengths, substitution model and rate distribution parameters.
+     */
+    ParameterList getFirstOrderDerivableParameters() const;
+
+    /**
+     * @brief Set parameters, and compute the function and its gradient at once.
+     *
+     * The likelihood is computed with a single tree traversal, and the requested derivatives
+     * are then obtained in one pass over branches, from the arrays of this traversal
+     * (see computeParameterDerivatives_()).
+     * Derivative arrays need not be enabled, and should not be, as they cost an additional traversal.
+     * The likelihood is not computed again if the parameters already have the given values.
+     *
+     * @param parameters The parameters to set. They must all be first order derivable.
+     * @param gradient   [out] The derivatives with respect to each parameter, in the same order.
+     * @return The value of the function.
+     * @throw Exception If a parameter is not first order derivable.
+     */
+    double getValueAndGradient(const ParameterList& parameters, Vdouble& gradient);
     
     /**
      * @brief Function and NNISearchable interface.
@@ -191,6 +223,30 @@ class DRHomogeneousTreeLikelihood:
     double getFirstOrderDerivative(const std::string& variable) const;
     /** @{ */
 
+  protected:
+    /**
+     * @brief Compute the derivatives with respect to some branch lengths, substitution model
+     * and rate distribution parameters, and store them in parameterDerivatives_.
+     *
+     * For each branch, the two likelihood arrays on each side of the branch, as left by
+     * the last traversal, are combined with the derivatives of transition probabilities
+     * with respect to time, and with respect to each model parameter, as provided by
+     * NumericalModelParameterDerivative. Only the branches whose length is requested are visited,
+     * unless substitution model or rate distribution parameters are requested.
+     * The contribution of the equilibrium frequencies at the root is added.
+     * Rate distribution parameters act through the rates of each class, which scale all
+     * branch lengths, and through the probabilities of each class. Derivatives of rates and
+     * probabilities are taken by finite differences on the distribution alone.
+     * As all branches are then visited, all rate distribution parameters and branch lengths
+     * derivatives are stored as well. No additional tree traversal is performed.
+     *
+     * @param parameters The parameters to derive with respect to. Parameters which are not
+     * first order derivable are ignored.
+     */
+    void computeParameterDerivatives_(const ParameterList& parameters) const;
+
+  public:
+
     /**
      * @name DerivableSecondOrder interface.
      *
@@ -199,16 +255,53 @@ class DRHomogeneousTreeLikelihood:
     double getSecondOrderDerivative(const std::string& variable) const;
     double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const { return 0; } // Not implemented for now.
     /** @} */
+
+    /**
+     * @brief Get the derivatives with respect to all branch lengths at once.
+     *
+     * @see DRTreeLikelihood::getBranchLengthsDerivatives()
+     */
+    void getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const;
     
   public:  // Specific methods:
 
     DRASDRTreeLikelihoodData* getLikelihoodData() { return likelihoodData_; }
     const DRASDRTreeLikelihoodData* getLikelihoodData() const { return likelihoodData_; }
+
+    /**
+     * @brief Change the number of sites with each pattern, and update the likelihood.
+     *
+     * Likelihood arrays do not depend on the weights, and are not recomputed.
+     * This is used to evaluate bootstrap replicates without building new likelihood objects.
+     *
+     * @param weights The new weights, one per distinct site (see getSiteIndex()).
+     * @throw Exception If the object is not initialized, or if the number of weights is wrong.
+     */
+    virtual void setPatternWeights(const std::vector<unsigned int>& weights);
   
     virtual void computeLikelihoodAtNode(int nodeId, VVVdouble& likelihoodArray) const
     {
       computeLikelihoodAtNode_(tree_->getNode(nodeId), likelihoodArray);
     }
+
+    /**
+     * @brief Optimize the length of a single branch, all other parameters being fixed.
+     *
+     * The likelihood is a function of the branch length through the two conditional likelihood
+     * arrays on each side of the branch only, which are computed once. Newton-Raphson iterations
+     * are then performed on this one-dimensional function, with the Felsenstein and Churchill (1996)
+     * correction when a move does not improve the likelihood.
+     *
+     * The object is not modified, and the new length is not applied. Provided that a distinct
+     * model instance is passed to each call, the method can be called concurrently for several branches.
+     *
+     * @param brI           The index of the branch, as in the parameter name "BrLen<brI>".
+     * @param model         A copy of the substitution model of this instance, used to compute transition probabilities.
+     * @param tolerance     The tolerance on the log-likelihood used to stop iterations.
+     * @param maxCorrection The maximum number of times a move is halved.
+     * @return The optimized branch length.
+     */
+    double optimizeBranchLength(size_t brI, const TransitionModel& model, double tolerance, unsigned int maxCorrection = 10) const;
       
   protected:
     virtual void computeLikelihoodAtNode_(const Node* node, VVVdouble& likelihoodArray, const Node* sonNode = 0) const;
@@ -217,13 +310,27 @@ class DRHomogeneousTreeLikelihood:
      * Initialize the arrays corresponding to each son node for the node passed as argument.
      * The method is called for each son node and the result stored in the corresponding array.
      */
-    virtual void computeSubtreeLikelihoodPostfix(const Node* node); //Recursive method.
+    virtual void computeSubtreeLikelihoodPostfix(const Node* node);
     /**
      * This method initilize the remaining likelihood arrays, corresponding to father nodes.
      * It must be called after the postfix method because it requires that the arrays for
      * son nodes to be be computed.
      */
-    virtual void computeSubtreeLikelihoodPrefix(const Node* node); //Recursive method.
+    virtual void computeSubtreeLikelihoodPrefix(const Node* node);
+
+    /**
+     * @brief Compute the arrays of a node toward its sons, from the arrays of its sons.
+     *
+     * Subtrees are traversed in postorder with this method, without recursion.
+     */
+    void computeNodeLikelihoodsPostfix_(const Node* node);
+
+    /**
+     * @brief Compute the array of a node toward its father, from the arrays of its father.
+     *
+     * Subtrees are traversed in preorder with this method, without recursion.
+     */
+    void computeNodeLikelihoodsPrefix_(const Node* node);
 
     virtual void computeRootLikelihood();
 
@@ -302,6 +409,39 @@ class DRHomogeneousTreeLikelihood:
         size_t nbStates,
         bool reset = true);
 
+    /**
+     * @brief Multiply conditional likelihoods by the contribution of leaf neighbors.
+     *
+     * No likelihood array is stored toward leaves. When leaves are stored as compact state codes
+     * (see DRASDRTreeLikelihoodData::getLeafStateCodes()), the product of the transition matrix by
+     * the likelihood vector of each code is computed once for each leaf, and then looked up at each site.
+     * For a non-ambiguous state, this is a column of the transition matrix, so that no matrix-vector
+     * product is performed per site. Otherwise, the likelihood vector of the leaf is read at each site.
+     *
+     * @param leaves The leaves to account for.
+     * @param oLik   The likelihood array to update.
+     */
+    void computeLikelihoodFromLeaves_(const std::vector<const Node*>& leaves, VVVdouble& oLik) const;
+
+    /**
+     * @brief Multiply conditional likelihoods by the product of the transition probabilities
+     * of several branches with the arrays of their nodes.
+     *
+     * This is the same as computeLikelihoodFromArrays() with no reset, but the products are
+     * computed by AbstractSubstitutionModel::multiplyPij_t(), which does not use the transition
+     * matrices when the model computes them by uniformization.
+     *
+     * @param iLik  The likelihood arrays, one for each branch.
+     * @param nodes The nodes below each branch.
+     * @param oLik  The likelihood array to update.
+     */
+    void computeLikelihoodFromArraysByUniformization_(const std::vector<const VVVdouble*>& iLik, const std::vector<const Node*>& nodes, VVVdouble& oLik) const;
+
+    /**
+     * @return The model, if it computes transition probabilities by uniformization, or 0.
+     */
+    const AbstractSubstitutionModel* getUniformizedModel_() const;
+
   friend class DRHomogeneousMixedTreeLikelihood;
 };
 
@@ -52,6 +52,7 @@ using namespace bpp;
 
 // From the STL:
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -65,7 +66,16 @@ DRNonHomogeneousTreeLikelihood::DRNonHomogeneousTreeLikelihood(
   bool reparametrizeRoot) :
   AbstractNonHomogeneousTreeLikelihood(tree, modelSet, rDist, verbose, reparametrizeRoot),
   likelihoodData_(0),
-  minusLogLik_(-1.)
+  minusLogLik_(-1.),
+  nodeIndex_(),
+  minNodeId_(0),
+  fatherIndex_(),
+  postOrder_(),
+  modelBranches_(),
+  parameterModels_(),
+  subtreeUpToDate_(),
+  upperUpToDate_(),
+  allUpperUpToDate_(true)
 {
   if (!modelSet->isFullySetUpFor(tree))
     throw Exception("DRNonHomogeneousTreeLikelihood(constructor). Model set is not fully specified.");
@@ -83,7 +93,16 @@ DRNonHomogeneousTreeLikelihood::DRNonHomogeneousTreeLikelihood(
   bool reparametrizeRoot) :
   AbstractNonHomogeneousTreeLikelihood(tree, modelSet, rDist, verbose, reparametrizeRoot),
   likelihoodData_(0),
-  minusLogLik_(-1.)
+  minusLogLik_(-1.),
+  nodeIndex_(),
+  minNodeId_(0),
+  fatherIndex_(),
+  postOrder_(),
+  modelBranches_(),
+  parameterModels_(),
+  subtreeUpToDate_(),
+  upperUpToDate_(),
+  allUpperUpToDate_(true)
 {
   if (!modelSet->isFullySetUpFor(tree))
     throw Exception("DRNonHomogeneousTreeLikelihood(constructor). Model set is not fully specified.");
@@ -105,7 +124,16 @@ void DRNonHomogeneousTreeLikelihood::init_()
 DRNonHomogeneousTreeLikelihood::DRNonHomogeneousTreeLikelihood(const DRNonHomogeneousTreeLikelihood& lik) :
   AbstractNonHomogeneousTreeLikelihood(lik),
   likelihoodData_(0),
-  minusLogLik_(lik.minusLogLik_)
+  minusLogLik_(lik.minusLogLik_),
+  nodeIndex_(lik.nodeIndex_),
+  minNodeId_(lik.minNodeId_),
+  fatherIndex_(lik.fatherIndex_),
+  postOrder_(lik.postOrder_),
+  modelBranches_(lik.modelBranches_),
+  parameterModels_(lik.parameterModels_),
+  subtreeUpToDate_(lik.subtreeUpToDate_),
+  upperUpToDate_(lik.upperUpToDate_),
+  allUpperUpToDate_(lik.allUpperUpToDate_)
 {
   likelihoodData_ = dynamic_cast<DRASDRTreeLikelihoodData*>(lik.likelihoodData_->clone());
   likelihoodData_->setTree(tree_);
@@ -121,6 +149,15 @@ DRNonHomogeneousTreeLikelihood& DRNonHomogeneousTreeLikelihood::operator=(const
   likelihoodData_ = dynamic_cast<DRASDRTreeLikelihoodData*>(lik.likelihoodData_->clone());
   likelihoodData_->setTree(tree_);
   minusLogLik_ = lik.minusLogLik_;
+  nodeIndex_ = lik.nodeIndex_;
+  minNodeId_ = lik.minNodeId_;
+  fatherIndex_ = lik.fatherIndex_;
+  postOrder_ = lik.postOrder_;
+  modelBranches_ = lik.modelBranches_;
+  parameterModels_ = lik.parameterModels_;
+  subtreeUpToDate_ = lik.subtreeUpToDate_;
+  upperUpToDate_ = lik.upperUpToDate_;
+  allUpperUpToDate_ = lik.allUpperUpToDate_;
   return *this;
 }
 
@@ -133,6 +170,23 @@ DRNonHomogeneousTreeLikelihood::~DRNonHomogeneousTreeLikelihood()
 
 /******************************************************************************/
 
+void DRNonHomogeneousTreeLikelihood::initialize()
+{
+  // Dependency tables will be built on the first call to fireParameterChanged:
+  nodeIndex_.clear();
+  AbstractNonHomogeneousTreeLikelihood::initialize();
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::setSubstitutionModelSet(SubstitutionModelSet* modelSet)
+{
+  nodeIndex_.clear();
+  AbstractNonHomogeneousTreeLikelihood::setSubstitutionModelSet(modelSet);
+}
+
+/******************************************************************************/
+
 void DRNonHomogeneousTreeLikelihood::setData(const SiteContainer& sites)
 {
   if (data_)
@@ -243,50 +297,66 @@ void DRNonHomogeneousTreeLikelihood::fireParameterChanged(const ParameterList& p
 {
   applyParameters();
 
-  if (params.getCommonParametersWith(rateDistribution_->getIndependentParameters()).size() > 0)
+  if (nodeIndex_.empty())
   {
+    initDependencies_();
     computeAllTransitionProbabilities();
   }
+  else if (params.getCommonParametersWith(rateDistribution_->getIndependentParameters()).size() > 0)
+  {
+    computeAllTransitionProbabilities();
+    invalidateLikelihoodArrays_(vector<bool>(nbNodes_, true), true);
+  }
   else
   {
-    vector<int> ids;
-    vector<string> tmp = params.getCommonParametersWith(modelSet_->getNodeParameters()).getParameterNames();
-    for (size_t i = 0; i < tmp.size(); i++)
-    {
-      vector<int> tmpv = modelSet_->getNodesWithParameter(tmp[i]);
-      ids = VectorTools::vectorUnion(ids, tmpv);
-    }
-    tmp = params.getCommonParametersWith(brLenParameters_).getParameterNames();
-    vector<const Node*> nodes;
-    for (size_t i = 0; i < ids.size(); i++)
-    {
-      nodes.push_back(idToNode_[ids[i]]);
-    }
-    vector<const Node*> tmpv;
-    bool test = false;
-    for (size_t i = 0; i < tmp.size(); i++)
+    vector<bool> changed(nbNodes_, false);
+    bool rootFrequenciesChanged = false;
+    for (size_t i = 0; i < params.size(); i++)
     {
-      if (tmp[i] == "BrLenRoot" || tmp[i] == "RootPosition")
+      const string& name = params[i].getName();
+      if (name == "BrLenRoot" || name == "RootPosition")
+      {
+        changed[getNodeIndex_(root1_)] = true;
+        changed[getNodeIndex_(root2_)] = true;
+      }
+      else if (name.compare(0, 5, "BrLen") == 0)
+      {
+        changed[TextTools::to<size_t>(name.substr(5))] = true;
+      }
+      else
       {
-        if (!test)
+        map<string, vector<size_t> >::const_iterator it = parameterModels_.find(name);
+        if (it != parameterModels_.end())
+        {
+          for (size_t j = 0; j < it->second.size(); j++)
+          {
+            const vector<size_t>& branches = modelBranches_[it->second[j]];
+            for (size_t k = 0; k < branches.size(); k++)
+            {
+              changed[branches[k]] = true;
+            }
+          }
+        }
+        else if (modelSet_->hasParameter(name))
         {
-          tmpv.push_back(tree_->getRootNode()->getSon(0));
-          tmpv.push_back(tree_->getRootNode()->getSon(1));
-          test = true; // Add only once.
+          // Not attached to nodes:
+          rootFrequenciesChanged = true;
         }
       }
-      else
-        tmpv.push_back(nodes_[TextTools::to < size_t > (tmp[i].substr(5))]);
     }
-    nodes = VectorTools::vectorUnion(nodes, tmpv);
-
-    for (size_t i = 0; i < nodes.size(); i++)
+    for (size_t k = 0; k < nbNodes_; k++)
     {
-      computeTransitionProbabilitiesForNode(nodes[i]);
+      if (changed[k])
+        computeTransitionProbabilitiesForNode(nodes_[k]);
     }
     rootFreqs_ = modelSet_->getRootFrequencies();
+    invalidateLikelihoodArrays_(changed, rootFrequenciesChanged);
   }
-  computeTreeLikelihood();
+
+  computeSubtreeLikelihoodPostfix(tree_->getRootNode());
+  computeRootLikelihood();
+  // Only the invalidated arrays are recomputed:
+  updateUpperLikelihoods_();
   if (computeFirstOrderDerivatives_)
   {
     computeTreeDLikelihoods();
@@ -312,7 +382,13 @@ double DRNonHomogeneousTreeLikelihood::getValue() const
 void DRNonHomogeneousTreeLikelihood::computeTreeDLikelihoodAtNode(const Node* node)
 {
   const Node* father = node->getFather();
-  VVVdouble* _likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
+  // Nothing is stored toward a leaf, its likelihoods are the same for all rate classes:
+  const VVVdouble* _likelihoods_father_node = 0;
+  vector<const Vdouble*> leafLikelihoods;
+  if (node->isLeaf())
+    likelihoodData_->getLeafLikelihoods(node->getId(), leafLikelihoods);
+  else
+    _likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
   Vdouble* _dLikelihoods_node = &likelihoodData_->getDLikelihoodArray(node->getId());
   VVVdouble*  pxy__node = &pxy_[node->getId()];
   VVVdouble* dpxy__node = &dpxy_[node->getId()];
@@ -323,12 +399,11 @@ void DRNonHomogeneousTreeLikelihood::computeTreeDLikelihoodAtNode(const Node* no
   double dLi, dLic, dLicx, numerator, denominator;
   for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    VVdouble* _likelihoods_father_node_i = &(*_likelihoods_father_node)[i];
     VVdouble* larray_i = &larray[i];
     dLi = 0;
     for (size_t c = 0; c < nbClasses_; c++)
     {
-      Vdouble* _likelihoods_father_node_i_c = &(*_likelihoods_father_node_i)[c];
+      const Vdouble* _likelihoods_father_node_i_c = _likelihoods_father_node ? &(*_likelihoods_father_node)[i][c] : leafLikelihoods[i];
       Vdouble* larray_i_c = &(*larray_i)[c];
       VVdouble*  pxy__node_c = &(*pxy__node)[c];
       VVdouble* dpxy__node_c = &(*dpxy__node)[c];
@@ -439,7 +514,13 @@ double DRNonHomogeneousTreeLikelihood::getFirstOrderDerivative(const string& var
 void DRNonHomogeneousTreeLikelihood::computeTreeD2LikelihoodAtNode(const Node* node)
 {
   const Node* father = node->getFather();
-  VVVdouble* _likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
+  // Nothing is stored toward a leaf, its likelihoods are the same for all rate classes:
+  const VVVdouble* _likelihoods_father_node = 0;
+  vector<const Vdouble*> leafLikelihoods;
+  if (node->isLeaf())
+    likelihoodData_->getLeafLikelihoods(node->getId(), leafLikelihoods);
+  else
+    _likelihoods_father_node = &likelihoodData_->getLikelihoodArray(father->getId(), node->getId());
   Vdouble* _d2Likelihoods_node = &likelihoodData_->getD2LikelihoodArray(node->getId());
   VVVdouble*   pxy__node = &pxy_[node->getId()];
   VVVdouble* d2pxy__node = &d2pxy_[node->getId()];
@@ -451,12 +532,11 @@ void DRNonHomogeneousTreeLikelihood::computeTreeD2LikelihoodAtNode(const Node* n
 
   for (size_t i = 0; i < nbDistinctSites_; i++)
   {
-    VVdouble* _likelihoods_father_node_i = &(*_likelihoods_father_node)[i];
     VVdouble* larray_i = &larray[i];
     d2Li = 0;
     for (size_t c = 0; c < nbClasses_; c++)
     {
-      Vdouble* _likelihoods_father_node_i_c = &(*_likelihoods_father_node_i)[c];
+      const Vdouble* _likelihoods_father_node_i_c = _likelihoods_father_node ? &(*_likelihoods_father_node)[i][c] : leafLikelihoods[i];
       Vdouble* larray_i_c = &(*larray_i)[c];
       VVdouble*   pxy__node_c = &(*pxy__node)[c];
       VVdouble* d2pxy__node_c = &(*d2pxy__node)[c];
@@ -550,8 +630,18 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
 
       if (son->getId() == root1_)
       {
-        VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(father->getId(), root1_);
-        VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(father->getId(), root2_);
+        // Nothing is stored toward leaves, their likelihoods are the same for all rate classes:
+        const VVVdouble* _likelihoodsroot1_ = 0;
+        const VVVdouble* _likelihoodsroot2_ = 0;
+        vector<const Vdouble*> leafLikelihoodsroot1, leafLikelihoodsroot2;
+        if (tree_->isLeaf(root1_))
+          likelihoodData_->getLeafLikelihoods(root1_, leafLikelihoodsroot1);
+        else
+          _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(father->getId(), root1_);
+        if (tree_->isLeaf(root2_))
+          likelihoodData_->getLeafLikelihoods(root2_, leafLikelihoodsroot2);
+        else
+          _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(father->getId(), root2_);
         double pos = getParameterValue("RootPosition");
 
         VVVdouble* d2pxy_root1_ = &d2pxy_[root1_];
@@ -562,14 +652,12 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
         VVVdouble* pxy_root2_   = &pxy_[root2_];
         for (size_t i = 0; i < nbDistinctSites_; i++)
         {
-          VVdouble* _likelihoodsroot1__i = &(*_likelihoodsroot1_)[i];
-          VVdouble* _likelihoodsroot2__i = &(*_likelihoodsroot2_)[i];
           VVdouble* dLikelihoods_father_i = &dLikelihoods_father[i];
           VVdouble* d2Likelihoods_father_i = &d2Likelihoods_father[i];
           for (size_t c = 0; c < nbClasses_; c++)
           {
-            Vdouble* _likelihoodsroot1__i_c = &(*_likelihoodsroot1__i)[c];
-            Vdouble* _likelihoodsroot2__i_c = &(*_likelihoodsroot2__i)[c];
+            const Vdouble* _likelihoodsroot1__i_c = _likelihoodsroot1_ ? &(*_likelihoodsroot1_)[i][c] : leafLikelihoodsroot1[i];
+            const Vdouble* _likelihoodsroot2__i_c = _likelihoodsroot2_ ? &(*_likelihoodsroot2_)[i][c] : leafLikelihoodsroot2[i];
             Vdouble* dLikelihoods_father_i_c = &(*dLikelihoods_father_i)[c];
             Vdouble* d2Likelihoods_father_i_c = &(*d2Likelihoods_father_i)[c];
             VVdouble* d2pxy_root1__c = &(*d2pxy_root1_)[c];
@@ -611,17 +699,21 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
       else
       {
         // Account for a putative multifurcation:
-        VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(father->getId(), son->getId());
+        const VVVdouble* _likelihoods_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (son->isLeaf())
+          likelihoodData_->getLeafLikelihoods(son->getId(), leafLikelihoods);
+        else
+          _likelihoods_son = &likelihoodData_->getLikelihoodArray(father->getId(), son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
         for (size_t i = 0; i < nbDistinctSites_; i++)
         {
-          VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[i];
           VVdouble* dLikelihoods_father_i = &dLikelihoods_father[i];
           VVdouble* d2Likelihoods_father_i = &d2Likelihoods_father[i];
           for (size_t c = 0; c < nbClasses_; c++)
           {
-            Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
+            const Vdouble* _likelihoods_son_i_c = _likelihoods_son ? &(*_likelihoods_son)[i][c] : leafLikelihoods[i];
             Vdouble* dLikelihoods_father_i_c = &(*dLikelihoods_father_i)[c];
             Vdouble* d2Likelihoods_father_i_c = &(*d2Likelihoods_father_i)[c];
             VVdouble* pxy__son_c = &(*pxy__son)[c];
@@ -696,8 +788,18 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
 
       if (son->getId() == root1_)
       {
-        VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(father->getId(), root1_);
-        VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(father->getId(), root2_);
+        // Nothing is stored toward leaves, their likelihoods are the same for all rate classes:
+        const VVVdouble* _likelihoodsroot1_ = 0;
+        const VVVdouble* _likelihoodsroot2_ = 0;
+        vector<const Vdouble*> leafLikelihoodsroot1, leafLikelihoodsroot2;
+        if (tree_->isLeaf(root1_))
+          likelihoodData_->getLeafLikelihoods(root1_, leafLikelihoodsroot1);
+        else
+          _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(father->getId(), root1_);
+        if (tree_->isLeaf(root2_))
+          likelihoodData_->getLeafLikelihoods(root2_, leafLikelihoodsroot2);
+        else
+          _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(father->getId(), root2_);
         double len = getParameterValue("BrLenRoot");
 
         VVVdouble* d2pxy_root1_ = &d2pxy_[root1_];
@@ -708,14 +810,12 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
         VVVdouble* pxy_root2_   = &pxy_[root2_];
         for (size_t i = 0; i < nbDistinctSites_; i++)
         {
-          VVdouble* _likelihoodsroot1__i = &(*_likelihoodsroot1_)[i];
-          VVdouble* _likelihoodsroot2__i = &(*_likelihoodsroot2_)[i];
           VVdouble* dLikelihoods_father_i = &dLikelihoods_father[i];
           VVdouble* d2Likelihoods_father_i = &d2Likelihoods_father[i];
           for (size_t c = 0; c < nbClasses_; c++)
           {
-            Vdouble* _likelihoodsroot1__i_c = &(*_likelihoodsroot1__i)[c];
-            Vdouble* _likelihoodsroot2__i_c = &(*_likelihoodsroot2__i)[c];
+            const Vdouble* _likelihoodsroot1__i_c = _likelihoodsroot1_ ? &(*_likelihoodsroot1_)[i][c] : leafLikelihoodsroot1[i];
+            const Vdouble* _likelihoodsroot2__i_c = _likelihoodsroot2_ ? &(*_likelihoodsroot2_)[i][c] : leafLikelihoodsroot2[i];
             Vdouble* dLikelihoods_father_i_c = &(*dLikelihoods_father_i)[c];
             Vdouble* d2Likelihoods_father_i_c = &(*d2Likelihoods_father_i)[c];
             VVdouble* d2pxy_root1__c = &(*d2pxy_root1_)[c];
@@ -757,17 +857,21 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
       else
       {
         // Account for a putative multifurcation:
-        VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(father->getId(), son->getId());
+        const VVVdouble* _likelihoods_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (son->isLeaf())
+          likelihoodData_->getLeafLikelihoods(son->getId(), leafLikelihoods);
+        else
+          _likelihoods_son = &likelihoodData_->getLikelihoodArray(father->getId(), son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
         for (size_t i = 0; i < nbDistinctSites_; i++)
         {
-          VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[i];
           VVdouble* dLikelihoods_father_i = &dLikelihoods_father[i];
           VVdouble* d2Likelihoods_father_i = &d2Likelihoods_father[i];
           for (size_t c = 0; c < nbClasses_; c++)
           {
-            Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
+            const Vdouble* _likelihoods_son_i_c = _likelihoods_son ? &(*_likelihoods_son)[i][c] : leafLikelihoods[i];
             Vdouble* dLikelihoods_father_i_c = &(*dLikelihoods_father_i)[c];
             Vdouble* d2Likelihoods_father_i_c = &(*d2Likelihoods_father_i)[c];
             VVdouble* pxy__son_c = &(*pxy__son)[c];
@@ -827,11 +931,154 @@ double DRNonHomogeneousTreeLikelihood::getSecondOrderDerivative(const string& va
 
 /******************************************************************************/
 
+void DRNonHomogeneousTreeLikelihood::getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const
+{
+  d1.resize(nbNodes_);
+  d2.resize(nbNodes_);
+  const vector<unsigned int>* w = &likelihoodData_->getWeights();
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    int id = nodes_[k]->getId();
+    Vdouble* dLikelihoods_branch = &likelihoodData_->getDLikelihoodArray(id);
+    Vdouble* d2Likelihoods_branch = &likelihoodData_->getD2LikelihoodArray(id);
+    double d1k = 0, d2k = 0;
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      double dLi = (*dLikelihoods_branch)[i];
+      d1k += (*w)[i] * dLi;
+      d2k += (*w)[i] * ((*d2Likelihoods_branch)[i] - dLi * dLi);
+    }
+    d1[k] = -d1k;
+    d2[k] = -d2k;
+  }
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::initDependencies_()
+{
+  // Dense index of nodes:
+  vector<int> ids = tree_->getNodesId();
+  int minId = ids[0], maxId = ids[0];
+  for (size_t i = 1; i < ids.size(); i++)
+  {
+    minId = min(minId, ids[i]);
+    maxId = max(maxId, ids[i]);
+  }
+  minNodeId_ = minId;
+  nodeIndex_.assign(static_cast<size_t>(maxId - minId) + 1, nbNodes_);
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    nodeIndex_[static_cast<size_t>(nodes_[k]->getId() - minNodeId_)] = k;
+  }
+  fatherIndex_.resize(nbNodes_);
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    fatherIndex_[k] = getNodeIndex_(nodes_[k]->getFather()->getId());
+  }
+
+  // Sons before fathers, from a reversed preorder:
+  postOrder_.clear();
+  vector<const Node*> stack(1, tree_->getRootNode());
+  while (!stack.empty())
+  {
+    const Node* node = stack.back();
+    stack.pop_back();
+    if (node->hasFather())
+      postOrder_.push_back(getNodeIndex_(node->getId()));
+    for (size_t n = 0; n < node->getNumberOfSons(); n++)
+    {
+      stack.push_back(node->getSon(n));
+    }
+  }
+  reverse(postOrder_.begin(), postOrder_.end());
+
+  // Model -> branches:
+  size_t nbModels = modelSet_->getNumberOfModels();
+  modelBranches_.assign(nbModels, vector<size_t>());
+  for (size_t m = 0; m < nbModels; m++)
+  {
+    const vector<int>& modelNodes = modelSet_->getNodesWithModel(m);
+    for (size_t i = 0; i < modelNodes.size(); i++)
+    {
+      size_t k = getNodeIndex_(modelNodes[i]);
+      if (k < nbNodes_)
+        modelBranches_[m].push_back(k);
+    }
+  }
+
+  // Parameter -> models, following the naming scheme of SubstitutionModelSet
+  // (the model number is the suffix of the parameter and of its aliases):
+  parameterModels_.clear();
+  vector<string> names = modelSet_->getNodeParameters().getParameterNames();
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    vector<string> aliases = modelSet_->getAlias(names[i]);
+    aliases.push_back(names[i]);
+    vector<size_t>* models = &parameterModels_[names[i]];
+    for (size_t j = 0; j < aliases.size(); j++)
+    {
+      size_t m = TextTools::to<size_t>(aliases[j].substr(aliases[j].rfind("_") + 1));
+      if (m > 0 && find(models->begin(), models->end(), m - 1) == models->end())
+        models->push_back(m - 1);
+    }
+  }
+
+  subtreeUpToDate_.assign(nbNodes_, false);
+  upperUpToDate_.assign(nbNodes_, false);
+  allUpperUpToDate_ = false;
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::invalidateLikelihoodArrays_(const vector<bool>& changed, bool rootFrequenciesChanged)
+{
+  // The array of a subtree depends on the branches it contains, hence
+  // a change in a branch invalidates the arrays of all its ancestors:
+  size_t nbChanged = 0;
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    if (!changed[k])
+      continue;
+    nbChanged++;
+    for (size_t j = fatherIndex_[k]; j < nbNodes_ && subtreeUpToDate_[j]; j = fatherIndex_[j])
+    {
+      subtreeUpToDate_[j] = false;
+    }
+  }
+  if (nbChanged == 0 && !rootFrequenciesChanged)
+    return;
+
+  // The array for the upper part of the tree remains valid only if all changed
+  // branches are below the node, or are the branch of the node itself:
+  vector<size_t> nbChangedBelow(nbNodes_ + 1, 0);
+  for (size_t i = 0; i < postOrder_.size(); i++)
+  {
+    size_t k = postOrder_[i];
+    if (changed[k])
+      nbChangedBelow[k]++;
+    nbChangedBelow[fatherIndex_[k]] += nbChangedBelow[k];
+  }
+  for (size_t k = 0; k < nbNodes_; k++)
+  {
+    if (rootFrequenciesChanged || nbChangedBelow[k] < nbChanged)
+    {
+      upperUpToDate_[k] = false;
+      allUpperUpToDate_ = false;
+    }
+  }
+}
+
+/******************************************************************************/
+
 void DRNonHomogeneousTreeLikelihood::resetLikelihoodArrays(const Node* node)
 {
   for (size_t n = 0; n < node->getNumberOfSons(); n++)
   {
     const Node* subNode = node->getSon(n);
+    // No array is stored toward leaves:
+    if (subNode->isLeaf())
+      continue;
     resetLikelihoodArray(likelihoodData_->getLikelihoodArray(node->getId(), subNode->getId()));
   }
   if (node->hasFather())
@@ -845,6 +1092,16 @@ void DRNonHomogeneousTreeLikelihood::resetLikelihoodArrays(const Node* node)
 
 void DRNonHomogeneousTreeLikelihood::computeTreeLikelihood()
 {
+  if (nodeIndex_.empty())
+  {
+    initDependencies_();
+  }
+  else
+  {
+    subtreeUpToDate_.assign(nbNodes_, false);
+    upperUpToDate_.assign(nbNodes_, false);
+    allUpperUpToDate_ = false;
+  }
   computeSubtreeLikelihoodPostfix(tree_->getRootNode());
   computeSubtreeLikelihoodPrefix(tree_->getRootNode());
   computeRootLikelihood();
@@ -854,96 +1111,119 @@ void DRNonHomogeneousTreeLikelihood::computeTreeLikelihood()
 
 void DRNonHomogeneousTreeLikelihood::computeSubtreeLikelihoodPostfix(const Node* node)
 {
-//  if(node->isLeaf()) return;
-// cout << node->getId() << "\t" << (node->hasName()?node->getName():"") << endl;
-  if (node->getNumberOfSons() == 0)
-    return;
+  // Collect the out of date arrays, skipping the subtrees where nothing changed.
+  // Each son is collected after its father, so that the list is processed backward.
+  vector<const Node*> sons;
+  vector<const Node*> stack(1, node);
+  while (!stack.empty())
+  {
+    const Node* current = stack.back();
+    stack.pop_back();
+    size_t nbSons = current->getNumberOfSons();
+    for (size_t l = 0; l < nbSons; l++)
+    {
+      const Node* son = current->getSon(l);
+      if (subtreeUpToDate_[getNodeIndex_(son->getId())])
+        continue; // Nothing changed in this subtree.
+      sons.push_back(son);
+      stack.push_back(son);
+    }
+  }
+  for (size_t i = sons.size(); i > 0; i--)
+  {
+    computeSonLikelihoodsPostfix_(sons[i - 1]);
+  }
+}
 
-  // Set all likelihood arrays to 1 for a start:
-  resetLikelihoodArrays(node);
+/******************************************************************************/
 
-  map<int, VVVdouble>* _likelihoods_node = &likelihoodData_->getLikelihoodArrays(node->getId());
-  size_t nbNodes = node->getNumberOfSons();
-  for (size_t l = 0; l < nbNodes; l++)
+void DRNonHomogeneousTreeLikelihood::computeSonLikelihoodsPostfix_(const Node* son)
+{
+  // No array is stored toward leaves, their likelihoods are read directly:
+  if (!son->isLeaf())
   {
-    // For each son node...
-
-    const Node* son = node->getSon(l);
-    VVVdouble* _likelihoods_node_son = &(*_likelihoods_node)[son->getId()];
+    VVVdouble* _likelihoods_node_son = &likelihoodData_->getLikelihoodArrays(son->getFather()->getId())[son->getId()];
+    size_t nbSons = son->getNumberOfSons();
+    map<int, VVVdouble>* _likelihoods_son = &likelihoodData_->getLikelihoodArrays(son->getId());
 
-    if (son->isLeaf())
+    vector<const VVVdouble*> iLik;
+    vector<const VVVdouble*> tProb;
+    vector<const Node*> leaves;
+    for (size_t n = 0; n < nbSons; n++)
     {
-      VVdouble* _likelihoods_leaf = &likelihoodData_->getLeafLikelihoods(son->getId());
-      for (size_t i = 0; i < nbDistinctSites_; i++)
+      const Node* sonSon = son->getSon(n);
+      if (sonSon->isLeaf())
       {
-        // For each site in the sequence,
-        Vdouble* _likelihoods_leaf_i = &(*_likelihoods_leaf)[i];
-        VVdouble* _likelihoods_node_son_i = &(*_likelihoods_node_son)[i];
-        for (size_t c = 0; c < nbClasses_; c++)
-        {
-          // For each rate classe,
-          Vdouble* _likelihoods_node_son_i_c = &(*_likelihoods_node_son_i)[c];
-          for (size_t x = 0; x < nbStates_; x++)
-          {
-            // For each initial state,
-            (*_likelihoods_node_son_i_c)[x] = (*_likelihoods_leaf_i)[x];
-          }
-        }
+        leaves.push_back(sonSon);
       }
-    }
-    else
-    {
-      computeSubtreeLikelihoodPostfix(son); // Recursive method:
-      size_t nbSons = son->getNumberOfSons();
-      map<int, VVVdouble>* _likelihoods_son = &likelihoodData_->getLikelihoodArrays(son->getId());
-
-      vector<const VVVdouble*> iLik(nbSons);
-      vector<const VVVdouble*> tProb(nbSons);
-      for (size_t n = 0; n < nbSons; n++)
+      else
       {
-        const Node* sonSon = son->getSon(n);
-        tProb[n] = &pxy_[sonSon->getId()];
-        iLik[n] = &(*_likelihoods_son)[sonSon->getId()];
+        tProb.push_back(&pxy_[sonSon->getId()]);
+        iLik.push_back(&(*_likelihoods_son)[sonSon->getId()]);
       }
-      computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_son, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
     }
+    computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_son, iLik.size(), nbDistinctSites_, nbClasses_, nbStates_, true);
+    computeLikelihoodFromLeaves_(leaves, *_likelihoods_node_son);
   }
+  subtreeUpToDate_[getNodeIndex_(son->getId())] = true;
 }
 
 /******************************************************************************/
 
 void DRNonHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node* node)
 {
+  computeUpperLikelihoods_(node);
   if (!node->hasFather())
-  {
-    // 'node' is the root of the tree.
-    // Just call the method on each son node:
-    size_t nbSons = node->getNumberOfSons();
-    for (size_t n = 0; n < nbSons; n++)
-    {
-      computeSubtreeLikelihoodPrefix(node->getSon(n));
-    }
+    allUpperUpToDate_ = true;
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::updateUpperLikelihoods_()
+{
+  if (allUpperUpToDate_)
     return;
+  // The traversal order is cached by the tree:
+  const vector<const Node*>& preorder = tree_->getPreorderNodes();
+  for (size_t i = 0; i < preorder.size(); i++)
+  {
+    computeNodeUpperLikelihoods_(preorder[i]);
   }
-  else
+  allUpperUpToDate_ = true;
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::computeUpperLikelihoods_(const Node* node)
+{
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPreorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    computeNodeUpperLikelihoods_(nodes[i]);
+  }
+}
+
+/******************************************************************************/
+
+void DRNonHomogeneousTreeLikelihood::computeNodeUpperLikelihoods_(const Node* node)
+{
+  if (node->hasFather() && !upperUpToDate_[getNodeIndex_(node->getId())])
   {
     const Node* father = node->getFather();
     map<int, VVVdouble>* _likelihoods_node = &likelihoodData_->getLikelihoodArrays(node->getId());
     map<int, VVVdouble>* _likelihoods_father = &likelihoodData_->getLikelihoodArrays(father->getId());
     VVVdouble* _likelihoods_node_father = &(*_likelihoods_node)[father->getId()];
-    if (node->isLeaf())
-    {
-      resetLikelihoodArray(*_likelihoods_node_father);
-    }
 
     if (father->isLeaf())
     {
       // If the tree is rooted by a leaf
-      VVdouble* _likelihoods_leaf = &likelihoodData_->getLeafLikelihoods(father->getId());
+      vector<const Vdouble*> _likelihoods_leaf;
+      likelihoodData_->getLeafLikelihoods(father->getId(), _likelihoods_leaf);
       for (size_t i = 0; i < nbDistinctSites_; i++)
       {
         // For each site in the sequence,
-        Vdouble* _likelihoods_leaf_i = &(*_likelihoods_leaf)[i];
+        const Vdouble* _likelihoods_leaf_i = _likelihoods_leaf[i];
         VVdouble* _likelihoods_node_father_i = &(*_likelihoods_node_father)[i];
         for (size_t c = 0; c < nbClasses_; c++)
         {
@@ -960,19 +1240,26 @@ void DRNonHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node*
     else
     {
       vector<const Node*> nodes;
+      vector<const Node*> leaves;
       // Add brothers:
       size_t nbFatherSons = father->getNumberOfSons();
       for (size_t n = 0; n < nbFatherSons; n++)
       {
         const Node* son = father->getSon(n);
         if (son->getId() != node->getId())
-          nodes.push_back(son);  // This is a real brother, not current node!
+        {
+          // This is a real brother, not current node!
+          if (son->isLeaf())
+            leaves.push_back(son);
+          else
+            nodes.push_back(son);
+        }
       }
       // Now the real stuff... We've got to compute the likelihoods for the
       // subtree defined by node 'father'.
       // This is the same as postfix method, but with different subnodes.
 
-      size_t nbSons = nodes.size(); // In case of a bifurcating tree this is equal to 1.
+      size_t nbSons = nodes.size(); // In case of a bifurcating tree this is equal to 1 (or 0 if the brother is a leaf).
 
       vector<const VVVdouble*> iLik(nbSons);
       vector<const VVVdouble*> tProb(nbSons);
@@ -986,12 +1273,13 @@ void DRNonHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node*
       if (father->hasFather())
       {
         const Node* fatherFather = father->getFather();
-        computeLikelihoodFromArrays(iLik, tProb, &(*_likelihoods_father)[fatherFather->getId()], &pxy_[father->getId()], *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
+        computeLikelihoodFromArrays(iLik, tProb, &(*_likelihoods_father)[fatherFather->getId()], &pxy_[father->getId()], *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, true);
       }
       else
       {
-        computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, false);
+        computeLikelihoodFromArrays(iLik, tProb, *_likelihoods_node_father, nbSons, nbDistinctSites_, nbClasses_, nbStates_, true);
       }
+      computeLikelihoodFromLeaves_(leaves, *_likelihoods_node_father);
     }
 
     if (!father->hasFather())
@@ -1010,13 +1298,7 @@ void DRNonHomogeneousTreeLikelihood::computeSubtreeLikelihoodPrefix(const Node*
         }
       }
     }
-
-    // Call the method on each son node:
-    size_t nbNodeSons = node->getNumberOfSons();
-    for (size_t i = 0; i < nbNodeSons; i++)
-    {
-      computeSubtreeLikelihoodPrefix(node->getSon(i)); // Recursive method.
-    }
+    upperUpToDate_[getNodeIndex_(node->getId())] = true;
   }
 }
 
@@ -1029,11 +1311,12 @@ void DRNonHomogeneousTreeLikelihood::computeRootLikelihood()
   // Set all likelihoods to 1 for a start:
   if (root->isLeaf())
   {
-    VVdouble* leavesLikelihoods_root = &likelihoodData_->getLeafLikelihoods(root->getId());
+    vector<const Vdouble*> leavesLikelihoods_root;
+    likelihoodData_->getLeafLikelihoods(root->getId(), leavesLikelihoods_root);
     for (size_t i = 0; i < nbDistinctSites_; i++)
     {
       VVdouble* rootLikelihoods_i = &(*rootLikelihoods)[i];
-      Vdouble* leavesLikelihoods_root_i = &(*leavesLikelihoods_root)[i];
+      const Vdouble* leavesLikelihoods_root_i = leavesLikelihoods_root[i];
       for (size_t c = 0; c < nbClasses_; c++)
       {
         Vdouble* rootLikelihoods_i_c = &(*rootLikelihoods_i)[c];
@@ -1051,15 +1334,24 @@ void DRNonHomogeneousTreeLikelihood::computeRootLikelihood()
 
   map<int, VVVdouble>* likelihoods_root = &likelihoodData_->getLikelihoodArrays(root->getId());
   size_t nbNodes = root->getNumberOfSons();
-  vector<const VVVdouble*> iLik(nbNodes);
-  vector<const VVVdouble*> tProb(nbNodes);
+  vector<const VVVdouble*> iLik;
+  vector<const VVVdouble*> tProb;
+  vector<const Node*> leaves;
   for (size_t n = 0; n < nbNodes; n++)
   {
     const Node* son = root->getSon(n);
-    tProb[n] = &pxy_[son->getId()];
-    iLik[n] = &(*likelihoods_root)[son->getId()];
+    if (son->isLeaf())
+    {
+      leaves.push_back(son);
+    }
+    else
+    {
+      tProb.push_back(&pxy_[son->getId()]);
+      iLik.push_back(&(*likelihoods_root)[son->getId()]);
+    }
   }
-  computeLikelihoodFromArrays(iLik, tProb, *rootLikelihoods, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
+  computeLikelihoodFromArrays(iLik, tProb, *rootLikelihoods, iLik.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
+  computeLikelihoodFromLeaves_(leaves, *rootLikelihoods);
 
   Vdouble p = rateDistribution_->getProbabilities();
   VVdouble* rootLikelihoodsS  = &likelihoodData_->getRootSiteLikelihoodArray();
@@ -1097,16 +1389,17 @@ void DRNonHomogeneousTreeLikelihood::computeLikelihoodAtNode_(const Node* node,
 //  const Node * node = tree_->getNode(nodeId);
   int nodeId = node->getId();
   likelihoodArray.resize(nbDistinctSites_);
-  map<int, VVVdouble>* likelihoods_node = &likelihoodData_->getLikelihoodArrays(node->getId());
+  const map<int, VVVdouble>* likelihoods_node = &getLikelihoodData()->getLikelihoodArrays(node->getId());
 
   // Initialize likelihood array:
   if (node->isLeaf())
   {
-    VVdouble* leavesLikelihoods_node = &likelihoodData_->getLeafLikelihoods(nodeId);
+    vector<const Vdouble*> leavesLikelihoods_node;
+    getLikelihoodData()->getLeafLikelihoods(nodeId, leavesLikelihoods_node);
     for (size_t i = 0; i < nbDistinctSites_; i++)
     {
       VVdouble* likelihoodArray_i = &likelihoodArray[i];
-      Vdouble* leavesLikelihoods_node_i = &(*leavesLikelihoods_node)[i];
+      const Vdouble* leavesLikelihoods_node_i = leavesLikelihoods_node[i];
       likelihoodArray_i->resize(nbClasses_);
       for (size_t c = 0; c < nbClasses_; c++)
       {
@@ -1141,19 +1434,29 @@ void DRNonHomogeneousTreeLikelihood::computeLikelihoodAtNode_(const Node* node,
 
   size_t nbNodes = node->getNumberOfSons();
 
-  vector<const VVVdouble*> iLik(nbNodes);
-  vector<const VVVdouble*> tProb(nbNodes);
+  vector<const VVVdouble*> iLik;
+  vector<const VVVdouble*> tProb;
+  vector<const Node*> leaves;
   for (size_t n = 0; n < nbNodes; n++)
   {
     const Node* son = node->getSon(n);
-    tProb[n] = &pxy_[son->getId()];
-    iLik[n] = &(*likelihoods_node)[son->getId()];
+    if (son->isLeaf())
+    {
+      leaves.push_back(son);
+    }
+    else
+    {
+      tProb.push_back(&pxy_.at(son->getId()));
+      iLik.push_back(&likelihoods_node->at(son->getId()));
+    }
   }
+  nbNodes = iLik.size();
+  computeLikelihoodFromLeaves_(leaves, likelihoodArray);
 
   if (node->hasFather())
   {
     const Node* father = node->getFather();
-    computeLikelihoodFromArrays(iLik, tProb, &(*likelihoods_node)[father->getId()], &pxy_[nodeId], likelihoodArray, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
+    computeLikelihoodFromArrays(iLik, tProb, &likelihoods_node->at(father->getId()), &pxy_.at(nodeId), likelihoodArray, nbNodes, nbDistinctSites_, nbClasses_, nbStates_, false);
   }
   else
   {
@@ -1308,12 +1611,100 @@ void DRNonHomogeneousTreeLikelihood::computeLikelihoodFromArrays(
 
 /******************************************************************************/
 
+void DRNonHomogeneousTreeLikelihood::computeLikelihoodFromLeaves_(const vector<const Node*>& leaves, VVVdouble& oLik) const
+{
+  if (leaves.size() == 0)
+    return;
+  if (!getLikelihoodData()->hasLeafStateCodes())
+  {
+    // Leaves are stored as [site][state] arrays:
+    vector<const Vdouble*> leafLikelihoods;
+    for (size_t l = 0; l < leaves.size(); l++)
+    {
+      int leafId = leaves[l]->getId();
+      const VVVdouble* pxy_leaf = &pxy_.at(leafId);
+      getLikelihoodData()->getLeafLikelihoods(leafId, leafLikelihoods);
+      for (size_t i = 0; i < nbDistinctSites_; i++)
+      {
+        const Vdouble* leafLikelihoods_i = leafLikelihoods[i];
+        VVdouble* oLik_i = &oLik[i];
+        for (size_t c = 0; c < nbClasses_; c++)
+        {
+          const VVdouble* pxy_leaf_c = &(*pxy_leaf)[c];
+          Vdouble* oLik_i_c = &(*oLik_i)[c];
+          for (size_t x = 0; x < nbStates_; x++)
+          {
+            const Vdouble* pxy_leaf_c_x = &(*pxy_leaf_c)[x];
+            double likelihood = 0;
+            for (size_t y = 0; y < nbStates_; y++)
+            {
+              likelihood += (*pxy_leaf_c_x)[y] * (*leafLikelihoods_i)[y];
+            }
+            (*oLik_i_c)[x] *= likelihood;
+          }
+        }
+      }
+    }
+    return;
+  }
+  const VVdouble* codeLikelihoods = &getLikelihoodData()->getLeafCodeLikelihoods();
+  size_t nbCodes = codeLikelihoods->size();
+
+  // Conditional likelihood of each state code, for each rate class and each initial state:
+  Vdouble codeCondLikelihoods(nbClasses_ * nbCodes * nbStates_);
+  for (size_t l = 0; l < leaves.size(); l++)
+  {
+    int leafId = leaves[l]->getId();
+    const VVVdouble* pxy_leaf = &pxy_.at(leafId);
+    for (size_t c = 0; c < nbClasses_; c++)
+    {
+      const VVdouble* pxy_leaf_c = &(*pxy_leaf)[c];
+      for (size_t k = 0; k < nbCodes; k++)
+      {
+        const Vdouble* codeLikelihoods_k = &(*codeLikelihoods)[k];
+        double* codeCondLikelihoods_c_k = &codeCondLikelihoods[(c * nbCodes + k) * nbStates_];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          const Vdouble* pxy_leaf_c_x = &(*pxy_leaf_c)[x];
+          double likelihood = 0;
+          for (size_t y = 0; y < nbStates_; y++)
+          {
+            likelihood += (*pxy_leaf_c_x)[y] * (*codeLikelihoods_k)[y];
+          }
+          codeCondLikelihoods_c_k[x] = likelihood;
+        }
+      }
+    }
+
+    // Now each site only requires a lookup:
+    const vector<unsigned char>* codes = &getLikelihoodData()->getLeafStateCodes(leafId);
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      size_t k = (*codes)[i];
+      VVdouble* oLik_i = &oLik[i];
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        const double* codeCondLikelihoods_c_k = &codeCondLikelihoods[(c * nbCodes + k) * nbStates_];
+        Vdouble* oLik_i_c = &(*oLik_i)[c];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          (*oLik_i_c)[x] *= codeCondLikelihoods_c_k[x];
+        }
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
 void DRNonHomogeneousTreeLikelihood::displayLikelihood(const Node* node)
 {
   cout << "Likelihoods at node " << node->getId() << ": " << endl;
   for (size_t n = 0; n < node->getNumberOfSons(); n++)
   {
     const Node* subNode = node->getSon(n);
+    if (subNode->isLeaf())
+      continue; // No array is stored toward leaves.
     cout << "Array for sub-node " << subNode->getId() << endl;
     displayLikelihoodArray(likelihoodData_->getLikelihoodArray(node->getId(), subNode->getId()));
   }
@@ -73,6 +73,58 @@ class DRNonHomogeneousTreeLikelihood:
   protected:
     mutable DRASDRTreeLikelihoodData *likelihoodData_;
     double minusLogLik_;
+
+    /**
+     * @name Dependency tracking.
+     *
+     * When parameters change, only the transition probabilities of the branches depending on them
+     * are recomputed, and only the conditional likelihood arrays depending on these branches are
+     * invalidated. Arrays for subtrees, which are needed for the likelihood, are updated immediately.
+     * Arrays for the upper part of the tree are only needed for derivatives and for likelihoods at
+     * nodes, and are updated when they are needed.
+     *
+     * Vectors are indexed like nodes_, that is, by branch length parameter number.
+     *
+     * @{
+     */
+
+    /**
+     * @brief Position of each node in nodes_, by id (shifted by minNodeId_). The root has position nbNodes_.
+     */
+    std::vector<size_t> nodeIndex_;
+    int minNodeId_;
+
+    /**
+     * @brief Position in nodes_ of the father of each node, nbNodes_ for the sons of the root.
+     */
+    std::vector<size_t> fatherIndex_;
+
+    /**
+     * @brief Positions in nodes_ of all nodes, sons before fathers.
+     */
+    std::vector<size_t> postOrder_;
+
+    /**
+     * @brief For each model in the set, the branches it is attached to.
+     */
+    std::vector< std::vector<size_t> > modelBranches_;
+
+    /**
+     * @brief For each independent substitution model parameter attached to nodes, the models depending on it.
+     */
+    std::map<std::string, std::vector<size_t> > parameterModels_;
+
+    /**
+     * @brief Tell if the array for the subtree defined by each node, (father, node), is up to date.
+     */
+    std::vector<bool> subtreeUpToDate_;
+
+    /**
+     * @brief Tell if the array for the rest of the tree, (node, father), is up to date.
+     */
+    std::vector<bool> upperUpToDate_;
+    bool allUpperUpToDate_;
+    /** @} */
    
   public:
     /**
@@ -138,6 +190,11 @@ class DRNonHomogeneousTreeLikelihood:
 
   public:
 
+    /**
+     * @brief Set the model set, and rebuild the dependency tables.
+     */
+    void setSubstitutionModelSet(SubstitutionModelSet* modelSet);
+
     /**
      * @name The TreeLikelihood interface.
      *
@@ -145,6 +202,8 @@ class DRNonHomogeneousTreeLikelihood:
      *
      * @{
      */
+    void initialize();
+
     void setData(const SiteContainer& sites);
     double getLikelihood () const;
     double getLogLikelihood() const;
@@ -201,6 +260,17 @@ class DRNonHomogeneousTreeLikelihood:
     double getSecondOrderDerivative(const std::string& variable) const;
     double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const { return 0; } // Not implemented for now.
     /** @} */
+
+    /**
+     * @brief Get the derivatives with respect to all branch lengths at once.
+     *
+     * Elements corresponding to the two branches under the root, if they are not
+     * independent parameters, are the derivatives with respect to each branch.
+     * Derivatives for "BrLenRoot" and "RootPosition" must be obtained by name.
+     *
+     * @see DRTreeLikelihood::getBranchLengthsDerivatives()
+     */
+    void getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const;
     
   public:  // Specific methods:
 
@@ -220,13 +290,20 @@ class DRNonHomogeneousTreeLikelihood:
      * Initialize the arrays corresponding to each son node for the node passed as argument.
      * The method is called for each son node and the result stored in the corresponding array.
      */
-    virtual void computeSubtreeLikelihoodPostfix(const Node* node); //Recursive method.
+    virtual void computeSubtreeLikelihoodPostfix(const Node* node);
     /**
      * This method initilize the remaining likelihood arrays, corresponding to father nodes.
      * It must be called after the postfix method because it requires that the arrays for
      * son nodes to be be computed.
      */
-    virtual void computeSubtreeLikelihoodPrefix(const Node* node); //Recursive method.
+    virtual void computeSubtreeLikelihoodPrefix(const Node* node);
+
+    /**
+     * @brief Compute the array of a node toward its father, from the arrays of its sons.
+     *
+     * Out of date subtrees are traversed in postorder with this method, without recursion.
+     */
+    void computeSonLikelihoodsPostfix_(const Node* son);
 
     virtual void computeRootLikelihood();
 
@@ -247,6 +324,44 @@ class DRNonHomogeneousTreeLikelihood:
      */
     virtual void displayLikelihood(const Node* node);
 
+    /**
+     * @brief Build the dependency tables, and mark all conditional likelihood arrays as out of date.
+     */
+    void initDependencies_();
+
+    /**
+     * @brief Mark as out of date the conditional likelihood arrays depending on some branches.
+     *
+     * @param changed                For each branch, tell if its transition probabilities changed.
+     * @param rootFrequenciesChanged Tell if the root frequencies changed.
+     */
+    void invalidateLikelihoodArrays_(const std::vector<bool>& changed, bool rootFrequenciesChanged);
+
+    /**
+     * @brief Recompute the out of date arrays for the upper part of the tree, if any.
+     *
+     * This is done each time parameters change, so that const methods never
+     * modify the arrays and can be called concurrently.
+     */
+    void updateUpperLikelihoods_();
+
+    /**
+     * @brief Recompute the out of date arrays for the upper part of the tree, in the subtree defined by a node.
+     */
+    void computeUpperLikelihoods_(const Node* node);
+
+    /**
+     * @brief Recompute the array of a node toward its father, if it is out of date.
+     *
+     * Subtrees are traversed in preorder with this method, without recursion.
+     */
+    void computeNodeUpperLikelihoods_(const Node* node);
+
+    size_t getNodeIndex_(int nodeId) const
+    {
+      return nodeIndex_[static_cast<size_t>(nodeId - minNodeId_)];
+    }
+
     /**
      * @brief Compute conditional likelihoods.
      *
@@ -305,6 +420,16 @@ class DRNonHomogeneousTreeLikelihood:
         size_t nbStates,
         bool reset = true);
 
+    /**
+     * @brief Multiply conditional likelihoods by the contribution of leaf neighbors.
+     *
+     * No likelihood array is stored toward leaves, see DRHomogeneousTreeLikelihood::computeLikelihoodFromLeaves_().
+     *
+     * @param leaves The leaves to account for.
+     * @param oLik   The likelihood array to update.
+     */
+    void computeLikelihoodFromLeaves_(const std::vector<const Node*>& leaves, VVVdouble& oLik) const;
+
   friend class DRNonHomogeneousMixedTreeLikelihood;
 };
 
@@ -101,6 +101,19 @@ class DRTreeLikelihood:
      */
     virtual void computeLikelihoodAtNode(int nodeId, VVVdouble& likelihoodArray) const = 0;
 
+    /**
+     * @brief Get the derivatives with respect to all branch lengths at once.
+     *
+     * This avoids the parameter lookup performed by getFirstOrderDerivative() and
+     * getSecondOrderDerivative() for each branch.
+     * Vectors are indexed as branch length parameters: element i is the derivative
+     * with respect to the length of the branch of parameter "BrLen<i>".
+     *
+     * @param d1 [out] The first order derivatives of the negative log-likelihood.
+     * @param d2 [out] The second order derivatives of the negative log-likelihood.
+     */
+    virtual void getBranchLengthsDerivatives(Vdouble& d1, Vdouble& d2) const = 0;
+
 };
 
 } //end of namespace bpp.
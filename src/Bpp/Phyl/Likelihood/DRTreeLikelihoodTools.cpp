@@ -57,12 +57,13 @@ VVVdouble DRTreeLikelihoodTools::getPosteriorProbabilitiesForEachStateForEachRat
   Vdouble rcProbs = rDist->getProbabilities();
   if (drl.getTree().isLeaf(nodeId))
   {
-    VVdouble larray = drl.getLikelihoodData()->getLeafLikelihoods(nodeId);
+    std::vector<const Vdouble*> larray;
+    drl.getLikelihoodData()->getLeafLikelihoods(nodeId, larray);
     for (size_t i = 0; i < nSites; i++)
     {
       VVdouble * postProb_i = & postProb[i];
       postProb_i->resize(nClasses);
-      Vdouble * larray_i = & larray[i];
+      const Vdouble * larray_i = larray[i];
       //In case of generic character:
       double sumprobs = VectorTools::sum(*larray_i);
       for (size_t c = 0; c < nClasses; c++)
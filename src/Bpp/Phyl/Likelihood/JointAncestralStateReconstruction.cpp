@@ -0,0 +1,295 @@
+//
+// File: JointAncestralStateReconstruction.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "JointAncestralStateReconstruction.h"
+#include "../ParallelTools.h"
+#include "../TreeExceptions.h"
+
+#include <Bpp/Text/TextTools.h>
+
+// From the STL:
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+JointAncestralStateReconstruction::JointAncestralStateReconstruction(const DRTreeLikelihood* drl, unsigned int nbThreads) :
+  likelihood_      (drl),
+  tree_            (drl->getTree()),
+  alphabet_        (drl->getAlphabet()),
+  nbSites_         (drl->getLikelihoodData()->getNumberOfSites()),
+  nbDistinctSites_ (drl->getLikelihoodData()->getNumberOfDistinctSites()),
+  nbClasses_       (drl->getLikelihoodData()->getNumberOfClasses()),
+  nbStates_        (drl->getLikelihoodData()->getNumberOfStates()),
+  rootPatternLinks_(drl->getLikelihoodData()->getRootArrayPositions()),
+  nodeIds_         (),
+  nodeIndexes_     (),
+  states_          (),
+  logLikelihoods_  ()
+{
+  // Nodes are stored in post-order, so that sons always come before their father,
+  // and the root comes last:
+  vector<Node*> nodes = tree_.getNodes();
+  size_t nbNodes = nodes.size();
+  nodeIds_.resize(nbNodes);
+  for (size_t k = 0; k < nbNodes; ++k)
+  {
+    nodeIds_[k] = nodes[k]->getId();
+    nodeIndexes_[nodeIds_[k]] = k;
+  }
+
+  vector<size_t> fatherIndexes(nbNodes, nbNodes);
+  vector< vector<const Vdouble*> > leafLikelihoods(nbNodes);
+  vector<Vdouble> logPxy(nbNodes);
+  for (size_t k = 0; k < nbNodes; ++k)
+  {
+    const Node* node = nodes[k];
+    if (node->hasFather())
+    {
+      fatherIndexes[k] = nodeIndexes_[node->getFather()->getId()];
+      VVVdouble pxy = likelihood_->getTransitionProbabilitiesPerRateClass(nodeIds_[k], 0);
+      Vdouble* logPxy_k = &logPxy[k];
+      logPxy_k->resize(nbClasses_ * nbStates_ * nbStates_);
+      for (size_t c = 0; c < nbClasses_; ++c)
+      {
+        for (size_t x = 0; x < nbStates_; ++x)
+        {
+          for (size_t y = 0; y < nbStates_; ++y)
+          {
+            (*logPxy_k)[(c * nbStates_ + x) * nbStates_ + y] = log(pxy[c][x][y]);
+          }
+        }
+      }
+    }
+    if (node->isLeaf())
+      likelihood_->getLikelihoodData()->getLeafLikelihoods(nodeIds_[k], leafLikelihoods[k]);
+  }
+
+  const vector<double>& rootFreqs = likelihood_->getRootFrequencies(0);
+  Vdouble logRootFreqs(nbStates_);
+  for (size_t x = 0; x < nbStates_; ++x)
+  {
+    logRootFreqs[x] = log(rootFreqs[x]);
+  }
+  Vdouble rates = likelihood_->getRateDistribution()->getProbabilities();
+  Vdouble logRates(nbClasses_);
+  for (size_t c = 0; c < nbClasses_; ++c)
+  {
+    logRates[c] = log(rates[c]);
+  }
+
+  states_.resize(nbNodes * nbDistinctSites_);
+  logLikelihoods_.resize(nbDistinctSites_);
+  ParallelTools::runInParallel(nbDistinctSites_, nbThreads, [&](size_t begin, size_t end) {
+    reconstruct_(fatherIndexes, leafLikelihoods, logPxy, logRootFreqs, logRates, begin, end);
+  });
+}
+
+/******************************************************************************/
+
+void JointAncestralStateReconstruction::reconstruct_(
+  const vector<size_t>& fatherIndexes,
+  const vector< vector<const Vdouble*> >& leafLikelihoods,
+  const vector<Vdouble>& logPxy,
+  const Vdouble& logRootFreqs,
+  const Vdouble& logRates,
+  size_t begin,
+  size_t end)
+{
+  size_t nbNodes = nodeIds_.size();
+  size_t root = nbNodes - 1;
+  size_t nbStates2 = nbStates_ * nbStates_;
+
+  // Log-likelihoods of the leaves for the current pattern:
+  Vdouble leafLogLik(nbNodes * nbStates_, 0.);
+  // Log-likelihoods of the best reconstruction of the subtree defined by each node, for each state of the node:
+  Vdouble subtreeLogLik(nbNodes * nbStates_);
+  // Best state of each node, for each state of its father, for each rate class:
+  vector<size_t> bestStates(nbClasses_ * nbNodes * nbStates_);
+  Vdouble classLogLik(nbClasses_);
+  vector<size_t> rootStates(nbClasses_);
+
+  for (size_t i = begin; i < end; ++i)
+  {
+    for (size_t k = 0; k < nbNodes; ++k)
+    {
+      if (!leafLikelihoods[k].empty())
+      {
+        const Vdouble* leafLikelihoods_k_i = leafLikelihoods[k][i];
+        for (size_t y = 0; y < nbStates_; ++y)
+        {
+          leafLogLik[k * nbStates_ + y] = log((*leafLikelihoods_k_i)[y]);
+        }
+      }
+    }
+
+    // Post-order pass, for each rate class:
+    for (size_t c = 0; c < nbClasses_; ++c)
+    {
+      copy(leafLogLik.begin(), leafLogLik.end(), subtreeLogLik.begin());
+      size_t* bestStates_c = &bestStates[c * nbNodes * nbStates_];
+      for (size_t k = 0; k < root; ++k)
+      {
+        const double* subtreeLogLik_k = &subtreeLogLik[k * nbStates_];
+        double* subtreeLogLik_father = &subtreeLogLik[fatherIndexes[k] * nbStates_];
+        const double* logPxy_k_c = &logPxy[k][c * nbStates2];
+        size_t* bestStates_c_k = bestStates_c + k * nbStates_;
+        for (size_t x = 0; x < nbStates_; ++x)
+        {
+          // For each state of the father node,
+          const double* logPxy_k_c_x = logPxy_k_c + x * nbStates_;
+          double best = -numeric_limits<double>::infinity();
+          size_t bestY = 0;
+          for (size_t y = 0; y < nbStates_; ++y)
+          {
+            double l = logPxy_k_c_x[y] + subtreeLogLik_k[y];
+            if (l > best)
+            {
+              best = l;
+              bestY = y;
+            }
+          }
+          bestStates_c_k[x] = bestY;
+          subtreeLogLik_father[x] += best;
+        }
+      }
+
+      // Now deal with the root:
+      const double* subtreeLogLik_root = &subtreeLogLik[root * nbStates_];
+      double best = -numeric_limits<double>::infinity();
+      size_t bestX = 0;
+      for (size_t x = 0; x < nbStates_; ++x)
+      {
+        double l = logRootFreqs[x] + subtreeLogLik_root[x];
+        if (l > best)
+        {
+          best = l;
+          bestX = x;
+        }
+      }
+      rootStates[c] = bestX;
+      classLogLik[c] = logRates[c] + best;
+    }
+
+    // Traceback, in pre-order, for the best rate class:
+    size_t bestClass = static_cast<size_t>(max_element(classLogLik.begin(), classLogLik.end()) - classLogLik.begin());
+    const size_t* bestStates_c = &bestStates[bestClass * nbNodes * nbStates_];
+    states_[root * nbDistinctSites_ + i] = rootStates[bestClass];
+    for (size_t k = root; k > 0; --k)
+    {
+      size_t n = k - 1;
+      size_t fatherState = states_[fatherIndexes[n] * nbDistinctSites_ + i];
+      states_[n * nbDistinctSites_ + i] = bestStates_c[n * nbStates_ + fatherState];
+    }
+    logLikelihoods_[i] = classLogLik[bestClass];
+  }
+}
+
+/******************************************************************************/
+
+vector<size_t> JointAncestralStateReconstruction::getAncestralStatesForNode(int nodeId) const
+{
+  map<int, size_t>::const_iterator it = nodeIndexes_.find(nodeId);
+  if (it == nodeIndexes_.end())
+    throw NodeNotFoundException("JointAncestralStateReconstruction::getAncestralStatesForNode().", nodeId);
+  vector<size_t>::const_iterator first = states_.begin() + static_cast<ptrdiff_t>(it->second * nbDistinctSites_);
+  return vector<size_t>(first, first + static_cast<ptrdiff_t>(nbDistinctSites_));
+}
+
+/******************************************************************************/
+
+map<int, vector<size_t> > JointAncestralStateReconstruction::getAllAncestralStates() const
+{
+  map<int, vector<size_t> > ancestors;
+  for (size_t k = 0; k < nodeIds_.size(); ++k)
+  {
+    ancestors[nodeIds_[k]] = getAncestralStatesForNode(nodeIds_[k]);
+  }
+  return ancestors;
+}
+
+/******************************************************************************/
+
+Sequence* JointAncestralStateReconstruction::getAncestralSequenceForNode(int nodeId) const
+{
+  string name = tree_.hasNodeName(nodeId) ? tree_.getNodeName(nodeId) : ("" + TextTools::toString(nodeId));
+  const TransitionModel* model = likelihood_->getModelForSite(tree_.getNodesId()[0], 0); // We assume all nodes have a model with the same number of states.
+  vector<size_t> states = getAncestralStatesForNode(nodeId);
+  vector<int> allStates(nbSites_);
+  for (size_t i = 0; i < nbSites_; i++)
+  {
+    allStates[i] = model->getAlphabetStateAsInt(states[rootPatternLinks_[i]]);
+  }
+  return new BasicSequence(name, allStates, alphabet_);
+}
+
+/******************************************************************************/
+
+AlignedSequenceContainer* JointAncestralStateReconstruction::getAncestralSequences() const
+{
+  AlignedSequenceContainer* asc = new AlignedSequenceContainer(alphabet_);
+  vector<int> ids = tree_.getInnerNodesId();
+  for (size_t i = 0; i < ids.size(); i++)
+  {
+    Sequence* seq = getAncestralSequenceForNode(ids[i]);
+    asc->addSequence(*seq);
+    delete seq;
+  }
+  return asc;
+}
+
+/******************************************************************************/
+
+double JointAncestralStateReconstruction::getLogLikelihood() const
+{
+  const vector<unsigned int>& w = likelihood_->getLikelihoodData()->getWeights();
+  double ll = 0;
+  for (size_t i = 0; i < nbDistinctSites_; i++)
+  {
+    ll += w[i] * logLikelihoods_[i];
+  }
+  return ll;
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,209 @@
+//
+// File: JointAncestralStateReconstruction.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _JOINTANCESTRALSTATESRECONSTRUCTION_H_
+#define _JOINTANCESTRALSTATESRECONSTRUCTION_H_
+
+#include "../AncestralStateReconstruction.h"
+#include "DRTreeLikelihood.h"
+
+// From SeqLib:
+#include <Bpp/Seq/Alphabet/Alphabet.h>
+#include <Bpp/Seq/Container/AlignedSequenceContainer.h>
+#include <Bpp/Seq/Sequence.h>
+
+// From the STL:
+#include <vector>
+#include <map>
+
+namespace bpp
+{
+
+/**
+ * @brief Likelihood ancestral states reconstruction: joint method.
+ *
+ * The states at all nodes (including leaves, which allows to resolve
+ * ambiguous characters) are reconstructed so that their joint probability
+ * is maximal, using the dynamic programming algorithm of Pupko et al.
+ * One post-order pass is performed for each site pattern, using the
+ * transition probabilities of the likelihood object, followed by a pre-order
+ * traceback. Computations are performed in log scale, so that large trees do
+ * not underflow. The complexity is in O(nodes x patterns x classes x states^2).
+ *
+ * In case of rate variation across sites, the rate class is reconstructed
+ * together with the states: for each pattern, the reconstruction with the
+ * highest joint probability over all classes (weighted by the class
+ * probabilities) is retained.
+ *
+ * The reconstruction is performed once at construction, from the current
+ * parameter values of the likelihood object. Site patterns are distributed
+ * over several threads.
+ *
+ * Reference:
+ * T Pupko, I Pe'er, R Shamir and D Graur (2000), _Molecular Biology and Evolution_ 17(6) 890-6.
+ */
+class JointAncestralStateReconstruction:
+  public virtual AncestralStateReconstruction
+{
+  private:
+    const DRTreeLikelihood* likelihood_;
+    TreeTemplate<Node> tree_;
+    const Alphabet* alphabet_;
+    size_t nbSites_;
+    size_t nbDistinctSites_;
+    size_t nbClasses_;
+    size_t nbStates_;
+    std::vector<size_t> rootPatternLinks_;
+    std::vector<int> nodeIds_;
+    std::map<int, size_t> nodeIndexes_;
+    std::vector<size_t> states_;
+    std::vector<double> logLikelihoods_;
+
+  public:
+    /**
+     * @brief Build a new joint reconstruction and perform it.
+     *
+     * @param drl       The likelihood object to use. It must have been initialized.
+     * @param nbThreads The number of threads to use. 0 means as many as the hardware supports.
+     * The reconstruction is performed in the calling thread by default.
+     */
+    JointAncestralStateReconstruction(const DRTreeLikelihood* drl, unsigned int nbThreads = 1);
+
+    JointAncestralStateReconstruction(const JointAncestralStateReconstruction& jasr) :
+      likelihood_      (jasr.likelihood_),
+      tree_            (jasr.tree_),
+      alphabet_        (jasr.alphabet_),
+      nbSites_         (jasr.nbSites_),
+      nbDistinctSites_ (jasr.nbDistinctSites_),
+      nbClasses_       (jasr.nbClasses_),
+      nbStates_        (jasr.nbStates_),
+      rootPatternLinks_(jasr.rootPatternLinks_),
+      nodeIds_         (jasr.nodeIds_),
+      nodeIndexes_     (jasr.nodeIndexes_),
+      states_          (jasr.states_),
+      logLikelihoods_  (jasr.logLikelihoods_)
+    {}
+
+    JointAncestralStateReconstruction& operator=(const JointAncestralStateReconstruction& jasr)
+    {
+      likelihood_       = jasr.likelihood_;
+      tree_             = jasr.tree_;
+      alphabet_         = jasr.alphabet_;
+      nbSites_          = jasr.nbSites_;
+      nbDistinctSites_  = jasr.nbDistinctSites_;
+      nbClasses_        = jasr.nbClasses_;
+      nbStates_         = jasr.nbStates_;
+      rootPatternLinks_ = jasr.rootPatternLinks_;
+      nodeIds_          = jasr.nodeIds_;
+      nodeIndexes_      = jasr.nodeIndexes_;
+      states_           = jasr.states_;
+      logLikelihoods_   = jasr.logLikelihoods_;
+      return *this;
+    }
+
+    JointAncestralStateReconstruction* clone() const { return new JointAncestralStateReconstruction(*this); }
+
+    virtual ~JointAncestralStateReconstruction() {}
+
+  public:
+
+    /**
+     * @brief Get ancestral states for a given node as a vector of int.
+     *
+     * The size of the vector is the number of distinct sites in the container
+     * associated to the likelihood object.
+     *
+     * @param nodeId The id of the node at which the states must be retrieved.
+     * @return A vector of states indices.
+     * @throw NodeNotFoundException If no node with this id exists in the tree.
+     * @see getAncestralSequenceForNode
+     */
+    std::vector<size_t> getAncestralStatesForNode(int nodeId) const;
+
+    std::map<int, std::vector<size_t> > getAllAncestralStates() const;
+
+    /**
+     * @brief Get the ancestral sequence for a given node.
+     *
+     * The name of the sequence will be the name of the node if there is one, its id otherwise.
+     * A new sequence object is created, whose destruction is up to the user.
+     *
+     * @param nodeId The id of the node at which the sequence must be retrieved.
+     * @return A sequence object.
+     */
+    Sequence* getAncestralSequenceForNode(int nodeId) const;
+
+    AlignedSequenceContainer* getAncestralSequences() const;
+
+    /**
+     * @return The log-probability of the reconstructed states and rate class at a given site,
+     * jointly with the data.
+     *
+     * @param site The index of the site in the alignment.
+     */
+    double getLogLikelihoodForASite(size_t site) const
+    {
+      return logLikelihoods_[rootPatternLinks_[site]];
+    }
+
+    /**
+     * @return The log-probability of the reconstructed states and rate classes at all sites,
+     * jointly with the data.
+     */
+    double getLogLikelihood() const;
+
+  private:
+    /**
+     * @brief Reconstruct the states for the site patterns in the range [begin, end[.
+     */
+    void reconstruct_(
+        const std::vector<size_t>& fatherIndexes,
+        const std::vector< std::vector<const Vdouble*> >& leafLikelihoods,
+        const std::vector<Vdouble>& logPxy,
+        const Vdouble& logRootFreqs,
+        const Vdouble& logRates,
+        size_t begin,
+        size_t end);
+
+};
+
+} //end of namespace bpp.
+
+#endif // _JOINTANCESTRALSTATESRECONSTRUCTION_H_
+
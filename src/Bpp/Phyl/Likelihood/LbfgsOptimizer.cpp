@@ -0,0 +1,288 @@
+//
+// File: LbfgsOptimizer.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "LbfgsOptimizer.h"
+#include "TreeLikelihood.h"
+
+#include <Bpp/Text/TextTools.h>
+#include <Bpp/Numeric/NumConstants.h>
+
+// From the STL:
+#include <cmath>
+
+using namespace bpp;
+using namespace std;
+
+/**************************************************************************/
+
+LbfgsOptimizer::LbfgsOptimizer(DerivableFirstOrder* function, unsigned int memory) :
+  AbstractOptimizer(function),
+  n_(0),
+  memory_(memory),
+  maxBacktracking_(20),
+  x_(),
+  gradient_(),
+  s_(),
+  y_(),
+  rho_(),
+  savedDerivatives_(false),
+  firstOrderDerivatives_(false),
+  secondOrderDerivatives_(false)
+{
+  setDefaultStopCondition_(new FunctionStopCondition(this));
+  setStopCondition(*getDefaultStopCondition());
+}
+
+/**************************************************************************/
+
+void LbfgsOptimizer::doInit(const ParameterList& params)
+{
+  n_ = getParameters().size();
+  x_.resize(n_);
+  for (size_t i = 0; i < n_; i++)
+  {
+    x_[i] = getParameters()[i].getValue();
+  }
+  s_.clear();
+  y_.clear();
+  rho_.clear();
+
+  DerivableFirstOrder* f = getFunction_();
+  DerivableSecondOrder* f2 = dynamic_cast<DerivableSecondOrder*>(f);
+  if (!savedDerivatives_)
+  {
+    firstOrderDerivatives_ = f->enableFirstOrderDerivatives();
+    secondOrderDerivatives_ = f2 && f2->enableSecondOrderDerivatives();
+    savedDerivatives_ = true;
+  }
+  // The joint evaluation of a likelihood does not need derivative arrays:
+  TreeLikelihood* tl = dynamic_cast<TreeLikelihood*>(f);
+  if (tl && dynamic_cast<ValueAndGradientFunction*>(f))
+    tl->enableDerivatives(false);
+  else
+    f->enableFirstOrderDerivatives(true);
+  currentValue_ = evaluate_(x_, gradient_);
+}
+
+/**************************************************************************/
+
+double LbfgsOptimizer::optimize()
+{
+  try
+  {
+    AbstractOptimizer::optimize();
+  }
+  catch (...)
+  {
+    restoreDerivatives_();
+    throw;
+  }
+  restoreDerivatives_();
+  return currentValue_;
+}
+
+/**************************************************************************/
+
+void LbfgsOptimizer::restoreDerivatives_()
+{
+  DerivableFirstOrder* f = getFunction_();
+  if (!savedDerivatives_ || !f)
+    return;
+  savedDerivatives_ = false;
+  f->enableFirstOrderDerivatives(firstOrderDerivatives_);
+  DerivableSecondOrder* f2 = dynamic_cast<DerivableSecondOrder*>(f);
+  if (f2 && secondOrderDerivatives_)
+    f2->enableSecondOrderDerivatives(true);
+  // Derivative arrays of a likelihood were not computed at the last point:
+  TreeLikelihood* tl = dynamic_cast<TreeLikelihood*>(f);
+  if (tl && dynamic_cast<ValueAndGradientFunction*>(f) && (firstOrderDerivatives_ || secondOrderDerivatives_))
+    tl->setParameters(tl->getBranchLengthsParameters());
+}
+
+/**************************************************************************/
+
+double LbfgsOptimizer::evaluate_(const Vdouble& x, Vdouble& gradient)
+{
+  ParameterList pl = getParameters();
+  for (size_t i = 0; i < n_; i++)
+  {
+    pl[i].setValue(x[i]);
+  }
+  ValueAndGradientFunction* vg = dynamic_cast<ValueAndGradientFunction*>(getFunction_());
+  if (vg)
+    return vg->getValueAndGradient(pl, gradient);
+
+  getFunction_()->setParameters(pl);
+  gradient.resize(n_);
+  for (size_t i = 0; i < n_; i++)
+  {
+    gradient[i] = getFunction_()->getFirstOrderDerivative(pl[i].getName());
+  }
+  return getFunction_()->getValue();
+}
+
+/**************************************************************************/
+
+void LbfgsOptimizer::project_(Vdouble& x) const
+{
+  for (size_t i = 0; i < n_; i++)
+  {
+    const Parameter& p = getParameters()[i];
+    if (p.hasConstraint() && !p.getConstraint()->isCorrect(x[i]))
+      x[i] = p.getConstraint()->getAcceptedLimit(x[i]);
+  }
+}
+
+/**************************************************************************/
+
+double LbfgsOptimizer::doStep()
+{
+  // Two-loop recursion for the search direction:
+  size_t m = s_.size();
+  Vdouble q = gradient_;
+  Vdouble alpha(m);
+  for (size_t k = m; k > 0; k--)
+  {
+    alpha[k - 1] = rho_[k - 1] * VectorTools::scalar<double, double>(s_[k - 1], q);
+    for (size_t i = 0; i < n_; i++)
+    {
+      q[i] -= alpha[k - 1] * y_[k - 1][i];
+    }
+  }
+  double gamma;
+  if (m > 0)
+    gamma = 1. / (rho_[m - 1] * VectorTools::scalar<double, double>(y_[m - 1], y_[m - 1]));
+  else
+  {
+    // First step: start with a move of unit length at most.
+    double norm = VectorTools::norm<double, double>(gradient_);
+    gamma = norm > 1. ? 1. / norm : 1.;
+  }
+  Vdouble direction(n_);
+  for (size_t i = 0; i < n_; i++)
+  {
+    direction[i] = gamma * q[i];
+  }
+  for (size_t k = 0; k < m; k++)
+  {
+    double beta = rho_[k] * VectorTools::scalar<double, double>(y_[k], direction);
+    for (size_t i = 0; i < n_; i++)
+    {
+      direction[i] += s_[k][i] * (alpha[k] - beta);
+    }
+  }
+  for (size_t i = 0; i < n_; i++)
+  {
+    direction[i] = -direction[i];
+  }
+  if (VectorTools::scalar<double, double>(gradient_, direction) >= 0)
+  {
+    printMessage("!!! L-BFGS direction is not a descent direction. Resetting memory.");
+    s_.clear();
+    y_.clear();
+    rho_.clear();
+    double norm = VectorTools::norm<double, double>(gradient_);
+    for (size_t i = 0; i < n_; i++)
+    {
+      direction[i] = -gradient_[i] / max(norm, 1.);
+    }
+  }
+
+  // Backtracking line search:
+  Vdouble xNew(n_), gradientNew;
+  double newValue = 0;
+  double step = 1.;
+  for (unsigned int count = 0; ; count++)
+  {
+    for (size_t i = 0; i < n_; i++)
+    {
+      xNew[i] = x_[i] + step * direction[i];
+    }
+    project_(xNew);
+    newValue = evaluate_(xNew, gradientNew);
+    double decrease = 0;
+    for (size_t i = 0; i < n_; i++)
+    {
+      decrease += gradient_[i] * (xNew[i] - x_[i]);
+    }
+    if (!std::isnan(newValue) && newValue <= currentValue_ + 1e-4 * decrease)
+      break;
+    if (count == maxBacktracking_)
+    {
+      printMessage("!!! L-BFGS line search failed to improve the function (f=" + TextTools::toString(newValue) + "). No move performed.");
+      s_.clear();
+      y_.clear();
+      rho_.clear();
+      return evaluate_(x_, gradient_);
+    }
+    step /= 2.;
+  }
+
+  // Update the approximation of the Hessian:
+  Vdouble s(n_), y(n_);
+  for (size_t i = 0; i < n_; i++)
+  {
+    s[i] = xNew[i] - x_[i];
+    y[i] = gradientNew[i] - gradient_[i];
+  }
+  double sy = VectorTools::scalar<double, double>(s, y);
+  if (sy > NumConstants::TINY())
+  {
+    s_.push_back(s);
+    y_.push_back(y);
+    rho_.push_back(1. / sy);
+    if (s_.size() > memory_)
+    {
+      s_.pop_front();
+      y_.pop_front();
+      rho_.pop_front();
+    }
+  }
+
+  x_ = xNew;
+  gradient_ = gradientNew;
+  for (size_t i = 0; i < n_; i++)
+  {
+    getParameters_()[i].setValue(x_[i]);
+  }
+  return newValue;
+}
+
+/**************************************************************************/
+
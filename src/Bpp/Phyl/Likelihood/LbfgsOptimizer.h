@@ -0,0 +1,167 @@
+//
+// File: LbfgsOptimizer.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _LBFGSOPTIMIZER_H_
+#define _LBFGSOPTIMIZER_H_
+
+#include "ValueAndGradientFunction.h"
+
+#include <Bpp/Numeric/Function/AbstractOptimizer.h>
+#include <Bpp/Numeric/VectorTools.h>
+
+// From the STL:
+#include <deque>
+
+namespace bpp
+{
+
+  /**
+   * @brief Limited-memory BFGS optimizer (Nocedal, 1980).
+   *
+   * The inverse Hessian is approximated from the last few displacements and gradient changes,
+   * using the two-loop recursion, and a backtracking line search satisfying the Armijo condition
+   * is performed along the resulting direction. Points are projected onto the parameter
+   * constraints.
+   *
+   * If the function implements ValueAndGradientFunction, as DRHomogeneousTreeLikelihood does,
+   * the value and the gradient with respect to all parameters are obtained from a single call to
+   * ValueAndGradientFunction::getValueAndGradient(), so that branch lengths,
+   * substitution model and rate distribution parameters can be optimized jointly
+   * at the cost of one tree traversal per evaluation. Wrapped functions keep this ability
+   * if the wrapper implements the interface too (see ReparametrizationValueAndGradientWrapper).
+   * Otherwise, getFirstOrderDerivative() is called for each parameter.
+   *
+   * The derivative flags of the function are changed by init(), and restored when optimize() returns.
+   */
+  class LbfgsOptimizer:
+    public AbstractOptimizer
+  {
+  private:
+    size_t n_; // Number of parameters
+
+    unsigned int memory_;
+
+    unsigned int maxBacktracking_;
+
+    Vdouble x_; // Current point
+
+    Vdouble gradient_; // Gradient at current point
+
+    std::deque<Vdouble> s_; // Last displacements
+
+    std::deque<Vdouble> y_; // Last gradient changes
+
+    std::deque<double> rho_;
+
+    /**
+     * @brief The derivative flags of the function before doInit() changed them.
+     */
+    bool savedDerivatives_;
+    bool firstOrderDerivatives_;
+    bool secondOrderDerivatives_;
+
+  public:
+
+    /**
+     * @param function The function to optimize.
+     * @param memory   The number of previous iterations used to approximate the Hessian.
+     */
+    LbfgsOptimizer(DerivableFirstOrder* function, unsigned int memory = 10);
+
+    virtual ~LbfgsOptimizer() {}
+
+    LbfgsOptimizer* clone() const { return new LbfgsOptimizer(*this); }
+
+  public:
+    const DerivableFirstOrder* getFunction() const
+    {
+      return dynamic_cast<const DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+    DerivableFirstOrder* getFunction()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+
+    /**
+     * @name The Optimizer interface.
+     *
+     * @{
+     */
+    double getFunctionValue() const { return currentValue_; }
+    /** @} */
+
+    void doInit(const ParameterList& params);
+
+    double doStep();
+
+    /**
+     * @brief Optimize, and then restore the derivative flags of the function.
+     */
+    double optimize();
+
+    void setMemory(unsigned int memory) { memory_ = memory; }
+    unsigned int getMemory() const { return memory_; }
+
+    void setMaximumNumberOfBacktracking(unsigned int mx) { maxBacktracking_ = mx; }
+
+  protected:
+    DerivableFirstOrder* getFunction_()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction_());
+    }
+
+  private:
+    /**
+     * @brief Set the function at a given point, and compute its value and gradient.
+     */
+    double evaluate_(const Vdouble& x, Vdouble& gradient);
+
+    /**
+     * @brief Move a point inside the constraints of the parameters.
+     */
+    void project_(Vdouble& x) const;
+
+    void restoreDerivatives_();
+
+  };
+
+} //end of namespace bpp.
+
+#endif //_LBFGSOPTIMIZER_H_
+
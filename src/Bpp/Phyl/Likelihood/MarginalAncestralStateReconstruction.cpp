@@ -38,9 +38,16 @@
  */
 
 #include "MarginalAncestralStateReconstruction.h"
+#include "../ParallelTools.h"
+
 #include <Bpp/Numeric/VectorTools.h>
 #include <Bpp/Numeric/Random/RandomTools.h>
 
+// From the STL:
+#include <algorithm>
+#include <numeric>
+#include <random>
+
 using namespace bpp;
 using namespace std;
 
@@ -52,12 +59,13 @@ vector<size_t> MarginalAncestralStateReconstruction::getAncestralStatesForNode(i
   double r;
   if (likelihood_->getTree().isLeaf(nodeId))
   {
-    VVdouble larray = likelihood_->getLikelihoodData()->getLeafLikelihoods(nodeId);
+    vector<const Vdouble*> larray;
+    likelihood_->getLikelihoodData()->getLeafLikelihoods(nodeId, larray);
     for (size_t i = 0; i < nbDistinctSites_; ++i)
     {
       Vdouble* probs_i = &probs[i];
       probs_i->resize(nbStates_);
-      size_t j = VectorTools::whichMax(larray[i]);
+      size_t j = VectorTools::whichMax(*larray[i]);
       ancestors[i] = j;
       (*probs_i)[j] = 1.;
     }
@@ -104,13 +112,119 @@ vector<size_t> MarginalAncestralStateReconstruction::getAncestralStatesForNode(i
 map<int, vector<size_t> > MarginalAncestralStateReconstruction::getAllAncestralStates() const
 {
   map<int, vector<size_t> > ancestors;
+
+  // Inner nodes, all at once:
+  vector<int> nodeIds;
+  Vdouble posteriors;
+  getAllPosteriorProbabilities(nodeIds, posteriors);
+  for (size_t k = 0; k < nodeIds.size(); ++k)
+  {
+    vector<size_t>* v = &ancestors[nodeIds[k]];
+    v->resize(nbDistinctSites_);
+    const double* posteriors_k = &posteriors[k * nbDistinctSites_ * nbStates_];
+    for (size_t i = 0; i < nbDistinctSites_; ++i)
+    {
+      const double* posteriors_k_i = posteriors_k + i * nbStates_;
+      (*v)[i] = static_cast<size_t>(max_element(posteriors_k_i, posteriors_k_i + nbStates_) - posteriors_k_i);
+    }
+  }
+
+  // Leaves:
+  // This is a tricky way to store the real sequence as an ancestral one...
+  // In case of Markov Modulated models, we consider that the real sequences
+  // Are all in the first category.
   // Clone the data into a AlignedSequenceContainer for more efficiency:
-  AlignedSequenceContainer* data = new AlignedSequenceContainer(*likelihood_->getLikelihoodData()->getShrunkData());
-  recursiveMarginalAncestralStates(tree_.getRootNode(), ancestors, *data);
-  delete data;
+  AlignedSequenceContainer data(*likelihood_->getLikelihoodData()->getShrunkData());
+  const TransitionModel* model = likelihood_->getModelForSite(tree_.getNodesId()[0], 0); // We assume all nodes have a model with the same number of states.
+  vector<const Node*> leaves = tree_.getLeaves();
+  for (size_t l = 0; l < leaves.size(); ++l)
+  {
+    const Sequence& seq = data.getSequence(leaves[l]->getName());
+    vector<size_t>* v = &ancestors[leaves[l]->getId()];
+    v->resize(seq.size());
+    for (size_t i = 0; i < seq.size(); i++)
+    {
+      (*v)[i] = model->getModelStates(seq[i])[0];
+    }
+  }
   return ancestors;
 }
 
+void MarginalAncestralStateReconstruction::getAllPosteriorProbabilities(vector<int>& nodeIds, Vdouble& posteriors) const
+{
+  nodeIds = tree_.getInnerNodesId();
+  posteriors.resize(nodeIds.size() * nbDistinctSites_ * nbStates_);
+  ParallelTools::runInParallel(nodeIds.size(), nbThreads_, [&](size_t begin, size_t end) {
+    computePosteriorProbabilities_(nodeIds, begin, end, posteriors);
+  });
+}
+
+void MarginalAncestralStateReconstruction::computePosteriorProbabilities_(
+  const vector<int>& nodeIds,
+  size_t begin,
+  size_t end,
+  Vdouble& posteriors) const
+{
+  // The array is resized at the first node only, then reused.
+  VVVdouble larray;
+  for (size_t k = begin; k < end; ++k)
+  {
+    likelihood_->computeLikelihoodAtNode(nodeIds[k], larray);
+    double* posteriors_k = &posteriors[k * nbDistinctSites_ * nbStates_];
+    for (size_t i = 0; i < nbDistinctSites_; i++)
+    {
+      const VVdouble* larray_i = &larray[i];
+      double* posteriors_k_i = posteriors_k + i * nbStates_;
+      fill(posteriors_k_i, posteriors_k_i + nbStates_, 0.);
+      for (size_t c = 0; c < nbClasses_; c++)
+      {
+        const Vdouble* larray_i_c = &(*larray_i)[c];
+        double w = r_[c] / l_[i];
+        for (size_t x = 0; x < nbStates_; x++)
+        {
+          posteriors_k_i[x] += (*larray_i_c)[x] * w;
+        }
+      }
+    }
+  }
+}
+
+void MarginalAncestralStateReconstruction::sampleAllAncestralStates(
+  size_t nbReplicates,
+  unsigned int seed,
+  vector<int>& nodeIds,
+  vector<size_t>& samples) const
+{
+  // Posterior probabilities are turned into cumulative distributions, in place:
+  Vdouble cumProbs;
+  getAllPosteriorProbabilities(nodeIds, cumProbs);
+  size_t nbDistributions = nodeIds.size() * nbDistinctSites_;
+  for (size_t j = 0; j < nbDistributions; ++j)
+  {
+    double* cumProbs_j = &cumProbs[j * nbStates_];
+    partial_sum(cumProbs_j, cumProbs_j + nbStates_, cumProbs_j);
+  }
+
+  samples.resize(nbReplicates * nbDistributions);
+  ParallelTools::runInParallel(nbReplicates, nbThreads_, [&](size_t begin, size_t end) {
+    mt19937 generator;
+    uniform_real_distribution<double> uniform(0., 1.);
+    for (size_t b = begin; b < end; ++b)
+    {
+      seed_seq seq{ seed, static_cast<unsigned int>(b) };
+      generator.seed(seq);
+      size_t* samples_b = &samples[b * nbDistributions];
+      for (size_t j = 0; j < nbDistributions; ++j)
+      {
+        const double* cumProbs_j = &cumProbs[j * nbStates_];
+        // Numerical errors may let the last cumulative probability be slightly lower than 1:
+        size_t x = static_cast<size_t>(lower_bound(cumProbs_j, cumProbs_j + nbStates_, uniform(generator)) - cumProbs_j);
+        samples_b[j] = min(x, nbStates_ - 1);
+      }
+    }
+  });
+}
+
 Sequence* MarginalAncestralStateReconstruction::getAncestralSequenceForNode(int nodeId, VVdouble* probs, bool sample) const
 {
   string name = tree_.hasNodeName(nodeId) ? tree_.getNodeName(nodeId) : ("" + TextTools::toString(nodeId));
@@ -140,35 +254,6 @@ Sequence* MarginalAncestralStateReconstruction::getAncestralSequenceForNode(int
   return new BasicSequence(name, allStates, alphabet_);
 }
 
-void MarginalAncestralStateReconstruction::recursiveMarginalAncestralStates(
-  const Node* node,
-  map<int, vector<size_t> >& ancestors,
-  AlignedSequenceContainer& data) const
-{
-  if (node->isLeaf())
-  {
-    const Sequence& seq = data.getSequence(node->getName());
-    vector<size_t>* v = &ancestors[node->getId()];
-    v->resize(seq.size());
-    // This is a tricky way to store the real sequence as an ancestral one...
-    // In case of Markov Modulated models, we consider that the real sequences
-    // Are all in the first category.
-    const TransitionModel* model = likelihood_->getModelForSite(tree_.getNodesId()[0], 0); // We assume all nodes have a model with the same number of states.
-    for (size_t i = 0; i < seq.size(); i++)
-    {
-      (*v)[i] = model->getModelStates(seq[i])[0];
-    }
-  }
-  else
-  {
-    ancestors[node->getId()] = getAncestralStatesForNode(node->getId());
-    for (size_t i = 0; i < node->getNumberOfSons(); i++)
-    {
-      recursiveMarginalAncestralStates(node->getSon(i), ancestors, data);
-    }
-  }
-}
-
 AlignedSequenceContainer* MarginalAncestralStateReconstruction::getAncestralSequences(bool sample) const
 {
   AlignedSequenceContainer* asc = new AlignedSequenceContainer(alphabet_);
@@ -57,6 +57,12 @@ namespace bpp
 /**
  * @brief Likelihood ancestral states reconstruction: marginal method.
  *
+ * Posterior probabilities are computed from the double-recursive likelihood
+ * arrays, so that no tree traversal is needed once the likelihood has been
+ * computed. All inner nodes can be reconstructed in one pass with the
+ * getAllPosteriorProbabilities() method, which dispatches nodes over several
+ * threads (see setNumberOfThreads()).
+ *
  * Reference:
  * Z Yang, S Kumar and M Nei (1995), _Genetics_ 141(4) 1641-50.
  */
@@ -74,6 +80,7 @@ class MarginalAncestralStateReconstruction:
     std::vector<size_t> rootPatternLinks_;
     std::vector<double> r_;
     std::vector<double> l_;
+    unsigned int nbThreads_;
 		
 	public:
 		MarginalAncestralStateReconstruction(const DRTreeLikelihood* drl) :
@@ -86,7 +93,8 @@ class MarginalAncestralStateReconstruction:
 			nbStates_        (drl->getLikelihoodData()->getNumberOfStates()),
 			rootPatternLinks_(drl->getLikelihoodData()->getRootArrayPositions()),
       r_               (drl->getRateDistribution()->getProbabilities()),
-      l_               (drl->getLikelihoodData()->getRootRateSiteLikelihoodArray())
+      l_               (drl->getLikelihoodData()->getRootRateSiteLikelihoodArray()),
+      nbThreads_       (1)
     {}
 
     MarginalAncestralStateReconstruction(const MarginalAncestralStateReconstruction& masr) :
@@ -99,7 +107,8 @@ class MarginalAncestralStateReconstruction:
       nbStates_        (masr.nbStates_),
       rootPatternLinks_(masr.rootPatternLinks_),
       r_               (masr.r_),
-      l_               (masr.l_)
+      l_               (masr.l_),
+      nbThreads_       (masr.nbThreads_)
     {}
 
     MarginalAncestralStateReconstruction& operator=(const MarginalAncestralStateReconstruction& masr)
@@ -114,6 +123,7 @@ class MarginalAncestralStateReconstruction:
       rootPatternLinks_ = masr.rootPatternLinks_;
       r_                = masr.r_;
       l_                = masr.l_;
+      nbThreads_        = masr.nbThreads_;
       return *this;
     }
 
@@ -172,14 +182,63 @@ class MarginalAncestralStateReconstruction:
     }
 
     AlignedSequenceContainer * getAncestralSequences(bool sample) const;
-	
+
+    /**
+     * @brief Set the number of threads used for all-nodes computations.
+     *
+     * @param nbThreads The number of threads to use. 0 means as many as
+     * the hardware supports. Only the calling thread is used by default.
+     */
+    void setNumberOfThreads(unsigned int nbThreads) { nbThreads_ = nbThreads; }
+
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @brief Compute the posterior probabilities of all states, for all inner nodes, in one pass.
+     *
+     * The posterior probabilities are stored in a single contiguous buffer,
+     * indexed as [node][site][state]: the probability of state x at distinct
+     * site i for the kth node is stored at position
+     * (k * nbDistinctSites + i) * nbStates + x.
+     * Nodes are distributed over the available threads.
+     *
+     * @param nodeIds    [out] The ids of the inner nodes, in the order of the buffer.
+     * @param posteriors [out] The buffer of posterior probabilities.
+     */
+    void getAllPosteriorProbabilities(std::vector<int>& nodeIds, Vdouble& posteriors) const;
+
+    /**
+     * @brief Sample ancestral states for all inner nodes from their posterior distributions.
+     *
+     * Posterior probabilities are computed once for all replicates.
+     * Replicates are distributed over the available threads, each thread owning its own
+     * random number generator. The generator is seeded from the seed and the replicate index,
+     * so that results do not depend on the number of threads.
+     *
+     * @param nbReplicates The number of replicates to sample.
+     * @param seed         The seed for the random number generators.
+     * @param nodeIds      [out] The ids of the inner nodes, in the order of the buffer.
+     * @param samples      [out] The sampled states, as a contiguous buffer indexed as
+     * [replicate][node][site], with sites given as distinct site indices.
+     */
+    void sampleAllAncestralStates(
+        size_t nbReplicates,
+        unsigned int seed,
+        std::vector<int>& nodeIds,
+        std::vector<size_t>& samples) const;
+
   private:
-		void recursiveMarginalAncestralStates(
-			const Node* node,
-			std::map<int, std::vector<size_t> >& ancestors,
-			AlignedSequenceContainer& data) const;
+    /**
+     * @brief Compute posterior probabilities for the nodes in the range [begin, end[.
+     *
+     * A single likelihood array is used for all nodes in the range.
+     */
+    void computePosteriorProbabilities_(
+        const std::vector<int>& nodeIds,
+        size_t begin,
+        size_t end,
+        Vdouble& posteriors) const;
 
-		
 };
 
 } //end of namespace bpp.
@@ -216,50 +216,71 @@ double NNIHomogeneousTreeLikelihood::testNNI(int nodeId) const
   // const Node * uncle = grandFather->getSon(parentPosition > 1 ? parentPosition - 1 : 1 - parentPosition);
   const Node* uncle = grandFather->getSon(parentPosition > 1 ? 0 : 1 - parentPosition);
 
-  // Retrieving arrays of interest:
+  // Retrieving arrays of interest.
+  // No array is stored toward leaves, they are accounted for separately:
   const DRASDRTreeLikelihoodNodeData* parentData = &getLikelihoodData()->getNodeData(parent->getId());
-  const VVVdouble* sonArray   = &parentData->getLikelihoodArrayForNeighbor(son->getId());
   vector<const Node*> parentNeighbors = TreeTemplateTools::getRemainingNeighbors(parent, grandFather, son);
   size_t nbParentNeighbors = parentNeighbors.size();
-  vector<const VVVdouble*> parentArrays(nbParentNeighbors);
-  vector<const VVVdouble*> parentTProbs(nbParentNeighbors);
+  vector<const VVVdouble*> parentArrays;
+  vector<const VVVdouble*> parentTProbs;
+  vector<const Node*> parentLeaves;
   for (size_t k = 0; k < nbParentNeighbors; k++)
   {
     const Node* n = parentNeighbors[k]; // This neighbor
-    parentArrays[k] = &parentData->getLikelihoodArrayForNeighbor(n->getId());
-    // if(n != grandFather) parentTProbs[k] = & pxy_[n->getId()];
-    // else                 parentTProbs[k] = & pxy_[parent->getId()];
-    parentTProbs[k] = &pxy_[n->getId()];
+    if (n->isLeaf())
+    {
+      parentLeaves.push_back(n);
+    }
+    else
+    {
+      parentArrays.push_back(&parentData->getLikelihoodArrayForNeighbor(n->getId()));
+      parentTProbs.push_back(&pxy_.at(n->getId()).get());
+    }
   }
 
   const DRASDRTreeLikelihoodNodeData* grandFatherData = &getLikelihoodData()->getNodeData(grandFather->getId());
-  const VVVdouble* uncleArray      = &grandFatherData->getLikelihoodArrayForNeighbor(uncle->getId());
   vector<const Node*> grandFatherNeighbors = TreeTemplateTools::getRemainingNeighbors(grandFather, parent, uncle);
   size_t nbGrandFatherNeighbors = grandFatherNeighbors.size();
   vector<const VVVdouble*> grandFatherArrays;
   vector<const VVVdouble*> grandFatherTProbs;
+  vector<const Node*> grandFatherLeaves;
   for (size_t k = 0; k < nbGrandFatherNeighbors; k++)
   {
     const Node* n = grandFatherNeighbors[k]; // This neighbor
     if (grandFather->getFather() == NULL || n != grandFather->getFather())
     {
-      grandFatherArrays.push_back(&grandFatherData->getLikelihoodArrayForNeighbor(n->getId()));
-      grandFatherTProbs.push_back(&pxy_[n->getId()]);
+      if (n->isLeaf())
+      {
+        grandFatherLeaves.push_back(n);
+      }
+      else
+      {
+        grandFatherArrays.push_back(&grandFatherData->getLikelihoodArrayForNeighbor(n->getId()));
+        grandFatherTProbs.push_back(&pxy_.at(n->getId()).get());
+      }
     }
   }
 
   // Compute array 1: grand father array
-  VVVdouble array1 = *sonArray;
+  VVVdouble array1 = getLikelihoodData()->getRootLikelihoodArray();
   resetLikelihoodArray(array1);
-  grandFatherArrays.push_back(sonArray);
-  grandFatherTProbs.push_back(&pxy_[son->getId()]);
+  if (son->isLeaf())
+  {
+    grandFatherLeaves.push_back(son);
+  }
+  else
+  {
+    grandFatherArrays.push_back(&parentData->getLikelihoodArrayForNeighbor(son->getId()));
+    grandFatherTProbs.push_back(&pxy_.at(son->getId()).get());
+  }
+  computeLikelihoodFromLeaves_(grandFatherLeaves, array1);
   if (grandFather->hasFather())
   {
-    computeLikelihoodFromArrays(grandFatherArrays, grandFatherTProbs, &grandFatherData->getLikelihoodArrayForNeighbor(grandFather->getFather()->getId()), &pxy_[grandFather->getId()], array1, nbGrandFatherNeighbors, nbDistinctSites_, nbClasses_, nbStates_, false);
+    computeLikelihoodFromArrays(grandFatherArrays, grandFatherTProbs, &grandFatherData->getLikelihoodArrayForNeighbor(grandFather->getFather()->getId()), &pxy_.at(grandFather->getId()).get(), array1, grandFatherArrays.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
   }
   else
   {
-    computeLikelihoodFromArrays(grandFatherArrays, grandFatherTProbs, array1, nbGrandFatherNeighbors + 1, nbDistinctSites_, nbClasses_, nbStates_, false);
+    computeLikelihoodFromArrays(grandFatherArrays, grandFatherTProbs, array1, grandFatherArrays.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
 
     // This is the root node, we have to account for the ancestral frequencies:
     for (size_t i = 0; i < nbDistinctSites_; i++)
@@ -275,11 +296,19 @@ double NNIHomogeneousTreeLikelihood::testNNI(int nodeId) const
   }
 
   // Compute array 2: parent array
-  VVVdouble array2 = *uncleArray;
+  VVVdouble array2 = getLikelihoodData()->getRootLikelihoodArray();
   resetLikelihoodArray(array2);
-  parentArrays.push_back(uncleArray);
-  parentTProbs.push_back(&pxy_[uncle->getId()]);
-  computeLikelihoodFromArrays(parentArrays, parentTProbs, array2, nbParentNeighbors + 1, nbDistinctSites_, nbClasses_, nbStates_, false);
+  if (uncle->isLeaf())
+  {
+    parentLeaves.push_back(uncle);
+  }
+  else
+  {
+    parentArrays.push_back(&grandFatherData->getLikelihoodArrayForNeighbor(uncle->getId()));
+    parentTProbs.push_back(&pxy_.at(uncle->getId()).get());
+  }
+  computeLikelihoodFromLeaves_(parentLeaves, array2);
+  computeLikelihoodFromArrays(parentArrays, parentTProbs, array2, parentArrays.size(), nbDistinctSites_, nbClasses_, nbStates_, false);
 
   // Initialize BranchLikelihood:
   brLikFunction_->initModel(model_, rateDistribution_);
@@ -327,6 +356,7 @@ void NNIHomogeneousTreeLikelihood::doNNI(int nodeId)
   grandFather->removeSon(uncle);
   parent->addSon(uncle);
   grandFather->addSon(son);
+  tree_->invalidateTraversals();
   size_t pos = 0;
   while (pos < nodes_.size() && nodes_[pos]->getId() != parent->getId()) pos++;
   if (pos == nodes_.size()) throw Exception("NNIHomogeneousTreeLikelihood::doNNI. Unvalid node id.");
@@ -139,6 +139,8 @@ public:
     array2_ = 0;
   }
 
+  void setWeights(const std::vector<unsigned int>& weights) { weights_ = weights; }
+
   void setParameters(const ParameterList& parameters)
   {
     setParametersValues(parameters);
@@ -237,6 +239,12 @@ public:
     brLikFunction_ = new BranchLikelihood(getLikelihoodData()->getWeights());
   }
 
+  void setPatternWeights(const std::vector<unsigned int>& weights)
+  {
+    DRHomogeneousTreeLikelihood::setPatternWeights(weights);
+    brLikFunction_->setWeights(weights);
+  }
+
   /**
    * @name The NNISearchable interface.
    *
@@ -121,6 +121,28 @@ void PairedSiteLikelihoods::appendModels(const PairedSiteLikelihoods& psl)
 }
 
 
+vector<double> PairedSiteLikelihoods::getReplicateLogLikelihoods(const vector<int>& siteCounts) const
+{
+  if (getNumberOfModels() > 0 && siteCounts.size() != getNumberOfSites())
+    throw Exception("PairedSiteLikelihoods::getReplicateLogLikelihoods: The number of site counts does not match the number of sites.");
+
+  vector<double> models_logliks(getNumberOfModels(), 0);
+  for (size_t m = 0; m < getNumberOfModels(); ++m)
+  {
+    const vector<double>& modelSiteLLiks = logLikelihoods_[m];
+    double Y = 0;
+    for (size_t s = 0; s < siteCounts.size(); ++s)
+    {
+      // Sites absent from the replicate are skipped, so that a site with
+      // infinite log-likelihood does not give NaN:
+      if (siteCounts[s] != 0)
+        Y += modelSiteLLiks[s] * siteCounts[s];
+    }
+    models_logliks[m] = Y;
+  }
+  return models_logliks;
+}
+
 pair<vector<string>, vector<double> > PairedSiteLikelihoods::computeExpectedLikelihoodWeights (int replicates) const
 {
   // Initialize the weights
@@ -133,17 +155,7 @@ pair<vector<string>, vector<double> > PairedSiteLikelihoods::computeExpectedLike
     vector<int> siteCounts = bootstrap(getNumberOfSites());
 
     // Compute the loglikelihood of each model for this replicate
-    vector<double> models_logliks (getNumberOfModels(), 0);
-    for (size_t m = 0; m < getNumberOfModels(); ++m)
-    {
-      const vector<double>& modelSiteLLiks = logLikelihoods_.at(m);
-      double Y = 0;
-      for (size_t s = 0; s < getNumberOfSites(); ++s)
-      {
-        Y += modelSiteLLiks.at(s) * siteCounts.at(s);
-      }
-      models_logliks.at(m) = Y;
-    }
+    vector<double> models_logliks = getReplicateLogLikelihoods(siteCounts);
 
     // Get the best loglikelihood
     double Ymax = *max_element(models_logliks.begin(), models_logliks.end());
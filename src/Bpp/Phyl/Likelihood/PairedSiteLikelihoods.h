@@ -161,6 +161,17 @@ public:
     modelNames_.at(pos) = name;
   }
 
+  /**
+   * @brief Compute the log-likelihood of each model for a pseudoreplicate,
+   * by resampling site log-likelihoods (RELL).
+   *
+   * @param siteCounts The number of times each site is present in the replicate,
+   * as given by bootstrap().
+   * @return The log-likelihood of each model.
+   * @throw Exception If the number of counts does not match the number of sites.
+   */
+  std::vector<double> getReplicateLogLikelihoods(const std::vector<int>& siteCounts) const;
+
   /**
    * @brief Compute the Expected Likelihood Weights of the models.
    *
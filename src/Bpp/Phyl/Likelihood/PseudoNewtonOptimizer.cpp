@@ -75,7 +75,8 @@ PseudoNewtonOptimizer::PseudoNewtonOptimizer(DerivableSecondOrder* function) :
   n_(0),
   params_(),
   maxCorrection_(10),
-  useCG_(true)
+  useCG_(true),
+  brLenIndices_()
 {
   setDefaultStopCondition_(new FunctionStopCondition(this));
   setStopCondition(*getDefaultStopCondition());
@@ -87,6 +88,15 @@ void PseudoNewtonOptimizer::doInit(const ParameterList& params)
 {
   n_ = getParameters().size();
   params_ = getParameters().getParameterNames();
+  brLenIndices_.assign(n_, -1);
+  if (dynamic_cast<const DRTreeLikelihood*>(getFunction()))
+  {
+    for (size_t i = 0; i < n_; i++)
+    {
+      if (params_[i].substr(0, 5) == "BrLen" && params_[i] != "BrLenRoot")
+        brLenIndices_[i] = TextTools::to<int>(params_[i].substr(5));
+    }
+  }
   getFunction()->enableSecondOrderDerivatives(true);
   getFunction()->setParameters(getParameters());
 }
@@ -101,10 +111,23 @@ double PseudoNewtonOptimizer::doStep()
   // Compute derivative at current point:
   std::vector<double> movements(n_);
   ParameterList newPoint = getParameters();
+  Vdouble brLenD1, brLenD2;
+  const DRTreeLikelihood* drtl = dynamic_cast<const DRTreeLikelihood*>(getFunction());
+  if (drtl)
+    drtl->getBranchLengthsDerivatives(brLenD1, brLenD2);
   for (size_t i = 0; i < n_; i++)
   {
-    double  firstOrderDerivative = getFunction()->getFirstOrderDerivative(params_[i]);
-    double secondOrderDerivative = getFunction()->getSecondOrderDerivative(params_[i]);
+    double firstOrderDerivative, secondOrderDerivative;
+    if (drtl && brLenIndices_[i] >= 0)
+    {
+      firstOrderDerivative  = brLenD1[static_cast<size_t>(brLenIndices_[i])];
+      secondOrderDerivative = brLenD2[static_cast<size_t>(brLenIndices_[i])];
+    }
+    else
+    {
+      firstOrderDerivative  = getFunction()->getFirstOrderDerivative(params_[i]);
+      secondOrderDerivative = getFunction()->getSecondOrderDerivative(params_[i]);
+    }
     if (secondOrderDerivative == 0)
     {
       movements[i] = 0;
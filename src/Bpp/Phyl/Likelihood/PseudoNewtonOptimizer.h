@@ -54,6 +54,9 @@ namespace bpp
    * algorithm.
    * Felsenstein and Churchill's (1996) correction is applied when new trial as a likelihood
    * lower than the starting point.
+   *
+   * If the function is a DRTreeLikelihood, derivatives with respect to branch lengths are
+   * retrieved at once at each step, using DRTreeLikelihood::getBranchLengthsDerivatives().
    */
   class PseudoNewtonOptimizer:
     public AbstractOptimizer
@@ -90,6 +93,11 @@ namespace bpp
 
     bool useCG_;
 
+    /**
+     * @brief For each parameter, the index of the corresponding branch, or -1 if derivatives must be obtained by name.
+     */
+    std::vector<int> brLenIndices_;
+
   public:
 
     PseudoNewtonOptimizer(DerivableSecondOrder* function);
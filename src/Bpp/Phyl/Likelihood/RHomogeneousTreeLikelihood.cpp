@@ -391,12 +391,12 @@ void RHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variable)
   {
     const Node* son = father->getSon(l);
 
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     if (son == branch)
     {
-      VVVdouble* dpxy__son = &dpxy_[son->getId()];
+      const VVVdouble* dpxy__son = &dpxy_.at(son->getId()).get();
       for (size_t i = 0; i < nbSites; i++)
       {
         VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[(*_patternLinks_father_son)[i]];
@@ -405,11 +405,11 @@ void RHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variable)
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _dLikelihoods_father_i_c = &(*_dLikelihoods_father_i)[c];
-          VVdouble* dpxy__son_c = &(*dpxy__son)[c];
+          const VVdouble* dpxy__son_c = &(*dpxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double dl = 0;
-            Vdouble* dpxy__son_c_x = &(*dpxy__son_c)[x];
+            const Vdouble* dpxy__son_c_x = &(*dpxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               dl += (*dpxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -421,7 +421,7 @@ void RHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variable)
     }
     else
     {
-      VVVdouble* pxy__son = &pxy_[son->getId()];
+      const VVVdouble* pxy__son = &pxy_.at(son->getId()).get();
       for (size_t i = 0; i < nbSites; i++)
       {
         VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[(*_patternLinks_father_son)[i]];
@@ -430,11 +430,11 @@ void RHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variable)
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _dLikelihoods_father_i_c = &(*_dLikelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double dl = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               dl += (*pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -481,8 +481,8 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeDLikelihood(const Node* node)
   {
     const Node* son = father->getSon(l);
 
-    VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const VVVdouble* pxy__son = &pxy_.at(son->getId()).get();
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
 
     if (son == node)
     {
@@ -495,11 +495,11 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeDLikelihood(const Node* node)
         {
           Vdouble* _dLikelihoods_son_i_c = &(*_dLikelihoods_son_i)[c];
           Vdouble* _dLikelihoods_father_i_c = &(*_dLikelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double dl = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               dl += (*pxy__son_c_x)[y] * (*_dLikelihoods_son_i_c)[y];
@@ -520,11 +520,11 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeDLikelihood(const Node* node)
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _dLikelihoods_father_i_c = &(*_dLikelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double dl = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               dl += (*pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -641,12 +641,12 @@ void RHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variable)
   {
     const Node* son = father->getSon(l);
 
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     if (son == branch)
     {
-      VVVdouble* d2pxy__son = &d2pxy_[son->getId()];
+      const VVVdouble* d2pxy__son = &d2pxy_.at(son->getId()).get();
       for (size_t i = 0; i < nbSites; i++)
       {
         VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[(*_patternLinks_father_son)[i]];
@@ -655,11 +655,11 @@ void RHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variable)
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _d2Likelihoods_father_i_c = &(*_d2Likelihoods_father_i)[c];
-          VVdouble* d2pxy__son_c = &(*d2pxy__son)[c];
+          const VVdouble* d2pxy__son_c = &(*d2pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double d2l = 0;
-            Vdouble* d2pxy__son_c_x = &(*d2pxy__son_c)[x];
+            const Vdouble* d2pxy__son_c_x = &(*d2pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               d2l += (*d2pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -671,7 +671,7 @@ void RHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variable)
     }
     else
     {
-      VVVdouble* pxy__son = &pxy_[son->getId()];
+      const VVVdouble* pxy__son = &pxy_.at(son->getId()).get();
       for (size_t i = 0; i < nbSites; i++)
       {
         VVdouble* _likelihoods_son_i = &(*_likelihoods_son)[(*_patternLinks_father_son)[i]];
@@ -680,11 +680,11 @@ void RHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variable)
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _d2Likelihoods_father_i_c = &(*_d2Likelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double d2l = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               d2l += (*pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -731,8 +731,8 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeD2Likelihood(const Node* node
   {
     const Node* son = father->getSon(l);
 
-    VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const VVVdouble* pxy__son = &pxy_.at(son->getId()).get();
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
 
     if (son == node)
     {
@@ -745,11 +745,11 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeD2Likelihood(const Node* node
         {
           Vdouble* _d2Likelihoods_son_i_c = &(*_d2Likelihoods_son_i)[c];
           Vdouble* _d2Likelihoods_father_i_c = &(*_d2Likelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double d2l = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               d2l += (*pxy__son_c_x)[y] * (*_d2Likelihoods_son_i_c)[y];
@@ -770,11 +770,11 @@ void RHomogeneousTreeLikelihood::computeDownSubtreeD2Likelihood(const Node* node
         {
           Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
           Vdouble* _d2Likelihoods_father_i_c = &(*_d2Likelihoods_father_i)[c];
-          VVdouble* pxy__son_c = &(*pxy__son)[c];
+          const VVdouble* pxy__son_c = &(*pxy__son)[c];
           for (size_t x = 0; x < nbStates_; x++)
           {
             double dl = 0;
-            Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+            const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
             for (size_t y = 0; y < nbStates_; y++)
             {
               dl += (*pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -832,8 +832,8 @@ void RHomogeneousTreeLikelihood::computeSubtreeLikelihood(const Node* node)
 
     computeSubtreeLikelihood(son); //Recursive method:
 
-    VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_node_son = &likelihoodData_->getArrayPositions(node->getId(), son->getId());
+    const VVVdouble* pxy__son = &pxy_.at(son->getId()).get();
+    const vector<size_t>* _patternLinks_node_son = &likelihoodData_->getArrayPositions(node->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     for (size_t i = 0; i < nbSites; i++)
@@ -846,11 +846,11 @@ void RHomogeneousTreeLikelihood::computeSubtreeLikelihood(const Node* node)
         //For each rate classe,
         Vdouble* _likelihoods_son_i_c = &(*_likelihoods_son_i)[c];
         Vdouble* _likelihoods_node_i_c = &(*_likelihoods_node_i)[c];
-        VVdouble* pxy__son_c = &(*pxy__son)[c];
+        const VVdouble* pxy__son_c = &(*pxy__son)[c];
         for (size_t x = 0; x < nbStates_; x++)
         {
           //For each initial state,
-          Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
+          const Vdouble* pxy__son_c_x = &(*pxy__son_c)[x];
           double likelihood = 0;
           for (size_t y = 0; y < nbStates_; y++)
             likelihood += (*pxy__son_c_x)[y] * (*_likelihoods_son_i_c)[y];
@@ -420,8 +420,8 @@ void RNonHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variabl
       {
         const Node* root1 = father->getSon(0);
         const Node* root2 = father->getSon(1);
-        vector<size_t> * _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
-        vector<size_t> * _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
+        const vector<size_t>* _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
+        const vector<size_t>* _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
         VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(root1->getId());
         VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(root2->getId());
         double pos = getParameterValue("RootPosition");
@@ -471,7 +471,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variabl
       else
       {
         //Account for a putative multifurcation:
-        vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+        const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
         VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
@@ -530,8 +530,8 @@ void RNonHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variabl
       {
         const Node* root1 = father->getSon(0);
         const Node* root2 = father->getSon(1);
-        vector<size_t> * _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
-        vector<size_t> * _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
+        const vector<size_t>* _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
+        const vector<size_t>* _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
         VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(root1->getId());
         VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(root2->getId());
         double len = getParameterValue("BrLenRoot");
@@ -581,7 +581,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variabl
       else
       {
         //Account for a putative multifurcation:
-        vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+        const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
         VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
@@ -638,7 +638,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeDLikelihood(const string& variabl
   {
     const Node* son = father->getSon(l);
 
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     if (son == branch)
@@ -729,7 +729,7 @@ void RNonHomogeneousTreeLikelihood::computeDownSubtreeDLikelihood(const Node* no
     const Node* son = father->getSon(l);
 
     VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
 
     if (son == node)
     {
@@ -891,8 +891,8 @@ void RNonHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variab
       {
         const Node* root1 = father->getSon(0);
         const Node* root2 = father->getSon(1);
-        vector<size_t> * _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
-        vector<size_t> * _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
+        const vector<size_t>* _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
+        const vector<size_t>* _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
         VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(root1->getId());
         VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(root2->getId());
         double pos = getParameterValue("RootPosition");
@@ -950,7 +950,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variab
       else
       {
         //Account for a putative multifurcation:
-        vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+        const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
         VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
@@ -1009,8 +1009,8 @@ void RNonHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variab
       {
         const Node* root1 = father->getSon(0);
         const Node* root2 = father->getSon(1);
-        vector<size_t> * _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
-        vector<size_t> * _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
+        const vector<size_t>* _patternLinks_fatherroot1_ = &likelihoodData_->getArrayPositions(father->getId(), root1->getId());
+        const vector<size_t>* _patternLinks_fatherroot2_ = &likelihoodData_->getArrayPositions(father->getId(), root2->getId());
         VVVdouble* _likelihoodsroot1_ = &likelihoodData_->getLikelihoodArray(root1->getId());
         VVVdouble* _likelihoodsroot2_ = &likelihoodData_->getLikelihoodArray(root2->getId());
         double len = getParameterValue("BrLenRoot");
@@ -1068,7 +1068,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variab
       else
       {
         //Account for a putative multifurcation:
-        vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+        const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
         VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
         VVVdouble* pxy__son = &pxy_[son->getId()];
@@ -1125,7 +1125,7 @@ void RNonHomogeneousTreeLikelihood::computeTreeD2Likelihood(const string& variab
   {
     const Node* son = father->getSon(l);
 
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     if (son == branch)
@@ -1216,7 +1216,7 @@ void RNonHomogeneousTreeLikelihood::computeDownSubtreeD2Likelihood(const Node* n
     const Node* son = father->getSon(l);
 
     VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
+    const vector<size_t>* _patternLinks_father_son = &likelihoodData_->getArrayPositions(father->getId(), son->getId());
 
     if (son == node)
     {
@@ -1317,7 +1317,7 @@ void RNonHomogeneousTreeLikelihood::computeSubtreeLikelihood(const Node* node)
     computeSubtreeLikelihood(son); //Recursive method:
 
     VVVdouble* pxy__son = &pxy_[son->getId()];
-    vector<size_t> * _patternLinks_node_son = &likelihoodData_->getArrayPositions(node->getId(), son->getId());
+    const vector<size_t>* _patternLinks_node_son = &likelihoodData_->getArrayPositions(node->getId(), son->getId());
     VVVdouble* _likelihoods_son = &likelihoodData_->getLikelihoodArray(son->getId());
 
     for (size_t i = 0; i < nbSites; i++)
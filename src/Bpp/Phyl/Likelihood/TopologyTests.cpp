@@ -0,0 +1,330 @@
+//
+// File: TopologyTests.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "TopologyTests.h"
+#include "../ParallelTools.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Numeric/NumConstants.h>
+#include <Bpp/Numeric/Random/RandomTools.h>
+
+// From the STL:
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+
+using namespace bpp;
+using namespace std;
+
+namespace
+{
+
+/**
+ * @brief Number of replicates evaluated together, sharing each tile of the log-likelihood matrix.
+ */
+const size_t REPLICATE_BLOCK = 16;
+
+/**
+ * @brief Number of columns in a tile, chosen so that a tile of counts for a block of replicates stays in cache.
+ */
+const size_t COLUMN_TILE = 1024;
+
+}
+
+/******************************************************************************/
+
+TopologyTests::TopologyTests(const PairedSiteLikelihoods& psl, unsigned int nbThreads) :
+  modelNames_(psl.getModelNames()),
+  observed_(),
+  nbSites_(0),
+  nbColumns_(0),
+  logLikelihoods_(),
+  siteColumns_(),
+  nbReplicates_(10000),
+  scales_(),
+  nbThreads_(nbThreads),
+  bp_(),
+  kh_(),
+  sh_(),
+  au_(),
+  scaledBp_()
+{
+  if (psl.getNumberOfModels() < 2)
+    throw Exception("TopologyTests. At least two models are needed.");
+  for (size_t k = 0; k < 10; ++k)
+  {
+    scales_.push_back(0.5 + 0.1 * static_cast<double>(k));
+  }
+
+  // Merge sites with the same log-likelihoods under all models:
+  const vector< vector<double> >& ll = psl.getLikelihoods();
+  size_t nbModels = ll.size();
+  nbSites_ = psl.getNumberOfSites();
+  observed_.assign(nbModels, 0);
+  siteColumns_.resize(nbSites_);
+  map<vector<double>, size_t> columns;
+  vector<size_t> firstSites;
+  vector<double> column(nbModels);
+  for (size_t s = 0; s < nbSites_; ++s)
+  {
+    for (size_t m = 0; m < nbModels; ++m)
+    {
+      column[m] = ll[m][s];
+      observed_[m] += ll[m][s];
+    }
+    pair<map<vector<double>, size_t>::iterator, bool> ins = columns.insert(make_pair(column, firstSites.size()));
+    if (ins.second)
+      firstSites.push_back(s);
+    siteColumns_[s] = ins.first->second;
+  }
+  nbColumns_ = firstSites.size();
+  logLikelihoods_.resize(nbModels * nbColumns_);
+  for (size_t m = 0; m < nbModels; ++m)
+  {
+    for (size_t c = 0; c < nbColumns_; ++c)
+    {
+      logLikelihoods_[m * nbColumns_ + c] = ll[m][firstSites[c]];
+    }
+  }
+}
+
+/******************************************************************************/
+
+void TopologyTests::setScales(const std::vector<double>& scales)
+{
+  bool hasOne = false;
+  for (size_t k = 0; k < scales.size(); ++k)
+  {
+    if (scales[k] <= 0)
+      throw Exception("TopologyTests::setScales. Scales must be positive.");
+    if (abs(scales[k] - 1.) < 1e-9)
+      hasOne = true;
+  }
+  scales_ = scales;
+  if (!hasOne)
+    scales_.push_back(1.);
+  sort(scales_.begin(), scales_.end());
+}
+
+/******************************************************************************/
+
+void TopologyTests::computeWeightedSums(
+  const double* logLikelihoods, size_t nbModels, size_t nbColumns,
+  const double* counts, size_t nbReplicates,
+  double* sums)
+{
+  fill(sums, sums + nbReplicates * nbModels, 0.);
+  // The matrix is traversed by tiles of columns, each tile of a model row
+  // being used for all replicates while it is in cache:
+  for (size_t c0 = 0; c0 < nbColumns; c0 += COLUMN_TILE)
+  {
+    size_t c1 = min(c0 + COLUMN_TILE, nbColumns);
+    for (size_t m = 0; m < nbModels; ++m)
+    {
+      const double* row = logLikelihoods + m * nbColumns;
+      for (size_t b = 0; b < nbReplicates; ++b)
+      {
+        const double* w = counts + b * nbColumns;
+        // Independent partial sums, which can be computed simultaneously:
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        size_t c = c0;
+        for ( ; c + 4 <= c1; c += 4)
+        {
+          s0 += row[c] * w[c];
+          s1 += row[c + 1] * w[c + 1];
+          s2 += row[c + 2] * w[c + 2];
+          s3 += row[c + 3] * w[c + 3];
+        }
+        for ( ; c < c1; ++c)
+        {
+          s0 += row[c] * w[c];
+        }
+        sums[b * nbModels + m] += (s0 + s1) + (s2 + s3);
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+void TopologyTests::runScale_(double scale, const std::vector<unsigned int>& seeds, std::vector<size_t>& best, std::vector<double>* sums) const
+{
+  size_t nbModels = modelNames_.size();
+  size_t nbDraws = static_cast<size_t>(scale * static_cast<double>(nbSites_) + 0.5);
+  size_t nbBlocks = (seeds.size() + REPLICATE_BLOCK - 1) / REPLICATE_BLOCK;
+  best.assign(seeds.size(), 0);
+  if (sums)
+    sums->assign(seeds.size() * nbModels, 0.);
+
+  ParallelTools::runInParallel(nbBlocks, nbThreads_, [&](size_t begin, size_t end)
+  {
+    vector<double> counts(REPLICATE_BLOCK * nbColumns_);
+    vector<double> blockSums(REPLICATE_BLOCK * nbModels);
+    for (size_t k = begin; k < end; ++k)
+    {
+      size_t b0 = k * REPLICATE_BLOCK;
+      size_t nb = min(REPLICATE_BLOCK, seeds.size() - b0);
+      fill(counts.begin(), counts.end(), 0.);
+      for (size_t b = 0; b < nb; ++b)
+      {
+        mt19937 generator(seeds[b0 + b]);
+        uniform_int_distribution<size_t> site(0, nbSites_ - 1);
+        double* w = &counts[b * nbColumns_];
+        for (size_t i = 0; i < nbDraws; ++i)
+        {
+          w[siteColumns_[site(generator)]]++;
+        }
+      }
+      computeWeightedSums(&logLikelihoods_[0], nbModels, nbColumns_, &counts[0], nb, &blockSums[0]);
+      for (size_t b = 0; b < nb; ++b)
+      {
+        const double* s = &blockSums[b * nbModels];
+        best[b0 + b] = static_cast<size_t>(max_element(s, s + nbModels) - s);
+        if (sums)
+          copy(s, s + nbModels, sums->begin() + static_cast<ptrdiff_t>((b0 + b) * nbModels));
+      }
+    }
+  });
+}
+
+/******************************************************************************/
+
+void TopologyTests::run()
+{
+  if (nbReplicates_ == 0)
+    throw Exception("TopologyTests::run. The number of replicates must be positive.");
+  size_t nbModels = modelNames_.size();
+  double nbReplicates = static_cast<double>(nbReplicates_);
+
+  vector< vector<unsigned int> > seeds(scales_.size(), vector<unsigned int>(nbReplicates_));
+  for (size_t k = 0; k < scales_.size(); ++k)
+  {
+    for (size_t b = 0; b < nbReplicates_; ++b)
+    {
+      seeds[k][b] = RandomTools::giveIntRandomNumberBetweenZeroAndEntry<unsigned int>(numeric_limits<unsigned int>::max());
+    }
+  }
+
+  scaledBp_.assign(scales_.size(), vector<double>(nbModels, 0.));
+  vector<double> sums;
+  vector<size_t> best;
+  for (size_t k = 0; k < scales_.size(); ++k)
+  {
+    bool unit = abs(scales_[k] - 1.) < 1e-9;
+    runScale_(scales_[k], seeds[k], best, unit ? &sums : 0);
+    for (size_t b = 0; b < nbReplicates_; ++b)
+    {
+      scaledBp_[k][best[b]] += 1.;
+    }
+    for (size_t m = 0; m < nbModels; ++m)
+    {
+      scaledBp_[k][m] /= nbReplicates;
+    }
+    if (unit)
+      bp_ = scaledBp_[k];
+  }
+
+  // KH and SH tests, on the centered log-likelihoods of the replicates at scale 1:
+  size_t mBest = static_cast<size_t>(max_element(observed_.begin(), observed_.end()) - observed_.begin());
+  double lMax = observed_[mBest];
+  kh_.assign(nbModels, 0.);
+  sh_.assign(nbModels, 0.);
+  vector<double> r(nbModels);
+  for (size_t b = 0; b < nbReplicates_; ++b)
+  {
+    for (size_t m = 0; m < nbModels; ++m)
+    {
+      r[m] = sums[b * nbModels + m] - observed_[m];
+    }
+    double rMax = *max_element(r.begin(), r.end());
+    for (size_t m = 0; m < nbModels; ++m)
+    {
+      double delta = lMax - observed_[m];
+      if (r[mBest] - r[m] >= delta)
+        kh_[m]++;
+      if (rMax - r[m] >= delta)
+        sh_[m]++;
+    }
+  }
+  au_.resize(nbModels);
+  for (size_t m = 0; m < nbModels; ++m)
+  {
+    kh_[m] /= nbReplicates;
+    sh_[m] /= nbReplicates;
+    au_[m] = fitAU_(m, bp_[m]);
+  }
+}
+
+/******************************************************************************/
+
+double TopologyTests::fitAU_(size_t model, double bp) const
+{
+  // Weighted least squares fit of z = v * a + c * b, with a = sqrt(r) and b = 1 / sqrt(r),
+  // each scale being weighted by the inverse of the variance of z:
+  double saa = 0, sbb = 0, sab = 0, saz = 0, sbz = 0;
+  size_t nbUsed = 0;
+  for (size_t k = 0; k < scales_.size(); ++k)
+  {
+    double p = scaledBp_[k][model];
+    if (p <= 0. || p >= 1.)
+      continue;
+    double z = RandomTools::qNorm(1. - p);
+    double phi = exp(-z * z / 2.) / sqrt(2. * NumConstants::PI());
+    double w = static_cast<double>(nbReplicates_) * phi * phi / (p * (1. - p));
+    double a = sqrt(scales_[k]);
+    double b = 1. / a;
+    saa += w * a * a;
+    sbb += w * b * b;
+    sab += w * a * b;
+    saz += w * a * z;
+    sbz += w * b * z;
+    nbUsed++;
+  }
+  double det = saa * sbb - sab * sab;
+  if (nbUsed < 2 || det <= 0.)
+    return bp;
+  double v = (saz * sbb - sbz * sab) / det;
+  double c = (saa * sbz - sab * saz) / det;
+  return 1. - RandomTools::pNorm(v - c);
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,205 @@
+//
+// File: TopologyTests.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _TOPOLOGYTESTS_H_
+#define _TOPOLOGYTESTS_H_
+
+#include "PairedSiteLikelihoods.h"
+
+// From the STL:
+#include <vector>
+#include <string>
+
+namespace bpp
+{
+
+/**
+ * @brief KH, SH and AU tests of several trees (or models), using RELL bootstrap replicates.
+ *
+ * Replicates are obtained by resampling the site log-likelihoods of a PairedSiteLikelihoods
+ * object (RELL), so that no likelihood is recomputed. Sites whose log-likelihoods are identical
+ * under all models are merged, and all log-likelihoods are stored as a contiguous [model][site]
+ * matrix. The log-likelihoods of a block of replicates are then obtained as a product of this
+ * matrix with the matrix of site counts, computed by tiles of sites, in a pool of threads.
+ *
+ * The following tests are available, for each model:
+ * - BP: the bootstrap probability, i.e. the proportion of replicates where the model has the highest likelihood,
+ * - KH: the one-sided Kishino-Hasegawa test against the best model,
+ * - SH: the Shimodaira-Hasegawa test,
+ * - AU: the approximately unbiased test of Shimodaira (2002).
+ *
+ * The AU test uses a multiscale bootstrap: for each scale r, replicates contain r times as many sites
+ * as the original data, and the bootstrap probabilities BP(r) are fitted by weighted least squares as
+ * @f[ \Phi^{-1}(1 - BP(r)) = v \sqrt{r} + c / \sqrt{r}, @f]
+ * the p-value being @f$ 1 - \Phi(v - c) @f$.
+ * BP, KH and SH are computed on the replicates at scale 1.
+ *
+ * All random seeds are drawn from the global generator when run() is called, so that results
+ * do not depend on the number of threads.
+ *
+ * References:
+ * - Kishino H. and Hasegawa M. (1989), J. Mol. Evol. 29:170-179.
+ * - Shimodaira H. and Hasegawa M. (1999), Mol. Biol. Evol. 16:1114-1116.
+ * - Shimodaira H. (2002), Syst. Biol. 51:492-508.
+ */
+class TopologyTests
+{
+  private:
+    std::vector<std::string> modelNames_;
+    std::vector<double> observed_;
+    size_t nbSites_;
+    size_t nbColumns_;
+    /**
+     * @brief Log-likelihoods of each distinct site, as a [model][column] matrix.
+     */
+    std::vector<double> logLikelihoods_;
+    /**
+     * @brief The column of each site.
+     */
+    std::vector<size_t> siteColumns_;
+    unsigned int nbReplicates_;
+    std::vector<double> scales_;
+    unsigned int nbThreads_;
+    std::vector<double> bp_;
+    std::vector<double> kh_;
+    std::vector<double> sh_;
+    std::vector<double> au_;
+    std::vector< std::vector<double> > scaledBp_;
+
+  public:
+    /**
+     * @brief Build a new test engine.
+     *
+     * @param psl       The site log-likelihoods of all models. It is copied.
+     * @param nbThreads The number of threads to use. 0 means as many as the hardware supports.
+     * Replicates are computed in the calling thread by default.
+     * @throw Exception If there are less than two models.
+     */
+    TopologyTests(const PairedSiteLikelihoods& psl, unsigned int nbThreads = 1);
+
+    virtual ~TopologyTests() {}
+
+  public:
+    /**
+     * @brief Set the number of replicates for each scale (10000 by default).
+     */
+    void setNumberOfReplicates(unsigned int nbReplicates) { nbReplicates_ = nbReplicates; }
+
+    /**
+     * @brief Set the scales of the multiscale bootstrap.
+     *
+     * The default is 0.5, 0.6, ..., 1.4, as in CONSEL. Scale 1 is added if missing.
+     *
+     * @throw Exception If a scale is not positive.
+     */
+    void setScales(const std::vector<double>& scales);
+
+    const std::vector<double>& getScales() const { return scales_; }
+
+    /**
+     * @brief Draw the replicates and compute all tests.
+     */
+    void run();
+
+    size_t getNumberOfModels() const { return modelNames_.size(); }
+
+    const std::vector<std::string>& getModelNames() const { return modelNames_; }
+
+    /**
+     * @return The log-likelihood of each model on the original data.
+     */
+    const std::vector<double>& getObservedLogLikelihoods() const { return observed_; }
+
+    /**
+     * @return The number of distinct sites, i.e. the number of columns of the log-likelihood matrix.
+     */
+    size_t getNumberOfDistinctSites() const { return nbColumns_; }
+
+    /**
+     * @name Results of the last run, for each model.
+     *
+     * @{
+     */
+    const std::vector<double>& getBPValues() const { return bp_; }
+    const std::vector<double>& getKHPValues() const { return kh_; }
+    const std::vector<double>& getSHPValues() const { return sh_; }
+    const std::vector<double>& getAUPValues() const { return au_; }
+
+    /**
+     * @return The bootstrap probabilities at each scale, as a [scale][model] array.
+     */
+    const std::vector< std::vector<double> >& getScaledBPValues() const { return scaledBp_; }
+    /** @} */
+
+    /**
+     * @brief Compute the log-likelihoods of all models for several replicates.
+     *
+     * @param logLikelihoods The [model][column] log-likelihood matrix.
+     * @param nbModels       The number of models.
+     * @param nbColumns      The number of columns.
+     * @param counts         The number of times each column is drawn, as a [replicate][column] matrix.
+     * @param nbReplicates   The number of replicates.
+     * @param sums           [out] The log-likelihoods, as a [replicate][model] matrix.
+     */
+    static void computeWeightedSums(
+      const double* logLikelihoods, size_t nbModels, size_t nbColumns,
+      const double* counts, size_t nbReplicates,
+      double* sums);
+
+  private:
+    /**
+     * @brief Draw and evaluate the replicates of one scale.
+     *
+     * @param scale   The scale.
+     * @param seeds   The random seed of each replicate.
+     * @param best    [out] The index of the best model in each replicate.
+     * @param sums    [out] If not null, the log-likelihoods of each replicate, as a [replicate][model] matrix.
+     */
+    void runScale_(double scale, const std::vector<unsigned int>& seeds, std::vector<size_t>& best, std::vector<double>* sums) const;
+
+    /**
+     * @brief Fit the AU p-value of a model from its bootstrap probabilities at each scale.
+     */
+    double fitAU_(size_t model, double bp) const;
+};
+
+} //end of namespace bpp.
+
+#endif // _TOPOLOGYTESTS_H_
+
@@ -425,6 +425,17 @@ namespace bpp
      */
     virtual ParameterList getDerivableParameters() const = 0;
 
+    /**
+     * @brief All parameters for which first order derivatives are available.
+     *
+     * This is a superset of derivable parameters, for which second order
+     * derivatives may not be available. Gradient-based optimizers may use
+     * these derivatives instead of finite differences.
+     *
+     * @return A ParameterList. By default, the derivable parameters.
+     */
+    virtual ParameterList getFirstOrderDerivableParameters() const { return getDerivableParameters(); }
+
     /**
      * @brief All non derivable parameters.
      *
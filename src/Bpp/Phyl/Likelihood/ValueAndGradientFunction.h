@@ -0,0 +1,192 @@
+//
+// File: ValueAndGradientFunction.h
+// Created by: Bio++ Development Team
+// Created on: Mon Oct 19 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _VALUEANDGRADIENTFUNCTION_H_
+#define _VALUEANDGRADIENTFUNCTION_H_
+
+#include <Bpp/Numeric/ParameterList.h>
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/Numeric/Function/Functions.h>
+#include <Bpp/Numeric/Function/ReparametrizationFunctionWrapper.h>
+#include <Bpp/Numeric/Function/TwoPointsNumericalDerivative.h>
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace bpp
+{
+
+/**
+ * @brief Interface for functions which compute their value and their gradient at once.
+ *
+ * This is used by LbfgsOptimizer, which needs both at each evaluation. The gradient is
+ * computed whatever the derivative flags of the function (see DerivableFirstOrder::enableFirstOrderDerivatives()).
+ *
+ * Function wrappers must implement this interface themselves for the joint evaluation
+ * of the wrapped function to be used, see ReparametrizationValueAndGradientWrapper
+ * and TwoPointsValueAndGradientWrapper.
+ */
+class ValueAndGradientFunction
+{
+  public:
+    ValueAndGradientFunction() {}
+    virtual ~ValueAndGradientFunction() {}
+
+  public:
+    /**
+     * @brief Set parameters, and compute the function and its gradient at once.
+     *
+     * @param parameters The parameters to set.
+     * @param gradient   [out] The derivatives with respect to each parameter, in the same order.
+     * @return The value of the function.
+     * @throw Exception If a parameter is not derivable.
+     */
+    virtual double getValueAndGradient(const ParameterList& parameters, Vdouble& gradient) = 0;
+};
+
+/**
+ * @brief Remove the constraints of a function which computes its value and gradient at once.
+ *
+ * The gradient of the wrapped function is multiplied by the derivative of each parameter transformation.
+ */
+class ReparametrizationValueAndGradientWrapper :
+  public ReparametrizationDerivableSecondOrderWrapper,
+  public virtual ValueAndGradientFunction
+{
+  private:
+    ValueAndGradientFunction* gradientFunction_;
+
+  public:
+    /**
+     * @param function   The function to wrap. It must also implement ValueAndGradientFunction.
+     * @param parameters The parameters to transform.
+     * @throw Exception If the function does not implement ValueAndGradientFunction.
+     */
+    ReparametrizationValueAndGradientWrapper(DerivableSecondOrder* function, const ParameterList& parameters) :
+      ReparametrizationDerivableSecondOrderWrapper(function, parameters),
+      gradientFunction_(dynamic_cast<ValueAndGradientFunction*>(function))
+    {
+      if (!gradientFunction_)
+        throw Exception("ReparametrizationValueAndGradientWrapper. The function must implement ValueAndGradientFunction.");
+    }
+
+    ReparametrizationValueAndGradientWrapper* clone() const { return new ReparametrizationValueAndGradientWrapper(*this); }
+
+  public:
+    double getValueAndGradient(const ParameterList& parameters, Vdouble& gradient)
+    {
+      setParameters(parameters);
+      // The wrapped function is already at this point, it is not evaluated again:
+      ParameterList original = getFunction().getParameters().subList(parameters.getParameterNames());
+      double value = gradientFunction_->getValueAndGradient(original, gradient);
+      for (size_t i = 0; i < parameters.size(); i++)
+      {
+        gradient[i] *= dynamic_cast<const TransformedParameter&>(getParameter(parameters[i].getName())).getFirstOrderDerivative();
+      }
+      return value;
+    }
+};
+
+/**
+ * @brief Compute the derivatives of some parameters numerically, and the others at once with the wrapped function.
+ */
+class TwoPointsValueAndGradientWrapper :
+  public TwoPointsNumericalDerivative,
+  public virtual ValueAndGradientFunction
+{
+  private:
+    ValueAndGradientFunction* gradientFunction_;
+    std::vector<std::string> numericalParameters_;
+
+  public:
+    /**
+     * @param function            The function to wrap. It must also implement ValueAndGradientFunction.
+     * @param numericalParameters The names of the parameters whose derivatives are computed numerically.
+     * @throw Exception If the function does not implement ValueAndGradientFunction.
+     */
+    TwoPointsValueAndGradientWrapper(DerivableFirstOrder* function, const std::vector<std::string>& numericalParameters) :
+      TwoPointsNumericalDerivative(function),
+      gradientFunction_(dynamic_cast<ValueAndGradientFunction*>(function)),
+      numericalParameters_(numericalParameters)
+    {
+      if (!gradientFunction_)
+        throw Exception("TwoPointsValueAndGradientWrapper. The function must implement ValueAndGradientFunction.");
+      setParametersToDerivate(numericalParameters);
+    }
+
+    TwoPointsValueAndGradientWrapper* clone() const { return new TwoPointsValueAndGradientWrapper(*this); }
+
+  public:
+    double getValueAndGradient(const ParameterList& parameters, Vdouble& gradient)
+    {
+      // Numerical derivatives are computed when parameters are set:
+      setParameters(parameters);
+      gradient.resize(parameters.size());
+      ParameterList analytical;
+      std::vector<size_t> index;
+      for (size_t i = 0; i < parameters.size(); i++)
+      {
+        const std::string& name = parameters[i].getName();
+        if (std::find(numericalParameters_.begin(), numericalParameters_.end(), name) != numericalParameters_.end())
+          gradient[i] = getFirstOrderDerivative(name);
+        else
+        {
+          analytical.addParameter(parameters[i]);
+          index.push_back(i);
+        }
+      }
+      if (analytical.size() > 0)
+      {
+        Vdouble analyticalGradient;
+        gradientFunction_->getValueAndGradient(analytical, analyticalGradient);
+        for (size_t k = 0; k < index.size(); k++)
+        {
+          gradient[index[k]] = analyticalGradient[k];
+        }
+      }
+      return getValue();
+    }
+};
+
+} //end of namespace bpp.
+
+#endif //_VALUEANDGRADIENTFUNCTION_H_
+
@@ -150,7 +150,12 @@ ProbabilisticRewardMapping* RewardMappingTools::computeRewardVectors(
       const Node* currentSon = father->getSon(n);
       if (currentSon->getId() != currentNode->getId())
       {
-        const VVVdouble* likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
+        const VVVdouble* likelihoodsFather_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (currentSon->isLeaf())
+          drtl.getLikelihoodData()->getLeafLikelihoods(currentSon->getId(), leafLikelihoods);
+        else
+          likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
 
         // Now iterate over all site partitions:
         unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentSon->getId()));
@@ -170,11 +175,10 @@ ProbabilisticRewardMapping* RewardMappingTools::computeRewardVectors(
               pxy = drtl.getTransitionProbabilitiesPerRateClass(currentSon->getId(), i);
               first = false;
             }
-            const VVdouble* likelihoodsFather_son_i = &(*likelihoodsFather_son)[i];
             VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
             for (size_t c = 0; c < nbClasses; c++)
             {
-              const Vdouble* likelihoodsFather_son_i_c = &(*likelihoodsFather_son_i)[c];
+              const Vdouble* likelihoodsFather_son_i_c = likelihoodsFather_son ? &(*likelihoodsFather_son)[i][c] : leafLikelihoods[i];
               Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
               VVdouble* pxy_c = &pxy[c];
               for (size_t x = 0; x < nbStates; x++)
@@ -258,7 +262,12 @@ ProbabilisticRewardMapping* RewardMappingTools::computeRewardVectors(
     // ('y' is the state at 'node' and 'x' the state at 'father'.)
 
     // Iterate over all site partitions:
-    const VVVdouble* likelihoodsFather_node = &(drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId()));
+    const VVVdouble* likelihoodsFather_node = 0;
+    vector<const Vdouble*> leafLikelihoods;
+    if (currentNode->isLeaf())
+      drtl.getLikelihoodData()->getLeafLikelihoods(currentNode->getId(), leafLikelihoods);
+    else
+      likelihoodsFather_node = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId());
     unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentNode->getId()));
     VVVdouble pxy;
     bool first;
@@ -298,11 +307,10 @@ ProbabilisticRewardMapping* RewardMappingTools::computeRewardVectors(
           pxy = drtl.getTransitionProbabilitiesPerRateClass(currentNode->getId(), i);
           first = false;
         }
-        const VVdouble* likelihoodsFather_node_i = &(*likelihoodsFather_node)[i];
         VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
         for (size_t c = 0; c < nbClasses; ++c)
         {
-          const Vdouble* likelihoodsFather_node_i_c = &(*likelihoodsFather_node_i)[c];
+          const Vdouble* likelihoodsFather_node_i_c = likelihoodsFather_node ? &(*likelihoodsFather_node)[i][c] : leafLikelihoods[i];
           Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
           const VVdouble* pxy_c = &pxy[c];
           VVdouble* nxy_c = &nxy[c];
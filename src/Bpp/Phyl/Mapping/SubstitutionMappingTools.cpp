@@ -160,7 +160,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
       const Node* currentSon = father->getSon(n);
       if (currentSon->getId() != currentNode->getId())
       {
-        const VVVdouble* likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
+        const VVVdouble* likelihoodsFather_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (currentSon->isLeaf())
+          drtl.getLikelihoodData()->getLeafLikelihoods(currentSon->getId(), leafLikelihoods);
+        else
+          likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
 
         // Now iterate over all site partitions:
         unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentSon->getId()));
@@ -180,11 +185,10 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
               pxy = drtl.getTransitionProbabilitiesPerRateClass(currentSon->getId(), i);
               first = false;
             }
-            const VVdouble* likelihoodsFather_son_i = &(*likelihoodsFather_son)[i];
             VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
             for (size_t c = 0; c < nbClasses; c++)
             {
-              const Vdouble* likelihoodsFather_son_i_c = &(*likelihoodsFather_son_i)[c];
+              const Vdouble* likelihoodsFather_son_i_c = likelihoodsFather_son ? &(*likelihoodsFather_son)[i][c] : leafLikelihoods[i];
               Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
               VVdouble* pxy_c = &pxy[c];
               for (size_t x = 0; x < nbStates; x++)
@@ -269,7 +273,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
     // ('y' is the state at 'node' and 'x' the state at 'father'.)
 
     // Iterate over all site partitions:
-    const VVVdouble* likelihoodsFather_node = &(drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId()));
+    const VVVdouble* likelihoodsFather_node = 0;
+    vector<const Vdouble*> leafLikelihoods;
+    if (currentNode->isLeaf())
+      drtl.getLikelihoodData()->getLeafLikelihoods(currentNode->getId(), leafLikelihoods);
+    else
+      likelihoodsFather_node = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId());
     unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentNode->getId()));
     VVVdouble pxy;
     bool first;
@@ -315,11 +324,10 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
           pxy = drtl.getTransitionProbabilitiesPerRateClass(currentNode->getId(), i);
           first = false;
         }
-        const VVdouble* likelihoodsFather_node_i = &(*likelihoodsFather_node)[i];
         VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
         for (size_t c = 0; c < nbClasses; ++c)
         {
-          const Vdouble* likelihoodsFather_node_i_c = &(*likelihoodsFather_node_i)[c];
+          const Vdouble* likelihoodsFather_node_i_c = likelihoodsFather_node ? &(*likelihoodsFather_node)[i][c] : leafLikelihoods[i];
           Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
           const VVdouble* pxy_c = &pxy[c];
           VVVdouble* nxy_c = &nxy[c];
@@ -473,7 +481,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
       const Node* currentSon = father->getSon(n);
       if (currentSon->getId() != currentNode->getId())
       {
-        const VVVdouble* likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
+        const VVVdouble* likelihoodsFather_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (currentSon->isLeaf())
+          drtl.getLikelihoodData()->getLeafLikelihoods(currentSon->getId(), leafLikelihoods);
+        else
+          likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
 
         // Now iterate over all site partitions:
         unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentSon->getId()));
@@ -493,11 +506,10 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
               pxy = drtl.getTransitionProbabilitiesPerRateClass(currentSon->getId(), i);
               first = false;
             }
-            const VVdouble* likelihoodsFather_son_i = &(*likelihoodsFather_son)[i];
             VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
             for (size_t c = 0; c < nbClasses; c++)
             {
-              const Vdouble* likelihoodsFather_son_i_c = &(*likelihoodsFather_son_i)[c];
+              const Vdouble* likelihoodsFather_son_i_c = likelihoodsFather_son ? &(*likelihoodsFather_son)[i][c] : leafLikelihoods[i];
               Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
               VVdouble* pxy_c = &pxy[c];
               for (size_t x = 0; x < nbStates; x++)
@@ -582,7 +594,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
     // ('y' is the state at 'node' and 'x' the state at 'father'.)
 
     // Iterate over all site partitions:
-    const VVVdouble* likelihoodsFather_node = &(drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId()));
+    const VVVdouble* likelihoodsFather_node = 0;
+    vector<const Vdouble*> leafLikelihoods;
+    if (currentNode->isLeaf())
+      drtl.getLikelihoodData()->getLeafLikelihoods(currentNode->getId(), leafLikelihoods);
+    else
+      likelihoodsFather_node = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId());
     unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentNode->getId()));
     VVVdouble pxy;
     bool first;
@@ -628,11 +645,10 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
           pxy = drtl.getTransitionProbabilitiesPerRateClass(currentNode->getId(), i);
           first = false;
         }
-        const VVdouble* likelihoodsFather_node_i = &(*likelihoodsFather_node)[i];
         VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
         for (size_t c = 0; c < nbClasses; ++c)
         {
-          const Vdouble* likelihoodsFather_node_i_c = &(*likelihoodsFather_node_i)[c];
+          const Vdouble* likelihoodsFather_node_i_c = likelihoodsFather_node ? &(*likelihoodsFather_node)[i][c] : leafLikelihoods[i];
           Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
           const VVdouble* pxy_c = &pxy[c];
           VVVdouble* nxy_c = &nxy[c];
@@ -762,7 +778,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
       const Node* currentSon = father->getSon(n);
       if (currentSon->getId() != currentNode->getId())
       {
-        const VVVdouble* likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
+        const VVVdouble* likelihoodsFather_son = 0;
+        vector<const Vdouble*> leafLikelihoods;
+        if (currentSon->isLeaf())
+          drtl.getLikelihoodData()->getLeafLikelihoods(currentSon->getId(), leafLikelihoods);
+        else
+          likelihoodsFather_son = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentSon->getId());
 
         // Now iterate over all site partitions:
         unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentSon->getId()));
@@ -782,11 +803,10 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
               pxy = drtl.getTransitionProbabilitiesPerRateClass(currentSon->getId(), i);
               first = false;
             }
-            const VVdouble* likelihoodsFather_son_i = &(*likelihoodsFather_son)[i];
             VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
             for (size_t c = 0; c < nbClasses; ++c)
             {
-              const Vdouble* likelihoodsFather_son_i_c = &(*likelihoodsFather_son_i)[c];
+              const Vdouble* likelihoodsFather_son_i_c = likelihoodsFather_son ? &(*likelihoodsFather_son)[i][c] : leafLikelihoods[i];
               Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
               VVdouble* pxy_c = &pxy[c];
               for (size_t x = 0; x < nbStates; ++x)
@@ -870,7 +890,12 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
     // ('y' is the state at 'node' and 'x' the state at 'father'.)
 
     // Iterate over all site partitions:
-    const VVVdouble* likelihoodsFather_node = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId());
+    const VVVdouble* likelihoodsFather_node = 0;
+    vector<const Vdouble*> leafLikelihoods;
+    if (currentNode->isLeaf())
+      drtl.getLikelihoodData()->getLeafLikelihoods(currentNode->getId(), leafLikelihoods);
+    else
+      likelihoodsFather_node = &drtl.getLikelihoodData()->getLikelihoodArray(father->getId(), currentNode->getId());
     unique_ptr<TreeLikelihood::ConstBranchModelIterator> mit(drtl.getNewBranchModelIterator(currentNode->getId()));
     VVVdouble pxy;
     bool first;
@@ -915,7 +940,6 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
           pxy = drtl.getTransitionProbabilitiesPerRateClass(currentNode->getId(), i);
           first = false;
         }
-        const VVdouble* likelihoodsFather_node_i = &(*likelihoodsFather_node)[i];
         VVdouble* likelihoodsFatherConstantPart_i = &likelihoodsFatherConstantPart[i];
         RowMatrix<double> pairProbabilities(nbStates, nbStates);
         MatrixTools::fill(pairProbabilities, 0.);
@@ -930,7 +954,7 @@ ProbabilisticSubstitutionMapping* SubstitutionMappingTools::computeSubstitutionV
         }
         for (size_t c = 0; c < nbClasses; ++c)
         {
-          const Vdouble* likelihoodsFather_node_i_c = &(*likelihoodsFather_node_i)[c];
+          const Vdouble* likelihoodsFather_node_i_c = likelihoodsFather_node ? &(*likelihoodsFather_node)[i][c] : leafLikelihoods[i];
           Vdouble* likelihoodsFatherConstantPart_i_c = &(*likelihoodsFatherConstantPart_i)[c];
           const VVdouble* pxy_c = &pxy[c];
           VVVdouble* nxy_c = &nxy[c];
@@ -191,6 +191,23 @@ bool AbstractKroneckerWordSubstitutionModel::checkChangingPositions_()
   return true;
 }
 
+void AbstractKroneckerWordSubstitutionModel::computeSparsityPattern_()
+{
+  size_t salph = getNumberOfStates();
+  vector< vector<size_t> > pattern(salph);
+  for (size_t i = 0; i < salph; i++)
+  {
+    for (size_t j = 0; j < salph; j++)
+    {
+      if (i != j)
+        pattern[i].push_back(j);
+    }
+  }
+  sparseGenerator_.setPattern(pattern);
+}
+
+/******************************************************************************/
+
 void AbstractKroneckerWordSubstitutionModel::fillBasicGenerator()
 {
   size_t nbmod = VSubMod_.size();
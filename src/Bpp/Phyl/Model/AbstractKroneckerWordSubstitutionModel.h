@@ -110,6 +110,12 @@ namespace bpp
     
     bool checkChangingPositions_();
 
+    /**
+     * @brief Several letters may change simultaneously, so all
+     * substitutions are considered in the sparse generator.
+     */
+    void computeSparsityPattern_();
+
     
   private:
 
@@ -38,6 +38,7 @@
  */
 
 #include "AbstractSubstitutionModel.h"
+#include "EigenDecompositionCache.h"
 
 #include <Bpp/Text/TextTools.h>
 #include <Bpp/Numeric/VectorTools.h>
@@ -48,6 +49,9 @@
 // From SeqLib:
 #include <Bpp/Seq/Container/SequenceContainerTools.h>
 
+// From the STL:
+#include <typeinfo>
+
 using namespace bpp;
 using namespace std;
 
@@ -75,7 +79,11 @@ AbstractSubstitutionModel::AbstractSubstitutionModel(const Alphabet* alpha, cons
   isNonSingular_(false),
   leftEigenVectors_(size_, size_),
   vPowGen_(),
-  tmpMat_(size_, size_)
+  tmpMat_(size_, size_),
+  uniformize_(false),
+  uniformization_(),
+  uniformizedTime_(-1.),
+  uniformizedColumns_()
 {
   if (computeFrequencies())
     for (auto& fr : freq_)
@@ -90,6 +98,24 @@ void AbstractSubstitutionModel::updateMatrices()
   // Compute eigen values and vectors:
   if (enableEigenDecomposition())
   {
+    // Clones with the same generator share the same decomposition:
+    EigenDecompositionCache& cache = EigenDecompositionCache::getInstance();
+    unique_ptr<EigenDecompositionCache::Key> key;
+    if (cache.isEnabled())
+    {
+      key.reset(new EigenDecompositionCache::Key(typeid(*this).name(), isScalable_, computeFrequencies(), generator_, freq_));
+      shared_ptr<const EigenDecomposition> decomposition = cache.find(*key);
+      if (decomposition)
+      {
+        setEigenDecomposition_(*decomposition);
+        if (uniformize_)
+          updateUniformization_();
+        else if (!isNonSingular_)
+          MatrixTools::Taylor(generator_, 30, vPowGen_);
+        return;
+      }
+    }
+
     // Look for null lines (such as stop lines)
     // ie null diagonal elements
 
@@ -310,10 +336,126 @@ void AbstractSubstitutionModel::updateMatrices()
     // normalization
     normalize();
     
+    // The 30 powers of the generator are not needed with uniformization:
     if (!isNonSingular_)
-      MatrixTools::Taylor(generator_, 30, vPowGen_);
+    {
+      if (uniformize_)
+        vPowGen_.clear();
+      else
+        MatrixTools::Taylor(generator_, 30, vPowGen_);
+    }
+
+    if (key)
+      cache.insert(*key, getEigenDecomposition_());
   }
 
+  if (uniformize_)
+    updateUniformization_();
+}
+
+/******************************************************************************/
+
+shared_ptr<const EigenDecomposition> AbstractSubstitutionModel::getEigenDecomposition_() const
+{
+  shared_ptr<EigenDecomposition> decomposition(new EigenDecomposition());
+  decomposition->generator         = generator_;
+  decomposition->freq              = freq_;
+  decomposition->eigenValues       = eigenValues_;
+  decomposition->iEigenValues      = iEigenValues_;
+  decomposition->isDiagonalizable  = isDiagonalizable_;
+  decomposition->isNonSingular     = isNonSingular_;
+  decomposition->rightEigenVectors = rightEigenVectors_;
+  decomposition->leftEigenVectors  = leftEigenVectors_;
+  return decomposition;
+}
+
+/******************************************************************************/
+
+void AbstractSubstitutionModel::setEigenDecomposition_(const EigenDecomposition& decomposition)
+{
+  generator_         = decomposition.generator;
+  freq_              = decomposition.freq;
+  eigenValues_       = decomposition.eigenValues;
+  iEigenValues_      = decomposition.iEigenValues;
+  isDiagonalizable_  = decomposition.isDiagonalizable;
+  isNonSingular_     = decomposition.isNonSingular;
+  rightEigenVectors_ = decomposition.rightEigenVectors;
+  leftEigenVectors_  = decomposition.leftEigenVectors;
+}
+
+/******************************************************************************/
+
+void AbstractSubstitutionModel::enableUniformization(bool yn)
+{
+  if (yn == uniformize_)
+    return;
+  uniformize_ = yn;
+  if (uniformize_)
+  {
+    vPowGen_.clear();
+    updateUniformization_();
+  }
+  else
+  {
+    uniformization_ = UniformizationExponential();
+    uniformizedTime_ = -1.;
+    uniformizedColumns_.clear();
+    // The Taylor series may be needed again:
+    updateMatrices();
+  }
+}
+
+/******************************************************************************/
+
+void AbstractSubstitutionModel::updateUniformization_()
+{
+  uniformization_.setGenerator(generator_);
+  uniformizedTime_ = -1.;
+}
+
+/******************************************************************************/
+
+const VVdouble& AbstractSubstitutionModel::getUniformizedColumns_(double t) const
+{
+  if (uniformizedTime_ < 0 || uniformizedTime_ != rate_ * t)
+  {
+    VVdouble identity(size_, Vdouble(size_, 0.));
+    for (size_t i = 0; i < size_; i++)
+    {
+      identity[i][i] = 1.;
+    }
+    uniformization_.multiply(rate_ * t, identity, uniformizedColumns_);
+    uniformizedTime_ = rate_ * t;
+  }
+  return uniformizedColumns_;
+}
+
+/******************************************************************************/
+
+void AbstractSubstitutionModel::multiplyPij_t(double t, const VVdouble& v, VVdouble& result) const
+{
+  if (uniformize_)
+  {
+    uniformization_.multiply(rate_ * t, v, result);
+    return;
+  }
+  const Matrix<double>& pijt = getPij_t(t);
+  result.resize(v.size());
+  for (size_t i = 0; i < v.size(); i++)
+  {
+    const Vdouble* v_i = &v[i];
+    Vdouble* result_i = &result[i];
+    result_i->resize(size_);
+    for (size_t x = 0; x < size_; x++)
+    {
+      double p = 0;
+      for (size_t y = 0; y < size_; y++)
+      {
+        p += pijt(x, y) * (*v_i)[y];
+      }
+      (*result_i)[x] = p;
+    }
+  }
 }
 
 
@@ -325,6 +467,17 @@ const Matrix<double>& AbstractSubstitutionModel::getPij_t(double t) const
   {
     MatrixTools::getId(size_, pijt_);
   }
+  else if (uniformize_)
+  {
+    const VVdouble& columns = getUniformizedColumns_(t);
+    for (size_t i = 0; i < size_; i++)
+    {
+      for (size_t j = 0; j < size_; j++)
+      {
+        pijt_(i, j) = columns[j][i];
+      }
+    }
+  }
   else if (isNonSingular_)
   {
     if (isDiagonalizable_)
@@ -394,7 +547,21 @@ const Matrix<double>& AbstractSubstitutionModel::getPij_t(double t) const
 
 const Matrix<double>& AbstractSubstitutionModel::getdPij_dt(double t) const
 {
-  if (isNonSingular_)
+  if (uniformize_)
+  {
+    // dP/dt = r.Q.P(t)
+    const VVdouble& columns = getUniformizedColumns_(t);
+    Vdouble qc;
+    for (size_t j = 0; j < size_; j++)
+    {
+      uniformization_.getGenerator().multiply(columns[j], qc);
+      for (size_t i = 0; i < size_; i++)
+      {
+        dpijt_(i, j) = rate_ * qc[i];
+      }
+    }
+  }
+  else if (isNonSingular_)
   {
     if (isDiagonalizable_)
     {
@@ -465,7 +632,22 @@ const Matrix<double>& AbstractSubstitutionModel::getdPij_dt(double t) const
 
 const Matrix<double>& AbstractSubstitutionModel::getd2Pij_dt2(double t) const
 {
-  if (isNonSingular_)
+  if (uniformize_)
+  {
+    // d2P/dt2 = r^2.Q^2.P(t)
+    const VVdouble& columns = getUniformizedColumns_(t);
+    Vdouble qc, q2c;
+    for (size_t j = 0; j < size_; j++)
+    {
+      uniformization_.getGenerator().multiply(columns[j], qc);
+      uniformization_.getGenerator().multiply(qc, q2c);
+      for (size_t i = 0; i < size_; i++)
+      {
+        d2pijt_(i, j) = rate_ * rate_ * q2c[i];
+      }
+    }
+  }
+  else if (isNonSingular_)
   {
     if (isDiagonalizable_)
     {
@@ -607,6 +789,8 @@ void AbstractSubstitutionModel::setScale(double scale)
     MatrixTools::scale(generator_, scale);
     eigenValues_ *= scale;
     iEigenValues_ *= scale;
+    if (uniformize_)
+      updateUniformization_();
   }
 }
 
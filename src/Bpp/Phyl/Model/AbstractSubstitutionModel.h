@@ -41,6 +41,7 @@
 #define _ABSTRACTSUBSTITUTIONMODEL_H_
 
 #include "SubstitutionModel.h"
+#include "UniformizationExponential.h"
 
 #include <Bpp/Numeric/AbstractParameterAliasable.h>
 #include <Bpp/Numeric/VectorTools.h>
@@ -49,6 +50,8 @@
 
 namespace bpp
 {
+  struct EigenDecomposition;
+
 /**
  * @brief Partial implementation of the SubstitutionModel interface.
  *
@@ -64,6 +67,9 @@ namespace bpp
  *
  * This class also provides the updateMatrices() method, which computes eigen values and vectors and fills the corresponding vector (eigenValues_)
  * and matrices (leftEigenVectors_ and rightEigenVectors_) from the generator.
+ * Decompositions are shared between all models with the same generator
+ * through the EigenDecompositionCache, so that clones of a model with the
+ * same parameter values only diagonalize their generator once.
  *
  *
  * The freq_ vector and generator_ matrices are hence the only things to provide to
@@ -188,6 +194,25 @@ namespace bpp
      * @brief For computational issues
      */
     mutable RowMatrix<double> tmpMat_;
+
+    /**
+     * @brief Tell if transition probabilities are computed by uniformization.
+     */
+    bool uniformize_;
+
+    /**
+     * @brief Computes P(t).v from the generator, if uniformize_ is true.
+     */
+    UniformizationExponential uniformization_;
+
+    /**
+     * @brief The columns of P(t) computed by uniformization for the last
+     * value of rate_ * t, from which P(t) and its derivatives are all derived.
+     *
+     * uniformizedTime_ is negative if no columns are stored.
+     */
+    mutable double uniformizedTime_;
+    mutable VVdouble uniformizedColumns_;
   
   public:
     AbstractSubstitutionModel(const Alphabet* alpha, const StateMap* stateMap, const std::string& prefix);
@@ -214,7 +239,11 @@ namespace bpp
       isNonSingular_(model.isNonSingular_),
       leftEigenVectors_(model.leftEigenVectors_),
       vPowGen_(model.vPowGen_),
-      tmpMat_(model.tmpMat_)
+      tmpMat_(model.tmpMat_),
+      uniformize_(model.uniformize_),
+      uniformization_(model.uniformization_),
+      uniformizedTime_(model.uniformizedTime_),
+      uniformizedColumns_(model.uniformizedColumns_)
     {}
 
     AbstractSubstitutionModel& operator=(const AbstractSubstitutionModel& model)
@@ -241,6 +270,10 @@ namespace bpp
       leftEigenVectors_  = model.leftEigenVectors_;
       vPowGen_           = model.vPowGen_;
       tmpMat_            = model.tmpMat_;
+      uniformize_        = model.uniformize_;
+      uniformization_    = model.uniformization_;
+      uniformizedTime_   = model.uniformizedTime_;
+      uniformizedColumns_ = model.uniformizedColumns_;
       return *this;
     }
   
@@ -295,6 +328,19 @@ namespace bpp
 
     virtual double Qij(size_t i, size_t j) const { return generator_(i, j); }
 
+    /**
+     * @brief Compute \f$P(t).v\f$ for several vectors at once.
+     *
+     * With uniformization, the products are computed without forming
+     * \f$P(t)\f$, at the cost of a few sparse matrix-vector products per
+     * vector. Otherwise \f$P(t)\f$ is obtained from getPij_t().
+     *
+     * @param t The time.
+     * @param v The vectors, one per row, of size the number of states.
+     * @param result [out] The results, one per row.
+     */
+    void multiplyPij_t(double t, const VVdouble& v, VVdouble& result) const;
+
     virtual double Pij_t    (size_t i, size_t j, double t) const { return getPij_t(t) (i, j); }
     virtual double dPij_dt  (size_t i, size_t j, double t) const { return getdPij_dt(t) (i, j); }
     virtual double d2Pij_dt2(size_t i, size_t j, double t) const { return getd2Pij_dt2(t) (i, j); }
@@ -309,6 +355,26 @@ namespace bpp
 
     bool enableEigenDecomposition() { return eigenDecompose_; }
 
+    /**
+     * @brief Compute the transition probabilities by uniformization.
+     *
+     * P(t) and its derivatives are then computed with a UniformizationExponential,
+     * from sparse matrix-vector products with the generator, instead of the eigen
+     * decomposition or, for singular generators, the Taylor series. This suits large,
+     * non-reversible or non-diagonalizable generators. Uniformization does not need
+     * the eigen decomposition, which can be disabled if the equilibrium frequencies
+     * are not computed from it. Models overriding getPij_t(), for instance with
+     * closed-form probabilities, are not affected.
+     *
+     * With uniformization, the powers of singular generators used by the Taylor
+     * series (vPowGen_) are not computed, which saves 30 dense matrices.
+     *
+     * @param yn Tell if uniformization should be used.
+     */
+    void enableUniformization(bool yn);
+
+    bool enableUniformization() const { return uniformize_; }
+
     /**
      * @brief Tells the model that a parameter value has changed.
      *
@@ -357,6 +423,37 @@ namespace bpp
      */
     virtual void updateMatrices();
 
+    /**
+     * @return A copy of the current eigen decomposition, to be stored in
+     * the EigenDecompositionCache.
+     */
+    std::shared_ptr<const EigenDecomposition> getEigenDecomposition_() const;
+
+    /**
+     * @brief Set the generator, the frequencies and the eigen
+     * decomposition from a previously computed one.
+     */
+    void setEigenDecomposition_(const EigenDecomposition& decomposition);
+
+    /**
+     * @brief Set the generator of uniformization_ from generator_.
+     *
+     * Called whenever the generator changes while uniformization is enabled.
+     */
+    virtual void updateUniformization_();
+
+    /**
+     * @brief Compute the columns of P(t) by uniformization.
+     *
+     * The columns are kept until the next call with another time, so that
+     * getPij_t(), getdPij_dt() and getd2Pij_dt2() called for the same time
+     * only compute the Poisson series once.
+     *
+     * @param t The time.
+     * @return The columns of P(t), that is P(t).e_j for each state j.
+     */
+    const VVdouble& getUniformizedColumns_(double t) const;
+
     /*
      * @brief : To update the eq freq
      *
@@ -52,6 +52,7 @@
 using namespace bpp;
 
 // From the STL:
+#include <algorithm>
 #include <cmath>
 #include <complex>
 
@@ -70,7 +71,8 @@ AbstractWordSubstitutionModel::AbstractWordSubstitutionModel(
   new_alphabet_ (true),
   VSubMod_      (),
   VnestedPrefix_(),
-  Vrate_        (modelList.size())
+  Vrate_        (modelList.size()),
+  sparseGenerator_()
 {
   size_t i, j;
   size_t n = modelList.size();
@@ -134,7 +136,8 @@ AbstractWordSubstitutionModel::AbstractWordSubstitutionModel(
   new_alphabet_ (false),
   VSubMod_      (),
   VnestedPrefix_(),
-  Vrate_        (0)
+  Vrate_        (0),
+  sparseGenerator_()
 {
 }
 
@@ -147,7 +150,8 @@ AbstractWordSubstitutionModel::AbstractWordSubstitutionModel(
   new_alphabet_ (true),
   VSubMod_      (),
   VnestedPrefix_(),
-  Vrate_        (num,1.0/num)
+  Vrate_        (num,1.0/num),
+  sparseGenerator_()
 {
   stateMap_=std::unique_ptr<StateMap>(new CanonicalStateMap(getAlphabet(), false));
 
@@ -172,7 +176,8 @@ AbstractWordSubstitutionModel::AbstractWordSubstitutionModel(
   new_alphabet_ (wrsm.new_alphabet_),
   VSubMod_      (),
   VnestedPrefix_(wrsm.VnestedPrefix_),
-  Vrate_        (wrsm.Vrate_)
+  Vrate_        (wrsm.Vrate_),
+  sparseGenerator_(wrsm.sparseGenerator_)
 {
   size_t i;
   size_t num = wrsm.VSubMod_.size();
@@ -198,6 +203,7 @@ AbstractWordSubstitutionModel& AbstractWordSubstitutionModel::operator=(
   new_alphabet_  = model.new_alphabet_;
   VnestedPrefix_ = model.VnestedPrefix_;
   Vrate_         = model.Vrate_;
+  sparseGenerator_ = model.sparseGenerator_;
 
   size_t i;
   size_t num = model.VSubMod_.size();
@@ -276,12 +282,15 @@ void AbstractWordSubstitutionModel::updateMatrices()
       VSubMod_[i]->matchParametersValues(getParameters());
     }
 
+  if (sparseGenerator_.getNumberOfStates() != getNumberOfStates())
+    computeSparsityPattern_();
+
   size_t nbmod = VSubMod_.size();
   vector<bool> vnull; // vector of the indices of lines with only zeros
 
   // Generator
 
-  size_t i, j, n, l, k, m;
+  size_t j, n, l, k, m;
 
   vector<size_t> vsize;
 
@@ -290,8 +299,6 @@ void AbstractWordSubstitutionModel::updateMatrices()
     vsize.push_back(VSubMod_[k]->getNumberOfStates());
   }
 
-  RowMatrix<double> gk, exch;
-
   // First fill of the generator from simple position generators
   
   this->fillBasicGenerator();
@@ -344,10 +351,89 @@ void AbstractWordSubstitutionModel::updateMatrices()
     }
   }
 
+  // generator_ may have been normalized, or replaced by a cached one:
+  sparseGenerator_.fillFrom(generator_);
+
   // compute the exchangeability_
-  for (i = 0; i < size_; i++)
-    for (j = 0; j < size_; j++)
-      exchangeability_(i, j) = generator_(i, j) / freq_[j];
+  sparseGenerator_.computeExchangeabilities(freq_, exchangeability_);
+
+  if (enableUniformization() && !enableEigenDecomposition())
+    updateUniformization_();
+}
+
+/******************************************************************************/
+
+void AbstractWordSubstitutionModel::computeSparsityPattern_()
+{
+  size_t nbmod = VSubMod_.size();
+  size_t salph = getNumberOfStates();
+
+  vector< vector<size_t> > pattern(salph);
+
+  size_t m = 1;
+  for (size_t k = nbmod; k > 0; k--)
+  {
+    size_t sk = VSubMod_[k - 1]->getNumberOfStates();
+    for (size_t n = 0; n < salph; n++)
+    {
+      // letter of word n at position k - 1:
+      size_t letter = (n / m) % sk;
+      for (size_t j = 0; j < sk; j++)
+      {
+        if (j != letter)
+          pattern[n].push_back(n - letter * m + j * m);
+      }
+    }
+    m *= sk;
+  }
+
+  for (auto& row : pattern)
+  {
+    sort(row.begin(), row.end());
+  }
+
+  sparseGenerator_.setPattern(pattern);
+}
+
+/******************************************************************************/
+
+void AbstractWordSubstitutionModel::setScale(double scale)
+{
+  AbstractSubstitutionModel::setScale(scale);
+  if (sparseGenerator_.getNumberOfStates() == size_)
+    sparseGenerator_.fillFrom(generator_);
+}
+
+/******************************************************************************/
+
+void AbstractWordSubstitutionModel::updateUniformization_()
+{
+  if (sparseGenerator_.getNumberOfStates() != size_)
+  {
+    AbstractSubstitutionModel::updateUniformization_();
+    return;
+  }
+  sparseGenerator_.fillFrom(generator_);
+  uniformization_.setGenerator(sparseGenerator_);
+  uniformizedTime_ = -1.;
+}
+
+/******************************************************************************/
+
+void AbstractWordSubstitutionModel::setDiagonal()
+{
+  if (sparseGenerator_.getNumberOfStates() != size_)
+  {
+    AbstractSubstitutionModel::setDiagonal();
+    return;
+  }
+
+  sparseGenerator_.fillFrom(generator_);
+  sparseGenerator_.setDiagonal();
+  for (size_t i = 0; i < size_; i++)
+  {
+    generator_(i, i) = sparseGenerator_.getDiagonal(i);
+  }
 }
 
 
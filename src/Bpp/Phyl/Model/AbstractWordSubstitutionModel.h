@@ -41,6 +41,7 @@
 #define _ABSTRACTWORDSUBSTITUTIONMODEL_H_
 
 #include "AbstractSubstitutionModel.h"
+#include "SparseGenerator.h"
 
 // From bpp-seq:
 #include <Bpp/Seq/Alphabet/WordAlphabet.h>
@@ -162,9 +163,31 @@ protected:
 
   std::vector<double> Vrate_;
 
+  /**
+   * @brief The generator in compressed rows, restricted to the allowed
+   * substitutions (see computeSparsityPattern_()).
+   *
+   * It is filled from generator_ in updateMatrices() and setScale().
+   */
+  SparseGenerator sparseGenerator_;
+
 protected:
   void updateMatrices();
 
+  /**
+   * @brief Set the pattern of sparseGenerator_.
+   *
+   * By default, only substitutions with one letter changed are
+   * allowed, and each state has @f$\sum_i (s_i - 1)@f$ neighbours,
+   * where @f$s_i@f$ is the number of states at position i.
+   */
+  virtual void computeSparsityPattern_();
+
+  /**
+   * @brief Use the sparse generator, rather than a conversion of the dense one.
+   */
+  void updateUniformization_();
+
   /**
    * @brief Called by updateMatrices to handle specific modifications
    * for inheriting classes
@@ -241,6 +264,25 @@ public:
   size_t getNumberOfModels() const {
     return VSubMod_.size();
   }
+
+  /**
+   * @return The generator in compressed rows, synchronized with the
+   * dense generator. It can be used to compute @f$P(t).v@f$ with a
+   * UniformizationExponential, without diagonalization.
+   */
+  const SparseGenerator& getSparseGenerator() const { return sparseGenerator_; }
+
+  /**
+   * @brief Multiplies the current generator by the given scale, and
+   * keeps the sparse generator synchronized.
+   */
+  void setScale(double scale);
+
+  /**
+   * @brief Set the diagonal of the generator such that each row sums
+   * to 0, using only the allowed substitutions.
+   */
+  void setDiagonal();
   
   /**
    *@brief Estimation of the parameters of the models so that the
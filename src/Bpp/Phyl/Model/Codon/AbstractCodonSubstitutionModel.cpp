@@ -176,11 +176,20 @@ void AbstractCodonSubstitutionModel::completeMatrices()
   size_t i, j;
   size_t salph = getNumberOfStates();
 
+  vector<bool> isStop(salph);
   for (i = 0; i < salph; i++)
   {
-    for (j = 0; j < salph; j++)
+    isStop[i] = gCode_->isStop(getAlphabetStateAsInt(i));
+  }
+
+  // Only one letter may change, other elements of the generator are
+  // null, and the diagonal is set afterwards:
+  for (i = 0; i < salph; i++)
+  {
+    for (size_t k = sparseGenerator_.getRowStart(i); k < sparseGenerator_.getRowStart(i + 1); k++)
     {
-      if (gCode_->isStop(getAlphabetStateAsInt(i)) || gCode_->isStop(getAlphabetStateAsInt(j)))
+      j = sparseGenerator_.getColumn(k);
+      if (isStop[i] || isStop[j])
       {
         generator_(i, j) = 0;
       }
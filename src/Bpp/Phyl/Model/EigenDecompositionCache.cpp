@@ -0,0 +1,217 @@
+//
+// File: EigenDecompositionCache.cpp
+// Created by: Bio++ Development Team
+// Created on: Mon Oct 19 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "EigenDecompositionCache.h"
+
+#include <functional>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+EigenDecompositionCache::Key::Key(const std::string& type, bool scalable, bool computeFreq, const Matrix<double>& generator, const Vdouble& freq) :
+  type_(type),
+  scalable_(scalable),
+  computeFreq_(computeFreq),
+  values_(),
+  hash_(0)
+{
+  size_t nr = generator.getNumberOfRows();
+  size_t nc = generator.getNumberOfColumns();
+  values_.reserve(nr * nc + (computeFreq ? 0 : freq.size()));
+  for (size_t i = 0; i < nr; i++)
+  {
+    for (size_t j = 0; j < nc; j++)
+    {
+      values_.push_back(generator(i, j));
+    }
+  }
+  if (!computeFreq)
+    values_.insert(values_.end(), freq.begin(), freq.end());
+
+  hash<double> hashDouble;
+  hash_ = hash<string>()(type_);
+  hash_ ^= (scalable_ ? 1 : 2) + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
+  hash_ ^= (computeFreq_ ? 1 : 2) + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
+  for (auto v : values_)
+  {
+    hash_ ^= hashDouble(v) + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2);
+  }
+}
+
+/******************************************************************************/
+
+EigenDecompositionCache& EigenDecompositionCache::getInstance()
+{
+  static EigenDecompositionCache instance;
+  return instance;
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const EigenDecomposition> EigenDecompositionCache::find(const Key& key)
+{
+  lock_guard<mutex> lock(mutex_);
+  if (!enabled_)
+    return nullptr;
+
+  auto range = index_.equal_range(key.getHash());
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second->first == key)
+    {
+      // Move the entry to the front of the list:
+      entries_.splice(entries_.begin(), entries_, it->second);
+      nbHits_++;
+      return it->second->second;
+    }
+  }
+  nbMisses_++;
+  return nullptr;
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const EigenDecomposition> EigenDecompositionCache::insert(const Key& key, std::shared_ptr<const EigenDecomposition> decomposition)
+{
+  lock_guard<mutex> lock(mutex_);
+  if (!enabled_ || capacity_ == 0)
+    return decomposition;
+
+  auto range = index_.equal_range(key.getHash());
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second->first == key)
+      return it->second->second;
+  }
+
+  entries_.push_front(Entry_(key, decomposition));
+  index_.insert(make_pair(key.getHash(), entries_.begin()));
+
+  while (entries_.size() > capacity_)
+  {
+    erase_(prev(entries_.end()));
+  }
+  return decomposition;
+}
+
+/******************************************************************************/
+
+void EigenDecompositionCache::erase_(std::list<Entry_>::iterator it)
+{
+  auto range = index_.equal_range(it->first.getHash());
+  for (auto iti = range.first; iti != range.second; ++iti)
+  {
+    if (iti->second == it)
+    {
+      index_.erase(iti);
+      break;
+    }
+  }
+  entries_.erase(it);
+}
+
+/******************************************************************************/
+
+void EigenDecompositionCache::clear()
+{
+  lock_guard<mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  nbHits_ = 0;
+  nbMisses_ = 0;
+}
+
+/******************************************************************************/
+
+void EigenDecompositionCache::enable(bool yn)
+{
+  lock_guard<mutex> lock(mutex_);
+  enabled_ = yn;
+  if (!enabled_)
+  {
+    entries_.clear();
+    index_.clear();
+  }
+}
+
+bool EigenDecompositionCache::isEnabled() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return enabled_;
+}
+
+/******************************************************************************/
+
+void EigenDecompositionCache::setCapacity(size_t capacity)
+{
+  lock_guard<mutex> lock(mutex_);
+  capacity_ = capacity;
+  while (entries_.size() > capacity_)
+  {
+    erase_(prev(entries_.end()));
+  }
+}
+
+size_t EigenDecompositionCache::getCapacity() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return capacity_;
+}
+
+size_t EigenDecompositionCache::getNumberOfEntries() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t EigenDecompositionCache::getNumberOfHits() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return nbHits_;
+}
+
+size_t EigenDecompositionCache::getNumberOfMisses() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return nbMisses_;
+}
+
+/******************************************************************************/
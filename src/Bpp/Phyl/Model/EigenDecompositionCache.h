@@ -0,0 +1,229 @@
+//
+// File: EigenDecompositionCache.h
+// Created by: Bio++ Development Team
+// Created on: Mon Oct 19 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _EIGENDECOMPOSITIONCACHE_H_
+#define _EIGENDECOMPOSITIONCACHE_H_
+
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/Numeric/Matrix/Matrix.h>
+
+// From the STL:
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief The result of the diagonalization of a generator, as computed by
+ * AbstractSubstitutionModel::updateMatrices().
+ *
+ * All fields are stored after normalization of the generator, so that
+ * they can be copied as is in any model sharing the same generator.
+ * The powers of singular generators used in their Taylor series are not
+ * stored, as they are large and cheap to recompute from the generator.
+ */
+  struct EigenDecomposition
+  {
+public:
+    RowMatrix<double> generator;
+    Vdouble freq;
+    Vdouble eigenValues;
+    Vdouble iEigenValues;
+    bool isDiagonalizable;
+    bool isNonSingular;
+    RowMatrix<double> rightEigenVectors;
+    RowMatrix<double> leftEigenVectors;
+
+public:
+    EigenDecomposition() :
+      generator(),
+      freq(),
+      eigenValues(),
+      iEigenValues(),
+      isDiagonalizable(false),
+      isNonSingular(false),
+      rightEigenVectors(),
+      leftEigenVectors() {}
+  };
+
+/**
+ * @brief A process-wide cache of generator diagonalizations.
+ *
+ * Substitution models are cloned extensively (one per branch in a
+ * SubstitutionModelSet, one per class in a MixtureOfASubstitutionModel,
+ * etc.), and all clones with the same parameter values used to
+ * diagonalize the same generator independently. This cache stores
+ * immutable EigenDecomposition objects, shared between all models which
+ * ask for the same generator, so that the diagonalization is only
+ * performed once.
+ *
+ * The key of an entry is made of the dynamic type of the model, of the
+ * (unnormalized) generator and, when they are not computed from the
+ * generator, of the equilibrium frequencies. The generator is used
+ * rather than the parameter values, as several models carry a state
+ * which is not described by their parameters (frequencies set from data,
+ * rate matrices from files, etc.).
+ *
+ * The cache has a bounded capacity, and the least recently used entries
+ * are discarded first. All methods are thread-safe.
+ */
+  class EigenDecompositionCache
+  {
+public:
+    class Key
+    {
+private:
+      std::string type_;
+      bool scalable_;
+      bool computeFreq_;
+      std::vector<double> values_;
+      size_t hash_;
+
+public:
+      /**
+       * @param type The name of the dynamic type of the model.
+       * @param scalable Tell if the generator is normalized.
+       * @param computeFreq Tell if the frequencies are computed from the generator.
+       * @param generator The generator, before normalization.
+       * @param freq The equilibrium frequencies (only used if computeFreq is false).
+       */
+      Key(const std::string& type, bool scalable, bool computeFreq, const Matrix<double>& generator, const Vdouble& freq);
+
+      size_t getHash() const { return hash_; }
+
+      bool operator==(const Key& key) const
+      {
+        return hash_ == key.hash_
+               && scalable_ == key.scalable_
+               && computeFreq_ == key.computeFreq_
+               && type_ == key.type_
+               && values_ == key.values_;
+      }
+    };
+
+private:
+    typedef std::pair<Key, std::shared_ptr<const EigenDecomposition> > Entry_;
+
+    /**
+     * @brief Entries, from the most to the least recently used.
+     */
+    std::list<Entry_> entries_;
+    std::unordered_multimap<size_t, std::list<Entry_>::iterator> index_;
+    size_t capacity_;
+    bool enabled_;
+    size_t nbHits_;
+    size_t nbMisses_;
+    mutable std::mutex mutex_;
+
+private:
+    EigenDecompositionCache() :
+      entries_(),
+      index_(),
+      capacity_(256),
+      enabled_(true),
+      nbHits_(0),
+      nbMisses_(0),
+      mutex_() {}
+
+    EigenDecompositionCache(const EigenDecompositionCache&) = delete;
+    EigenDecompositionCache& operator=(const EigenDecompositionCache&) = delete;
+
+public:
+    /**
+     * @return The unique instance of the cache.
+     */
+    static EigenDecompositionCache& getInstance();
+
+    /**
+     * @brief Look for a decomposition.
+     *
+     * @param key The key of the generator.
+     * @return The decomposition, or a null pointer if it is not in the cache.
+     */
+    std::shared_ptr<const EigenDecomposition> find(const Key& key);
+
+    /**
+     * @brief Store a decomposition.
+     *
+     * If another thread stored a decomposition for the same key in the
+     * meantime, this one is discarded and the stored one is returned.
+     *
+     * @param key The key of the generator.
+     * @param decomposition The decomposition to store.
+     * @return The decomposition actually stored in the cache.
+     */
+    std::shared_ptr<const EigenDecomposition> insert(const Key& key, std::shared_ptr<const EigenDecomposition> decomposition);
+
+    /**
+     * @brief Remove all entries, and reset the statistics.
+     */
+    void clear();
+
+    /**
+     * @brief Enable or disable the cache. When the cache is disabled,
+     * all generators are diagonalized.
+     */
+    void enable(bool yn);
+
+    bool isEnabled() const;
+
+    /**
+     * @brief Set the maximum number of entries. Least recently used
+     * entries are discarded if needed.
+     */
+    void setCapacity(size_t capacity);
+
+    size_t getCapacity() const;
+
+    size_t getNumberOfEntries() const;
+
+    size_t getNumberOfHits() const;
+
+    size_t getNumberOfMisses() const;
+
+private:
+    void erase_(std::list<Entry_>::iterator it);
+  };
+} // end of namespace bpp.
+
+#endif // _EIGENDECOMPOSITIONCACHE_H_
@@ -0,0 +1,202 @@
+//
+// File: NumericalModelParameterDerivative.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "NumericalModelParameterDerivative.h"
+
+#include <Bpp/Numeric/Matrix/MatrixTools.h>
+
+// From the STL:
+#include <cmath>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+NumericalModelParameterDerivative::NumericalModelParameterDerivative(const TransitionModel& model, const std::string& parameterName, double precision) :
+  parameterName_(parameterName),
+  nbStates_(model.getNumberOfStates()),
+  rate_(model.getRate()),
+  useEigenDecomposition_(false),
+  eigenValues_(),
+  rightEigenVectors_(),
+  leftEigenVectors_(),
+  dGenerator_(),
+  dFrequencies_(),
+  upperModel_(model.clone()),
+  lowerModel_(model.clone()),
+  interval_(0)
+{
+  // Central differences are used whenever possible, otherwise one-sided differences:
+  const Parameter& parameter = model.getParameter(parameterName);
+  double value = parameter.getValue();
+  double h = precision * max(abs(value), 1.);
+  double upper = value + h;
+  double lower = value - h;
+  if (parameter.hasConstraint())
+  {
+    if (!parameter.getConstraint()->isCorrect(upper))
+      upper = value;
+    else if (!parameter.getConstraint()->isCorrect(lower))
+      lower = value;
+  }
+  upperModel_->setParameterValue(parameterName, upper);
+  lowerModel_->setParameterValue(parameterName, lower);
+  interval_ = upper - lower;
+
+  dFrequencies_.resize(nbStates_);
+  for (size_t i = 0; i < nbStates_; i++)
+  {
+    dFrequencies_[i] = (upperModel_->getFrequencies()[i] - lowerModel_->getFrequencies()[i]) / interval_;
+  }
+
+  const SubstitutionModel* sm = dynamic_cast<const SubstitutionModel*>(&model);
+  const SubstitutionModel* upperSm = dynamic_cast<const SubstitutionModel*>(upperModel_.get());
+  const SubstitutionModel* lowerSm = dynamic_cast<const SubstitutionModel*>(lowerModel_.get());
+  bool realEigenValues = sm && sm->isDiagonalizable();
+  for (size_t i = 0; realEigenValues && i < nbStates_; i++)
+  {
+    realEigenValues = (sm->getIEigenValues()[i] == 0);
+  }
+  if (realEigenValues)
+  {
+    useEigenDecomposition_ = true;
+    eigenValues_ = sm->getEigenValues();
+    rightEigenVectors_ = sm->getColumnRightEigenVectors();
+    leftEigenVectors_ = sm->getRowLeftEigenVectors();
+
+    RowMatrix<double> dQ(nbStates_, nbStates_);
+    const Matrix<double>& upperQ = upperSm->getGenerator();
+    const Matrix<double>& lowerQ = lowerSm->getGenerator();
+    for (size_t i = 0; i < nbStates_; i++)
+    {
+      for (size_t j = 0; j < nbStates_; j++)
+      {
+        dQ(i, j) = (upperQ(i, j) - lowerQ(i, j)) / interval_;
+      }
+    }
+    RowMatrix<double> tmp;
+    MatrixTools::mult(leftEigenVectors_, dQ, tmp);
+    MatrixTools::mult(tmp, rightEigenVectors_, dGenerator_);
+
+    // Finite difference models are not needed anymore:
+    upperModel_.reset();
+    lowerModel_.reset();
+  }
+}
+
+/******************************************************************************/
+
+NumericalModelParameterDerivative::NumericalModelParameterDerivative(const NumericalModelParameterDerivative& mpd) :
+  parameterName_(mpd.parameterName_),
+  nbStates_(mpd.nbStates_),
+  rate_(mpd.rate_),
+  useEigenDecomposition_(mpd.useEigenDecomposition_),
+  eigenValues_(mpd.eigenValues_),
+  rightEigenVectors_(mpd.rightEigenVectors_),
+  leftEigenVectors_(mpd.leftEigenVectors_),
+  dGenerator_(mpd.dGenerator_),
+  dFrequencies_(mpd.dFrequencies_),
+  upperModel_(mpd.upperModel_ ? mpd.upperModel_->clone() : 0),
+  lowerModel_(mpd.lowerModel_ ? mpd.lowerModel_->clone() : 0),
+  interval_(mpd.interval_)
+{}
+
+/******************************************************************************/
+
+NumericalModelParameterDerivative& NumericalModelParameterDerivative::operator=(const NumericalModelParameterDerivative& mpd)
+{
+  parameterName_         = mpd.parameterName_;
+  nbStates_              = mpd.nbStates_;
+  rate_                  = mpd.rate_;
+  useEigenDecomposition_ = mpd.useEigenDecomposition_;
+  eigenValues_           = mpd.eigenValues_;
+  rightEigenVectors_     = mpd.rightEigenVectors_;
+  leftEigenVectors_      = mpd.leftEigenVectors_;
+  dGenerator_            = mpd.dGenerator_;
+  dFrequencies_          = mpd.dFrequencies_;
+  upperModel_.reset(mpd.upperModel_ ? mpd.upperModel_->clone() : 0);
+  lowerModel_.reset(mpd.lowerModel_ ? mpd.lowerModel_->clone() : 0);
+  interval_              = mpd.interval_;
+  return *this;
+}
+
+/******************************************************************************/
+
+void NumericalModelParameterDerivative::getdPij_dParameter(double t, Matrix<double>& dP) const
+{
+  dP.resize(nbStates_, nbStates_);
+  if (!useEigenDecomposition_)
+  {
+    RowMatrix<double> upperP = upperModel_->getPij_t(t);
+    RowMatrix<double> lowerP = lowerModel_->getPij_t(t);
+    for (size_t i = 0; i < nbStates_; i++)
+    {
+      for (size_t j = 0; j < nbStates_; j++)
+      {
+        dP(i, j) = (upperP(i, j) - lowerP(i, j)) / interval_;
+      }
+    }
+    return;
+  }
+
+  double s = rate_ * t;
+  Vdouble expL(nbStates_);
+  for (size_t i = 0; i < nbStates_; i++)
+  {
+    expL[i] = exp(s * eigenValues_[i]);
+  }
+  RowMatrix<double> vf(nbStates_, nbStates_);
+  for (size_t i = 0; i < nbStates_; i++)
+  {
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      double d = eigenValues_[i] - eigenValues_[j];
+      // Close eigen values would lead to cancellation, the limit is used instead:
+      double f = (abs(d * s) < 1e-8) ? s * exp(s * (eigenValues_[i] + eigenValues_[j]) / 2.) : (expL[i] - expL[j]) / d;
+      vf(i, j) = dGenerator_(i, j) * f;
+    }
+  }
+  RowMatrix<double> tmp;
+  MatrixTools::mult(rightEigenVectors_, vf, tmp);
+  MatrixTools::mult(tmp, leftEigenVectors_, dP);
+}
+
+/******************************************************************************/
+
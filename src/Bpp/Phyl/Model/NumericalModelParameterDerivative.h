@@ -0,0 +1,144 @@
+//
+// File: NumericalModelParameterDerivative.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _NUMERICALMODELPARAMETERDERIVATIVE_H_
+#define _NUMERICALMODELPARAMETERDERIVATIVE_H_
+
+#include "SubstitutionModel.h"
+
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/Numeric/Matrix/Matrix.h>
+
+// From the STL:
+#include <memory>
+#include <string>
+
+namespace bpp
+{
+/**
+ * @brief Numerical derivatives of transition probabilities and equilibrium
+ * frequencies with respect to a model parameter \f$\theta\f$.
+ *
+ * Substitution models do not provide the derivatives of their generator
+ * with respect to their parameters. The derivative of the generator,
+ * \f$\partial Q/\partial\theta\f$, and of the equilibrium frequencies are hence
+ * obtained by central finite differences on the model alone, or one-sided ones
+ * close to a bound of the parameter. Only the model matrices are updated, no
+ * likelihood is recomputed. Results are therefore approximations, with an error
+ * of the order of the square of the step (of the step for one-sided differences).
+ *
+ * If the model is diagonalizable with real eigen values,
+ * \f$Q = U \Lambda U^{-1}\f$, the derivative of the transition
+ * probabilities is then analytic:
+ * \f[
+ * \frac{\partial P(t)}{\partial\theta} = U \left(V \circ F(t)\right) U^{-1},
+ * \f]
+ * where \f$V = U^{-1} \frac{\partial Q}{\partial\theta} U\f$, and
+ * \f$F_{ij}(t) = \frac{e^{\lambda_i t} - e^{\lambda_j t}}{\lambda_i - \lambda_j}\f$
+ * if \f$\lambda_i \neq \lambda_j\f$, \f$t e^{\lambda_i t}\f$ otherwise
+ * (Kalbfleisch and Lawless, 1985).
+ * Otherwise, transition probabilities are themselves derived by finite
+ * differences.
+ *
+ * The instance is not updated if the model changes, and must be rebuilt.
+ */
+class NumericalModelParameterDerivative
+{
+  private:
+    std::string parameterName_;
+    size_t nbStates_;
+    double rate_;
+    bool useEigenDecomposition_;
+    Vdouble eigenValues_;
+    RowMatrix<double> rightEigenVectors_;
+    RowMatrix<double> leftEigenVectors_;
+
+    /**
+     * @brief The derivative of the generator, in the basis of eigen vectors.
+     */
+    RowMatrix<double> dGenerator_;
+    Vdouble dFrequencies_;
+
+    /**
+     * @brief Models with the parameter set to upper and lower values, used for finite differences.
+     */
+    std::unique_ptr<TransitionModel> upperModel_;
+    std::unique_ptr<TransitionModel> lowerModel_;
+    double interval_;
+
+  public:
+    /**
+     * @param model         The model to derive.
+     * @param parameterName The name of the parameter, as in the model.
+     * @param precision     The relative step used for finite differences.
+     * @throw ParameterNotFoundException If the model has no such parameter.
+     */
+    NumericalModelParameterDerivative(const TransitionModel& model, const std::string& parameterName, double precision = 1e-6);
+
+    NumericalModelParameterDerivative(const NumericalModelParameterDerivative& mpd);
+
+    NumericalModelParameterDerivative& operator=(const NumericalModelParameterDerivative& mpd);
+
+    virtual ~NumericalModelParameterDerivative() {}
+
+  public:
+    const std::string& getParameterName() const { return parameterName_; }
+
+    /**
+     * @return True if the derivatives of transition probabilities are computed from the eigen decomposition.
+     */
+    bool usesEigenDecomposition() const { return useEigenDecomposition_; }
+
+    /**
+     * @brief Get the derivative of the transition probabilities.
+     *
+     * @param t  The branch length, before multiplication by the rate of the model.
+     * @param dP [out] The matrix \f$\partial P(t)/\partial\theta\f$.
+     */
+    void getdPij_dParameter(double t, Matrix<double>& dP) const;
+
+    /**
+     * @return The derivatives of the equilibrium frequencies.
+     */
+    const Vdouble& getdFrequencies() const { return dFrequencies_; }
+};
+} // end of namespace bpp.
+
+#endif // _NUMERICALMODELPARAMETERDERIVATIVE_H_
+
@@ -0,0 +1,240 @@
+//
+// File: SparseGenerator.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "SparseGenerator.h"
+
+#include <Bpp/Exceptions.h>
+
+// From the STL:
+#include <cmath>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+SparseGenerator::SparseGenerator(const Matrix<double>& generator) :
+  size_(generator.getNumberOfRows()),
+  rowStarts_(1, 0),
+  columns_(),
+  values_(),
+  diagonal_(size_)
+{
+  if (generator.getNumberOfColumns() != size_)
+    throw Exception("SparseGenerator (constructor). The generator must be a square matrix.");
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (size_t j = 0; j < size_; ++j)
+    {
+      if (i == j)
+        diagonal_[i] = generator(i, i);
+      else if (generator(i, j) != 0)
+      {
+        columns_.push_back(j);
+        values_.push_back(generator(i, j));
+      }
+    }
+    rowStarts_.push_back(columns_.size());
+  }
+}
+
+SparseGenerator::SparseGenerator(const std::vector< std::vector<size_t> >& pattern) :
+  size_(0),
+  rowStarts_(1, 0),
+  columns_(),
+  values_(),
+  diagonal_()
+{
+  setPattern(pattern);
+}
+
+/******************************************************************************/
+
+void SparseGenerator::setPattern(const std::vector< std::vector<size_t> >& pattern)
+{
+  size_ = pattern.size();
+  rowStarts_.assign(1, 0);
+  columns_.clear();
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (auto j : pattern[i])
+    {
+      if (j >= size_)
+        throw IndexOutOfBoundsException("SparseGenerator::setPattern.", j, 0, size_ - 1);
+      if (j != i)
+        columns_.push_back(j);
+    }
+    rowStarts_.push_back(columns_.size());
+  }
+  values_.assign(columns_.size(), 0.);
+  diagonal_.assign(size_, 0.);
+}
+
+/******************************************************************************/
+
+void SparseGenerator::fillFrom(const Matrix<double>& generator)
+{
+  if (generator.getNumberOfRows() != size_ || generator.getNumberOfColumns() != size_)
+    throw BadSizeException("SparseGenerator::fillFrom.", generator.getNumberOfRows(), size_);
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      values_[k] = generator(i, columns_[k]);
+    }
+    diagonal_[i] = generator(i, i);
+  }
+}
+
+/******************************************************************************/
+
+void SparseGenerator::fillTo(Matrix<double>& generator) const
+{
+  generator.resize(size_, size_);
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (size_t j = 0; j < size_; ++j)
+    {
+      generator(i, j) = 0;
+    }
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      generator(i, columns_[k]) = values_[k];
+    }
+    generator(i, i) = diagonal_[i];
+  }
+}
+
+/******************************************************************************/
+
+void SparseGenerator::setDiagonal()
+{
+  for (size_t i = 0; i < size_; ++i)
+  {
+    double lambda = 0;
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      lambda += values_[k];
+    }
+    diagonal_[i] = -lambda;
+  }
+}
+
+/******************************************************************************/
+
+void SparseGenerator::scale(double scale)
+{
+  for (auto& v : values_)
+  {
+    v *= scale;
+  }
+  for (auto& d : diagonal_)
+  {
+    d *= scale;
+  }
+}
+
+/******************************************************************************/
+
+double SparseGenerator::getMaximumExitRate() const
+{
+  double mu = 0;
+  for (auto d : diagonal_)
+  {
+    if (abs(d) > mu)
+      mu = abs(d);
+  }
+  return mu;
+}
+
+/******************************************************************************/
+
+void SparseGenerator::multiply(const Vdouble& v, Vdouble& result) const
+{
+  if (v.size() != size_)
+    throw BadSizeException("SparseGenerator::multiply.", v.size(), size_);
+  result.resize(size_);
+  for (size_t i = 0; i < size_; ++i)
+  {
+    double sum = diagonal_[i] * v[i];
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      sum += values_[k] * v[columns_[k]];
+    }
+    result[i] = sum;
+  }
+}
+
+/******************************************************************************/
+
+void SparseGenerator::leftMultiply(const Vdouble& v, Vdouble& result) const
+{
+  if (v.size() != size_)
+    throw BadSizeException("SparseGenerator::leftMultiply.", v.size(), size_);
+  result.resize(size_);
+  for (size_t j = 0; j < size_; ++j)
+  {
+    result[j] = diagonal_[j] * v[j];
+  }
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      result[columns_[k]] += v[i] * values_[k];
+    }
+  }
+}
+
+/******************************************************************************/
+
+void SparseGenerator::computeExchangeabilities(const Vdouble& freq, Matrix<double>& exchangeability) const
+{
+  if (freq.size() != size_)
+    throw BadSizeException("SparseGenerator::computeExchangeabilities.", freq.size(), size_);
+  for (size_t i = 0; i < size_; ++i)
+  {
+    for (size_t k = rowStarts_[i]; k < rowStarts_[i + 1]; ++k)
+    {
+      exchangeability(i, columns_[k]) = values_[k] / freq[columns_[k]];
+    }
+    exchangeability(i, i) = diagonal_[i] / freq[i];
+  }
+}
+
+/******************************************************************************/
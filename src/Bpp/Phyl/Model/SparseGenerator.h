@@ -0,0 +1,187 @@
+//
+// File: SparseGenerator.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _SPARSEGENERATOR_H_
+#define _SPARSEGENERATOR_H_
+
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/Numeric/Matrix/Matrix.h>
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A generator stored in compressed rows.
+ *
+ * Only the off-diagonal elements of a fixed sparsity pattern are stored,
+ * row by row, and the diagonal is stored separately. Generators of word
+ * and codon models, where only one letter may change at a time, have
+ * @f$n(\sum_i (s_i - 1))@f$ such elements instead of @f$n^2@f$ (576
+ * instead of 4096 for codons), and all operations below are linear in
+ * the number of stored elements.
+ *
+ * The pattern is structural: stored elements may be null, but elements
+ * outside the pattern are always considered as null.
+ */
+  class SparseGenerator
+  {
+private:
+    size_t size_;
+
+    /**
+     * @brief Start of each row in columns_ and values_, plus the total number of elements.
+     */
+    std::vector<size_t> rowStarts_;
+    std::vector<size_t> columns_;
+    Vdouble values_;
+    Vdouble diagonal_;
+
+public:
+    SparseGenerator() :
+      size_(0),
+      rowStarts_(1, 0),
+      columns_(),
+      values_(),
+      diagonal_() {}
+
+    /**
+     * @brief Build a generator from a dense one, keeping only its non-null
+     * off-diagonal elements in the pattern.
+     */
+    SparseGenerator(const Matrix<double>& generator);
+
+    /**
+     * @brief Build a null generator with a given pattern.
+     *
+     * @param pattern For each state, the (off-diagonal) states which can be reached.
+     */
+    SparseGenerator(const std::vector< std::vector<size_t> >& pattern);
+
+    virtual ~SparseGenerator() {}
+
+public:
+    /**
+     * @brief Set a new pattern. All values are reset to 0.
+     *
+     * @param pattern For each state, the (off-diagonal) states which can be reached.
+     * @throw IndexOutOfBoundsException If a state is not valid.
+     */
+    void setPattern(const std::vector< std::vector<size_t> >& pattern);
+
+    size_t getNumberOfStates() const { return size_; }
+
+    /**
+     * @return The number of stored off-diagonal elements.
+     */
+    size_t getNumberOfNonZeros() const { return values_.size(); }
+
+    /**
+     * @name Access to the rows.
+     *
+     * Stored elements of row i are those with indices in
+     * [getRowStart(i), getRowStart(i + 1)[.
+     *
+     * @{
+     */
+    size_t getRowStart(size_t i) const { return rowStarts_[i]; }
+
+    size_t getColumn(size_t k) const { return columns_[k]; }
+
+    double getValue(size_t k) const { return values_[k]; }
+
+    void setValue(size_t k, double value) { values_[k] = value; }
+
+    double getDiagonal(size_t i) const { return diagonal_[i]; }
+
+    const Vdouble& getDiagonal() const { return diagonal_; }
+    /** @} */
+
+    /**
+     * @brief Copy the values of a dense generator along the pattern.
+     *
+     * @param generator A dense generator of the same size.
+     */
+    void fillFrom(const Matrix<double>& generator);
+
+    /**
+     * @brief Copy all values in a dense matrix. Elements outside the
+     * pattern are set to 0.
+     */
+    void fillTo(Matrix<double>& generator) const;
+
+    /**
+     * @brief Set the diagonal such that all rows sum to 0.
+     */
+    void setDiagonal();
+
+    /**
+     * @brief Multiply all elements by a factor.
+     */
+    void scale(double scale);
+
+    /**
+     * @return The maximum absolute value of the diagonal.
+     */
+    double getMaximumExitRate() const;
+
+    /**
+     * @brief Compute the product @f$Q.v@f$.
+     */
+    void multiply(const Vdouble& v, Vdouble& result) const;
+
+    /**
+     * @brief Compute the product @f$v.Q@f$.
+     */
+    void leftMultiply(const Vdouble& v, Vdouble& result) const;
+
+    /**
+     * @brief Compute the exchangeabilities @f$S_{ij} = Q_{ij} / \pi_j@f$.
+     *
+     * Only the elements in the pattern and the diagonal are set, others are left untouched.
+     *
+     * @param freq The equilibrium frequencies.
+     * @param exchangeability [out] The exchangeability matrix, of size the number of states.
+     */
+    void computeExchangeabilities(const Vdouble& freq, Matrix<double>& exchangeability) const;
+  };
+} // end of namespace bpp.
+
+#endif // _SPARSEGENERATOR_H_
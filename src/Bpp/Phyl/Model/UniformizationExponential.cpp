@@ -0,0 +1,252 @@
+//
+// File: UniformizationExponential.cpp
+// Created by: Bio++ Development Team
+// Created on: Mon Oct 19 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "UniformizationExponential.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Numeric/NumConstants.h>
+#include <Bpp/Text/TextTools.h>
+
+// From the STL:
+#include <cmath>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const double UniformizationExponential::MAX_LAMBDA = 200.;
+
+/******************************************************************************/
+
+UniformizationExponential::UniformizationExponential() :
+  size_(0),
+  q_(),
+  mu_(0),
+  tolerance_(1e-12),
+  maxNbTerms_(10000)
+{}
+
+UniformizationExponential::UniformizationExponential(const Matrix<double>& generator, double tolerance) :
+  size_(0),
+  q_(),
+  mu_(0),
+  tolerance_(tolerance),
+  maxNbTerms_(10000)
+{
+  setTolerance(tolerance);
+  setGenerator(generator);
+}
+
+UniformizationExponential::UniformizationExponential(const SparseGenerator& generator, double tolerance) :
+  size_(0),
+  q_(),
+  mu_(0),
+  tolerance_(tolerance),
+  maxNbTerms_(10000)
+{
+  setTolerance(tolerance);
+  setGenerator(generator);
+}
+
+UniformizationExponential::UniformizationExponential(const SubstitutionModel& model, double tolerance) :
+  size_(0),
+  q_(),
+  mu_(0),
+  tolerance_(tolerance),
+  maxNbTerms_(10000)
+{
+  setTolerance(tolerance);
+  setGenerator(model.getGenerator(), model.getRate());
+}
+
+/******************************************************************************/
+
+void UniformizationExponential::setTolerance(double tolerance)
+{
+  if (tolerance <= 0 || tolerance >= 1)
+    throw Exception("UniformizationExponential::setTolerance. Tolerance must be in ]0,1[: " + TextTools::toString(tolerance));
+  tolerance_ = tolerance;
+}
+
+/******************************************************************************/
+
+void UniformizationExponential::setGenerator(const Matrix<double>& generator, double rate)
+{
+  if (generator.getNumberOfColumns() != generator.getNumberOfRows())
+    throw Exception("UniformizationExponential::setGenerator. The generator must be a square matrix.");
+  setGenerator(SparseGenerator(generator), rate);
+}
+
+void UniformizationExponential::setGenerator(const SparseGenerator& generator, double rate)
+{
+  if (rate < 0)
+    throw Exception("UniformizationExponential::setGenerator. Negative rate: " + TextTools::toString(rate));
+
+  size_ = generator.getNumberOfStates();
+  for (size_t i = 0; i < size_; ++i)
+  {
+    double sum = generator.getDiagonal(i);
+    for (size_t k = generator.getRowStart(i); k < generator.getRowStart(i + 1); ++k)
+    {
+      if (generator.getValue(k) < 0)
+        throw Exception("UniformizationExponential::setGenerator. Negative off-diagonal element in generator.");
+      sum += generator.getValue(k);
+    }
+    if (abs(sum) > NumConstants::SMALL())
+      throw Exception("UniformizationExponential::setGenerator. Row " + TextTools::toString(i) + " of the generator does not sum to 0.");
+  }
+
+  q_ = generator;
+  q_.scale(rate);
+  mu_ = q_.getMaximumExitRate();
+}
+
+/******************************************************************************/
+
+size_t UniformizationExponential::computeWeights_(double t, Vdouble& weights) const
+{
+  double lambda = mu_ * t;
+  size_t nbSteps = static_cast<size_t>(ceil(lambda / MAX_LAMBDA));
+  if (nbSteps == 0)
+    nbSteps = 1;
+  lambda /= static_cast<double>(nbSteps);
+
+  // The error of each step adds up:
+  double stepTolerance = tolerance_ / static_cast<double>(nbSteps);
+  weights.clear();
+  double w = exp(-lambda);
+  double cumul = w;
+  weights.push_back(w);
+  while (1. - cumul > stepTolerance)
+  {
+    if (weights.size() >= maxNbTerms_)
+      throw Exception("UniformizationExponential::computeWeights_. Maximum number of terms reached (" + TextTools::toString(maxNbTerms_) + ") for mu.t = " + TextTools::toString(lambda) + ".");
+    w *= lambda / static_cast<double>(weights.size());
+    cumul += w;
+    weights.push_back(w);
+    // Rounding errors may prevent the sum to reach 1 - stepTolerance:
+    if (w < NumConstants::VERY_TINY() && static_cast<double>(weights.size()) > lambda)
+      break;
+  }
+  return nbSteps;
+}
+
+/******************************************************************************/
+
+size_t UniformizationExponential::getNumberOfTerms(double t) const
+{
+  Vdouble weights;
+  computeWeights_(t, weights);
+  return weights.size();
+}
+
+/******************************************************************************/
+
+size_t UniformizationExponential::getNumberOfSteps(double t) const
+{
+  Vdouble weights;
+  return computeWeights_(t, weights);
+}
+
+/******************************************************************************/
+
+void UniformizationExponential::apply_(size_t nbSteps, const Vdouble& weights, Vdouble& v, Vdouble& term, Vdouble& tmp) const
+{
+  for (size_t s = 0; s < nbSteps; ++s)
+  {
+    term = v;
+    for (size_t x = 0; x < size_; ++x)
+    {
+      v[x] = weights[0] * term[x];
+    }
+    for (size_t k = 1; k < weights.size(); ++k)
+    {
+      // term <- B.term = term + Q.term / mu
+      q_.multiply(term, tmp);
+      for (size_t x = 0; x < size_; ++x)
+      {
+        term[x] += tmp[x] / mu_;
+      }
+      for (size_t x = 0; x < size_; ++x)
+      {
+        v[x] += weights[k] * term[x];
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
+void UniformizationExponential::multiply(double t, const Vdouble& v, Vdouble& result) const
+{
+  if (t < 0)
+    throw Exception("UniformizationExponential::multiply. Negative time: " + TextTools::toString(t));
+  if (v.size() != size_)
+    throw BadSizeException("UniformizationExponential::multiply.", v.size(), size_);
+  result = v;
+  if (t == 0 || mu_ == 0)
+    return;
+
+  Vdouble weights, term(size_), tmp(size_);
+  size_t nbSteps = computeWeights_(t, weights);
+  apply_(nbSteps, weights, result, term, tmp);
+}
+
+/******************************************************************************/
+
+void UniformizationExponential::multiply(double t, const VVdouble& v, VVdouble& result) const
+{
+  if (t < 0)
+    throw Exception("UniformizationExponential::multiply. Negative time: " + TextTools::toString(t));
+  result = v;
+  if (t == 0 || mu_ == 0)
+    return;
+
+  Vdouble weights, term(size_), tmp(size_);
+  size_t nbSteps = computeWeights_(t, weights);
+  for (size_t i = 0; i < result.size(); ++i)
+  {
+    if (result[i].size() != size_)
+      throw BadSizeException("UniformizationExponential::multiply.", result[i].size(), size_);
+    apply_(nbSteps, weights, result[i], term, tmp);
+  }
+}
+
+/******************************************************************************/
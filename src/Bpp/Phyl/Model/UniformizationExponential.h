@@ -0,0 +1,226 @@
+//
+// File: UniformizationExponential.h
+// Created by: Bio++ Development Team
+// Created on: Mon Oct 19 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _UNIFORMIZATIONEXPONENTIAL_H_
+#define _UNIFORMIZATIONEXPONENTIAL_H_
+
+#include "SubstitutionModel.h"
+#include "SparseGenerator.h"
+
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/Numeric/Matrix/Matrix.h>
+
+namespace bpp
+{
+/**
+ * @brief Compute the product of transition probabilities with vectors,
+ * \f$P(t).v = \exp(Qt).v\f$, without computing \f$P(t)\f$.
+ *
+ * The uniformization method is used: with \f$\mu \geq \max_i |Q_{ii}|\f$
+ * and \f$B = I + Q/\mu\f$,
+ * \f[
+ * \exp(Qt).v = \sum_{k \geq 0} e^{-\mu t} \frac{(\mu t)^k}{k!} B^k.v.
+ * \f]
+ * As \f$B\f$ is a stochastic matrix, all terms are bounded by
+ * \f$\|v\|_\infty\f$, so that the truncation error is bounded by the
+ * tail of the Poisson distribution, and the number of terms is chosen
+ * adaptively to reach the given tolerance. Long branches are split in
+ * several steps, so that \f$e^{-\mu t}\f$ never underflows.
+ *
+ * Each term only requires a matrix-vector product, and no
+ * diagonalization is needed. The generator is stored as a
+ * SparseGenerator, so that each product is linear in the number of non
+ * null elements. This makes this method suitable for
+ * large, non-reversible or non-diagonalizable generators (for instance
+ * MarkovModulatedSubstitutionModel, RE08, or codon models with stop
+ * codons).
+ *
+ * Matrices of vectors are stored as in the likelihood arrays, that is
+ * one row per vector (for instance one row per site), and one column
+ * per state.
+ */
+  class UniformizationExponential
+  {
+private:
+    size_t size_;
+
+    /**
+     * @brief The generator \f$Q\f$, multiplied by the rate.
+     */
+    SparseGenerator q_;
+
+    /**
+     * @brief The uniformization rate \f$\mu\f$.
+     */
+    double mu_;
+
+    /**
+     * @brief Maximum truncation error, relative to \f$\|v\|_\infty\f$.
+     */
+    double tolerance_;
+
+    /**
+     * @brief Maximum number of terms in each step.
+     */
+    size_t maxNbTerms_;
+
+public:
+    /**
+     * @brief Build an instance with an empty generator.
+     */
+    UniformizationExponential();
+
+    /**
+     * @param generator The generator \f$Q\f$, which rows must sum to 0.
+     * @param tolerance The maximum truncation error, relative to the
+     * maximum absolute value of the vectors.
+     * @throw Exception If the matrix is not a generator.
+     */
+    UniformizationExponential(const Matrix<double>& generator, double tolerance = 1e-12);
+
+    /**
+     * @param generator The generator \f$Q\f$, which rows must sum to 0.
+     * @param tolerance The maximum truncation error, relative to the
+     * maximum absolute value of the vectors.
+     * @throw Exception If the matrix is not a generator.
+     */
+    UniformizationExponential(const SparseGenerator& generator, double tolerance = 1e-12);
+
+    /**
+     * @brief Build an instance from the generator and the rate of a model.
+     *
+     * The instance is not updated if the model changes, setGenerator()
+     * has to be called again.
+     */
+    UniformizationExponential(const SubstitutionModel& model, double tolerance = 1e-12);
+
+    virtual ~UniformizationExponential() {}
+
+public:
+    /**
+     * @brief Set a new generator.
+     *
+     * @param generator The generator \f$Q\f$, which rows must sum to 0.
+     * @param rate A multiplicative factor applied to the generator.
+     * @throw Exception If the matrix is not a generator.
+     */
+    void setGenerator(const Matrix<double>& generator, double rate = 1.);
+
+    /**
+     * @brief Set a new generator.
+     *
+     * @param generator The generator \f$Q\f$, which rows must sum to 0.
+     * @param rate A multiplicative factor applied to the generator.
+     * @throw Exception If the matrix is not a generator.
+     */
+    void setGenerator(const SparseGenerator& generator, double rate = 1.);
+
+    size_t getNumberOfStates() const { return size_; }
+
+    double getUniformizationRate() const { return mu_; }
+
+    double getTolerance() const { return tolerance_; }
+
+    void setTolerance(double tolerance);
+
+    size_t getMaximumNumberOfTerms() const { return maxNbTerms_; }
+
+    void setMaximumNumberOfTerms(size_t maxNbTerms) { maxNbTerms_ = maxNbTerms; }
+
+    /**
+     * @return The generator \f$Q\f$, multiplied by the rate.
+     */
+    const SparseGenerator& getGenerator() const { return q_; }
+
+    /**
+     * @return The number of terms used in each step for a given time.
+     */
+    size_t getNumberOfTerms(double t) const;
+
+    /**
+     * @return The number of steps used for a given time.
+     */
+    size_t getNumberOfSteps(double t) const;
+
+    /**
+     * @brief Compute \f$P(t).v\f$.
+     *
+     * @param t The time.
+     * @param v The vector, of size the number of states.
+     * @param result [out] The result, of size the number of states.
+     * @throw Exception If t is negative or if too many terms are needed.
+     */
+    void multiply(double t, const Vdouble& v, Vdouble& result) const;
+
+    /**
+     * @brief Compute \f$P(t).v\f$ for several vectors at once.
+     *
+     * The Poisson weights are only computed once for all vectors.
+     * All work arrays are local to the call, so that the same instance
+     * can be used by several threads.
+     *
+     * @param t The time.
+     * @param v The vectors, one per row.
+     * @param result [out] The results, one per row.
+     * @throw Exception If t is negative or if too many terms are needed.
+     */
+    void multiply(double t, const VVdouble& v, VVdouble& result) const;
+
+private:
+    /**
+     * @brief Compute the Poisson weights for a given time, and return the
+     * number of steps to perform.
+     */
+    size_t computeWeights_(double t, Vdouble& weights) const;
+
+    /**
+     * @brief Perform all steps on a single vector, in place.
+     *
+     * @param term, tmp Work arrays of size the number of states.
+     */
+    void apply_(size_t nbSteps, const Vdouble& weights, Vdouble& v, Vdouble& term, Vdouble& tmp) const;
+
+    /**
+     * @brief The maximum value of \f$\mu t\f$ in a single step.
+     */
+    static const double MAX_LAMBDA;
+  };
+} // end of namespace bpp.
+
+#endif // _UNIFORMIZATIONEXPONENTIAL_H_
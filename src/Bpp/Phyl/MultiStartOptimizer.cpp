@@ -0,0 +1,358 @@
+//
+// File: MultiStartOptimizer.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#include "MultiStartOptimizer.h"
+#include "ParallelTools.h"
+#include "TreeTools.h"
+#include "TreeTemplateTools.h"
+#include "Distance/BioNJ.h"
+
+#include <Bpp/Io/FileTools.h>
+#include <Bpp/Text/TextTools.h>
+
+// From the STL:
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+using namespace bpp;
+using namespace std;
+
+namespace bpp
+{
+
+/**
+ * @brief Listener used internally to save the state of a starting point during its optimization.
+ */
+class MultiStartCheckpointListener:
+  public OptimizationListener
+{
+  private:
+    MultiStartOptimizer* driver_;
+    size_t index_;
+    const TreeLikelihood* tl_;
+
+  public:
+    MultiStartCheckpointListener(MultiStartOptimizer* driver, size_t index, const TreeLikelihood* tl):
+      driver_(driver), index_(index), tl_(tl) {}
+
+    MultiStartCheckpointListener(const MultiStartCheckpointListener& lr):
+      driver_(lr.driver_), index_(lr.index_), tl_(lr.tl_) {}
+
+    MultiStartCheckpointListener& operator=(const MultiStartCheckpointListener& lr)
+    {
+      driver_ = lr.driver_;
+      index_  = lr.index_;
+      tl_     = lr.tl_;
+      return *this;
+    }
+
+  public:
+    void optimizationInitializationPerformed(const OptimizationEvent& event) {}
+    void optimizationStepPerformed(const OptimizationEvent& event)
+    {
+      driver_->saveState_(index_, *tl_, false, false);
+    }
+    bool listenerModifiesParameters() const { return false; }
+};
+
+} //end of namespace bpp.
+
+/******************************************************************************/
+
+MultiStartOptimizer::MultiStartOptimizer(
+  const SiteContainer& data,
+  const TransitionModel& model,
+  const DiscreteDistribution& rDist,
+  unsigned int nbThreads) :
+  data_(data),
+  model_(model.clone()),
+  rateDistribution_(rDist.clone()),
+  starts_(),
+  nbThreads_(nbThreads),
+  optimizeTopology_(false),
+  tolerance_(0.000001),
+  nbEvalMax_(1000000),
+  optMethodDeriv_(OptimizationTools::OPTIMIZATION_NEWTON),
+  optMethodModel_(OptimizationTools::OPTIMIZATION_BRENT),
+  checkpointFile_(),
+  checkpointInterval_(600),
+  lastCheckpoint_(chrono::steady_clock::now()),
+  mutex_()
+{}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::addStartingTree(const Tree& tree, const std::string& description)
+{
+  starts_.push_back(unique_ptr<StartingPoint>(new StartingPoint(description, new TreeTemplate<Node>(tree))));
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::addRandomStartingTrees(unsigned int n, double brLen)
+{
+  vector<string> names = data_.getSequencesNames();
+  for (unsigned int i = 0; i < n; ++i)
+  {
+    TreeTemplate<Node>* tree = TreeTemplateTools::getRandomTree(names, false);
+    tree->setBranchLengths(brLen);
+    starts_.push_back(unique_ptr<StartingPoint>(new StartingPoint("random", tree)));
+  }
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::addParsimonyStartingTree(double brLen)
+{
+  vector<string> names = data_.getSequencesNames();
+  unique_ptr< TreeTemplate<Node> > random(TreeTemplateTools::getRandomTree(names, false));
+  unique_ptr<DRTreeParsimonyScore> tp(new DRTreeParsimonyScore(*random, data_, false));
+  tp.reset(OptimizationTools::optimizeTreeNNI(tp.release(), 0));
+  TreeTemplate<Node>* tree = new TreeTemplate<Node>(tp->getTree());
+  tree->setBranchLengths(brLen);
+  starts_.push_back(unique_ptr<StartingPoint>(new StartingPoint("parsimony", tree)));
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::addBioNJStartingTree()
+{
+  DistanceEstimation estimation(model_->clone(), rateDistribution_->clone(), &data_, 0, true);
+  unique_ptr<DistanceMatrix> matrix(estimation.getMatrix());
+  BioNJ bionj(*matrix, false, true, false);
+  starts_.push_back(unique_ptr<StartingPoint>(new StartingPoint("BioNJ", bionj.getTree())));
+}
+
+/******************************************************************************/
+
+size_t MultiStartOptimizer::optimize()
+{
+  if (starts_.size() == 0)
+    throw Exception("MultiStartOptimizer::optimize. No starting point.");
+  if (!checkpointFile_.empty() && FileTools::fileExists(checkpointFile_))
+    readCheckpoint_();
+  lastCheckpoint_ = chrono::steady_clock::now();
+
+  // Starting points may take very different times, so they are taken from a shared
+  // counter rather than split in fixed chunks:
+  unsigned int nbWorkers = static_cast<unsigned int>(min(static_cast<size_t>(ParallelTools::getNumberOfThreads(nbThreads_)), starts_.size()));
+  atomic<size_t> next(0);
+  string error;
+  ParallelTools::runInParallel(nbWorkers, nbWorkers, [&](size_t, size_t)
+  {
+    for (size_t i = next++; i < starts_.size(); i = next++)
+    {
+      if (starts_[i]->done)
+        continue;
+      try
+      {
+        optimizeStartingPoint_(i);
+      }
+      catch (exception& e)
+      {
+        lock_guard<mutex> lock(mutex_);
+        if (error.empty())
+          error = "Starting point " + TextTools::toString(i) + " (" + starts_[i]->description + "): " + e.what();
+      }
+    }
+  });
+  if (!error.empty())
+    throw Exception("MultiStartOptimizer::optimize. " + error);
+  return getBestStartingPoint();
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::optimizeStartingPoint_(size_t i)
+{
+  StartingPoint& start = *starts_[i];
+  unique_ptr<TransitionModel> model(model_->clone());
+  unique_ptr<DiscreteDistribution> rDist(rateDistribution_->clone());
+  unique_ptr<NNIHomogeneousTreeLikelihood> tl(new NNIHomogeneousTreeLikelihood(*start.tree, data_, model.get(), rDist.get(), true, false));
+  tl->initialize();
+  if (start.parameters.size() > 0)
+    tl->matchParametersValues(start.parameters);
+
+  MultiStartCheckpointListener listener(this, i, tl.get());
+  if (optimizeTopology_)
+  {
+    OptimizationTools::optimizeTreeNNI(tl.get(), tl->getParameters(), true, 100, 100, nbEvalMax_, 1, 0, 0, false, 0, optMethodDeriv_);
+    saveState_(i, *tl, false, false);
+  }
+  OptimizationTools::optimizeNumericalParameters(tl.get(), tl->getParameters(), &listener, 1, tolerance_, nbEvalMax_, 0, 0, false, 0, optMethodDeriv_, optMethodModel_);
+  saveState_(i, *tl, true, true);
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::saveState_(size_t i, const TreeLikelihood& tl, bool done, bool force)
+{
+  lock_guard<mutex> lock(mutex_);
+  StartingPoint& start = *starts_[i];
+  start.tree.reset(new TreeTemplate<Node>(tl.getTree()));
+  start.parameters = tl.getParameters();
+  start.value = tl.getValue();
+  start.done = done;
+  if (checkpointFile_.empty())
+    return;
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if (force || chrono::duration<double>(now - lastCheckpoint_).count() >= checkpointInterval_)
+  {
+    writeCheckpoint_();
+    lastCheckpoint_ = now;
+  }
+}
+
+/******************************************************************************/
+
+size_t MultiStartOptimizer::getBestStartingPoint() const
+{
+  size_t best = 0;
+  for (size_t i = 1; i < starts_.size(); ++i)
+  {
+    if (starts_[i]->value < starts_[best]->value)
+      best = i;
+  }
+  return best;
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::writeCheckpoint() const
+{
+  lock_guard<mutex> lock(mutex_);
+  writeCheckpoint_();
+}
+
+void MultiStartOptimizer::writeCheckpoint_() const
+{
+  if (checkpointFile_.empty())
+    throw Exception("MultiStartOptimizer::writeCheckpoint. No checkpoint file set.");
+  string tmpFile = checkpointFile_ + ".tmp";
+  ofstream out(tmpFile.c_str(), ios::out);
+  if (!out)
+    throw IOException("MultiStartOptimizer::writeCheckpoint. Could not open file: " + tmpFile);
+  // 17 significant digits are enough for all values to be read back exactly:
+  out << setprecision(17);
+  out << "# Multi-start optimization checkpoint" << endl;
+  out << "starts=" << starts_.size() << endl;
+  for (size_t i = 0; i < starts_.size(); ++i)
+  {
+    const StartingPoint& start = *starts_[i];
+    out << endl;
+    out << "start=" << i << endl;
+    out << "description=" << start.description << endl;
+    out << "status=" << (start.done ? "done" : "running") << endl;
+    if (!std::isinf(start.value))
+      out << "f(x)=" << start.value << endl;
+    // Branch lengths are written with the precision of the stream:
+    out << "tree=";
+    TreeTemplateTools::treeToParenthesis(*start.tree, out);
+    for (size_t j = 0; j < start.parameters.size(); ++j)
+    {
+      out << "parameter=" << start.parameters[j].getName() << "=" << start.parameters[j].getValue() << endl;
+    }
+  }
+  out.close();
+  if (!out || rename(tmpFile.c_str(), checkpointFile_.c_str()) != 0)
+    throw IOException("MultiStartOptimizer::writeCheckpoint. Could not write file: " + checkpointFile_);
+}
+
+/******************************************************************************/
+
+void MultiStartOptimizer::readCheckpoint_()
+{
+  ifstream in(checkpointFile_.c_str(), ios::in);
+  vector<string> lines = FileTools::putStreamIntoVectorOfStrings(in);
+  in.close();
+  StartingPoint* start = 0;
+  size_t nbStarts = 0;
+  for (size_t l = 0; l < lines.size(); ++l)
+  {
+    string line = TextTools::removeSurroundingWhiteSpaces(lines[l]);
+    if (line.empty() || line[0] == '#')
+      continue;
+    size_t pos = line.find('=');
+    if (pos == string::npos)
+      throw IOException("MultiStartOptimizer::readCheckpoint. Corrupted checkpoint file at line " + TextTools::toString(l + 1) + ": " + line);
+    string key = line.substr(0, pos);
+    string value = line.substr(pos + 1);
+    if (key == "starts")
+    {
+      nbStarts = TextTools::to<size_t>(value);
+      if (nbStarts != starts_.size())
+        throw Exception("MultiStartOptimizer::readCheckpoint. Checkpoint file has " + value + " starting points, but " + TextTools::toString(starts_.size()) + " were set.");
+    }
+    else if (key == "start")
+    {
+      size_t i = TextTools::to<size_t>(value);
+      if (i >= starts_.size())
+        throw Exception("MultiStartOptimizer::readCheckpoint. Starting point out of range: " + value);
+      start = starts_[i].get();
+      start->parameters.reset();
+    }
+    else if (!start)
+      throw IOException("MultiStartOptimizer::readCheckpoint. Corrupted checkpoint file at line " + TextTools::toString(l + 1) + ": " + line);
+    else if (key == "description")
+    {
+      if (value != start->description)
+        throw Exception("MultiStartOptimizer::readCheckpoint. Starting point mismatch: " + value + " found instead of " + start->description + ".");
+    }
+    else if (key == "status")
+      start->done = (value == "done");
+    else if (key == "f(x)")
+      start->value = TextTools::toDouble(value);
+    else if (key == "tree")
+      start->tree.reset(TreeTemplateTools::parenthesisToTree(value, false, TreeTools::BOOTSTRAP, false, false));
+    else if (key == "parameter")
+    {
+      size_t pos2 = value.rfind('=');
+      if (pos2 == string::npos)
+        throw IOException("MultiStartOptimizer::readCheckpoint. Corrupted checkpoint file at line " + TextTools::toString(l + 1) + ": " + line);
+      start->parameters.addParameter(Parameter(value.substr(0, pos2), TextTools::toDouble(value.substr(pos2 + 1))));
+    }
+  }
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,236 @@
+//
+// File: MultiStartOptimizer.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+
+#ifndef _MULTISTARTOPTIMIZER_H_
+#define _MULTISTARTOPTIMIZER_H_
+
+#include "OptimizationTools.h"
+
+#include <Bpp/Numeric/NumConstants.h>
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+namespace bpp
+{
+
+/**
+ * @brief Optimize a homogeneous likelihood from several starting trees, and keep the best result.
+ *
+ * Each starting point gets its own NNIHomogeneousTreeLikelihood object, built with copies of
+ * the substitution model and rate distribution, so that starting points are optimized
+ * independently in a pool of threads. Starting trees can be given directly, or generated at
+ * random, by parsimony or by BioNJ.
+ *
+ * If a checkpoint file is set, the state of all starting points (tree with branch lengths,
+ * parameter values, log-likelihood and status) is periodically written to it.
+ * When optimize() is called and the checkpoint file already exists, finished starting points
+ * are restored from it, and unfinished ones are resumed from their last saved state.
+ * The file is first written to a temporary file, which is then renamed, so that a crash
+ * while writing does not corrupt the previous checkpoint.
+ */
+class MultiStartOptimizer
+{
+  private:
+    class StartingPoint
+    {
+      public:
+        std::string description;
+        std::unique_ptr< TreeTemplate<Node> > tree;
+        ParameterList parameters;
+        double value;
+        bool done;
+
+      public:
+        StartingPoint(const std::string& desc, TreeTemplate<Node>* t):
+          description(desc), tree(t), parameters(), value(NumConstants::PINF()), done(false) {}
+    };
+
+    const SiteContainer& data_;
+    std::unique_ptr<TransitionModel> model_;
+    std::unique_ptr<DiscreteDistribution> rateDistribution_;
+    std::vector< std::unique_ptr<StartingPoint> > starts_;
+    unsigned int nbThreads_;
+    bool optimizeTopology_;
+    double tolerance_;
+    unsigned int nbEvalMax_;
+    std::string optMethodDeriv_;
+    std::string optMethodModel_;
+    std::string checkpointFile_;
+    double checkpointInterval_;
+    std::chrono::steady_clock::time_point lastCheckpoint_;
+    mutable std::mutex mutex_;
+
+  public:
+    /**
+     * @brief Build a new multi-start optimizer.
+     *
+     * @param data      The alignment to use.
+     * @param model     The substitution model, with initial parameter values. It will be copied for each starting point.
+     * @param rDist     The rate distribution, with initial parameter values. It will be copied for each starting point.
+     * @param nbThreads The number of starting points to optimize simultaneously. 0 means as many as the hardware supports.
+     */
+    MultiStartOptimizer(
+      const SiteContainer& data,
+      const TransitionModel& model,
+      const DiscreteDistribution& rDist,
+      unsigned int nbThreads = 0);
+
+    MultiStartOptimizer(const MultiStartOptimizer&) = delete;
+    MultiStartOptimizer& operator=(const MultiStartOptimizer&) = delete;
+
+    virtual ~MultiStartOptimizer() {}
+
+  public:
+    /**
+     * @brief Add a starting tree.
+     *
+     * @param tree        The tree to start from. It must be unrooted, and leaves must match the sequences.
+     * @param description A short description of the starting point, also used to check checkpoint files.
+     */
+    void addStartingTree(const Tree& tree, const std::string& description);
+
+    /**
+     * @brief Add random starting trees, all branch lengths being set to a given value.
+     *
+     * Trees are generated using TreeTemplateTools::getRandomTree, with the global random generator.
+     */
+    void addRandomStartingTrees(unsigned int n, double brLen = 0.1);
+
+    /**
+     * @brief Add a starting tree estimated by maximum parsimony, all branch lengths being set to a given value.
+     *
+     * A random tree is improved by NNIs using a DRTreeParsimonyScore.
+     */
+    void addParsimonyStartingTree(double brLen = 0.1);
+
+    /**
+     * @brief Add a starting tree estimated by BioNJ, from maximum likelihood distances computed with the model and rate distribution.
+     */
+    void addBioNJStartingTree();
+
+    size_t getNumberOfStartingPoints() const { return starts_.size(); }
+
+    const std::string& getStartingPointDescription(size_t i) const { return starts_[i]->description; }
+
+    void setOptimizeTopology(bool yn) { optimizeTopology_ = yn; }
+
+    void setTolerance(double tolerance) { tolerance_ = tolerance; }
+
+    void setMaximumNumberOfEvaluations(unsigned int nbEvalMax) { nbEvalMax_ = nbEvalMax; }
+
+    /**
+     * @brief Set the methods passed to OptimizationTools::optimizeNumericalParameters.
+     */
+    void setOptimizationMethods(const std::string& optMethodDeriv, const std::string& optMethodModel)
+    {
+      optMethodDeriv_ = optMethodDeriv;
+      optMethodModel_ = optMethodModel;
+    }
+
+    /**
+     * @brief Set the checkpoint file.
+     *
+     * @param path     The path to the checkpoint file, or an empty string for no checkpoint.
+     * @param interval The minimum time between two checkpoints during an optimization, in seconds.
+     * The file is also written each time a starting point is done.
+     */
+    void setCheckpointFile(const std::string& path, double interval = 600)
+    {
+      checkpointFile_ = path;
+      checkpointInterval_ = interval;
+    }
+
+    /**
+     * @brief Optimize all starting points, resuming from the checkpoint file if there is one.
+     *
+     * @return The index of the best starting point.
+     * @throw Exception If the checkpoint file does not match the starting points, or if an optimization failed.
+     */
+    size_t optimize();
+
+    /**
+     * @return The index of the starting point with the highest likelihood.
+     */
+    size_t getBestStartingPoint() const;
+
+    /**
+     * @return The -log likelihood reached from a starting point, or +inf if it was not optimized yet.
+     */
+    double getValue(size_t i) const { return starts_[i]->value; }
+
+    /**
+     * @return The current tree of a starting point, with its branch lengths.
+     */
+    const TreeTemplate<Node>& getTree(size_t i) const { return *starts_[i]->tree; }
+
+    /**
+     * @return The parameters of the likelihood function reached from a starting point, including branch lengths.
+     */
+    const ParameterList& getParameters(size_t i) const { return starts_[i]->parameters; }
+
+    /**
+     * @brief Write the state of all starting points to the checkpoint file.
+     */
+    void writeCheckpoint() const;
+
+  private:
+    void readCheckpoint_();
+
+    void optimizeStartingPoint_(size_t i);
+
+    /**
+     * @brief Store the current state of a likelihood function, and write it if enough time has elapsed.
+     */
+    void saveState_(size_t i, const TreeLikelihood& tl, bool done, bool force);
+
+    void writeCheckpoint_() const;
+
+    friend class MultiStartCheckpointListener;
+};
+
+} //end of namespace bpp.
+
+#endif // _MULTISTARTOPTIMIZER_H_
+
@@ -57,14 +57,15 @@ Node::Node(const Node& node):
   id_(node.id_), name_(0),
   sons_(), father_(0),
   //, sons_(node.sons_), father_(node.father_),
-  distanceToFather_(0), nodeProperties_(), branchProperties_()
+  distanceToFather_(0), nodeProperties_(), branchProperties_(), bootstrap_(0)
 {
-  name_             = node.hasName() ? new string(* node.name_) : 0;
-  distanceToFather_ = node.hasDistanceToFather() ? new double(* node.distanceToFather_) : 0;
+  name_             = node.hasName() ? NodeArena::create<string>(* node.name_) : 0;
+  distanceToFather_ = node.hasDistanceToFather() ? NodeArena::create<double>(* node.distanceToFather_) : 0;
   for (map<string, Clonable *>::iterator i = node.nodeProperties_.begin(); i != node.nodeProperties_.end(); i++)
     nodeProperties_[i->first] = i->second->clone();
   for (map<string, Clonable *>::iterator i = node.branchProperties_.begin(); i != node.branchProperties_.end(); i++)
     branchProperties_[i->first] = i->second->clone();
+  updateBootstrap_(TreeTools::BOOTSTRAP);
 }
 
 /** Assignation operator: *****************************************************/
@@ -72,11 +73,11 @@ Node::Node(const Node& node):
 Node& Node::operator=(const Node & node)
 {
   id_               = node.id_;
-  if(name_) delete name_;
-  name_             = node.hasName() ? new string(* node.name_) : 0;
+  NodeArena::destroy(name_);
+  name_             = node.hasName() ? NodeArena::create<string>(* node.name_) : 0;
   //father_           = node.father_;
-  if(distanceToFather_) delete distanceToFather_;
-  distanceToFather_ = node.hasDistanceToFather() ? new double(* node.distanceToFather_) : 0;
+  NodeArena::destroy(distanceToFather_);
+  distanceToFather_ = node.hasDistanceToFather() ? NodeArena::create<double>(* node.distanceToFather_) : 0;
   //sons_             = node.sons_;
   for(map<string, Clonable *>::iterator i = node.nodeProperties_.begin(); i != node.nodeProperties_.end(); i++)
   {
@@ -90,6 +91,7 @@ Node& Node::operator=(const Node & node)
     if(p) delete p;
     branchProperties_[i->first] = i->second->clone();
   }
+  updateBootstrap_(TreeTools::BOOTSTRAP);
   return * this;
 }
       
@@ -138,17 +140,28 @@ size_t Node::getSonPosition(const Node* son) const
   throw NodeNotFoundException("Son not found", TextTools::toString(son->getId()));
 }
 
-bool Node::hasBootstrapValue() const
+double Node::getBootstrapValue() const
 {
-  return hasBranchProperty(TreeTools::BOOTSTRAP);
+  if (bootstrap_)
+    return bootstrap_->getValue();
+  else
+    throw PropertyNotFoundException("", TreeTools::BOOTSTRAP, this);
 }
 
-double Node::getBootstrapValue() const
+void Node::setBootstrapValue(double value)
 {
-  if(hasBranchProperty(TreeTools::BOOTSTRAP))
-    return dynamic_cast<const Number<double> *>(getBranchProperty(TreeTools::BOOTSTRAP))->getValue();
+  if (bootstrap_)
+    *bootstrap_ = Number<double>(value);
   else
-    throw PropertyNotFoundException("", TreeTools::BOOTSTRAP, this);
+    setBranchProperty(TreeTools::BOOTSTRAP, Number<double>(value));
+}
+
+void Node::updateBootstrap_(const string& name)
+{
+  if (name != TreeTools::BOOTSTRAP)
+    return;
+  map<string, Clonable*>::iterator it = branchProperties_.find(name);
+  bootstrap_ = it == branchProperties_.end() ? 0 : dynamic_cast<Number<double>*>(it->second);
 }
 
 /******************************************************************************/
@@ -41,6 +41,7 @@
 #define _NODE_H_
 
 #include "TreeExceptions.h"
+#include "NodeArena.h"
 
 #include <Bpp/Clonable.h>
 #include <Bpp/Utils/MapTools.h>
@@ -99,6 +100,14 @@ protected:
   mutable std::map<std::string, Clonable*> nodeProperties_;
   mutable std::map<std::string, Clonable*> branchProperties_;
 
+  /**
+   * @brief The TreeTools::BOOTSTRAP branch property, if it is a Number<double>, 0 otherwise.
+   *
+   * This points to the object stored in branchProperties_, so that bootstrap values can be
+   * read without a map lookup nor a dynamic_cast.
+   */
+  Number<double>* bootstrap_;
+
 public:
   /**
    * @brief Build a new void Node object.
@@ -110,7 +119,8 @@ public:
     father_(0),
     distanceToFather_(0),
     nodeProperties_(),
-    branchProperties_()
+    branchProperties_(),
+    bootstrap_(0)
   {}
 
   /**
@@ -123,7 +133,8 @@ public:
     father_(0),
     distanceToFather_(0),
     nodeProperties_(),
-    branchProperties_()
+    branchProperties_(),
+    bootstrap_(0)
   {}
 
   /**
@@ -131,12 +142,13 @@ public:
    */
   Node(const std::string& name) :
     id_(0),
-    name_(new std::string(name)),
+    name_(NodeArena::create<std::string>(name)),
     sons_(),
     father_(0),
     distanceToFather_(0),
     nodeProperties_(),
-    branchProperties_()
+    branchProperties_(),
+    bootstrap_(0)
   {}
 
   /**
@@ -144,12 +156,13 @@ public:
    */
   Node(int id, const std::string& name) :
     id_(id),
-    name_(new std::string(name)),
+    name_(NodeArena::create<std::string>(name)),
     sons_(),
     father_(0),
     distanceToFather_(0),
     nodeProperties_(),
-    branchProperties_()
+    branchProperties_(),
+    bootstrap_(0)
   {}
 
   /**
@@ -173,11 +186,18 @@ public:
 
   Node* clone() const { return new Node(*this); }
 
+  /**
+   * @brief Nodes are allocated in the NodeArena active in the current thread, if any.
+   */
+  static void* operator new(size_t size) { return NodeArena::allocate(size); }
+
+  static void operator delete(void* p) { NodeArena::deallocate(p); }
+
 public:
   virtual ~Node()
   {
-    if (name_) delete name_;
-    if (distanceToFather_) delete distanceToFather_;
+    NodeArena::destroy(name_);
+    NodeArena::destroy(distanceToFather_);
     for (std::map<std::string, Clonable*>::iterator i = nodeProperties_.begin(); i != nodeProperties_.end(); i++)
     {
       delete i->second;
@@ -246,8 +266,10 @@ public:
    */
   virtual void setName(const std::string& name)
   {
-    if (name_) delete name_;
-    name_ = new std::string(name);
+    if (name_)
+      *name_ = name;
+    else
+      name_ = NodeArena::create<std::string>(name);
   }
 
   /**
@@ -255,7 +277,7 @@ public:
    */
   virtual void deleteName()
   {
-    if (name_) delete name_;
+    NodeArena::destroy(name_);
     name_ = 0;
   }
 
@@ -299,8 +321,9 @@ public:
   virtual void setDistanceToFather(double distance)
   {
     if (distanceToFather_)
-      delete distanceToFather_;
-    distanceToFather_ = new double(distance);
+      *distanceToFather_ = distance;
+    else
+      distanceToFather_ = NodeArena::create<double>(distance);
   }
 
   /**
@@ -308,8 +331,7 @@ public:
    */
   virtual void deleteDistanceToFather()
   {
-    if (distanceToFather_)
-      delete distanceToFather_;
+    NodeArena::destroy(distanceToFather_);
     distanceToFather_ = 0;
   }
 
@@ -612,6 +634,7 @@ public:
     if (hasBranchProperty(name))
       delete branchProperties_[name];
     branchProperties_[name] = property.clone();
+    updateBootstrap_(name);
   }
 
   virtual Clonable* getBranchProperty(const std::string& name)
@@ -636,6 +659,7 @@ public:
     {
       Clonable* removed = branchProperties_[name];
       branchProperties_.erase(name);
+      updateBootstrap_(name);
       return removed;
     }
     else
@@ -648,6 +672,7 @@ public:
     {
       delete branchProperties_[name];
       branchProperties_.erase(name);
+      updateBootstrap_(name);
     }
     else
       throw PropertyNotFoundException("", name, this);
@@ -661,6 +686,7 @@ public:
   virtual void removeBranchProperties()
   {
     branchProperties_.clear();
+    bootstrap_ = 0;
   }
 
   /**
@@ -673,15 +699,34 @@ public:
       delete i->second;
     }
     branchProperties_.clear();
+    bootstrap_ = 0;
   }
 
   virtual bool hasBranchProperty(const std::string& name) const { return branchProperties_.find(name) != branchProperties_.end(); }
 
   virtual std::vector<std::string> getBranchPropertyNames() const { return MapTools::getKeys(branchProperties_); }
 
-  virtual bool hasBootstrapValue() const;
+  /** @} */
 
+  /**
+   * @name Bootstrap value, stored as the TreeTools::BOOTSTRAP branch property:
+   *
+   * These methods access the value directly, without a lookup of the property by name.
+   *
+   * @{
+   */
+  virtual bool hasBootstrapValue() const { return bootstrap_ != 0; }
+
+  /**
+   * @throw PropertyNotFoundException If the node has no bootstrap value, or if it is not a Number<double>.
+   */
   virtual double getBootstrapValue() const;
+
+  /**
+   * @brief Set the bootstrap value, updating the existing property in place if any.
+   */
+  virtual void setBootstrapValue(double value);
+
   /** @} */
   // Equality operator:
 
@@ -691,6 +736,12 @@ public:
 
   virtual bool isLeaf() const { return degree() <= 1; }
 
+private:
+  /**
+   * @brief Update bootstrap_ after the branch property with the given name has been modified.
+   */
+  void updateBootstrap_(const std::string& name);
+
 };
 } // end of namespace bpp.
 
@@ -0,0 +1,143 @@
+//
+// File: NodeArena.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "NodeArena.h"
+
+using namespace bpp;
+
+// From the STL:
+#include <algorithm>
+
+using namespace std;
+
+/******************************************************************************/
+
+thread_local NodeArena* NodeArena::active_ = 0;
+
+map<uintptr_t, size_t> NodeArena::registry_;
+
+mutex NodeArena::registryMutex_;
+
+atomic<size_t> NodeArena::nbRegisteredBlocks_(0);
+
+/******************************************************************************/
+
+void* NodeArena::allocate(size_t size)
+{
+  NodeArena* arena = active_;
+  return arena ? arena->allocateInArena_(size) : ::operator new(size);
+}
+
+/******************************************************************************/
+
+void NodeArena::deallocate(void* p)
+{
+  if (!p)
+    return;
+  if (nbRegisteredBlocks_.load() > 0 && isInArena_(p))
+    return; // The memory is released with the arena.
+  ::operator delete(p);
+}
+
+/******************************************************************************/
+
+bool NodeArena::isInArena_(const void* p)
+{
+  uintptr_t address = reinterpret_cast<uintptr_t>(p);
+  lock_guard<mutex> lock(registryMutex_);
+  map<uintptr_t, size_t>::const_iterator it = registry_.upper_bound(address);
+  if (it == registry_.begin())
+    return false;
+  --it;
+  return address < it->first + it->second;
+}
+
+/******************************************************************************/
+
+void* NodeArena::allocateInArena_(size_t size)
+{
+  // Keep all allocations aligned:
+  size_t alignment = alignof(std::max_align_t);
+  size = (size + alignment - 1) / alignment * alignment;
+  // Look for room in the current block, then in the next ones, which may be left from before the last clear:
+  while (currentBlock_ < blocks_.size() && position_ + size > blocks_[currentBlock_].second)
+  {
+    currentBlock_++;
+    position_ = 0;
+  }
+  if (currentBlock_ == blocks_.size())
+  {
+    size_t blockSize = max(blockSize_, size);
+    char* block = static_cast<char*>(::operator new(blockSize));
+    {
+      lock_guard<mutex> lock(registryMutex_);
+      registry_[reinterpret_cast<uintptr_t>(block)] = blockSize;
+      nbRegisteredBlocks_++;
+    }
+    blocks_.push_back(pair<char*, size_t>(block, blockSize));
+    position_ = 0;
+  }
+  char* p = blocks_[currentBlock_].first + position_;
+  position_ += size;
+  allocatedSize_ += size;
+  return p;
+}
+
+/******************************************************************************/
+
+void NodeArena::release_()
+{
+  {
+    lock_guard<mutex> lock(registryMutex_);
+    for (size_t i = 0; i < blocks_.size(); i++)
+    {
+      registry_.erase(reinterpret_cast<uintptr_t>(blocks_[i].first));
+      nbRegisteredBlocks_--;
+    }
+  }
+  for (size_t i = 0; i < blocks_.size(); i++)
+  {
+    ::operator delete(blocks_[i].first);
+  }
+  blocks_.clear();
+  clear();
+}
+
+/******************************************************************************/
+
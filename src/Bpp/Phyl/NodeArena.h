@@ -0,0 +1,224 @@
+//
+// File: NodeArena.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _NODEARENA_H_
+#define _NODEARENA_H_
+
+// From the STL:
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace bpp
+{
+
+/**
+ * @brief A memory arena for tree nodes.
+ *
+ * Node objects, together with their name and branch length, are usually allocated one by one
+ * on the heap. When an arena is activated in a thread with a NodeArena::Scope object, all the
+ * nodes created by this thread are allocated in large blocks owned by the arena instead,
+ * whatever the code creating them (tree readers, copies of trees, distance methods, ...):
+ * @code
+ * NodeArena arena;
+ * {
+ *   NodeArena::Scope scope(arena);
+ *   TreeTemplate<Node>* tree = TreeTemplateTools::parenthesisToTree(description);
+ *   ...
+ *   delete tree;
+ * }
+ * arena.clear(); // The memory can now be reused for another tree.
+ * @endcode
+ * Deleting a node allocated in an arena does not free any memory: the arena releases all its
+ * blocks at once when it is cleared or destroyed. Nodes still call their destructor, which frees
+ * the properties, the list of sons and names longer than the small string buffer, which remain
+ * allocated on the heap.
+ *
+ * An arena must outlive all the nodes allocated in it, and must not be used by several threads
+ * at the same time. Nodes allocated in an arena can be deleted while another arena, or none, is active.
+ *
+ * Allocations carry no header: the blocks of all arenas are registered, so that deallocate() can
+ * recognize the memory they own. As long as no arena holds any block, allocate() and deallocate()
+ * reduce to plain operator new and delete.
+ */
+class NodeArena
+{
+  private:
+    std::vector< std::pair<char*, size_t> > blocks_;
+    size_t blockSize_;
+    size_t currentBlock_;
+    size_t position_;
+    size_t allocatedSize_;
+
+    static thread_local NodeArena* active_;
+
+    /**
+     * @brief The blocks of all arenas, as sizes indexed by start address.
+     */
+    static std::map<uintptr_t, size_t> registry_;
+    static std::mutex registryMutex_;
+    static std::atomic<size_t> nbRegisteredBlocks_;
+
+  public:
+    /**
+     * @brief RAII object activating an arena in the current thread.
+     *
+     * The previously active arena, if any, is restored when the scope is destroyed.
+     */
+    class Scope
+    {
+      private:
+        NodeArena* previous_;
+
+      public:
+        Scope(NodeArena& arena) : previous_(active_) { active_ = &arena; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { active_ = previous_; }
+    };
+
+  public:
+    /**
+     * @param blockSize The size in bytes of the blocks of memory.
+     * Larger allocations get a block of their own.
+     */
+    NodeArena(size_t blockSize = 65536) :
+      blocks_(),
+      blockSize_(blockSize),
+      currentBlock_(0),
+      position_(0),
+      allocatedSize_(0)
+    {}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    virtual ~NodeArena() { release_(); }
+
+  public:
+    /**
+     * @brief Make all the memory of the arena available again.
+     *
+     * The blocks are kept for future allocations. All the objects allocated in the arena must have been deleted.
+     */
+    void clear()
+    {
+      currentBlock_ = 0;
+      position_ = 0;
+      allocatedSize_ = 0;
+    }
+
+    /**
+     * @return The total size in bytes of the allocations since the last clear.
+     */
+    size_t getAllocatedSize() const { return allocatedSize_; }
+
+    size_t getNumberOfBlocks() const { return blocks_.size(); }
+
+    /**
+     * @return The arena active in the current thread, 0 if none.
+     */
+    static NodeArena* getActiveArena() { return active_; }
+
+    /**
+     * @brief Allocate memory in the active arena, or on the heap if no arena is active.
+     *
+     * @param size The number of bytes to allocate.
+     * @return A pointer to memory suitably aligned for any type.
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * @brief Free memory obtained with allocate().
+     *
+     * Nothing is done for memory allocated in an arena. While arenas hold blocks,
+     * this requires a lookup in the registry of blocks, under a lock.
+     */
+    static void deallocate(void* p);
+
+    /**
+     * @brief Create an object with allocate().
+     */
+    template<class T, class... Args>
+    static T* create(Args&&... args)
+    {
+      void* p = allocate(sizeof(T));
+      try
+      {
+        return new (p) T(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        deallocate(p);
+        throw;
+      }
+    }
+
+    /**
+     * @brief Destroy an object built with create().
+     */
+    template<class T>
+    static void destroy(T* object)
+    {
+      if (!object)
+        return;
+      object->~T();
+      deallocate(object);
+    }
+
+  private:
+    void* allocateInArena_(size_t size);
+
+    void release_();
+
+    /**
+     * @return True if the memory belongs to a block of an arena.
+     */
+    static bool isInArena_(const void* p);
+};
+
+} //end of namespace bpp.
+
+#endif //_NODEARENA_H_
+
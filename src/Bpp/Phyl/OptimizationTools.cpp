@@ -39,6 +39,9 @@
 
 #include "OptimizationTools.h"
 #include "Likelihood/PseudoNewtonOptimizer.h"
+#include "Likelihood/BranchNewtonOptimizer.h"
+#include "Likelihood/LbfgsOptimizer.h"
+#include "Likelihood/ValueAndGradientFunction.h"
 #include "Likelihood/GlobalClockTreeLikelihoodFunctionWrapper.h"
 #include "NNISearchable.h"
 #include "NNITopologySearch.h"
@@ -71,6 +74,8 @@ std::string OptimizationTools::OPTIMIZATION_NEWTON = "newton";
 std::string OptimizationTools::OPTIMIZATION_GRADIENT = "gradient";
 std::string OptimizationTools::OPTIMIZATION_BRENT = "Brent";
 std::string OptimizationTools::OPTIMIZATION_BFGS = "BFGS";
+std::string OptimizationTools::OPTIMIZATION_BRANCH_NEWTON = "branch_newton";
+std::string OptimizationTools::OPTIMIZATION_LBFGS = "L-BFGS";
 
 /******************************************************************************/
 
@@ -165,13 +170,58 @@ unsigned int OptimizationTools::optimizeNumericalParameters(
   unique_ptr<DerivableSecondOrder> frep;
   if (reparametrization)
   {
-    frep.reset(new ReparametrizationDerivableSecondOrderWrapper(f, parameters));
+    // Keep the joint computation of the value and gradient when the likelihood has one:
+    if (dynamic_cast<ValueAndGradientFunction*>(tl))
+      frep.reset(new ReparametrizationValueAndGradientWrapper(f, parameters));
+    else
+      frep.reset(new ReparametrizationDerivableSecondOrderWrapper(f, parameters));
     f = frep.get();
 
     // Reset parameters to remove constraints:
     pl = f->getParameters().subList(parameters.getParameterNames());
   }
 
+  if (optMethodModel == OPTIMIZATION_LBFGS)
+  {
+    // All parameters are optimized jointly, with numerical derivatives only when analytical ones are not available:
+    DerivableFirstOrder* fl = f;
+    unique_ptr<AbstractNumericalDerivative> fnum;
+    ParameterList plder = tl->getFirstOrderDerivableParameters();
+    vector<string> vNameNum;
+    for (size_t i = 0; i < pl.size(); i++)
+    {
+      if (!plder.hasParameter(pl[i].getName()))
+        vNameNum.push_back(pl[i].getName());
+    }
+    if (vNameNum.size() > 0)
+    {
+      if (dynamic_cast<ValueAndGradientFunction*>(f))
+        fnum.reset(new TwoPointsValueAndGradientWrapper(f, vNameNum));
+      else
+        fnum.reset(new TwoPointsNumericalDerivative(f));
+      fnum->setInterval(0.0001);
+      fnum->setParametersToDerivate(vNameNum);
+      fl = fnum.get();
+    }
+    LbfgsOptimizer optimizer(fl);
+    optimizer.setVerbose(verbose);
+    optimizer.setProfiler(profiler);
+    optimizer.setMessageHandler(messageHandler);
+    optimizer.setMaximumNumberOfEvaluations(tlEvalMax);
+    optimizer.getStopCondition()->setTolerance(tolerance);
+    optimizer.setConstraintPolicy(AutoParameter::CONSTRAINTS_AUTO);
+    NaNListener nanListener(&optimizer, tl);
+    optimizer.addOptimizationListener(&nanListener);
+    if (listener)
+      optimizer.addOptimizationListener(listener);
+    optimizer.init(pl);
+    optimizer.optimize();
+
+    if (verbose > 0)
+      ApplicationTools::displayMessage("\n");
+    return optimizer.getNumberOfEvaluations();
+  }
+
   // ///////////////
   // Build optimizer:
 
@@ -187,6 +237,13 @@ unsigned int OptimizationTools::optimizeNumericalParameters(
     desc->addOptimizer("Branch length parameters", new PseudoNewtonOptimizer(f), tl->getBranchLengthsParameters().getParameterNames(), 2, MetaOptimizerInfos::IT_TYPE_FULL);
   else if (optMethodDeriv == OPTIMIZATION_BFGS)
     desc->addOptimizer("Branch length parameters", new BfgsMultiDimensions(f), tl->getBranchLengthsParameters().getParameterNames(), 2, MetaOptimizerInfos::IT_TYPE_FULL);
+  else if (optMethodDeriv == OPTIMIZATION_BRANCH_NEWTON)
+  {
+    DRHomogeneousTreeLikelihood* drtl = dynamic_cast<DRHomogeneousTreeLikelihood*>(tl);
+    if (!BranchNewtonOptimizer::isSupported(drtl) || reparametrization)
+      throw Exception("OptimizationTools::optimizeNumericalParameters. Method " + optMethodDeriv + " requires a DRHomogeneousTreeLikelihood or a NNIHomogeneousTreeLikelihood without reparametrization.");
+    desc->addOptimizer("Branch length parameters", new BranchNewtonOptimizer(drtl), tl->getBranchLengthsParameters().getParameterNames(), 2, MetaOptimizerInfos::IT_TYPE_FULL);
+  }
   else
     throw Exception("OptimizationTools::optimizeNumericalParameters. Unknown optimization method: " + optMethodDeriv);
 
@@ -214,7 +271,16 @@ unsigned int OptimizationTools::optimizeNumericalParameters(
     vector<string> vNameDer2 = plrd.getParameterNames();
 
     vNameDer.insert(vNameDer.begin(), vNameDer2.begin(), vNameDer2.end());
-    fnum->setParametersToDerivate(vNameDer);
+
+    // Analytical first order derivatives are used when available:
+    ParameterList plder = tl->getFirstOrderDerivableParameters();
+    vector<string> vNameNum;
+    for (size_t i = 0; i < vNameDer.size(); i++)
+    {
+      if (!plder.hasParameter(vNameDer[i]))
+        vNameNum.push_back(vNameDer[i]);
+    }
+    fnum->setParametersToDerivate(vNameNum);
 
     desc->addOptimizer("Rate & model distribution parameters", new BfgsMultiDimensions(fnum.get()), vNameDer, 1, MetaOptimizerInfos::IT_TYPE_FULL);
     poptimizer = new MetaOptimizer(fnum.get(), desc, nstep);
@@ -316,6 +382,16 @@ unsigned int OptimizationTools::optimizeNumericalParameters2(
   ParameterList tmp = tl->getNonDerivableParameters(); 
   if (useClock)
     tmp.addParameters(fclock->getHeightParameters());
+  else if (optMethodDeriv != OPTIMIZATION_NEWTON)
+  {
+    // Analytical first order derivatives are used when available:
+    ParameterList plder = tl->getFirstOrderDerivableParameters();
+    for (size_t i = 0; i < plder.size(); i++)
+    {
+      if (tmp.hasParameter(plder[i].getName()))
+        tmp.deleteParameter(plder[i].getName());
+    }
+  }
   fnum->setParametersToDerivate(tmp.getParameterNames());
   optimizer->setVerbose(verbose);
   optimizer->setProfiler(profiler);
@@ -372,6 +448,13 @@ unsigned int OptimizationTools::optimizeBranchLengthsParameters(
     tl->enableSecondOrderDerivatives(false);
     optimizer = new BfgsMultiDimensions(tl);
   }
+  else if (optMethodDeriv == OPTIMIZATION_BRANCH_NEWTON)
+  {
+    DRHomogeneousTreeLikelihood* drtl = dynamic_cast<DRHomogeneousTreeLikelihood*>(tl);
+    if (!BranchNewtonOptimizer::isSupported(drtl))
+      throw Exception("OptimizationTools::optimizeBranchLengthsParameters. Method " + optMethodDeriv + " requires a DRHomogeneousTreeLikelihood or a NNIHomogeneousTreeLikelihood.");
+    optimizer = new BranchNewtonOptimizer(drtl);
+  }
   else
     throw Exception("OptimizationTools::optimizeBranchLengthsParameters. Unknown optimization method: " + optMethodDeriv);
   optimizer->setVerbose(verbose);
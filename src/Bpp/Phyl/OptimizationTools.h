@@ -309,6 +309,25 @@ public:
   static std::string OPTIMIZATION_BRENT;
   static std::string OPTIMIZATION_BFGS;
 
+  /**
+   * @brief Newton's method applied to each branch separately, on sets of non-adjacent branches processed in parallel.
+   *
+   * Requires a DRHomogeneousTreeLikelihood or a NNIHomogeneousTreeLikelihood, without reparametrization.
+   * @see BranchNewtonOptimizer
+   */
+  static std::string OPTIMIZATION_BRANCH_NEWTON;
+
+  /**
+   * @brief Limited-memory BFGS on all parameters jointly, instead of alternating sub-optimizers.
+   *
+   * First order derivatives provided by the likelihood function are used when available:
+   * they are analytical for branch lengths, and partly numerical for substitution model and
+   * rate distribution parameters (see NumericalModelParameterDerivative). Derivatives are
+   * computed numerically on the whole function otherwise.
+   * @see LbfgsOptimizer, TreeLikelihood::getFirstOrderDerivableParameters()
+   */
+  static std::string OPTIMIZATION_LBFGS;
+
   /**
    * @brief Optimize numerical parameters (branch length, substitution model & rate distribution) of a TreeLikelihood function.
    *
@@ -330,9 +349,10 @@ public:
    *                          This can improve optimization, but is a bit slower.
    * @param verbose        The verbose level.
    * @param optMethodDeriv Optimization type for derivable parameters (first or second order derivatives).
-   * @see OPTIMIZATION_NEWTON, OPTIMIZATION_GRADIENT
+   * @see OPTIMIZATION_NEWTON, OPTIMIZATION_GRADIENT, OPTIMIZATION_BRANCH_NEWTON
    * @param optMethodModel Optimization type for model parameters (Brent or BFGS).
-   * @see OPTIMIZATION_BRENT, OPTIMIZATION_BFGS
+   * If L-BFGS is used, all parameters are optimized jointly, and optMethodDeriv and nstep are ignored.
+   * @see OPTIMIZATION_BRENT, OPTIMIZATION_BFGS, OPTIMIZATION_LBFGS
    * @throw Exception any exception thrown by the Optimizer.
    */
   static unsigned int optimizeNumericalParameters(
@@ -0,0 +1,118 @@
+//
+// File: ParallelTools.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "ParallelTools.h"
+
+// From the STL:
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+unsigned int ParallelTools::getNumberOfThreads(unsigned int nbThreads)
+{
+  if (nbThreads > 0)
+    return nbThreads;
+  return max(thread::hardware_concurrency(), 1u);
+}
+
+/******************************************************************************/
+
+void ParallelTools::runInParallel(size_t n, unsigned int nbThreads, const function<void (size_t, size_t)>& f)
+{
+  size_t nbChunks = min(static_cast<size_t>(getNumberOfThreads(nbThreads)), n);
+  if (nbChunks <= 1)
+  {
+    f(0, n);
+    return;
+  }
+  vector<thread> threads;
+  threads.reserve(nbChunks);
+  // Exceptions cannot leave a thread, they are passed to the current one:
+  vector<exception_ptr> errors(nbChunks);
+  size_t chunk = n / nbChunks;
+  size_t remainder = n % nbChunks;
+  size_t begin = 0;
+  try
+  {
+    for (size_t t = 0; t < nbChunks; ++t)
+    {
+      size_t end = begin + chunk + (t < remainder ? 1 : 0);
+      exception_ptr* error = &errors[t];
+      threads.push_back(thread([&f, error, begin, end]()
+      {
+        try
+        {
+          f(begin, end);
+        }
+        catch (...)
+        {
+          *error = current_exception();
+        }
+      }));
+      begin = end;
+    }
+  }
+  catch (...)
+  {
+    // A thread could not be started:
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+      threads[t].join();
+    }
+    throw;
+  }
+  for (size_t t = 0; t < nbChunks; ++t)
+  {
+    threads[t].join();
+  }
+  for (size_t t = 0; t < nbChunks; ++t)
+  {
+    if (errors[t])
+      rethrow_exception(errors[t]);
+  }
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,85 @@
+//
+// File: ParallelTools.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PARALLELTOOLS_H_
+#define _PARALLELTOOLS_H_
+
+// From the STL:
+#include <cstddef>
+#include <functional>
+
+namespace bpp
+{
+
+/**
+ * @brief Utilitary methods to distribute independent computations over threads.
+ *
+ * Computations are split into contiguous chunks of indices, one per thread.
+ * The function passed to runInParallel() must only write to data specific to
+ * its range of indices, or protect shared data by itself.
+ */
+class ParallelTools
+{
+  public:
+    /**
+     * @brief Get the number of threads actually used for a given request.
+     *
+     * @param nbThreads The number of threads requested. 0 means as many as the hardware supports.
+     * @return The number of threads to use, at least 1.
+     */
+    static unsigned int getNumberOfThreads(unsigned int nbThreads);
+
+    /**
+     * @brief Split the range [0, n[ into contiguous chunks and process each of them in a separate thread.
+     *
+     * If only one thread is used, the function is called directly in the current thread.
+     * Otherwise, all threads are joined before returning, and if some calls threw an exception,
+     * the one thrown for the first chunk is rethrown in the current thread.
+     *
+     * @param n         The number of indices to process.
+     * @param nbThreads The maximum number of threads to use. 0 means as many as the hardware supports.
+     * @param f         The function to call, with the first and past-the-last indices of a chunk as arguments.
+     */
+    static void runInParallel(size_t n, unsigned int nbThreads, const std::function<void (size_t, size_t)>& f);
+};
+
+} //end of namespace bpp.
+
+#endif // _PARALLELTOOLS_H_
+
@@ -118,8 +118,20 @@ DRTreeParsimonyScore::~DRTreeParsimonyScore()
 /******************************************************************************/
 void DRTreeParsimonyScore::computeScores()
 {
-  computeScoresPostorder(getTreeP_()->getRootNode());
-  computeScoresPreorder(getTreeP_()->getRootNode());
+  // The traversal orders are cached by the tree:
+  if (!getTreeP_()->getRootNode()->isLeaf())
+  {
+    const vector<const Node*>& postorder = getTreeP_()->getPostorderNodes();
+    for (size_t i = 0; i < postorder.size(); i++)
+    {
+      computeNodeScoresPostorder_(postorder[i]);
+    }
+  }
+  const vector<const Node*>& preorder = getTreeP_()->getPreorderNodes();
+  for (size_t i = 0; i < preorder.size(); i++)
+  {
+    computeNodeScoresPreorder_(preorder[i]);
+  }
   computeScoresForNode(
     parsimonyData_->getNodeData(getTree().getRootId()),
     parsimonyData_->getRootBitsets(),
@@ -127,13 +139,23 @@ void DRTreeParsimonyScore::computeScores()
 }
 
 void DRTreeParsimonyScore::computeScoresPostorder(const Node* node)
+{
+  if (node->isLeaf()) return;
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPostorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    computeNodeScoresPostorder_(nodes[i]);
+  }
+}
+
+void DRTreeParsimonyScore::computeNodeScoresPostorder_(const Node* node)
 {
   if (node->isLeaf()) return;
   DRTreeParsimonyNodeData* pData = &parsimonyData_->getNodeData(node->getId());
   for (unsigned int k = 0; k < node->getNumberOfSons(); k++)
   {
     const Node* son = node->getSon(k);
-    computeScoresPostorder(son);
     vector<Bitset>* bitsets      = &pData->getBitsetsArrayForNeighbor(son->getId());
     vector<unsigned int>* scores = &pData->getScoresArrayForNeighbor(son->getId());
     if (son->isLeaf())
@@ -179,6 +201,16 @@ void DRTreeParsimonyScore::computeScoresPostorderForNode(const DRTreeParsimonyNo
 }
 
 void DRTreeParsimonyScore::computeScoresPreorder(const Node* node)
+{
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPreorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    computeNodeScoresPreorder_(nodes[i]);
+  }
+}
+
+void DRTreeParsimonyScore::computeNodeScoresPreorder_(const Node* node)
 {
   if (node->getNumberOfSons() == 0) return;
   DRTreeParsimonyNodeData* pData = &parsimonyData_->getNodeData(node->getId());
@@ -206,11 +238,6 @@ void DRTreeParsimonyScore::computeScoresPreorder(const Node* node)
         *scores);
     }
   }
-  // Recurse call:
-  for (unsigned int k = 0; k < node->getNumberOfSons(); k++)
-  {
-    computeScoresPreorder(node->getSon(k));
-  }
 }
 
 void DRTreeParsimonyScore::computeScoresPreorderForNode(const DRTreeParsimonyNodeData& pData, const Node* source, std::vector<Bitset>& rBitsets, std::vector<unsigned int>& rScores)
@@ -397,6 +424,7 @@ void DRTreeParsimonyScore::doNNI(int nodeId)
   grandFather->removeSon(uncle);
   parent->addSon(uncle);
   grandFather->addSon(son);
+  getTreeP_()->invalidateTraversals();
 }
 
 /******************************************************************************/
@@ -100,6 +100,18 @@ protected:
    * @brief Compute scores (postorder algorithm).
    */
   virtual void computeScoresPostorder(const Node*);
+  /**
+   * @brief Compute the scores of a node toward its sons.
+   *
+   * Subtrees are traversed in postorder with this method, without recursion.
+   */
+  void computeNodeScoresPostorder_(const Node*);
+  /**
+   * @brief Compute the scores of a node toward its father.
+   *
+   * Subtrees are traversed in preorder with this method, without recursion.
+   */
+  void computeNodeScoresPreorder_(const Node*);
 
 public:
   unsigned int getScore() const;
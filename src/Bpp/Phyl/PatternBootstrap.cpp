@@ -0,0 +1,200 @@
+//
+// File: PatternBootstrap.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "PatternBootstrap.h"
+#include "ParallelTools.h"
+#include "TreeTools.h"
+
+#include <Bpp/Numeric/NumConstants.h>
+#include <Bpp/Numeric/Random/RandomTools.h>
+#include <Bpp/Text/TextTools.h>
+
+// From the STL:
+#include <atomic>
+#include <mutex>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+PatternBootstrap::PatternBootstrap(const NNIHomogeneousTreeLikelihood& tl, unsigned int nbThreads) :
+  model_(tl.getModel()->clone()),
+  rateDistribution_(tl.getRateDistribution()->clone()),
+  reference_(tl.clone()),
+  weights_(),
+  trees_(),
+  values_(),
+  nbThreads_(nbThreads),
+  optimizeTopology_(false),
+  optimizeModelParameters_(false),
+  tolerance_(0.000001),
+  nbEvalMax_(1000000),
+  optMethodDeriv_(OptimizationTools::OPTIMIZATION_NEWTON)
+{
+  if (!tl.isInitialized())
+    throw Exception("PatternBootstrap. The likelihood object is not initialized.");
+  reference_->setModel(model_.get());
+  reference_->setRateDistribution(rateDistribution_.get());
+}
+
+/******************************************************************************/
+
+vector<unsigned int> PatternBootstrap::drawPatternWeights(const AbstractTreeLikelihoodData& data)
+{
+  const vector<size_t>& patterns = data.getRootArrayPositions();
+  vector<unsigned int> weights(data.getWeights().size(), 0);
+  for (size_t i = 0; i < patterns.size(); ++i)
+  {
+    weights[patterns[RandomTools::giveIntRandomNumberBetweenZeroAndEntry<size_t>(patterns.size())]]++;
+  }
+  return weights;
+}
+
+/******************************************************************************/
+
+void PatternBootstrap::run(unsigned int nbReplicates)
+{
+  weights_.resize(nbReplicates);
+  for (size_t i = 0; i < nbReplicates; ++i)
+  {
+    weights_[i] = drawPatternWeights(*reference_->getLikelihoodData());
+  }
+  trees_.clear();
+  trees_.resize(nbReplicates);
+  values_.assign(nbReplicates, NumConstants::PINF());
+
+  unsigned int nbWorkers = static_cast<unsigned int>(min(static_cast<size_t>(ParallelTools::getNumberOfThreads(nbThreads_)), static_cast<size_t>(nbReplicates)));
+  atomic<size_t> next(0);
+  mutex errorMutex;
+  string error;
+  ParallelTools::runInParallel(nbWorkers, nbWorkers, [&](size_t, size_t)
+  {
+    unique_ptr<TransitionModel> model(model_->clone());
+    unique_ptr<DiscreteDistribution> rDist(rateDistribution_->clone());
+    unique_ptr<NNIHomogeneousTreeLikelihood> tl;
+    for (size_t i = next++; i < nbReplicates; i = next++)
+    {
+      try
+      {
+        if (!tl || optimizeTopology_)
+        {
+          // A fresh copy shares all its arrays with the reference, and
+          // the model and distribution are reset to the reference values:
+          model->matchParametersValues(model_->getParameters());
+          rDist->matchParametersValues(rateDistribution_->getParameters());
+          tl.reset(reference_->clone());
+          tl->setModel(model.get());
+          tl->setRateDistribution(rDist.get());
+        }
+        else
+        {
+          // Only the parameters modified by the previous replicate are recomputed:
+          tl->matchParametersValues(reference_->getParameters());
+        }
+        optimizeReplicate_(*tl, i);
+      }
+      catch (exception& e)
+      {
+        lock_guard<mutex> lock(errorMutex);
+        if (error.empty())
+          error = "Replicate " + TextTools::toString(i) + ": " + e.what();
+        tl.reset();
+      }
+    }
+  });
+  if (!error.empty())
+    throw Exception("PatternBootstrap::run. " + error);
+}
+
+/******************************************************************************/
+
+void PatternBootstrap::optimizeReplicate_(NNIHomogeneousTreeLikelihood& tl, size_t i)
+{
+  tl.setPatternWeights(weights_[i]);
+  ParameterList parameters = optimizeModelParameters_ ? tl.getParameters() : tl.getBranchLengthsParameters();
+  if (optimizeTopology_)
+    OptimizationTools::optimizeTreeNNI(&tl, parameters, true, 100, 100, nbEvalMax_, 1, 0, 0, false, 0, optMethodDeriv_);
+  OptimizationTools::optimizeNumericalParameters(&tl, parameters, 0, 1, tolerance_, nbEvalMax_, 0, 0, false, 0, optMethodDeriv_);
+  trees_[i].reset(new TreeTemplate<Node>(tl.getTree()));
+  values_[i] = tl.getValue();
+}
+
+/******************************************************************************/
+
+void PatternBootstrap::computeBootstrapValues(Tree& tree) const
+{
+  vector<Tree*> trees;
+  for (size_t i = 0; i < trees_.size(); ++i)
+  {
+    trees.push_back(trees_[i].get());
+  }
+  TreeTools::computeBootstrapValues(tree, trees, false);
+}
+
+/******************************************************************************/
+
+vector< vector<double> > PatternBootstrap::getRellLogLikelihoods(const PairedSiteLikelihoods& psl) const
+{
+  const vector<size_t>& patterns = reference_->getLikelihoodData()->getRootArrayPositions();
+  if (psl.getNumberOfSites() != patterns.size())
+    throw Exception("PatternBootstrap::getRellLogLikelihoods. The number of sites does not match the original alignment.");
+
+  // One site of each pattern:
+  vector<size_t> sites(reference_->getLikelihoodData()->getWeights().size());
+  for (size_t s = patterns.size(); s > 0; --s)
+  {
+    sites[patterns[s - 1]] = s - 1;
+  }
+
+  vector< vector<double> > logliks(weights_.size());
+  vector<int> siteCounts(patterns.size(), 0);
+  for (size_t i = 0; i < weights_.size(); ++i)
+  {
+    for (size_t p = 0; p < sites.size(); ++p)
+    {
+      siteCounts[sites[p]] = static_cast<int>(weights_[i][p]);
+    }
+    logliks[i] = psl.getReplicateLogLikelihoods(siteCounts);
+  }
+  return logliks;
+}
+
+/******************************************************************************/
+
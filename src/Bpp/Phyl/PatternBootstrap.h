@@ -0,0 +1,188 @@
+//
+// File: PatternBootstrap.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PATTERNBOOTSTRAP_H_
+#define _PATTERNBOOTSTRAP_H_
+
+#include "OptimizationTools.h"
+#include "Likelihood/PairedSiteLikelihoods.h"
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace bpp
+{
+
+/**
+ * @brief Nonparametric bootstrap by reweighting the site patterns of an alignment.
+ *
+ * A bootstrap replicate only contains sites of the original alignment, and therefore
+ * only its distinct site patterns, in different numbers. Instead of building a new alignment
+ * and a new likelihood object for each replicate, replicates are evaluated by changing the
+ * pattern weights of a copy of the original likelihood object
+ * (see DRHomogeneousTreeLikelihood::setPatternWeights()).
+ *
+ * Replicates are optimized in a pool of threads. Each thread works on its own copy of the
+ * likelihood object, with its own copies of the substitution model and rate distribution.
+ * Copies share the likelihood arrays of the leaves, which are never modified, and the other
+ * arrays until they are recomputed (see CopyOnWrite). If the topology is not optimized, the
+ * copy of a thread is reused for all its replicates, and no array is reallocated.
+ *
+ * All pattern weights are drawn by run() with the global random generator before any
+ * optimization, so that the replicates do not depend on the number of threads.
+ * The same replicates can then be used to compute RELL log-likelihoods of other trees
+ * or models, see getRellLogLikelihoods().
+ */
+class PatternBootstrap
+{
+  private:
+    std::unique_ptr<TransitionModel> model_;
+    std::unique_ptr<DiscreteDistribution> rateDistribution_;
+    std::unique_ptr<NNIHomogeneousTreeLikelihood> reference_;
+    std::vector< std::vector<unsigned int> > weights_;
+    std::vector< std::unique_ptr< TreeTemplate<Node> > > trees_;
+    std::vector<double> values_;
+    unsigned int nbThreads_;
+    bool optimizeTopology_;
+    bool optimizeModelParameters_;
+    double tolerance_;
+    unsigned int nbEvalMax_;
+    std::string optMethodDeriv_;
+
+  public:
+    /**
+     * @brief Build a new bootstrap engine.
+     *
+     * @param tl        The likelihood of the original data, with the parameter values to start from.
+     * It must be initialized. It is copied, together with its substitution model and rate distribution.
+     * @param nbThreads The number of replicates to optimize simultaneously. 0 means as many as the hardware supports.
+     * Replicates are optimized one at a time by default.
+     */
+    PatternBootstrap(const NNIHomogeneousTreeLikelihood& tl, unsigned int nbThreads = 1);
+
+    PatternBootstrap(const PatternBootstrap&) = delete;
+    PatternBootstrap& operator=(const PatternBootstrap&) = delete;
+
+    virtual ~PatternBootstrap() {}
+
+  public:
+    void setOptimizeTopology(bool yn) { optimizeTopology_ = yn; }
+
+    /**
+     * @brief Tell if substitution model and rate distribution parameters are optimized for each replicate.
+     *
+     * By default, only branch lengths (and the topology if requested) are optimized.
+     */
+    void setOptimizeModelParameters(bool yn) { optimizeModelParameters_ = yn; }
+
+    void setTolerance(double tolerance) { tolerance_ = tolerance; }
+
+    void setMaximumNumberOfEvaluations(unsigned int nbEvalMax) { nbEvalMax_ = nbEvalMax; }
+
+    /**
+     * @brief Set the method used for derivable parameters, as passed to OptimizationTools::optimizeNumericalParameters.
+     */
+    void setOptimizationMethod(const std::string& optMethodDeriv) { optMethodDeriv_ = optMethodDeriv; }
+
+    /**
+     * @brief Draw the pattern weights of a bootstrap replicate.
+     *
+     * As many sites as in the original alignment are drawn with replacement, and counted by pattern.
+     *
+     * @param data The likelihood data of the original alignment.
+     * @return The number of sites drawn for each pattern.
+     */
+    static std::vector<unsigned int> drawPatternWeights(const AbstractTreeLikelihoodData& data);
+
+    /**
+     * @brief Draw new replicates and optimize them.
+     *
+     * Results of previous runs are discarded.
+     *
+     * @param nbReplicates The number of replicates.
+     * @throw Exception If an optimization failed.
+     */
+    void run(unsigned int nbReplicates);
+
+    size_t getNumberOfReplicates() const { return weights_.size(); }
+
+    /**
+     * @return The pattern weights of a replicate.
+     */
+    const std::vector<unsigned int>& getPatternWeights(size_t i) const { return weights_[i]; }
+
+    /**
+     * @return The optimized tree of a replicate, with its branch lengths.
+     */
+    const TreeTemplate<Node>& getTree(size_t i) const { return *trees_[i]; }
+
+    /**
+     * @return The -log likelihood of a replicate at its optimum.
+     */
+    double getValue(size_t i) const { return values_[i]; }
+
+    /**
+     * @brief Set bootstrap values on the branches of a tree, from the trees of all replicates.
+     *
+     * @see TreeTools::computeBootstrapValues
+     */
+    void computeBootstrapValues(Tree& tree) const;
+
+    /**
+     * @brief Compute the RELL log-likelihoods of several models on the replicates of the last run.
+     *
+     * As sites with the same pattern have the same log-likelihood under each model,
+     * the log-likelihood of a replicate is obtained by weighting one site of each pattern.
+     *
+     * @param psl Site log-likelihoods of several models, for the original alignment.
+     * @return The log-likelihood of each model, for each replicate, as a [replicate][model] array.
+     * @throw Exception If the number of sites does not match the original alignment.
+     */
+    std::vector< std::vector<double> > getRellLogLikelihoods(const PairedSiteLikelihoods& psl) const;
+
+  private:
+    void optimizeReplicate_(NNIHomogeneousTreeLikelihood& tl, size_t i);
+};
+
+} //end of namespace bpp.
+
+#endif // _PATTERNBOOTSTRAP_H_
+
@@ -72,37 +72,49 @@ void PhyloStatistics::setTree(const Tree& tree)
 
 void PhyloStatistics::computeForSubtree_(const Node* node, double& height, size_t& depth)
 {
-  if (node->isLeaf())
-    numberOfLeaves_++;
-  else
-    numberOfAncestors_++;
-
-  nodeNumberOfSons_.push_back(node->getNumberOfSons());
-  
-  height = 0;
-  depth = 0;
-  for (size_t i = 0; i < node->getNumberOfSons(); i++)
+  vector<const Node*> nodes;
+  TreeTemplateTools::getPreorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    const Node* son = (*node)[static_cast<int>(i)];
-    double dist = 0;
-    if (son->hasDistanceToFather()) dist = son->getDistanceToFather();
-    else dist = 0;
-    double subHeight;
-    size_t subDepth;
-    computeForSubtree_(son, subHeight, subDepth);
-    subHeight += dist;
-    subDepth++;
-    if (subHeight > height) height = subHeight;
-    if (subDepth  > depth ) depth  = subDepth ;
+    if (nodes[i]->isLeaf())
+      numberOfLeaves_++;
+    else
+      numberOfAncestors_++;
+    nodeNumberOfSons_.push_back(nodes[i]->getNumberOfSons());
   }
 
-  if (node->hasDistanceToFather())
-    branchLengths_.push_back(node->getDistanceToFather());
-  else 
-    branchLengths_.push_back(log(0)); //-Inf if no branch length.
-
-  nodeHeights_.push_back(height);
-  nodeDepths_.push_back(depth);
+  // Heights and depths are computed in postorder, the results for the sons of each node
+  // being the last ones on the stack:
+  nodes.clear();
+  TreeTemplateTools::getPostorderNodes(*node, nodes);
+  vector< pair<double, size_t> > results;
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    const Node* current = nodes[i];
+    size_t nbSons = current->getNumberOfSons();
+    height = 0;
+    depth = 0;
+    for (size_t j = 0; j < nbSons; j++)
+    {
+      const Node* son = current->getSon(j);
+      double dist = 0;
+      if (son->hasDistanceToFather()) dist = son->getDistanceToFather();
+      const pair<double, size_t>& sonResult = results[results.size() - nbSons + j];
+      double subHeight = sonResult.first + dist;
+      size_t subDepth = sonResult.second + 1;
+      if (subHeight > height) height = subHeight;
+      if (subDepth  > depth ) depth  = subDepth ;
+    }
+    results.resize(results.size() - nbSons);
+    results.push_back(make_pair(height, depth));
+
+    if (current->hasDistanceToFather())
+      branchLengths_.push_back(current->getDistanceToFather());
+    else 
+      branchLengths_.push_back(log(0)); //-Inf if no branch length.
+
+    nodeHeights_.push_back(height);
+    nodeDepths_.push_back(depth);
+  }
 }
 
-
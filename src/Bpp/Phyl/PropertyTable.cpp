@@ -0,0 +1,287 @@
+//
+// File: PropertyTable.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "PropertyTable.h"
+
+#include <Bpp/Exceptions.h>
+
+using namespace bpp;
+
+// From the STL:
+#include <typeinfo>
+
+using namespace std;
+
+/******************************************************************************/
+
+PropertyTable::PropertyTable(const PropertyTable& table) :
+  columns_(table.columns_),
+  keys_(table.keys_)
+{
+  for (size_t k = 0; k < columns_.size(); k++)
+  {
+    vector<Clonable*>& objects = columns_[k].objects;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+      if (objects[i])
+        objects[i] = objects[i]->clone();
+    }
+  }
+}
+
+/******************************************************************************/
+
+PropertyTable& PropertyTable::operator=(const PropertyTable& table)
+{
+  if (this == &table)
+    return *this;
+  PropertyTable copy(table);
+  clear();
+  columns_.swap(copy.columns_);
+  keys_.swap(copy.keys_);
+  return *this;
+}
+
+/******************************************************************************/
+
+void PropertyTable::clear()
+{
+  for (size_t k = 0; k < columns_.size(); k++)
+  {
+    deleteObjects_(columns_[k]);
+  }
+  columns_.clear();
+  keys_.clear();
+}
+
+/******************************************************************************/
+
+void PropertyTable::deleteObjects_(Column& column)
+{
+  for (size_t i = 0; i < column.objects.size(); i++)
+  {
+    delete column.objects[i];
+  }
+  column.objects.clear();
+}
+
+/******************************************************************************/
+
+size_t PropertyTable::getKey(const string& name, Type type)
+{
+  map<string, size_t>::const_iterator it = keys_.find(name);
+  if (it != keys_.end())
+    return it->second;
+  size_t key = columns_.size();
+  columns_.push_back(Column(name, type));
+  keys_[name] = key;
+  return key;
+}
+
+/******************************************************************************/
+
+void PropertyTable::throwType_(size_t key, const string& method) const
+{
+  const char* typeNames[] = { "double", "int", "string", "object" };
+  throw Exception("PropertyTable::" + method + ". Property '" + columns_[key].name + "' is of type " + typeNames[columns_[key].type] + ".");
+}
+
+/******************************************************************************/
+
+void PropertyTable::resize_(size_t key, size_t index, Type type, const string& method)
+{
+  Column& column = columns_[key];
+  if (column.type != type)
+    throwType_(key, method);
+  if (index >= column.defined.size())
+  {
+    column.defined.resize(index + 1, false);
+    switch (type)
+    {
+    case DOUBLE:
+      column.doubles.resize(index + 1);
+      break;
+    case INT:
+      column.ints.resize(index + 1);
+      break;
+    case STRING:
+      column.strings.resize(index + 1, BppString(""));
+      break;
+    case OBJECT:
+      column.objects.resize(index + 1, 0);
+      break;
+    }
+  }
+  column.defined[index] = true;
+}
+
+/******************************************************************************/
+
+void PropertyTable::removeValue(size_t key, size_t index)
+{
+  if (!hasValue(key, index))
+    return;
+  Column& column = columns_[key];
+  column.defined[index] = false;
+  if (column.type == OBJECT)
+  {
+    delete column.objects[index];
+    column.objects[index] = 0;
+  }
+  else if (column.type == STRING)
+    column.strings[index] = BppString("");
+}
+
+/******************************************************************************/
+
+void PropertyTable::convertToObjects_(Column& column)
+{
+  vector<Clonable*> objects(column.defined.size(), 0);
+  for (size_t i = 0; i < column.defined.size(); i++)
+  {
+    if (!column.defined[i])
+      continue;
+    switch (column.type)
+    {
+    case DOUBLE:
+      objects[i] = column.doubles[i].clone();
+      break;
+    case INT:
+      objects[i] = column.ints[i].clone();
+      break;
+    case STRING:
+      objects[i] = column.strings[i].clone();
+      break;
+    case OBJECT:
+      objects[i] = column.objects[i];
+      break;
+    }
+  }
+  column.doubles.clear();
+  column.ints.clear();
+  column.strings.clear();
+  column.objects.swap(objects);
+  column.type = OBJECT;
+}
+
+/******************************************************************************/
+
+void PropertyTable::setProperty(size_t index, const string& name, const Clonable& property)
+{
+  // Only exact types are stored by value, so that derived classes are not sliced:
+  Type type = OBJECT;
+  if (typeid(property) == typeid(Number<double>))
+    type = DOUBLE;
+  else if (typeid(property) == typeid(Number<int>))
+    type = INT;
+  else if (typeid(property) == typeid(BppString))
+    type = STRING;
+
+  size_t key = getKey(name, type);
+  Column& column = columns_[key];
+  if (column.type != type && column.type != OBJECT)
+    convertToObjects_(column);
+  switch (column.type)
+  {
+  case DOUBLE:
+    setDouble(key, index, dynamic_cast<const Number<double>&>(property).getValue());
+    break;
+  case INT:
+    setInt(key, index, dynamic_cast<const Number<int>&>(property).getValue());
+    break;
+  case STRING:
+    setString(key, index, dynamic_cast<const BppString&>(property).toSTL());
+    break;
+  case OBJECT:
+    {
+      Clonable* object = property.clone();
+      removeValue(key, index);
+      resize_(key, index, OBJECT, "setProperty");
+      column.objects[index] = object;
+    }
+    break;
+  }
+}
+
+/******************************************************************************/
+
+Clonable* PropertyTable::getProperty(size_t index, const string& name)
+{
+  int key = findKey(name);
+  if (key < 0 || !hasValue(static_cast<size_t>(key), index))
+    throw PropertyNotFoundException("PropertyTable::getProperty.", name, static_cast<int>(index));
+  Column& column = columns_[static_cast<size_t>(key)];
+  switch (column.type)
+  {
+  case DOUBLE:
+    return &column.doubles[index];
+  case INT:
+    return &column.ints[index];
+  case STRING:
+    return &column.strings[index];
+  case OBJECT:
+    return column.objects[index];
+  }
+  return 0;
+}
+
+/******************************************************************************/
+
+Clonable* PropertyTable::removeProperty(size_t index, const string& name)
+{
+  Clonable* property = getProperty(index, name)->clone();
+  removeValue(static_cast<size_t>(findKey(name)), index);
+  return property;
+}
+
+/******************************************************************************/
+
+vector<string> PropertyTable::getPropertyNames(size_t index) const
+{
+  vector<string> names;
+  for (map<string, size_t>::const_iterator it = keys_.begin(); it != keys_.end(); it++)
+  {
+    if (hasValue(it->second, index))
+      names.push_back(it->first);
+  }
+  return names;
+}
+
+/******************************************************************************/
+
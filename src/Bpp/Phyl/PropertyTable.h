@@ -0,0 +1,279 @@
+//
+// File: PropertyTable.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PROPERTYTABLE_H_
+#define _PROPERTYTABLE_H_
+
+#include "TreeExceptions.h"
+
+#include <Bpp/Clonable.h>
+#include <Bpp/BppString.h>
+#include <Bpp/Numeric/Number.h>
+
+// From the STL:
+#include <string>
+#include <vector>
+#include <map>
+
+namespace bpp
+{
+
+/**
+ * @brief A table of node or branch properties, stored by column.
+ *
+ * Each property name is interned once as a key, and all the values of a property are
+ * stored contiguously in a typed column, indexed by node (node ids, or node indices for
+ * FrozenTree objects). Reading a bootstrap value is then an array access:
+ * @code
+ * size_t key = table.getKey(TreeTools::BOOTSTRAP, PropertyTable::DOUBLE);
+ * for (...)
+ *   if (table.hasValue(key, id))
+ *     total += table.getDouble(key, id);
+ * @endcode
+ * instead of a string-keyed map lookup and a dynamic_cast for each node.
+ *
+ * Number<double>, Number<int> and BppString properties are stored in DOUBLE, INT and
+ * STRING columns. Properties of any other type, or of several types under the same name,
+ * are stored as cloned objects in an OBJECT column.
+ *
+ * The methods taking a property name and a Clonable object provide the same interface as
+ * Node::setNodeProperty and the like. Pointers returned by getProperty() are only valid
+ * until the table is modified.
+ */
+class PropertyTable :
+  public virtual Clonable
+{
+  public:
+    enum Type { DOUBLE, INT, STRING, OBJECT };
+
+  private:
+    struct Column
+    {
+      std::string name;
+      Type type;
+      std::vector<bool> defined;
+      std::vector< Number<double> > doubles;
+      std::vector< Number<int> > ints;
+      std::vector<BppString> strings;
+      std::vector<Clonable*> objects;
+
+      Column(const std::string& columnName, Type columnType) :
+        name(columnName), type(columnType), defined(), doubles(), ints(), strings(), objects() {}
+    };
+
+    std::vector<Column> columns_;
+    std::map<std::string, size_t> keys_;
+
+  public:
+    PropertyTable() : columns_(), keys_() {}
+
+    PropertyTable(const PropertyTable& table);
+
+    PropertyTable& operator=(const PropertyTable& table);
+
+    PropertyTable* clone() const { return new PropertyTable(*this); }
+
+    virtual ~PropertyTable() { clear(); }
+
+  public:
+    /**
+     * @brief Remove all properties and keys.
+     */
+    void clear();
+
+    /**
+     * @name Typed access
+     *
+     * @{
+     */
+
+    /**
+     * @brief Get the key of a property, creating an empty column if needed.
+     *
+     * @param name The name of the property.
+     * @param type The type of the column to create, if the property is not in the table yet.
+     * @return The key of the property.
+     */
+    size_t getKey(const std::string& name, Type type);
+
+    /**
+     * @return The key of a property, or -1 if the table has no such property.
+     */
+    int findKey(const std::string& name) const
+    {
+      std::map<std::string, size_t>::const_iterator it = keys_.find(name);
+      return it == keys_.end() ? -1 : static_cast<int>(it->second);
+    }
+
+    size_t getNumberOfKeys() const { return columns_.size(); }
+
+    const std::string& getKeyName(size_t key) const { return columns_[key].name; }
+
+    Type getType(size_t key) const { return columns_[key].type; }
+
+    bool hasValue(size_t key, size_t index) const
+    {
+      const std::vector<bool>& defined = columns_[key].defined;
+      return index < defined.size() && defined[index];
+    }
+
+    /**
+     * @throw PropertyNotFoundException If there is no value for this index.
+     * @throw Exception If the property is not of type DOUBLE.
+     */
+    double getDouble(size_t key, size_t index) const
+    {
+      checkValue_(key, index, DOUBLE, "getDouble");
+      return columns_[key].doubles[index].getValue();
+    }
+
+    int getInt(size_t key, size_t index) const
+    {
+      checkValue_(key, index, INT, "getInt");
+      return columns_[key].ints[index].getValue();
+    }
+
+    const std::string& getString(size_t key, size_t index) const
+    {
+      checkValue_(key, index, STRING, "getString");
+      return columns_[key].strings[index].toSTL();
+    }
+
+    /**
+     * @throw Exception If the property is not of type DOUBLE.
+     */
+    void setDouble(size_t key, size_t index, double value)
+    {
+      resize_(key, index, DOUBLE, "setDouble");
+      columns_[key].doubles[index] = Number<double>(value);
+    }
+
+    void setInt(size_t key, size_t index, int value)
+    {
+      resize_(key, index, INT, "setInt");
+      columns_[key].ints[index] = Number<int>(value);
+    }
+
+    void setString(size_t key, size_t index, const std::string& value)
+    {
+      resize_(key, index, STRING, "setString");
+      columns_[key].strings[index] = BppString(value);
+    }
+
+    /**
+     * @brief Remove the value of a property, if any.
+     */
+    void removeValue(size_t key, size_t index);
+
+    /** @} */
+
+    /**
+     * @name Access by name, as with Node properties
+     *
+     * @{
+     */
+
+    bool hasProperty(size_t index, const std::string& name) const
+    {
+      int key = findKey(name);
+      return key >= 0 && hasValue(static_cast<size_t>(key), index);
+    }
+
+    /**
+     * @brief Set a property, replacing the previous value if any.
+     *
+     * @param index    The index of the node.
+     * @param name     The name of the property.
+     * @param property The value of the property, which is copied.
+     */
+    void setProperty(size_t index, const std::string& name, const Clonable& property);
+
+    /**
+     * @throw PropertyNotFoundException If the node has no such property.
+     */
+    Clonable* getProperty(size_t index, const std::string& name);
+
+    const Clonable* getProperty(size_t index, const std::string& name) const
+    {
+      return const_cast<PropertyTable*>(this)->getProperty(index, name);
+    }
+
+    /**
+     * @brief Remove a property.
+     *
+     * @return A copy of the removed property, which the caller has to delete.
+     * @throw PropertyNotFoundException If the node has no such property.
+     */
+    Clonable* removeProperty(size_t index, const std::string& name);
+
+    /**
+     * @return The names of the properties of a node, sorted.
+     */
+    std::vector<std::string> getPropertyNames(size_t index) const;
+
+    /** @} */
+
+  private:
+    void checkValue_(size_t key, size_t index, Type type, const std::string& method) const
+    {
+      if (columns_[key].type != type)
+        throwType_(key, method);
+      if (!hasValue(key, index))
+        throw PropertyNotFoundException("PropertyTable::" + method + ".", columns_[key].name, static_cast<int>(index));
+    }
+
+    /**
+     * @brief Check the type of a column and make room for the given index.
+     */
+    void resize_(size_t key, size_t index, Type type, const std::string& method);
+
+    void throwType_(size_t key, const std::string& method) const;
+
+    /**
+     * @brief Convert a typed column to an OBJECT one, when properties of another type are added.
+     */
+    void convertToObjects_(Column& column);
+
+    static void deleteObjects_(Column& column);
+};
+
+} //end of namespace bpp.
+
+#endif //_PROPERTYTABLE_H_
+
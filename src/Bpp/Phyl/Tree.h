@@ -305,6 +305,21 @@ namespace bpp
     virtual std::vector<std::string> getBranchPropertyNames(int nodeId) const = 0;
     /** @} */
 
+    /**
+     * @name Bootstrap values.
+     *
+     * Bootstrap values are stored as TreeTools::BOOTSTRAP branch properties, of type Number<double>.
+     * These methods give a typed access to them, faster than the generic branch property methods.
+     *
+     * @{
+     */
+    virtual bool hasBootstrapValue(int nodeId) const = 0;
+
+    virtual double getBootstrapValue(int nodeId) const = 0;
+
+    virtual void setBootstrapValue(int nodeId, double value) = 0;
+    /** @} */
+
     /**
      * @brief Change the root node.
      *
@@ -0,0 +1,289 @@
+//
+// File: TreeQueryIndex.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "TreeQueryIndex.h"
+
+using namespace bpp;
+
+// From the STL:
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/******************************************************************************/
+
+TreeQueryIndex::TreeQueryIndex(const TreeTemplate<Node>& tree) :
+  tree_(tree),
+  firstOccurrences_(),
+  subtreeSizes_(),
+  levels_(),
+  rootDistances_(),
+  sparseTable_(),
+  log2_()
+{
+  build_();
+}
+
+TreeQueryIndex::TreeQueryIndex(const Tree& tree) :
+  tree_(tree),
+  firstOccurrences_(),
+  subtreeSizes_(),
+  levels_(),
+  rootDistances_(),
+  sparseTable_(),
+  log2_()
+{
+  build_();
+}
+
+TreeQueryIndex::TreeQueryIndex(const FrozenTree& tree) :
+  tree_(tree),
+  firstOccurrences_(),
+  subtreeSizes_(),
+  levels_(),
+  rootDistances_(),
+  sparseTable_(),
+  log2_()
+{
+  build_();
+}
+
+/******************************************************************************/
+
+void TreeQueryIndex::build_()
+{
+  size_t nbNodes = tree_.getNumberOfNodes();
+
+  // Nodes are in preorder, fathers come before their sons:
+  levels_.assign(nbNodes, 0);
+  rootDistances_.assign(nbNodes, 0.);
+  for (size_t i = 1; i < nbNodes; i++)
+  {
+    size_t father = static_cast<size_t>(tree_.getFatherIndex(i));
+    levels_[i] = levels_[father] + 1;
+    rootDistances_[i] = rootDistances_[father] + tree_.getBranchLength(i); // NaN if a length is missing.
+  }
+  subtreeSizes_.assign(nbNodes, 1);
+  for (size_t i = nbNodes - 1; i > 0; i--)
+  {
+    subtreeSizes_[static_cast<size_t>(tree_.getFatherIndex(i))] += subtreeSizes_[i];
+  }
+
+  // Euler tour:
+  vector<unsigned int> tour;
+  tour.reserve(2 * nbNodes - 1);
+  firstOccurrences_.assign(nbNodes, 0);
+  vector<int> nextSons(nbNodes);
+  for (size_t i = 0; i < nbNodes; i++)
+  {
+    nextSons[i] = tree_.getFirstSonIndex(i);
+  }
+  size_t current = 0;
+  tour.push_back(0);
+  while (true)
+  {
+    int son = nextSons[current];
+    if (son >= 0)
+    {
+      nextSons[current] = tree_.getNextBrotherIndex(static_cast<size_t>(son));
+      current = static_cast<size_t>(son);
+      firstOccurrences_[current] = tour.size();
+    }
+    else
+    {
+      int father = tree_.getFatherIndex(current);
+      if (father < 0)
+        break;
+      current = static_cast<size_t>(father);
+    }
+    tour.push_back(static_cast<unsigned int>(current));
+  }
+
+  // Sparse table:
+  size_t tourLength = tour.size();
+  log2_.assign(tourLength + 1, 0);
+  for (size_t i = 2; i <= tourLength; i++)
+  {
+    log2_[i] = static_cast<unsigned char>(log2_[i / 2] + 1);
+  }
+  sparseTable_.assign(static_cast<size_t>(log2_[tourLength]) + 1, vector<unsigned int>());
+  sparseTable_[0].swap(tour);
+  for (size_t k = 1; k < sparseTable_.size(); k++)
+  {
+    const vector<unsigned int>& previous = sparseTable_[k - 1];
+    size_t half = static_cast<size_t>(1) << (k - 1);
+    vector<unsigned int>& row = sparseTable_[k];
+    row.resize(tourLength - 2 * half + 1);
+    for (size_t i = 0; i < row.size(); i++)
+    {
+      row[i] = min(previous[i], previous[i + half]);
+    }
+  }
+}
+
+/******************************************************************************/
+
+size_t TreeQueryIndex::getLastCommonAncestorIndex_(size_t index1, size_t index2) const
+{
+  size_t i = firstOccurrences_[index1];
+  size_t j = firstOccurrences_[index2];
+  if (i > j)
+    swap(i, j);
+  unsigned char k = log2_[j - i + 1];
+  return static_cast<size_t>(min(sparseTable_[k][i], sparseTable_[k][j + 1 - (static_cast<size_t>(1) << k)]));
+}
+
+/******************************************************************************/
+
+double TreeQueryIndex::getDistance_(size_t index1, size_t index2) const
+{
+  size_t ancestor = getLastCommonAncestorIndex_(index1, index2);
+  double d = rootDistances_[index1] + rootDistances_[index2] - 2. * rootDistances_[ancestor];
+  if (!std::isnan(d))
+    return d;
+  // Some length is missing above one of the nodes, sum the lengths along the path to find out if it is on the path:
+  d = 0;
+  size_t ends[2] = { index1, index2 };
+  for (size_t e = 0; e < 2; e++)
+  {
+    for (size_t i = ends[e]; i != ancestor; i = static_cast<size_t>(tree_.getFatherIndex(i)))
+    {
+      if (std::isnan(tree_.getBranchLength(i)))
+        throw NodePException("TreeQueryIndex::getDistanceBetweenAnyTwoNodes. No branch length.", tree_.getNodeId(i));
+      d += tree_.getBranchLength(i);
+    }
+  }
+  return d;
+}
+
+/******************************************************************************/
+
+int TreeQueryIndex::getLastCommonAncestor(const vector<int>& nodeIds) const
+{
+  if (nodeIds.size() == 0)
+    throw Exception("TreeQueryIndex::getLastCommonAncestor(). You must provide at least one node id.");
+  size_t ancestor = tree_.getNodeIndex(nodeIds[0]);
+  for (size_t i = 1; i < nodeIds.size(); i++)
+  {
+    ancestor = getLastCommonAncestorIndex_(ancestor, tree_.getNodeIndex(nodeIds[i]));
+  }
+  return tree_.getNodeId(ancestor);
+}
+
+/******************************************************************************/
+
+double TreeQueryIndex::getDistanceBetweenAnyTwoNodes(int nodeId1, int nodeId2) const
+{
+  return getDistance_(tree_.getNodeIndex(nodeId1), tree_.getNodeIndex(nodeId2));
+}
+
+/******************************************************************************/
+
+size_t TreeQueryIndex::getNumberOfBranchesBetweenAnyTwoNodes(int nodeId1, int nodeId2) const
+{
+  size_t index1 = tree_.getNodeIndex(nodeId1);
+  size_t index2 = tree_.getNodeIndex(nodeId2);
+  size_t ancestor = getLastCommonAncestorIndex_(index1, index2);
+  return levels_[index1] + levels_[index2] - 2 * levels_[ancestor];
+}
+
+/******************************************************************************/
+
+double TreeQueryIndex::getDistanceFromRoot(int nodeId) const
+{
+  return getDistance_(tree_.getNodeIndex(nodeId), 0);
+}
+
+/******************************************************************************/
+
+vector<int> TreeQueryIndex::getPathBetweenAnyTwoNodes(int nodeId1, int nodeId2, bool includeAncestor) const
+{
+  size_t index1 = tree_.getNodeIndex(nodeId1);
+  size_t index2 = tree_.getNodeIndex(nodeId2);
+  size_t ancestor = getLastCommonAncestorIndex_(index1, index2);
+  vector<int> path;
+  path.reserve(levels_[index1] + levels_[index2] - 2 * levels_[ancestor] + 1);
+  for (size_t i = index1; i != ancestor; i = static_cast<size_t>(tree_.getFatherIndex(i)))
+  {
+    path.push_back(tree_.getNodeId(i));
+  }
+  if (includeAncestor)
+    path.push_back(tree_.getNodeId(ancestor));
+  size_t middle = path.size();
+  for (size_t i = index2; i != ancestor; i = static_cast<size_t>(tree_.getFatherIndex(i)))
+  {
+    path.push_back(tree_.getNodeId(i));
+  }
+  reverse(path.begin() + static_cast<ptrdiff_t>(middle), path.end());
+  return path;
+}
+
+/******************************************************************************/
+
+DistanceMatrix* TreeQueryIndex::getDistanceMatrix() const
+{
+  vector<size_t> leaves;
+  for (size_t i = 0; i < tree_.getNumberOfNodes(); i++)
+  {
+    if (tree_.getDegree(i) <= 1)
+      leaves.push_back(i);
+  }
+  DistanceMatrix* matrix = new DistanceMatrix(tree_.getLeavesNames());
+  try
+  {
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+      (*matrix)(i, i) = 0;
+      for (size_t j = 0; j < i; j++)
+      {
+        (*matrix)(i, j) = (*matrix)(j, i) = getDistance_(leaves[i], leaves[j]);
+      }
+    }
+  }
+  catch (Exception&)
+  {
+    delete matrix;
+    throw;
+  }
+  return matrix;
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,217 @@
+//
+// File: TreeQueryIndex.h
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _TREEQUERYINDEX_H_
+#define _TREEQUERYINDEX_H_
+
+#include "FrozenTree.h"
+
+#include <Bpp/Seq/DistanceMatrix.h>
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+
+/**
+ * @brief An index answering common ancestor and distance queries on a tree in constant time.
+ *
+ * The index records an Euler tour of the tree, that is the list of nodes met during a
+ * depth-first traversal, each node being listed again after each of its sons.
+ * The last common ancestor of two nodes is the node of minimum depth in the tour between
+ * their first occurrences. This range minimum query is answered in constant time with a
+ * sparse table storing the minimum of all ranges whose length is a power of two.
+ * Distances are obtained from the distances of the nodes to the root.
+ *
+ * The preprocessing takes O(n log n) time and memory, for a tree with n nodes.
+ * The index works on a FrozenTree copy of the tree, and is not updated when the original tree is modified.
+ *
+ * Nodes are designated by their ids, as in TreeTools.
+ */
+class TreeQueryIndex
+{
+  private:
+    FrozenTree tree_;
+    std::vector<size_t> firstOccurrences_;
+    std::vector<size_t> subtreeSizes_;
+    std::vector<size_t> levels_;
+    std::vector<double> rootDistances_;
+
+    /**
+     * @brief Minimum node index in the ranges of the Euler tour.
+     *
+     * sparseTable_[k][i] is the minimum on [i, i + 2^k[. Nodes are indexed in preorder,
+     * so that the node of minimum depth in a range of the tour also has the minimum index.
+     */
+    std::vector< std::vector<unsigned int> > sparseTable_;
+    std::vector<unsigned char> log2_;
+
+  public:
+    /**
+     * @brief Build the index of a tree.
+     *
+     * @param tree The tree to index.
+     */
+    TreeQueryIndex(const TreeTemplate<Node>& tree);
+
+    /**
+     * @brief Build the index of any tree, through the Tree interface.
+     *
+     * @param tree The tree to index.
+     */
+    TreeQueryIndex(const Tree& tree);
+
+    /**
+     * @brief Build the index of a frozen tree.
+     *
+     * @param tree The tree to index.
+     */
+    TreeQueryIndex(const FrozenTree& tree);
+
+    virtual ~TreeQueryIndex() {}
+
+  private:
+    void build_();
+
+    size_t getLastCommonAncestorIndex_(size_t index1, size_t index2) const;
+
+    double getDistance_(size_t index1, size_t index2) const;
+
+  public:
+    /**
+     * @return The indexed tree.
+     */
+    const FrozenTree& getTree() const { return tree_; }
+
+    /**
+     * @brief Get the id of the last common ancestor of two nodes.
+     *
+     * @param nodeId1 Id of the first node.
+     * @param nodeId2 Id of the second node.
+     * @return The id of the last common ancestor, which can be one of the nodes.
+     * @throw NodeNotFoundException If a node is not found.
+     */
+    int getLastCommonAncestor(int nodeId1, int nodeId2) const
+    {
+      return tree_.getNodeId(getLastCommonAncestorIndex_(tree_.getNodeIndex(nodeId1), tree_.getNodeIndex(nodeId2)));
+    }
+
+    /**
+     * @brief Get the id of the last common ancestor of all specified nodes.
+     *
+     * This does the same as TreeTools::getLastCommonAncestor.
+     *
+     * @param nodeIds The ids of the input nodes.
+     * @throw NodeNotFoundException If a node is not found.
+     */
+    int getLastCommonAncestor(const std::vector<int>& nodeIds) const;
+
+    /**
+     * @brief Tell if a node is in the subtree defined by another node.
+     *
+     * @param ancestorId The id of the node defining the subtree.
+     * @param nodeId     The id of the node to look for.
+     * @return True if the node is in the subtree, including when the two ids are the same.
+     * @throw NodeNotFoundException If a node is not found.
+     */
+    bool isInSubtree(int ancestorId, int nodeId) const
+    {
+      size_t ancestor = tree_.getNodeIndex(ancestorId);
+      size_t node = tree_.getNodeIndex(nodeId);
+      return node >= ancestor && node < ancestor + subtreeSizes_[ancestor];
+    }
+
+    /**
+     * @brief Sum all branch lengths between two nodes.
+     *
+     * This does the same as TreeTools::getDistanceBetweenAnyTwoNodes.
+     *
+     * @param nodeId1 First node id.
+     * @param nodeId2 Second node id.
+     * @return The sum of all branch lengths between the two nodes.
+     * @throw NodeNotFoundException If a node is not found.
+     * @throw NodePException If a branch on the path has no length.
+     */
+    double getDistanceBetweenAnyTwoNodes(int nodeId1, int nodeId2) const;
+
+    /**
+     * @brief Get the number of branches between two nodes.
+     *
+     * @param nodeId1 First node id.
+     * @param nodeId2 Second node id.
+     * @throw NodeNotFoundException If a node is not found.
+     */
+    size_t getNumberOfBranchesBetweenAnyTwoNodes(int nodeId1, int nodeId2) const;
+
+    /**
+     * @brief Get the sum of the branch lengths from the root to a node.
+     *
+     * @param nodeId The node id.
+     * @throw NodeNotFoundException If the node is not found.
+     * @throw NodePException If a branch on the path has no length.
+     */
+    double getDistanceFromRoot(int nodeId) const;
+
+    /**
+     * @brief Get the nodes between two nodes.
+     *
+     * This does the same as TreeTools::getPathBetweenAnyTwoNodes, in time proportional to the length of the path.
+     *
+     * @param nodeId1 Id of first node.
+     * @param nodeId2 Id of second node.
+     * @param includeAncestor Tell if the common ancestor must be included in the vector.
+     * @return The ids of the nodes from the first node to the second one.
+     * @throw NodeNotFoundException If a node is not found.
+     */
+    std::vector<int> getPathBetweenAnyTwoNodes(int nodeId1, int nodeId2, bool includeAncestor = true) const;
+
+    /**
+     * @brief Compute the distances between all pairs of leaves.
+     *
+     * @return A new DistanceMatrix object, with leaves in the same order as Tree::getLeavesNames().
+     * @throw NodePException If a branch has no length.
+     */
+    DistanceMatrix* getDistanceMatrix() const;
+};
+
+} //end of namespace bpp.
+
+#endif //_TREEQUERYINDEX_H_
+
@@ -49,6 +49,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 namespace bpp
 {
@@ -84,6 +85,18 @@ namespace bpp
  * The TreeTools::getMaxId() method may also prove useful in this respect.
  * The resetNodesId() method can also be used to re-initialize all ids.
  *
+ * Nodes are retrieved from their id in constant time, using an index which is kept up to date
+ * by all methods of this class and of TreeTemplateTools modifying the tree. Nodes added, or whose ids
+ * were modified, by direct manipulation of the Node objects are still found, by a search of the tree,
+ * but the updateNodeIndex() method must be called after nodes have been deleted in this way.
+ * Lookups never modify the tree, so that several threads may look nodes up concurrently.
+ *
+ * The postorder and preorder arrays of nodes are also cached, so that trees can be traversed
+ * without recursion. They are rebuilt by each method modifying the tree, never by the accessors,
+ * so that several threads may traverse the tree concurrently. The invalidateTraversals() method
+ * must be called after the topology has been changed by direct manipulation of the Node objects,
+ * for instance when performing NNIs.
+ *
  * @see Node
  * @see NodeTemplate
  * @see TreeTools
@@ -99,32 +112,56 @@ class TreeTemplate :
 private:
   N* root_;
   std::string name_;
+  /**
+   * @brief Nodes by id.
+   */
+  std::unordered_map<int, N*> nodeIndex_;
+  /**
+   * @brief Nodes in postorder and preorder, rebuilt when the tree is modified.
+   */
+  std::vector<const N*> postorder_;
+  std::vector<const N*> preorder_;
 
 public:
   // Constructors and destructor:
   TreeTemplate() : root_(0),
-    name_() {}
+    name_(),
+    nodeIndex_(),
+    postorder_(),
+    preorder_() {}
 
   TreeTemplate(const TreeTemplate<N>& t) :
     root_(0),
-    name_(t.name_)
+    name_(t.name_),
+    nodeIndex_(),
+    postorder_(),
+    preorder_()
   {
     // Perform a hard copy of the nodes:
     root_ = TreeTemplateTools::cloneSubtree<N>(*t.getRootNode());
+    updateNodeIndex();
   }
 
   TreeTemplate(const Tree& t) :
     root_(0),
-    name_(t.getName())
+    name_(t.getName()),
+    nodeIndex_(),
+    postorder_(),
+    preorder_()
   {
     // Create new nodes from an existing tree:
     root_ = TreeTemplateTools::cloneSubtree<N>(t, t.getRootId());
+    updateNodeIndex();
   }
 
   TreeTemplate(N* root) : root_(root),
-    name_()
+    name_(),
+    nodeIndex_(),
+    postorder_(),
+    preorder_()
   {
     root_->removeFather(); // In case this is a subtree from somewhere else...
+    updateNodeIndex();
   }
 
   TreeTemplate<N>& operator=(const TreeTemplate<N>& t)
@@ -133,6 +170,7 @@ public:
     if (root_) { TreeTemplateTools::deleteSubtree(root_); delete root_; }
     root_ = TreeTemplateTools::cloneSubtree<N>(*t.getRootNode());
     name_ = t.name_;
+    updateNodeIndex();
     return *this;
   }
 
@@ -197,7 +235,7 @@ public:
 
   void deleteNodeName(int nodeId) { return getNode(nodeId)->deleteName(); }
 
-  bool hasNode(int nodeId) const { return TreeTemplateTools::hasNodeWithId(*root_, nodeId); }
+  bool hasNode(int nodeId) const { return findNodeWithId_(nodeId) != 0; }
 
   bool isLeaf(int nodeId) const { return getNode(nodeId)->isLeaf(); }
 
@@ -235,6 +273,12 @@ public:
 
   std::vector<std::string> getBranchPropertyNames(int nodeId) const { return getNode(nodeId)->getBranchPropertyNames(); }
 
+  bool hasBootstrapValue(int nodeId) const { return getNode(nodeId)->hasBootstrapValue(); }
+
+  double getBootstrapValue(int nodeId) const { return getNode(nodeId)->getBootstrapValue(); }
+
+  void setBootstrapValue(int nodeId, double value) { getNode(nodeId)->setBootstrapValue(value); }
+
   void rootAt(int nodeId) { rootAt(getNode(nodeId)); }
 
   void newOutGroup(int nodeId) {  newOutGroup(getNode(nodeId)); }
@@ -290,6 +334,7 @@ public:
     {
       nodes[i]->setId(static_cast<int>(i));
     }
+    updateNodeIndex();
   }
 
   bool isMultifurcating() const
@@ -392,6 +437,7 @@ public:
     std::vector<N*> nodes = TreeTemplateTools::searchNodeWithId<N>(*root_, parentId);
     if (nodes.size() == 0) throw NodeNotFoundException("TreeTemplate:swapNodes(): Node with id not found.", TextTools::toString(parentId));
     for (size_t i = 0; i < nodes.size(); i++) { nodes[i]->swap(i1, i2); }
+    invalidateTraversals();
   }
 
 
@@ -400,7 +446,7 @@ public:
    *
    * @{
    */
-  virtual void setRootNode(N* root) { root_ = root; root_->removeFather(); }
+  virtual void setRootNode(N* root) { root_ = root; root_->removeFather(); updateNodeIndex(); }
 
   virtual N* getRootNode() { return root_; }
 
@@ -427,7 +473,7 @@ public:
       if (nodes.size() == 0) throw NodeNotFoundException("TreeTemplate::getNode(): Node with id not found.", TextTools::toString(id));
       return nodes[0];
     } else {
-      N* node = dynamic_cast<N*>(TreeTemplateTools::searchFirstNodeWithId(*root_, id));
+      N* node = findNodeWithId_(id);
       if (node)
         return node;
       else
@@ -444,7 +490,7 @@ public:
       if (nodes.size() == 0) throw NodeNotFoundException("TreeTemplate::getNode(): Node with id not found.", TextTools::toString(id));
       return nodes[0];
     } else {
-      const N* node = dynamic_cast<const N*>(TreeTemplateTools::searchFirstNodeWithId(*root_, id));
+      const N* node = findNodeWithId_(id);
       if (node)
         return node;
       else
@@ -452,6 +498,64 @@ public:
     }
   }
 
+  /**
+   * @brief Get a node from the id index, without any check.
+   *
+   * This is the fastest access, for loops where the node is known to exist and the index
+   * to be up to date. The result is undefined otherwise.
+   *
+   * @param id The id of the node.
+   * @return The node with the given id.
+   */
+  N* getNodeUnchecked(int id) { return nodeIndex_.find(id)->second; }
+
+  const N* getNodeUnchecked(int id) const { return nodeIndex_.find(id)->second; }
+
+  /**
+   * @brief Rebuild the index of nodes by id.
+   *
+   * This method is called by all methods of this class modifying the tree. It must be called
+   * after nodes have been deleted by direct manipulation of the Node objects, and should be called
+   * after their ids have been modified in this way, for the nodes to be found without a search
+   * (see also TreeTemplateTools::incrementAllIds(TreeTemplate<N>&, int)).
+   * The cached traversals are rebuilt too.
+   */
+  void updateNodeIndex()
+  {
+    invalidateTraversals();
+    nodeIndex_.clear();
+    if (!root_) return;
+    std::vector<N*> nodes = TreeTemplateTools::getNodes(*root_);
+    nodeIndex_.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+      // In case of duplicated ids, keep the first node, as searchFirstNodeWithId does:
+      nodeIndex_.insert(std::make_pair(nodes[i]->getId(), nodes[i]));
+    }
+  }
+
+  /**
+   * @return All nodes in postorder, that is, each node after all its sons.
+   */
+  const std::vector<const N*>& getPostorderNodes() const { return postorder_; }
+
+  /**
+   * @return All nodes in preorder, that is, each node before all its sons.
+   */
+  const std::vector<const N*>& getPreorderNodes() const { return preorder_; }
+
+  /**
+   * @brief Rebuild the cached postorder and preorder arrays, after a change of topology.
+   */
+  void invalidateTraversals()
+  {
+    postorder_.clear();
+    preorder_.clear();
+    if (!root_) return;
+    TreeTemplateTools::getPostorderNodes(*const_cast<const N*>(root_), postorder_);
+    TreeTemplateTools::getPreorderNodes(*const_cast<const N*>(root_), preorder_);
+  }
+
   virtual N* getNode(const std::string& name)
   {
     std::vector<N*> nodes;
@@ -495,6 +599,7 @@ public:
     newRoot->deleteDistanceToFather();
     newRoot->deleteBranchProperties();
     root_ = newRoot;
+    invalidateTraversals();
   }
 
   void newOutGroup(N* outGroup)
@@ -521,6 +626,7 @@ public:
     root_->setId(rootId);
     root_->addSon(oldRoot);
     root_->addSon(outGroup);
+    updateNodeIndex();
     // Check lengths:
     if (outGroup->hasDistanceToFather())
     {
@@ -531,6 +637,21 @@ public:
   }
 
   /** @} */
+
+private:
+  /**
+   * @return The node with the given id, or 0 if there is none.
+   *
+   * An indexed node is returned if it still has the requested id. Otherwise, for instance if ids
+   * were modified without updating the index, the id is searched in the tree, which is left unchanged.
+   */
+  N* findNodeWithId_(int id) const
+  {
+    typename std::unordered_map<int, N*>::const_iterator it = nodeIndex_.find(id);
+    if (it != nodeIndex_.end() && it->second->getId() == id) return it->second;
+    if (!root_) return 0;
+    return dynamic_cast<N*>(TreeTemplateTools::searchFirstNodeWithId(*root_, id));
+  }
 };
 } // end of namespace bpp.
 
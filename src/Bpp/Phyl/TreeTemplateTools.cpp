@@ -41,11 +41,11 @@
 
 #include "TreeTemplateTools.h"
 #include "TreeTemplate.h"
+#include "TreeQueryIndex.h"
 
 #include <Bpp/Numeric/Number.h>
 #include <Bpp/BppString.h>
 #include <Bpp/Text/StringTokenizer.h>
-#include <Bpp/Text/NestedStringTokenizer.h>
 #include <Bpp/Text/TextTools.h>
 #include <Bpp/Numeric/Random/RandomTools.h>
 
@@ -62,31 +62,27 @@ using namespace std;
 
 bool TreeTemplateTools::isMultifurcating(const Node& node)
 {
-  if (node.getNumberOfSons() > 2)
-    return true;
-  else
+  vector<const Node*> nodes;
+  getPreorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    bool b = false;
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
-    {
-      b = b || isMultifurcating(*node.getSon(i));
-    }
-    return b;
+    if (nodes[i]->getNumberOfSons() > 2)
+      return true;
   }
+  return false;
 }
 
 /******************************************************************************/
 
 unsigned int TreeTemplateTools::getNumberOfLeaves(const Node& node)
 {
+  vector<const Node*> nodes;
+  getPostorderNodes(node, nodes);
   unsigned int nbLeaves = 0;
-  if (node.isLeaf())
-  {
-    nbLeaves++;
-  }
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    nbLeaves += getNumberOfLeaves(*node[i]);
+    if (nodes[i]->isLeaf())
+      nbLeaves++;
   }
   return nbLeaves;
 }
@@ -95,30 +91,22 @@ unsigned int TreeTemplateTools::getNumberOfLeaves(const Node& node)
 
 unsigned int TreeTemplateTools::getNumberOfNodes(const Node& node)
 {
-  unsigned int nbNodes = 1;
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
-  {
-    nbNodes += getNumberOfNodes(*node[i]);
-  }
-  return nbNodes;
+  vector<const Node*> nodes;
+  getPostorderNodes(node, nodes);
+  return static_cast<unsigned int>(nodes.size());
 }
 
 /******************************************************************************/
 
 vector<string> TreeTemplateTools::getLeavesNames(const Node& node)
 {
+  vector<const Node*> nodes;
+  getPreorderNodes(node, nodes);
   vector<string> names;
-  if (node.isLeaf())
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    names.push_back(node.getName());
-  }
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
-  {
-    vector<string> subNames = getLeavesNames(*node.getSon(i));
-    for (size_t j = 0; j < subNames.size(); j++)
-    {
-      names.push_back(subNames[j]);
-    }
+    if (nodes[i]->isLeaf())
+      names.push_back(nodes[i]->getName());
   }
   return names;
 }
@@ -127,12 +115,20 @@ vector<string> TreeTemplateTools::getLeavesNames(const Node& node)
 
 unsigned int TreeTemplateTools::getDepth(const Node& node)
 {
+  // The depth of the subtree is the largest number of branches between its basal node and another node:
   unsigned int d = 0;
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+  vector< pair<const Node*, unsigned int> > stack(1, make_pair(&node, 0u));
+  while (!stack.empty())
   {
-    unsigned int c = getDepth(*node[i]) + 1;
+    const Node* current = stack.back().first;
+    unsigned int c = stack.back().second;
+    stack.pop_back();
     if (c > d)
       d = c;
+    for (size_t i = 0; i < current->getNumberOfSons(); i++)
+    {
+      stack.push_back(make_pair(current->getSon(i), c + 1));
+    }
   }
   return d;
 }
@@ -141,29 +137,42 @@ unsigned int TreeTemplateTools::getDepth(const Node& node)
 
 unsigned int TreeTemplateTools::getDepths(const Node& node, map<const Node*, unsigned int>& depths)
 {
-  unsigned int d = 0;
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+  vector<const Node*> nodes;
+  getPostorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    unsigned int c = getDepths(*node[i], depths) + 1;
-    if (c > d)
-      d = c;
+    const Node* current = nodes[i];
+    unsigned int d = 0;
+    for (size_t j = 0; j < current->getNumberOfSons(); j++)
+    {
+      unsigned int c = depths[current->getSon(j)] + 1;
+      if (c > d)
+        d = c;
+    }
+    depths[current] = d;
   }
-  depths[&node] = d;
-  return d;
+  return depths[&node];
 }
 
 /******************************************************************************/
 
 double TreeTemplateTools::getHeight(const Node& node)
 {
+  // The height of the subtree is the largest distance between its basal node and another node:
   double d = 0;
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+  vector< pair<const Node*, double> > stack(1, make_pair(&node, 0.));
+  while (!stack.empty())
   {
-    const Node* son = node[i];
-    double dist = son->getDistanceToFather();
-    double c = getHeight(*son) + dist;
+    const Node* current = stack.back().first;
+    double c = stack.back().second;
+    stack.pop_back();
     if (c > d)
       d = c;
+    for (size_t i = 0; i < current->getNumberOfSons(); i++)
+    {
+      const Node* son = current->getSon(i);
+      stack.push_back(make_pair(son, c + son->getDistanceToFather()));
+    }
   }
   return d;
 }
@@ -172,17 +181,22 @@ double TreeTemplateTools::getHeight(const Node& node)
 
 double TreeTemplateTools::getHeights(const Node& node, map<const Node*, double>& heights)
 {
-  double d = 0;
-  for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+  vector<const Node*> nodes;
+  getPostorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    const Node* son = node[i];
-    double dist = son->getDistanceToFather();
-    double c = getHeights(*son, heights) + dist;
-    if (c > d)
-      d = c;
+    const Node* current = nodes[i];
+    double d = 0;
+    for (size_t j = 0; j < current->getNumberOfSons(); j++)
+    {
+      const Node* son = current->getSon(j);
+      double c = heights[son] + son->getDistanceToFather();
+      if (c > d)
+        d = c;
+    }
+    heights[current] = d;
   }
-  heights[&node] = d;
-  return d;
+  return heights[&node];
 }
 
 /******************************************************************************/
@@ -250,84 +264,161 @@ TreeTemplateTools::Element TreeTemplateTools::getElement(const string& elt)
 
 /******************************************************************************/
 
+size_t TreeTemplateTools::findEndOfElement_(const string& description, size_t begin)
+{
+  size_t end = description.find_first_of(",()", begin);
+  if (end == string::npos)
+    return description.size();
+  if (description[end] == '(')
+    throw IOException("TreeTemplateTools::parenthesisToNode(). Invalid format: unexpected opening parenthesis in " + description);
+  return end;
+}
 
-Node* TreeTemplateTools::parenthesisToNode(const string& description, unsigned int& nodeCounter, bool bootstrap, const string& propertyName, bool withId, bool verbose)
+/******************************************************************************/
+
+void TreeTemplateTools::setElement_(Node& node, const string& text, bool isLeaf, bool bootstrap, const string& propertyName, bool withId)
 {
-  // cout << "NODE: " << description << endl;
-  Element elt = getElement(description);
+  string label = text;
+  string::size_type colon = text.rfind(':');
+  if (colon != string::npos)
+  {
+    label = text.substr(0, colon);
+    string length = TextTools::removeSurroundingWhiteSpaces(text.substr(colon + 1));
+    if (!TextTools::isEmpty(length))
+      node.setDistanceToFather(TextTools::toDouble(length));
+  }
+  label = TextTools::removeSurroundingWhiteSpaces(label);
 
-  // New node:
-  Node* node = new Node();
-  if (!TextTools::isEmpty(elt.length))
+  if (isLeaf)
   {
-    node->setDistanceToFather(TextTools::toDouble(elt.length));
-    // cout << "NODE: LENGTH: " << * elt.length << endl;
+    if (withId)
+    {
+      StringTokenizer st(label, "_", true, true);
+      ostringstream realName;
+      for (size_t i = 0; i < st.numberOfRemainingTokens() - 1; ++i)
+      {
+        if (i != 0)
+        {
+          realName << "_";
+        }
+        realName << st.getToken(i);
+      }
+      node.setName(realName.str());
+      node.setId(TextTools::toInt(st.getToken(st.numberOfRemainingTokens() - 1)));
+    }
+    else
+    {
+      node.setName(label);
+    }
   }
-  if (!TextTools::isEmpty(elt.bootstrap))
+  else if (!TextTools::isEmpty(label))
   {
     if (withId)
     {
-      node->setId(TextTools::toInt(elt.bootstrap));
+      node.setId(TextTools::toInt(label));
     }
     else
     {
       if (bootstrap)
       {
-        node->setBranchProperty(TreeTools::BOOTSTRAP, Number<double>(TextTools::toDouble(elt.bootstrap)));
-        // cout << "NODE: BOOTSTRAP: " << * elt.bootstrap << endl;
+        node.setBootstrapValue(TextTools::toDouble(label));
       }
       else
       {
-        node->setBranchProperty(propertyName, BppString(elt.bootstrap));
+        node.setBranchProperty(propertyName, BppString(label));
       }
     }
   }
+}
 
-  NestedStringTokenizer nt(elt.content, "(", ")", ",");
-  vector<string> elements;
-  while (nt.hasMoreToken())
-  {
-    elements.push_back(nt.nextToken());
-  }
+/******************************************************************************/
 
-  if (elt.isLeaf)
+
+Node* TreeTemplateTools::parenthesisToNode(const string& description, unsigned int& nodeCounter, bool bootstrap, const string& propertyName, bool withId, bool verbose)
+{
+  // The description is read in a single pass, inner nodes being kept on a stack until
+  // their closing parenthesis is found:
+  vector<Node*> ancestors;
+  Node* root = 0;
+  size_t n = description.size();
+  size_t i = 0;
+  try
   {
-    // This is a leaf:
-    string name = TextTools::removeSurroundingWhiteSpaces(elements[0]);
-    if (withId)
+    while (true)
     {
-      StringTokenizer st(name, "_", true, true);
-      ostringstream realName;
-      for (size_t i = 0; i < st.numberOfRemainingTokens() - 1; ++i)
+      // Beginning of a node:
+      while (i < n && TextTools::isWhiteSpaceCharacter(description[i]))
       {
-        if (i != 0)
-        {
-          realName << "_";
-        }
-        realName << st.getToken(i);
+        i++;
       }
-      node->setName(realName.str());
-      node->setId(TextTools::toInt(st.getToken(st.numberOfRemainingTokens() - 1)));
-    }
-    else
-    {
-      node->setName(name);
+      if (i < n && description[i] == '(')
+      {
+        Node* node = new Node();
+        if (ancestors.empty())
+          root = node;
+        else
+          ancestors.back()->addSon(node);
+        ancestors.push_back(node);
+        i++;
+        continue;
+      }
+
+      // This is a leaf:
+      size_t end = findEndOfElement_(description, i);
+      string text = description.substr(i, end - i);
+      i = end;
+      if (!TextTools::isEmpty(text))
+      {
+        if (root && ancestors.empty())
+          throw IOException("TreeTemplateTools::parenthesisToNode(). Invalid format: several nodes at the top level in " + description);
+        Node* leaf = new Node();
+        if (ancestors.empty())
+          root = leaf;
+        else
+          ancestors.back()->addSon(leaf);
+        setElement_(*leaf, text, true, bootstrap, propertyName, withId);
+        nodeCounter++;
+        if (verbose)
+          ApplicationTools::displayUnlimitedGauge(nodeCounter);
+      }
+
+      // Close inner nodes:
+      while (i < n && description[i] == ')')
+      {
+        if (ancestors.empty())
+          throw IOException("TreeTemplateTools::parenthesisToNode(). Invalid format: bad closing parenthesis in " + description);
+        Node* node = ancestors.back();
+        ancestors.pop_back();
+        end = findEndOfElement_(description, i + 1);
+        setElement_(*node, description.substr(i + 1, end - i - 1), false, bootstrap, propertyName, withId);
+        i = end;
+        nodeCounter++;
+        if (verbose)
+          ApplicationTools::displayUnlimitedGauge(nodeCounter);
+      }
+
+      if (i >= n)
+        break;
+      // This is a comma, separating two sons:
+      if (ancestors.empty())
+        throw IOException("TreeTemplateTools::parenthesisToNode(). Invalid format: several nodes at the top level in " + description);
+      i++;
     }
+    if (!ancestors.empty())
+      throw IOException("TreeTemplateTools::parenthesisToNode(). Invalid format: missing closing parenthesis in " + description);
+    if (!root)
+      throw IOException("TreeTemplateTools::parenthesisToNode(). Empty tree description.");
   }
-  else
+  catch (exception& e)
   {
-    // This is a node:
-    for (size_t i = 0; i < elements.size(); i++)
+    if (root)
     {
-      // cout << "NODE: SUBNODE: " << i << ", " << elements[i] << endl;
-      Node* son = parenthesisToNode(elements[i], nodeCounter, bootstrap, propertyName, withId, verbose);
-      node->addSon(son);
+      deleteSubtree(root);
+      delete root;
     }
+    throw;
   }
-  nodeCounter++;
-  if (verbose)
-    ApplicationTools::displayUnlimitedGauge(nodeCounter);
-  return node;
+  return root;
 }
 
 /******************************************************************************/
@@ -358,33 +449,7 @@ TreeTemplate<Node>* TreeTemplateTools::parenthesisToTree(const string& descripti
 string TreeTemplateTools::nodeToParenthesis(const Node& node, bool writeId)
 {
   ostringstream s;
-  if (node.isLeaf())
-  {
-    s << node.getName();
-  }
-  else
-  {
-    s << "(";
-    s << nodeToParenthesis(*node[0], writeId);
-    for (int i = 1; i < static_cast<int>(node.getNumberOfSons()); i++)
-    {
-      s << "," << nodeToParenthesis(*node[i], writeId);
-    }
-    s << ")";
-  }
-  if (writeId)
-  {
-    if (node.isLeaf())
-      s << "_";
-    s << node.getId();
-  }
-  else
-  {
-    if (node.hasBranchProperty(TreeTools::BOOTSTRAP))
-      s << (dynamic_cast<const Number<double>*>(node.getBranchProperty(TreeTools::BOOTSTRAP))->getValue());
-  }
-  if (node.hasDistanceToFather())
-    s << ":" << node.getDistanceToFather();
+  writeSubtree_(s, node, writeId);
   return s.str();
 }
 
@@ -393,40 +458,95 @@ string TreeTemplateTools::nodeToParenthesis(const Node& node, bool writeId)
 string TreeTemplateTools::nodeToParenthesis(const Node& node, bool bootstrap, const string& propertyName)
 {
   ostringstream s;
+  writeSubtree_(s, node, bootstrap, propertyName);
+  return s.str();
+}
+
+/******************************************************************************/
+
+void TreeTemplateTools::writeSubtree_(ostream& s, const Node& node, const std::function<void (ostream&, const Node&)>& writeSuffix)
+{
+  vector< pair<const Node*, size_t> > stack(1, make_pair(&node, static_cast<size_t>(0)));
   if (node.isLeaf())
-  {
     s << node.getName();
-  }
   else
-  {
     s << "(";
-    s << nodeToParenthesis(*node[0], bootstrap, propertyName);
-    for (int i = 1; i < static_cast<int>(node.getNumberOfSons()); i++)
+  while (!stack.empty())
+  {
+    const Node* current = stack.back().first;
+    size_t next = stack.back().second;
+    if (next < current->getNumberOfSons())
     {
-      s << "," << nodeToParenthesis(*node[i], bootstrap, propertyName);
+      stack.back().second++;
+      if (next > 0)
+        s << ",";
+      const Node* son = current->getSon(next);
+      if (son->isLeaf())
+        s << son->getName();
+      else
+        s << "(";
+      stack.push_back(make_pair(son, static_cast<size_t>(0)));
     }
-    s << ")";
+    else
+    {
+      if (!current->isLeaf())
+        s << ")";
+      writeSuffix(s, *current);
+      stack.pop_back();
+    }
+  }
+}
+
+/******************************************************************************/
 
-    if (bootstrap)
+void TreeTemplateTools::writeSubtree_(ostream& s, const Node& node, bool writeId)
+{
+  writeSubtree_(s, node, [writeId](ostream& os, const Node& current)
+  {
+    if (writeId)
     {
-      if (node.hasBranchProperty(TreeTools::BOOTSTRAP))
-        s << (dynamic_cast<const Number<double>*>(node.getBranchProperty(TreeTools::BOOTSTRAP))->getValue());
+      if (current.isLeaf())
+        os << "_";
+      os << current.getId();
     }
     else
     {
-      if (node.hasBranchProperty(propertyName))
+      if (current.hasBootstrapValue())
+        os << current.getBootstrapValue();
+    }
+    if (current.hasDistanceToFather())
+      os << ":" << current.getDistanceToFather();
+  });
+}
+
+/******************************************************************************/
+
+void TreeTemplateTools::writeSubtree_(ostream& s, const Node& node, bool bootstrap, const string& propertyName)
+{
+  writeSubtree_(s, node, [bootstrap, &propertyName](ostream& os, const Node& current)
+  {
+    if (!current.isLeaf())
+    {
+      if (bootstrap)
       {
-        const BppString* ppt = dynamic_cast<const BppString*>(node.getBranchProperty(propertyName));
-        if (ppt)
-          s << *ppt;
-        else
-          throw Exception("TreeTemplateTools::nodeToParenthesis. Property should be a BppString.");
+        if (current.hasBootstrapValue())
+          os << current.getBootstrapValue();
+      }
+      else
+      {
+        if (current.hasBranchProperty(propertyName))
+        {
+          const BppString* ppt = dynamic_cast<const BppString*>(current.getBranchProperty(propertyName));
+          if (ppt)
+            os << *ppt;
+          else
+            throw Exception("TreeTemplateTools::nodeToParenthesis. Property should be a BppString.");
+        }
       }
     }
-  }
-  if (node.hasDistanceToFather())
-    s << ":" << node.getDistanceToFather();
-  return s.str();
+    if (current.hasDistanceToFather())
+      os << ":" << current.getDistanceToFather();
+  });
 }
 
 /******************************************************************************/
@@ -434,59 +554,79 @@ string TreeTemplateTools::nodeToParenthesis(const Node& node, bool bootstrap, co
 string TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, bool writeId)
 {
   ostringstream s;
-  s << "(";
+  treeToParenthesis(tree, s, writeId);
+  return s.str();
+}
+
+/******************************************************************************/
+
+string TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, bool bootstrap, const string& propertyName)
+{
+  ostringstream s;
+  treeToParenthesis(tree, s, bootstrap, propertyName);
+  return s.str();
+}
+
+/******************************************************************************/
+
+void TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, ostream& out, bool writeId)
+{
+  out << "(";
   const Node* node = tree.getRootNode();
   if (node->isLeaf() && node->hasName()) // In case we have a tree like ((A:1.0)); where the root node is an unamed leaf!
   {
-    s << node->getName();
+    out << node->getName();
     for (size_t i = 0; i < node->getNumberOfSons(); ++i)
     {
-      s << "," << nodeToParenthesis(*node->getSon(i), writeId);
+      out << ",";
+      writeSubtree_(out, *node->getSon(i), writeId);
     }
   }
   else
   {
-    s << nodeToParenthesis(*node->getSon(0), writeId);
+    writeSubtree_(out, *node->getSon(0), writeId);
     for (size_t i = 1; i < node->getNumberOfSons(); ++i)
     {
-      s << "," << nodeToParenthesis(*node->getSon(i), writeId);
+      out << ",";
+      writeSubtree_(out, *node->getSon(i), writeId);
     }
   }
-  s << ")";
+  out << ")";
   if (node->hasDistanceToFather())
-    s << ":" << node->getDistanceToFather();
-  s << ";" << endl;
-  return s.str();
+    out << ":" << node->getDistanceToFather();
+  // No endl here: flushing after each tree would slow down the writing of large tree sets.
+  out << ";\n";
 }
 
 /******************************************************************************/
 
-string TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, bool bootstrap, const string& propertyName)
+void TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, ostream& out, bool bootstrap, const string& propertyName)
 {
-  ostringstream s;
-  s << "(";
+  out << "(";
   const Node* node = tree.getRootNode();
   if (node->isLeaf())
   {
-    s << node->getName();
+    out << node->getName();
     for (size_t i = 0; i < node->getNumberOfSons(); i++)
     {
-      s << "," << nodeToParenthesis(*node->getSon(i), bootstrap, propertyName);
+      out << ",";
+      writeSubtree_(out, *node->getSon(i), bootstrap, propertyName);
     }
   }
   else
   {
-    s << nodeToParenthesis(*node->getSon(0), bootstrap, propertyName);
+    writeSubtree_(out, *node->getSon(0), bootstrap, propertyName);
     for (size_t i = 1; i < node->getNumberOfSons(); i++)
     {
-      s << "," << nodeToParenthesis(*node->getSon(i), bootstrap, propertyName);
+      out << ",";
+      writeSubtree_(out, *node->getSon(i), bootstrap, propertyName);
     }
   }
-  s << ")";
+  out << ")";
   if (bootstrap)
   {
-    if (node->hasBranchProperty(TreeTools::BOOTSTRAP))
-      s << (dynamic_cast<const Number<double>*>(node->getBranchProperty(TreeTools::BOOTSTRAP))->getValue());
+    if (node->hasBootstrapValue())
+      out << node->getBootstrapValue();
   }
   else
   {
@@ -494,28 +634,24 @@ string TreeTemplateTools::treeToParenthesis(const TreeTemplate<Node>& tree, bool
     {
       const BppString* ppt = dynamic_cast<const BppString*>(node->getBranchProperty(propertyName));
       if (ppt)
-        s << *ppt;
+        out << *ppt;
       else
         throw Exception("TreeTemplateTools::nodeToParenthesis. Property should be a BppString.");
     }
   }
-  s << ";" << endl;
-  return s.str();
+  out << ";\n";
 }
 
 /******************************************************************************/
 
 Vdouble TreeTemplateTools::getBranchLengths(const Node& node)
 {
-  Vdouble brLen(1);
-  brLen[0] = node.getDistanceToFather();
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
+  vector<const Node*> nodes;
+  getPreorderNodes(node, nodes);
+  Vdouble brLen(nodes.size());
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    Vdouble sonBrLen = getBranchLengths(*node.getSon(i));
-    for (size_t j = 0; j < sonBrLen.size(); j++)
-    {
-      brLen.push_back(sonBrLen[j]);
-    }
+    brLen[i] = nodes[i]->getDistanceToFather();
   }
   return brLen;
 }
@@ -524,12 +660,14 @@ Vdouble TreeTemplateTools::getBranchLengths(const Node& node)
 
 double TreeTemplateTools::getTotalLength(const Node& node, bool includeAncestor)
 {
-  if (includeAncestor && !node.hasDistanceToFather())
-    throw NodePException("TreeTools::getTotalLength(). No branch length.", &node);
-  double length = includeAncestor ? node.getDistanceToFather() : 0;
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
+  vector<const Node*> nodes;
+  getPreorderNodes(node, nodes);
+  double length = 0;
+  for (size_t i = includeAncestor ? 0 : 1; i < nodes.size(); i++)
   {
-    length += getTotalLength(*node.getSon(i), true);
+    if (!nodes[i]->hasDistanceToFather())
+      throw NodePException("TreeTools::getTotalLength(). No branch length.", nodes[i]);
+    length += nodes[i]->getDistanceToFather();
   }
   return length;
 }
@@ -538,10 +676,11 @@ double TreeTemplateTools::getTotalLength(const Node& node, bool includeAncestor)
 
 void TreeTemplateTools::setBranchLengths(Node& node, double brLen)
 {
-  node.setDistanceToFather(brLen);
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
+  vector<Node*> nodes;
+  getPreorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    setBranchLengths(*node.getSon(i), brLen);
+    nodes[i]->setDistanceToFather(brLen);
   }
 }
 
@@ -549,10 +688,11 @@ void TreeTemplateTools::setBranchLengths(Node& node, double brLen)
 
 void TreeTemplateTools::deleteBranchLengths(Node& node)
 {
-  node.deleteDistanceToFather();
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
+  vector<Node*> nodes;
+  getPreorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    deleteBranchLengths(*node.getSon(i));
+    nodes[i]->deleteDistanceToFather();
   }
 }
 
@@ -560,11 +700,12 @@ void TreeTemplateTools::deleteBranchLengths(Node& node)
 
 void TreeTemplateTools::setVoidBranchLengths(Node& node, double brLen)
 {
-  if (!node.hasDistanceToFather())
-    node.setDistanceToFather(brLen);
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
+  vector<Node*> nodes;
+  getPreorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    setVoidBranchLengths(*node.getSon(i), brLen);
+    if (!nodes[i]->hasDistanceToFather())
+      nodes[i]->setDistanceToFather(brLen);
   }
 }
 
@@ -572,13 +713,14 @@ void TreeTemplateTools::setVoidBranchLengths(Node& node, double brLen)
 
 void TreeTemplateTools::scaleTree(Node& node, double factor)
 {
-  if (node.hasFather())
+  vector<Node*> nodes;
+  getPreorderNodes(node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    node.setDistanceToFather(node.getDistanceToFather() * factor);
-  }
-  for (size_t i = 0; i < node.getNumberOfSons(); i++)
-  {
-    scaleTree(*node.getSon(i), factor);
+    if (nodes[i]->hasFather())
+    {
+      nodes[i]->setDistanceToFather(nodes[i]->getDistanceToFather() * factor);
+    }
   }
 }
 
@@ -762,87 +904,10 @@ double TreeTemplateTools::getDistanceBetweenAnyTwoNodes(const Node& node1, const
 
 /******************************************************************************/
 
-void TreeTemplateTools::processDistsInSubtree_(const Node* node, DistanceMatrix& matrix, vector< std::pair<string, double> >& distsToNodeFather)
-{
-  distsToNodeFather.clear();
-
-  // node-is-leaf case
-  if (node->getNumberOfSons() == 0)
-  {
-    distsToNodeFather.push_back(make_pair(node->getName(), node->getDistanceToFather()));
-    return;
-  }
-
-  // For all leaves in node's subtree, get leaf-to-node distances.
-  // Leaves are classified upon node's sons.
-  map<const Node*, vector< pair<string, double> > > leavesDists;
-  for (size_t i = 0; i < node->getNumberOfSons(); ++i)
-  {
-    const Node* son = node->getSon(i);
-    processDistsInSubtree_(son, matrix, leavesDists[son]); // recursivity
-  }
-  // Write leaf-leaf distances to the distance matrix.
-  // Only pairs in which the two leaves belong to different
-  // sons are considered.
-  for (size_t son1_loc = 0; son1_loc < node->getNumberOfSons(); ++son1_loc)
-  {
-    for (size_t son2_loc = 0; son2_loc < son1_loc; ++son2_loc)
-    {
-      const Node* son1 = node->getSon(son1_loc);
-      const Node* son2 = node->getSon(son2_loc);
-
-      for (vector< pair<string, double> >::iterator son1_leaf = leavesDists[son1].begin();
-           son1_leaf != leavesDists[son1].end();
-           ++son1_leaf)
-      {
-        for (vector< pair<string, double> >::iterator son2_leaf = leavesDists[son2].begin();
-             son2_leaf != leavesDists[son2].end();
-             ++son2_leaf)
-        {
-          matrix(son1_leaf->first, son2_leaf->first) =
-            matrix(son2_leaf->first, son1_leaf->first) =
-              ( son1_leaf->second + son2_leaf->second );
-        }
-      }
-    }
-  }
-
-  // node-is-root case
-  if (!node->hasFather())
-  {
-    // node-is-root-and-leaf case
-    if (node->isLeaf() )
-    {
-      string root_name = node->getName();
-      for (vector< pair<string, double> >::iterator other_leaf = leavesDists[node->getSon(0)].begin();
-           other_leaf != leavesDists[node->getSon(0)].end();
-           ++other_leaf)
-      {
-        matrix(root_name, other_leaf->first) = matrix( other_leaf->first, root_name) = other_leaf->second;
-      }
-    }
-
-    return;
-  }
-
-  // Get distances from node's father to considered leaves
-  distsToNodeFather.clear();
-  double nodeToFather = node->getDistanceToFather();
-  for (map<const Node*, vector<pair<string, double> > >::iterator son = leavesDists.begin(); son != leavesDists.end(); ++son)
-  {
-    for (vector< pair<string, double> >::iterator leaf = (son->second).begin(); leaf != (son->second).end(); ++leaf)
-    {
-      distsToNodeFather.push_back(make_pair(leaf->first, (leaf->second + nodeToFather)));
-    }
-  }
-}
-
 DistanceMatrix* TreeTemplateTools::getDistanceMatrix(const TreeTemplate<Node>& tree)
 {
-  DistanceMatrix* matrix = new DistanceMatrix(tree.getLeavesNames());
-  vector< pair<string, double> > distsToRoot;
-  processDistsInSubtree_(tree.getRootNode(), *matrix, distsToRoot);
-  return matrix;
+  TreeQueryIndex index(tree);
+  return index.getDistanceMatrix();
 }
 
 /******************************************************************************/
@@ -864,10 +929,11 @@ std::vector<const Node*> TreeTemplateTools::getRemainingNeighbors(const Node* no
 
 void TreeTemplateTools::incrementAllIds(Node* node, int increment)
 {
-  node->setId(node->getId() + increment);
-  for (size_t i = 0; i < node->getNumberOfSons(); i++)
+  vector<Node*> nodes;
+  getPreorderNodes(*node, nodes);
+  for (size_t i = 0; i < nodes.size(); i++)
   {
-    incrementAllIds(node->getSon(i), increment);
+    nodes[i]->setId(nodes[i]->getId() + increment);
   }
 }
 
@@ -1130,6 +1196,8 @@ void TreeTemplateTools::midRoot(TreeTemplate<Node>& tree, short criterion, bool
       tree.rootAt(new_root);
     }
   }
+  // New nodes were added:
+  tree.updateNodeIndex();
 }
 
 /******************************************************************************/
@@ -48,6 +48,8 @@
 // From the STL:
 #include <string>
 #include <vector>
+#include <utility>
+#include <functional>
 
 namespace bpp
 {
@@ -69,9 +71,61 @@ public:
   /**
    * @name Retrieve topology information
    *
+   * All methods in this section traverse trees with an explicit stack, so that the depth of
+   * the tree is not limited by the size of the call stack.
+   *
    * @{
    */
 
+  /**
+   * @brief Retrieve all nodes of a subtree in postorder, that is, each node after all its sons.
+   *
+   * @param node The node that defines the subtree.
+   * @param nodes A vector to be filled with pointers toward each node in the subtree.
+   */
+  template<class N>
+  static void getPostorderNodes(N& node, std::vector<N*>& nodes)
+  {
+    std::vector< std::pair<N*, size_t> > stack(1, std::make_pair(&node, static_cast<size_t>(0)));
+    while (!stack.empty())
+    {
+      N* current = stack.back().first;
+      size_t next = stack.back().second;
+      if (next < current->getNumberOfSons())
+      {
+        stack.back().second++;
+        stack.push_back(std::make_pair(current->getSon(next), static_cast<size_t>(0)));
+      }
+      else
+      {
+        nodes.push_back(current);
+        stack.pop_back();
+      }
+    }
+  }
+
+  /**
+   * @brief Retrieve all nodes of a subtree in preorder, that is, each node before all its sons.
+   *
+   * @param node The node that defines the subtree.
+   * @param nodes A vector to be filled with pointers toward each node in the subtree.
+   */
+  template<class N>
+  static void getPreorderNodes(N& node, std::vector<N*>& nodes)
+  {
+    std::vector<N*> stack(1, &node);
+    while (!stack.empty())
+    {
+      N* current = stack.back();
+      stack.pop_back();
+      nodes.push_back(current);
+      for (size_t i = current->getNumberOfSons(); i > 0; --i)
+      {
+        stack.push_back(current->getSon(i - 1));
+      }
+    }
+  }
+
   /**
    * @brief Retrieve all leaves from a subtree.
    *
@@ -95,13 +149,12 @@ public:
   template<class N>
   static void getLeaves(N& node, std::vector<N*>& leaves)
   {
-    if (node.isLeaf())
-    {
-      leaves.push_back(&node);
-    }
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<N*> nodes;
+    getPreorderNodes<N>(node, nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
     {
-      getLeaves<N>(*node.getSon(i), leaves);
+      if (nodes[i]->isLeaf())
+        leaves.push_back(nodes[i]);
     }
   }
 
@@ -126,13 +179,12 @@ public:
    */
   static void getLeavesId(const Node& node, std::vector<int>& ids)
   {
-    if (node.isLeaf())
+    std::vector<const Node*> nodes;
+    getPreorderNodes<const Node>(node, nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
     {
-      ids.push_back(node.getId());
-    }
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
-    {
-      getLeavesId(*node.getSon(i), ids);
+      if (nodes[i]->isLeaf())
+        ids.push_back(nodes[i]->getId());
     }
   }
 
@@ -185,18 +237,16 @@ public:
    */
   static void searchLeaf(const Node& node, const std::string& name, int*& id)
   {
-    if (node.isLeaf())
-    {
-      if (node.getName() == name)
-      {
-        id = new int(node.getId());
-        return;
-      }
-    }
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<const Node*> nodes;
+    getPreorderNodes<const Node>(node, nodes);
+    const Node* leaf = 0;
+    for (size_t i = 0; i < nodes.size(); i++)
     {
-      searchLeaf(*node.getSon(i), name, id);
+      if (nodes[i]->isLeaf() && nodes[i]->getName() == name)
+        leaf = nodes[i];
     }
+    if (leaf)
+      id = new int(leaf->getId());
   }
 
   /**
@@ -254,6 +304,7 @@ public:
       // Dunno what to do in that case :(
       throw Exception("TreeTemplateTools::dropLeaf. Parent node as only one child, I don't know what to do in that case :(");
     }
+    tree.updateNodeIndex();
   }
 
   /**
@@ -309,6 +360,7 @@ public:
       // Dunno what to do in that case :(
       throw Exception("TreeTemplateTools::dropSubtree. Parent node as only one child, I don't know what to do in that case :(");
     }
+    tree.updateNodeIndex();
   }
 
   /**
@@ -353,11 +405,7 @@ public:
   template<class N>
   static void getNodes(N& node, std::vector<N*>& nodes)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
-    {
-      getNodes<N>(*node.getSon(i), nodes);
-    }
-    nodes.push_back(&node);
+    getPostorderNodes<N>(node, nodes);
   }
 
   /**
@@ -394,11 +442,12 @@ public:
    */
   static void getNodesId(const Node& node, std::vector<int>& ids)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<const Node*> nodes;
+    getPostorderNodes<const Node>(node, nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
     {
-      getNodesId(*node.getSon(i), ids);
+      ids.push_back(nodes[i]->getId());
     }
-    ids.push_back(node.getId());
   }
 
   /**
@@ -409,9 +458,12 @@ public:
    */
   static void getBranchesId(const Node& node, std::vector<int>& ids)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<const Node*> nodes;
+    getPostorderNodes<const Node>(node, nodes);
+    // All nodes but the last one, which is the basal node:
+    for (size_t i = 0; i + 1 < nodes.size(); i++)
     {
-      getNodesId(*node.getSon(i), ids);
+      ids.push_back(nodes[i]->getId());
     }
   }
 
@@ -440,12 +492,13 @@ public:
   template<class N>
   static void getInnerNodes(N& node, std::vector<N*>& nodes)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<N*> allNodes;
+    getPostorderNodes<N>(node, allNodes);
+    for (size_t i = 0; i < allNodes.size(); i++)
     {
-      getInnerNodes<N>(*node.getSon(i), nodes);
+      if (!allNodes[i]->isLeaf())
+        nodes.push_back(allNodes[i]);  // Do not add leaves!
     }
-    if (!node.isLeaf())
-      nodes.push_back(&node);  // Do not add leaves!
   }
 
   /**
@@ -471,12 +524,13 @@ public:
    */
   static void getInnerNodesId(const Node& node, std::vector<int>& ids)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<const Node*> nodes;
+    getPostorderNodes<const Node>(node, nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
     {
-      getInnerNodesId(*node.getSon(i), ids);
+      if (!nodes[i]->isLeaf())
+        ids.push_back(nodes[i]->getId());  // Do not add leaves!
     }
-    if (!node.isLeaf())
-      ids.push_back(node.getId());  // Do not add leaves!
   }
 
   /**
@@ -500,11 +554,12 @@ public:
   template<class N>
   static void searchNodeWithId(N& node, int id, std::vector<N*>& nodes)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); ++i)
+    std::vector<N*> allNodes;
+    getPostorderNodes<N>(node, allNodes);
+    for (size_t i = 0; i < allNodes.size(); ++i)
     {
-      searchNodeWithId<N>(*node.getSon(i), id, nodes);
+      if (allNodes[i]->getId() == id) nodes.push_back(allNodes[i]);
     }
-    if (node.getId() == id) nodes.push_back(&node);
   }
 
   /**
@@ -514,18 +569,7 @@ public:
    */
   static Node* searchFirstNodeWithId(Node& node, int id)
   {
-    if (node.getId() == id)
-      return &node;
-    else
-    {
-      for (size_t i = 0; i < node.getNumberOfSons(); ++i)
-      {
-        Node* result = searchFirstNodeWithId(*node.getSon(i), id);
-        if (result)
-          return result;
-      }
-    }
-    return 0;
+    return searchFirstNode_<Node>(node, NodeIdEquals_(id));
   }
 
   /**
@@ -535,18 +579,7 @@ public:
    */
   static const Node* searchFirstNodeWithId(const Node& node, int id)
   {
-    if (node.getId() == id)
-      return &node;
-    else
-    {
-      for (size_t i = 0; i < node.getNumberOfSons(); ++i)
-      {
-        const Node* result = searchFirstNodeWithId(*node.getSon(i), id);
-        if (result)
-          return result;
-      }
-    }
-    return 0;
+    return searchFirstNode_<const Node>(node, NodeIdEquals_(id));
   }
 
   /**
@@ -557,15 +590,7 @@ public:
   template<class N>
   static bool hasNodeWithId(const N& node, int id)
   {
-    if (node.getId() == id) return true;
-    else
-    {
-      for (size_t i = 0; i < node.getNumberOfSons(); i++)
-      {
-        if (hasNodeWithId(*node.getSon(i), id)) return true;
-      }
-      return false;
-    }
+    return searchFirstNode_<const N>(node, NodeIdEquals_(id)) != 0;
   }
 
   /**
@@ -577,7 +602,7 @@ public:
   static std::vector<N*> searchNodeWithName(N& node, const std::string& name)
   {
     std::vector<N*> nodes;
-    searchNodeWithId<N>(node, name, nodes);
+    searchNodeWithName<N>(node, name, nodes);
     return nodes;
   }
 
@@ -589,11 +614,12 @@ public:
   template<class N>
   static void searchNodeWithName(N& node, const std::string& name, std::vector<N*>& nodes)
   {
-    for (size_t i = 0; i < node.getNumberOfSons(); i++)
+    std::vector<N*> allNodes;
+    getPostorderNodes<N>(node, allNodes);
+    for (size_t i = 0; i < allNodes.size(); i++)
     {
-      searchNodeWithName<N>(*node.getSon(i), name, nodes);
+      if (allNodes[i]->hasName() && allNodes[i]->getName() == name) nodes.push_back(allNodes[i]);
     }
-    if (node.hasName() && node.getName() == name) nodes.push_back(&node);
   }
 
   /**
@@ -604,15 +630,7 @@ public:
   template<class N>
   static bool hasNodeWithName(const N& node, const std::string& name)
   {
-    if (node.hasName() & node.getName() == name) return true;
-    else
-    {
-      for (size_t i = 0; i < node.getNumberOfSons(); i++)
-      {
-        if (hasNodeWithName(*node.getSon(i), name)) return true;
-      }
-      return false;
-    }
+    return searchFirstNode_<const N>(node, NodeNameEquals_(name)) != 0;
   }
 
   /**
@@ -744,7 +762,7 @@ public:
   static std::vector<const Node*> getPathBetweenAnyTwoNodes(const Node& node1, const Node& node2, bool includeAncestor = true, bool includeAncestorAtEndOfPath = true);
 
   /**
-   * @brief Recursively clone a subtree structure.
+   * @brief Clone a subtree structure.
    *
    * This is a template function allowing to specify the class of the copy.
    * The template class has to have a constructor accepting const Node& as single argument.
@@ -757,30 +775,40 @@ public:
   {
     // First we copy this node using default copy constuctor:
     N* clone = new N(node);
-    // We remove the link toward the father:
-    // clone->removeFather();
 
-    // Now we perform a hard copy:
-    for (int i = 0; i < static_cast<int>(node.getNumberOfSons()); i++)
+    // Now we perform a hard copy, each node being copied before its sons:
+    std::vector< std::pair<const Node*, N*> > stack(1, std::make_pair(&node, clone));
+    while (!stack.empty())
     {
-      clone->addSon(cloneSubtree<N>(*node[i]));
+      const Node* original = stack.back().first;
+      N* copy = stack.back().second;
+      stack.pop_back();
+      for (size_t i = 0; i < original->getNumberOfSons(); i++)
+      {
+        N* son = new N(*original->getSon(i));
+        copy->addSon(son);
+        stack.push_back(std::make_pair(original->getSon(i), son));
+      }
     }
     return clone;
   }
 
   /**
-   * @brief Recursively delete a subtree structure.
+   * @brief Delete a subtree structure.
+   *
+   * All nodes of the subtree are deleted, excepted the basal node.
    *
    * @param node The basal node of the subtree.
    */
   template<class N>
   static void deleteSubtree(N* node)
   {
-    for (size_t i = 0; i < node->getNumberOfSons(); ++i)
+    std::vector<N*> nodes;
+    getPostorderNodes<N>(*node, nodes);
+    // All nodes but the last one, which is the basal node:
+    for (size_t i = 0; i + 1 < nodes.size(); ++i)
     {
-      N* son = node->getSon(i);
-      deleteSubtree(son);
-      delete son;
+      delete nodes[i];
     }
   }
 
@@ -788,30 +816,22 @@ public:
   template<class N>
   static N* cloneSubtree(const Tree& tree, int nodeId)
   {
-    // First we copy this node using default copy constuctor:
-    N* clone = tree.hasNodeName(nodeId) ? new N(nodeId, tree.getNodeName(nodeId)) : new N(nodeId);
-    // Then we set the length:
-    if (tree.hasDistanceToFather(nodeId))
-      clone->setDistanceToFather(tree.getDistanceToFather(nodeId));
-    // Now we copy all sons:
-    std::vector<int> sonsId = tree.getSonsId(nodeId);
-    for (size_t i = 0; i < sonsId.size(); i++)
-    {
-      clone->addSon(cloneSubtree<N>(tree, sonsId[i]));
-    }
-    // Must copy all properties too:
-    std::vector<std::string> names;
-    names = tree.getNodePropertyNames(nodeId);
-    for (size_t i = 0; i < names.size(); i++)
-    {
-      clone->setNodeProperty(names[i], *tree.getNodeProperty(nodeId, names[i]));
-    }
-    names = tree.getBranchPropertyNames(nodeId);
-    for (size_t i = 0; i < names.size(); i++)
+    N* clone = cloneNode_<N>(tree, nodeId);
+    // Now we copy all sons, each node being copied before its sons:
+    std::vector< std::pair<int, N*> > stack(1, std::make_pair(nodeId, clone));
+    while (!stack.empty())
     {
-      clone->setBranchProperty(names[i], *tree.getBranchProperty(nodeId, names[i]));
+      int id = stack.back().first;
+      N* copy = stack.back().second;
+      stack.pop_back();
+      std::vector<int> sonsId = tree.getSonsId(id);
+      for (size_t i = 0; i < sonsId.size(); i++)
+      {
+        N* son = cloneNode_<N>(tree, sonsId[i]);
+        copy->addSon(son);
+        stack.push_back(std::make_pair(sonsId[i], son));
+      }
     }
-
     return clone;
   }
   /** @} */
@@ -897,8 +917,9 @@ public:
    * From version 1.9 of Bio++, this function has been rewritten in a more efficient way
    * and does not use getDistanceBetweenAnyTwoNodes anymore, but makes use of a more clever
    * pass on the tree. The new function now works well on trees with thousands of leaves.
+   * Distances are now obtained in constant time from a TreeQueryIndex, without recursion.
    *
-   * @see getDistanceBetweenAnyTwoNodes
+   * @see getDistanceBetweenAnyTwoNodes, TreeQueryIndex
    *
    * @author Nicolas Rochette
    *
@@ -907,21 +928,6 @@ public:
    */
   static DistanceMatrix* getDistanceMatrix(const TreeTemplate<Node>& tree);
 
-private:
-  /**
-   * @brief Inner function used by getDistanceMatrix.
-   *
-   * (1) Retrieves leaf-leaf distances in node's subtree and
-   *  writes them in the distance matrix.
-   * (2) Returns distances from node's father to those leaves.
-   *
-   * @param node The current node in the recursion.
-   * @param matrix The output matrix which will be filled.
-   * @param distsToNodeFather Intermediate computations contianing the distances of the node to the leaves.
-   */
-  static void processDistsInSubtree_(const Node* node, DistanceMatrix& matrix, std::vector< std::pair<std::string, double> >& distsToNodeFather);
-
-public:
   /** @} */
 
   /**
@@ -1031,6 +1037,32 @@ public:
    */
   static std::string treeToParenthesis(const TreeTemplate<Node>& tree, bool bootstrap, const std::string& propertyName);
 
+  /**
+   * @brief Write the parenthesis description of a tree to a stream.
+   *
+   * Same as treeToParenthesis(const TreeTemplate<Node>&, bool), but the description is written
+   * directly, without building intermediate strings. Numbers are written with the precision of
+   * the stream: set it to 17 for branch lengths to be read back exactly.
+   *
+   * @param tree The tree to write.
+   * @param out The output stream.
+   * @param writeId Tells if node ids must be printed.
+   */
+  static void treeToParenthesis(const TreeTemplate<Node>& tree, std::ostream& out, bool writeId = false);
+
+  /**
+   * @brief Write the parenthesis description of a tree to a stream.
+   *
+   * Same as treeToParenthesis(const TreeTemplate<Node>&, bool, const std::string&), but the description
+   * is written directly, without building intermediate strings.
+   *
+   * @param tree The tree to write.
+   * @param out The output stream.
+   * @param bootstrap Tell is bootstrap values must be writen.
+   * @param propertyName The name of the property to use. Only used if bootstrap = false.
+   */
+  static void treeToParenthesis(const TreeTemplate<Node>& tree, std::ostream& out, bool bootstrap, const std::string& propertyName);
+
   /** @} */
 
   /**
@@ -1071,6 +1103,20 @@ public:
    */
   static void incrementAllIds(Node* node, int increment);
 
+  /**
+   * @brief This method will add a given value (possibly negative) to all identifiers in a tree,
+   * and update the index of nodes by id of the tree.
+   *
+   * @param tree The tree to edit.
+   * @param increment The value to add.
+   */
+  template<class N>
+  static void incrementAllIds(TreeTemplate<N>& tree, int increment)
+  {
+    incrementAllIds(tree.getRootNode(), increment);
+    tree.updateNodeIndex();
+  }
+
   /**
    * @name Retrieve properties from a (sub)tree.
    *
@@ -1217,10 +1263,29 @@ public:
    *
    * @param subtree   The node defining the subtree where nodes should be collapsed.
    * @param threshold The minimum value for which a node is considered to be confident.
+   * If the subtree belongs to a TreeTemplate, its TreeTemplate::updateNodeIndex() method must be called afterwards.
+   *
    * @param property  The branch property to be considered as a confidence value (bootstrap values by default).
    */
   static void unresolveUncertainNodes(Node& subtree, double threshold, const std::string& property = TreeTools::BOOTSTRAP);
 
+  /**
+   * @brief Unresolve nodes with low confidence value in a whole tree.
+   *
+   * Same as unresolveUncertainNodes(Node&, double, const std::string&) applied to the root node,
+   * the node index and cached traversals of the tree being updated afterwards.
+   *
+   * @param tree      The tree where nodes should be collapsed.
+   * @param threshold The minimum value for which a node is considered to be confident.
+   * @param property  The branch property to be considered as a confidence value (bootstrap values by default).
+   */
+  template<class N>
+  static void unresolveUncertainNodes(TreeTemplate<N>& tree, double threshold, const std::string& property = TreeTools::BOOTSTRAP)
+  {
+    unresolveUncertainNodes(*tree.getRootNode(), threshold, property);
+    tree.updateNodeIndex();
+  }
+
 private:
   struct OrderTreeData_
   {
@@ -1274,6 +1339,95 @@ private:
    */
   static void getBestRootInSubtree_(bpp::TreeTemplate<bpp::Node>& tree, short criterion,  bpp::Node* node, std::pair<bpp::Node*, std::map<std::string, double> >& bestRoot);
 
+  /**
+   * @return The position of the first delimiter (comma or closing parenthesis) after a node element
+   * in a parenthesis description, or the size of the description if there is none.
+   * @throw IOException If an opening parenthesis is found.
+   */
+  static size_t findEndOfElement_(const std::string& description, size_t begin);
+
+  /**
+   * @brief Set the name, branch length, and bootstrap value or property of a node from its text in a parenthesis description.
+   */
+  static void setElement_(Node& node, const std::string& text, bool isLeaf, bool bootstrap, const std::string& propertyName, bool withId);
+
+  /**
+   * @brief Write the parenthesis description of a subtree.
+   *
+   * @param s The output stream.
+   * @param node The node defining the subtree.
+   * @param writeSuffix A function writing the text following a node, i.e. its label and branch length.
+   */
+  static void writeSubtree_(std::ostream& s, const Node& node, const std::function<void (std::ostream&, const Node&)>& writeSuffix);
+
+  /**
+   * @brief Write the parenthesis description of a subtree, with node ids or bootstrap values.
+   */
+  static void writeSubtree_(std::ostream& s, const Node& node, bool writeId);
+
+  /**
+   * @brief Write the parenthesis description of a subtree, with bootstrap values or a property.
+   */
+  static void writeSubtree_(std::ostream& s, const Node& node, bool bootstrap, const std::string& propertyName);
+
+  struct NodeIdEquals_
+  {
+    int id;
+    NodeIdEquals_(int i) : id(i) {}
+    bool operator()(const Node& node) const { return node.getId() == id; }
+  };
+
+  struct NodeNameEquals_
+  {
+    std::string name;
+    NodeNameEquals_(const std::string& n) : name(n) {}
+    bool operator()(const Node& node) const { return node.hasName() && node.getName() == name; }
+  };
+
+  /**
+   * @return The first node of a subtree, in preorder, matching a predicate, or 0 if there is none.
+   */
+  template<class N, class Predicate>
+  static N* searchFirstNode_(N& node, const Predicate& predicate)
+  {
+    std::vector<N*> stack(1, &node);
+    while (!stack.empty())
+    {
+      N* current = stack.back();
+      stack.pop_back();
+      if (predicate(*current))
+        return current;
+      for (size_t i = current->getNumberOfSons(); i > 0; --i)
+      {
+        stack.push_back(current->getSon(i - 1));
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @return A copy of a node of a tree, with its name, length and properties, but without its sons.
+   */
+  template<class N>
+  static N* cloneNode_(const Tree& tree, int nodeId)
+  {
+    N* clone = tree.hasNodeName(nodeId) ? new N(nodeId, tree.getNodeName(nodeId)) : new N(nodeId);
+    if (tree.hasDistanceToFather(nodeId))
+      clone->setDistanceToFather(tree.getDistanceToFather(nodeId));
+    std::vector<std::string> names;
+    names = tree.getNodePropertyNames(nodeId);
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      clone->setNodeProperty(names[i], *tree.getNodeProperty(nodeId, names[i]));
+    }
+    names = tree.getBranchPropertyNames(nodeId);
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      clone->setBranchProperty(names[i], *tree.getBranchProperty(nodeId, names[i]));
+    }
+    return clone;
+  }
+
 public:
   static const short MIDROOT_VARIANCE;
   static const short MIDROOT_SUM_OF_SQUARES;
@@ -39,6 +39,7 @@
 
 #include "TreeTools.h"
 #include "Tree.h"
+#include "TreeQueryIndex.h"
 #include "BipartitionTools.h"
 #include "Model/Nucleotide/JCnuc.h"
 #include "Distance/DistanceEstimation.h"
@@ -277,8 +278,8 @@ string TreeTools::nodeToParenthesis(const Tree& tree, int nodeId, bool writeId)
   }
   else
   {
-    if (tree.hasBranchProperty(nodeId, BOOTSTRAP))
-      s << (dynamic_cast<const Number<double>*>(tree.getBranchProperty(nodeId, BOOTSTRAP))->getValue());
+    if (tree.hasBootstrapValue(nodeId))
+      s << tree.getBootstrapValue(nodeId);
   }
   if (tree.hasDistanceToFather(nodeId))
     s << ":" << tree.getDistanceToFather(nodeId);
@@ -309,8 +310,8 @@ string TreeTools::nodeToParenthesis(const Tree& tree, int nodeId, bool bootstrap
 
     if (bootstrap)
     {
-      if (tree.hasBranchProperty(nodeId, BOOTSTRAP))
-        s << (dynamic_cast<const Number<double>*>(tree.getBranchProperty(nodeId, BOOTSTRAP))->getValue());
+      if (tree.hasBootstrapValue(nodeId))
+        s << tree.getBootstrapValue(nodeId);
     }
     else
     {
@@ -382,8 +383,8 @@ string TreeTools::treeToParenthesis(const Tree& tree, bool bootstrap, const stri
   s << ")";
   if (bootstrap)
   {
-    if (tree.hasBranchProperty(rootId, BOOTSTRAP))
-      s << (dynamic_cast<const Number<double>*>(tree.getBranchProperty(rootId, BOOTSTRAP))->getValue());
+    if (tree.hasBootstrapValue(rootId))
+      s << tree.getBootstrapValue(rootId);
   }
   else
   {
@@ -697,13 +698,19 @@ double TreeTools::convertToClockTree2(Tree& tree, int nodeId)
 DistanceMatrix* TreeTools::getDistanceMatrix(const Tree& tree)
 {
   vector<string> names = tree.getLeavesNames();
+  vector<int> ids(names.size());
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    ids[i] = tree.getLeafId(names[i]);
+  }
+  TreeQueryIndex index(tree);
   DistanceMatrix* mat = new DistanceMatrix(names);
   for (size_t i = 0; i < names.size(); i++)
   {
     (*mat)(i, i) = 0;
     for (size_t j = 0; j < i; j++)
     {
-      (*mat)(i, j) = (*mat)(j, i) = getDistanceBetweenAnyTwoNodes(tree, tree.getLeafId(names[i]), tree.getLeafId(names[j]));
+      (*mat)(i, j) = (*mat)(j, i) = index.getDistanceBetweenAnyTwoNodes(ids[i], ids[j]);
     }
   }
   return mat;
@@ -1123,7 +1130,7 @@ void TreeTools::computeBootstrapValues(Tree& tree, const vector<Tree*>& vecTr, b
   vector<size_t> occurences;
   BipartitionList* bpList = bipartitionOccurrences(vecTr, occurences);
 
-  vector< Number<double> > bootstrapValues(bpTree.getNumberOfBipartitions());
+  vector<double> bootstrapValues(bpTree.getNumberOfBipartitions(), 0.);
 
   for (size_t i = 0; i < bpTree.getNumberOfBipartitions(); i++)
   {
@@ -1142,7 +1149,7 @@ void TreeTools::computeBootstrapValues(Tree& tree, const vector<Tree*>& vecTr, b
   for (size_t i = 0; i < index.size(); i++)
   {
     if (!tree.isLeaf(index[i]))
-      tree.setBranchProperty(index[i], BOOTSTRAP, bootstrapValues[i]);
+      tree.setBootstrapValue(index[i], bootstrapValues[i]);
   }
 
   delete bpList;
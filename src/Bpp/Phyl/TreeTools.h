@@ -154,6 +154,7 @@ class TreeTools
      * @brief Get the id of the last common ancestors of all specified nodes.
      *
      * Nodes id need not correspond to leaves.
+     * Use a TreeQueryIndex when many queries are made on the same tree.
      *
      * @author Simon Carrignon
      * @param tree The tree to use.
@@ -383,6 +384,7 @@ class TreeTools
      * @brief Get the total distance between two nodes.
      *
      * Sum all branch lengths between two nodes.
+     * Use a TreeQueryIndex when many queries are made on the same tree.
      *
      * @param tree The tree to consider.
      * @param nodeId1 First node id.
@@ -398,6 +400,7 @@ class TreeTools
      * Compute all distances between each leaves and store them in a matrix.
      * A new DistanceMatrix object is created, and a pointer toward it is returned.
      * The destruction of this matrix is left up to the user.
+     * Distances are obtained in constant time from a TreeQueryIndex.
      *
      * @see getDistanceBetweenAnyTwoNodes
      *
@@ -0,0 +1,181 @@
+//
+// File: test_ancestral.cpp
+// Created by: Bio++ Development Team
+// Created on: Tue Oct 20 2026
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Team, (November 16, 2004)
+
+   This software is a computer program whose purpose is to provide classes
+   for phylogenetic data analysis.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/Container/VectorSiteContainer.h>
+#include <Bpp/Phyl/TreeTemplate.h>
+#include <Bpp/Phyl/TreeTemplateTools.h>
+#include <Bpp/Phyl/Model/Nucleotide/T92.h>
+#include <Bpp/Phyl/Model/RateDistribution/GammaDiscreteRateDistribution.h>
+#include <Bpp/Phyl/Likelihood/DRHomogeneousTreeLikelihood.h>
+#include <Bpp/Phyl/Likelihood/MarginalAncestralStateReconstruction.h>
+#include <Bpp/Phyl/Likelihood/JointAncestralStateReconstruction.h>
+#include <limits>
+#include <iostream>
+
+using namespace bpp;
+using namespace std;
+
+int main() {
+  unique_ptr<TreeTemplate<Node> > tree(TreeTemplateTools::parenthesisToTree("((A:0.01, B:0.02):0.03,C:0.01,(D:0.1,E:0.05):0.2);"));
+  const NucleicAlphabet* alphabet = &AlphabetTools::DNA_ALPHABET;
+
+  VectorSiteContainer sites(alphabet);
+  sites.addSequence(BasicSequence("A", "AAATGGCTGTGCACGTC", alphabet));
+  sites.addSequence(BasicSequence("B", "GACTGGATCTGCACGTC", alphabet));
+  sites.addSequence(BasicSequence("C", "CTCTGGATGTGCACGTG", alphabet));
+  sites.addSequence(BasicSequence("D", "AAATGGCGGTGCGCCTA", alphabet));
+  sites.addSequence(BasicSequence("E", "AAATGGCGGTGCGCCTT", alphabet));
+
+  T92 model(alphabet, 3.);
+  GammaDiscreteRateDistribution rdist(4, 1.0);
+  DRHomogeneousTreeLikelihood tl(*tree, sites, &model, &rdist, true, false);
+  tl.initialize();
+
+  MarginalAncestralStateReconstruction asr(&tl);
+  size_t nbStates = 4;
+  size_t nbDistinctSites = tl.getLikelihoodData()->getNumberOfDistinctSites();
+
+  // All-nodes posteriors must match the node-by-node computation, whatever the number of threads:
+  map<int, vector<size_t> > states = asr.getAllAncestralStates();
+  for (unsigned int nbThreads = 1; nbThreads <= 3; ++nbThreads) {
+    asr.setNumberOfThreads(nbThreads);
+    vector<int> nodeIds;
+    Vdouble posteriors;
+    asr.getAllPosteriorProbabilities(nodeIds, posteriors);
+    for (size_t k = 0; k < nodeIds.size(); ++k) {
+      VVdouble probs;
+      vector<size_t> nodeStates = asr.getAncestralStatesForNode(nodeIds[k], probs, false);
+      if (nodeStates != states[nodeIds[k]]) {
+        cerr << "Wrong states for node " << nodeIds[k] << endl;
+        return 1;
+      }
+      for (size_t i = 0; i < nbDistinctSites; ++i) {
+        double sum = 0;
+        for (size_t x = 0; x < nbStates; ++x) {
+          double p = posteriors[(k * nbDistinctSites + i) * nbStates + x];
+          sum += p;
+          if (abs(p - probs[i][x]) > 1e-12) {
+            cerr << "Wrong posterior for node " << nodeIds[k] << ", site " << i << ", state " << x << ": " << p << " vs " << probs[i][x] << endl;
+            return 1;
+          }
+        }
+        if (abs(sum - 1.) > 1e-9) {
+          cerr << "Posteriors do not sum to one: " << sum << endl;
+          return 1;
+        }
+      }
+    }
+  }
+  cout << "Posterior probabilities OK." << endl;
+
+  // Sampling must not depend on the number of threads:
+  vector<int> nodeIds;
+  vector<size_t> samples1, samples4;
+  asr.setNumberOfThreads(1);
+  asr.sampleAllAncestralStates(50, 42, nodeIds, samples1);
+  asr.setNumberOfThreads(4);
+  asr.sampleAllAncestralStates(50, 42, nodeIds, samples4);
+  if (samples1 != samples4) {
+    cerr << "Sampling depends on the number of threads." << endl;
+    return 1;
+  }
+  if (samples1.size() != 50 * nodeIds.size() * nbDistinctSites) {
+    cerr << "Wrong number of samples." << endl;
+    return 1;
+  }
+  for (size_t j = 0; j < samples1.size(); ++j) {
+    if (samples1[j] >= nbStates) {
+      cerr << "Invalid sampled state." << endl;
+      return 1;
+    }
+  }
+  cout << "Sampling OK." << endl;
+
+  // Joint reconstruction must match an exhaustive search over inner states and rate classes:
+  JointAncestralStateReconstruction jasr(&tl, 2);
+  TreeTemplate<Node> ttree(tl.getTree());
+  vector<Node*> allNodes = ttree.getNodes();
+  vector<int> innerIds = ttree.getInnerNodesId();
+  const vector<size_t>& patterns = tl.getLikelihoodData()->getRootArrayPositions();
+  for (size_t j = 0; j < sites.getNumberOfSites(); ++j) {
+    map<int, size_t> current;
+    for (size_t k = 0; k < allNodes.size(); ++k) {
+      if (allNodes[k]->isLeaf())
+        current[allNodes[k]->getId()] = static_cast<size_t>(sites.getSequence(allNodes[k]->getName())[j]);
+    }
+    double best = -numeric_limits<double>::infinity();
+    map<int, size_t> bestStates;
+    size_t nbCombinations = 1;
+    for (size_t k = 0; k < innerIds.size(); ++k)
+      nbCombinations *= nbStates;
+    for (size_t c = 0; c < rdist.getNumberOfCategories(); ++c) {
+      for (size_t comb = 0; comb < nbCombinations; ++comb) {
+        size_t code = comb;
+        for (size_t k = 0; k < innerIds.size(); ++k) {
+          current[innerIds[k]] = code % nbStates;
+          code /= nbStates;
+        }
+        double l = log(rdist.getProbability(c)) + log(model.freq(current[ttree.getRootId()]));
+        for (size_t k = 0; k < allNodes.size(); ++k) {
+          const Node* node = allNodes[k];
+          if (node->hasFather())
+            l += log(model.Pij_t(current[node->getFather()->getId()], current[node->getId()], rdist.getCategory(c) * node->getDistanceToFather()));
+        }
+        if (l > best) {
+          best = l;
+          bestStates = current;
+        }
+      }
+    }
+    if (abs(best - jasr.getLogLikelihoodForASite(j)) > 1e-9) {
+      cerr << "Wrong joint likelihood for site " << j << ": " << jasr.getLogLikelihoodForASite(j) << " vs " << best << endl;
+      return 1;
+    }
+    for (size_t k = 0; k < innerIds.size(); ++k) {
+      if (jasr.getAncestralStatesForNode(innerIds[k])[patterns[j]] != bestStates[innerIds[k]]) {
+        cerr << "Wrong joint state for node " << innerIds[k] << ", site " << j << endl;
+        return 1;
+      }
+    }
+  }
+  cout << "Joint reconstruction OK." << endl;
+
+  return 0;
+}
@@ -45,7 +45,13 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Phyl/Model/RateDistribution/GammaDiscreteRateDistribution.h>
 #include <Bpp/Phyl/Simulation/HomogeneousSequenceSimulator.h>
 #include <Bpp/Phyl/Likelihood/RHomogeneousTreeLikelihood.h>
+#include <Bpp/Phyl/Likelihood/ValueAndGradientFunction.h>
 #include <Bpp/Phyl/OptimizationTools.h>
+#include <Bpp/Phyl/MultiStartOptimizer.h>
+#include <Bpp/Phyl/PatternBootstrap.h>
+#include <Bpp/Phyl/Likelihood/TopologyTests.h>
+#include <Bpp/Phyl/Io/IoPairedSiteLikelihoods.h>
+#include <cstdio>
 #include <iostream>
 
 using namespace bpp;
@@ -134,5 +140,212 @@ int main() {
     if (abs(d1sr - d1dr) > 0.000001) return 1;
   }
 
+  //Conditional likelihoods multiplied by uniformization:
+  unique_ptr<T92> uniformizedModel(dynamic_cast<T92*>(model->clone()));
+  uniformizedModel->enableUniformization(true);
+  DRHomogeneousTreeLikelihood tlUnif(*tree, sites, uniformizedModel.get(), rdist.get());
+  tlUnif.initialize();
+  if (abs(tlUnif.getValue() - tldr.getValue()) > 0.000001) return 1;
+
+  //Value and gradient in one call:
+  ParameterList allParams = tldr.getFirstOrderDerivableParameters();
+  Vdouble gradient;
+  double value = tldr.getValueAndGradient(allParams, gradient);
+  if (abs(value - tldr.getValue()) > 0.000001) return 1;
+  for (size_t i = 0; i < allParams.size(); i++) {
+    if (abs(gradient[i] - tldr.getFirstOrderDerivative(allParams[i].getName())) > 0.000001) return 1;
+  }
+  //Also through a reparametrization:
+  ReparametrizationValueAndGradientWrapper tldrRep(&tldr, allParams);
+  ParameterList repParams = tldrRep.getParameters();
+  Vdouble repGradient;
+  tldrRep.getValueAndGradient(repParams, repGradient);
+  for (size_t i = 0; i < repParams.size(); i++) {
+    if (abs(repGradient[i] - tldrRep.getFirstOrderDerivative(repParams[i].getName())) > 0.000001) return 1;
+  }
+
+  //Bulk derivatives, indexed as branch length parameters:
+  Vdouble d1s, d2s;
+  tldr.getBranchLengthsDerivatives(d1s, d2s);
+  for (size_t i = 0; i < d1s.size(); i++) {
+    string name = "BrLen" + TextTools::toString(i);
+    if (abs(d1s[i] - tldr.getFirstOrderDerivative(name)) > 0.000001) return 1;
+    if (abs(d2s[i] - tldr.getSecondOrderDerivative(name)) > 0.000001) return 1;
+  }
+
+  //Without derivative arrays, requested derivatives are computed from the likelihood arrays only:
+  tldr.enableDerivatives(false);
+  tldr.setParameters(allParams);
+  for (size_t i = 0; i < d1s.size(); i++) {
+    if (abs(d1s[i] - tldr.getFirstOrderDerivative("BrLen" + TextTools::toString(i))) > 0.000001) return 1;
+  }
+  tldr.enableDerivatives(true);
+  tldr.setParameters(allParams);
+
+  //Derivatives with respect to model and rate parameters, against finite differences on the likelihood:
+  vector<string> modelParams = tldr.getSubstitutionModelParameters().getParameterNames();
+  vector<string> rateParams = tldr.getRateDistributionParameters().getParameterNames();
+  modelParams.insert(modelParams.end(), rateParams.begin(), rateParams.end());
+  for (vector<string>::iterator it = modelParams.begin(); it != modelParams.end(); ++it) {
+    if (!tldr.getFirstOrderDerivableParameters().hasParameter(*it)) return 1;
+    double d1 = tldr.getFirstOrderDerivative(*it);
+    double v = tldr.getParameterValue(*it);
+    double h = 0.00001 * max(1., abs(v));
+    tldr.setParameterValue(*it, v + h);
+    double fp = tldr.getValue();
+    tldr.setParameterValue(*it, v - h);
+    double fm = tldr.getValue();
+    tldr.setParameterValue(*it, v);
+    double d1num = (fp - fm) / (2 * h);
+    cout << *it << "\t" << d1 << "\t" << d1num << endl;
+    if (abs(d1 - d1num) > 0.0001 * max(1., abs(d1num))) return 1;
+  }
+
+  //Leaves with ambiguous characters are stored as state codes in DR likelihoods:
+  VectorSiteContainer sitesAmb(alphabet);
+  sitesAmb.addSequence(BasicSequence("A", "AAATGGCTGTGCACGTN", alphabet));
+  sitesAmb.addSequence(BasicSequence("B", "GAC-GGATCTGCRCGTC", alphabet));
+  sitesAmb.addSequence(BasicSequence("C", "CTCTGGATGTGCACGYG", alphabet));
+  sitesAmb.addSequence(BasicSequence("D", "AAATGGCGGTGCGCCTA", alphabet));
+  RHomogeneousTreeLikelihood tlsrAmb(*tree, sitesAmb, model.get(), rdist.get(), true, false);
+  tlsrAmb.initialize();
+  DRHomogeneousTreeLikelihood tldrAmb(*tree, sitesAmb, model.get(), rdist.get(), true, false);
+  tldrAmb.initialize();
+  cout << "Ambiguous data:\t" << tlsrAmb.getValue() << "\t" << tldrAmb.getValue() << endl;
+  if (!tldrAmb.getLikelihoodData()->hasLeafStateCodes()) return 1;
+  if (abs(tlsrAmb.getValue() - tldrAmb.getValue()) > 0.000001) return 1;
+  for (vector<string>::iterator it = params.begin(); it != params.end(); ++it) {
+    if (abs(tlsrAmb.getFirstOrderDerivative(*it) - tldrAmb.getFirstOrderDerivative(*it)) > 0.000001) return 1;
+  }
+
+  //The array accessor of a leaf expands all state codes:
+  unique_ptr<DRHomogeneousTreeLikelihood> tldrExpanded(tldrAmb.clone());
+  int leafId = tldrExpanded->getTree().getLeavesId()[0];
+  VVdouble* leafArray = &tldrExpanded->getLikelihoodData()->getLeafLikelihoods(leafId);
+  if (leafArray->size() != tldrExpanded->getLikelihoodData()->getNumberOfDistinctSites()) return 1;
+  if (tldrExpanded->getLikelihoodData()->hasLeafStateCodes()) return 1;
+  if (!tldrAmb.getLikelihoodData()->hasLeafStateCodes()) return 1;
+  tldrExpanded->computeTreeLikelihood();
+  if (abs(tldrExpanded->getValue() - tldrAmb.getValue()) > 0.000001) return 1;
+
+  //Clones share their likelihood arrays until one of them is recomputed:
+  unique_ptr<DRHomogeneousTreeLikelihood> tldrClone(tldrAmb.clone());
+  unique_ptr<RHomogeneousTreeLikelihood> tlsrClone(tlsrAmb.clone());
+  double valueAmb = tldrAmb.getValue();
+  int brLen0Id = tldrClone->getBranchNode(0)->getId();
+  int brLen1Id = tldrClone->getBranchNode(1)->getId();
+  if (!tldrClone->hasSharedTransitionProbabilities(brLen0Id)) return 1;
+  tldrClone->getTransitionProbabilitiesPerRateClass(brLen0Id, 0);
+  tldrClone->getValue();
+  tldrClone->getFirstOrderDerivative("BrLen0");
+  if (!tldrClone->hasSharedTransitionProbabilities(brLen0Id)) return 1;
+  tldrClone->setParameterValue("BrLen0", 0.5);
+  if (tldrClone->hasSharedTransitionProbabilities(brLen0Id)) return 1;
+  if (!tldrClone->hasSharedTransitionProbabilities(brLen1Id)) return 1;
+  tlsrClone->setParameterValue("BrLen0", 0.5);
+  cout << "Clones:\t" << valueAmb << "\t" << tldrClone->getValue() << "\t" << tlsrClone->getValue() << endl;
+  if (abs(tldrAmb.getValue() - valueAmb) > 0.000001) return 1;
+  if (abs(tlsrAmb.getValue() - valueAmb) > 0.000001) return 1;
+  if (abs(tldrClone->getValue() - tlsrClone->getValue()) > 0.000001) return 1;
+  if (abs(tldrClone->getValue() - valueAmb) < 0.000001) return 1;
+  if (abs(tldrAmb.getFirstOrderDerivative("BrLen0") - tlsrAmb.getFirstOrderDerivative("BrLen0")) > 0.000001) return 1;
+
+  //Branch-wise Newton optimization should reach the same optimum as the joint one:
+  DRHomogeneousTreeLikelihood tlNewton(*tree, sites, model.get(), rdist.get(), true, false);
+  tlNewton.initialize();
+  OptimizationTools::optimizeBranchLengthsParameters(&tlNewton, tlNewton.getBranchLengthsParameters(), 0, 0.000001, 10000, 0, 0, 0);
+  DRHomogeneousTreeLikelihood tlBranchNewton(*tree, sites, model.get(), rdist.get(), true, false);
+  tlBranchNewton.initialize();
+  OptimizationTools::optimizeBranchLengthsParameters(&tlBranchNewton, tlBranchNewton.getBranchLengthsParameters(), 0, 0.000001, 10000, 0, 0, 0, OptimizationTools::OPTIMIZATION_BRANCH_NEWTON);
+  cout << "Branch lengths optimization:\t" << tlNewton.getValue() << "\t" << tlBranchNewton.getValue() << endl;
+  if (abs(tlNewton.getValue() - tlBranchNewton.getValue()) > 0.001) return 1;
+  //Derivatives are up to date again after the optimization:
+  if (!tlBranchNewton.enableFirstOrderDerivatives()) return 1;
+  DRHomogeneousTreeLikelihood tlBranchNewtonCheck(tlBranchNewton.getTree(), sites, model.get(), rdist.get(), true, false);
+  tlBranchNewtonCheck.initialize();
+  if (abs(tlBranchNewton.getFirstOrderDerivative("BrLen0") - tlBranchNewtonCheck.getFirstOrderDerivative("BrLen0")) > 0.000001) return 1;
+
+  //Joint L-BFGS optimization of all parameters:
+  unique_ptr<SubstitutionModel> modelLbfgs(new T92(alphabet, 3.));
+  unique_ptr<DiscreteDistribution> rdistLbfgs(new GammaDiscreteRateDistribution(4, 1.0));
+  DRHomogeneousTreeLikelihood tlLbfgs(*tree, sites, modelLbfgs.get(), rdistLbfgs.get(), true, false);
+  tlLbfgs.initialize();
+  OptimizationTools::optimizeNumericalParameters(&tlLbfgs, tlLbfgs.getParameters(), 0, 1, 0.000001, 10000, 0, 0, false, 0, OptimizationTools::OPTIMIZATION_NEWTON, OptimizationTools::OPTIMIZATION_LBFGS);
+  cout << "Joint L-BFGS optimization:\t" << tlLbfgs.getValue() << endl;
+  if (tlLbfgs.getValue() > 65.72293577214308868406 + 0.01) return 1;
+  if (!tlLbfgs.enableFirstOrderDerivatives()) return 1;
+
+  //Multi-start optimization, with checkpoint and resume:
+  string checkpoint = "test_likelihood_checkpoint.txt";
+  remove(checkpoint.c_str());
+  MultiStartOptimizer multiStart(sites, T92(alphabet, 3.), GammaDiscreteRateDistribution(4, 1.0), 2);
+  multiStart.addStartingTree(*tree, "input");
+  multiStart.addRandomStartingTrees(2);
+  multiStart.setCheckpointFile(checkpoint, 0);
+  size_t best = multiStart.optimize();
+  cout << "Multi-start optimization:\t" << multiStart.getValue(best) << endl;
+  if (multiStart.getValue(best) > 65.72293577214308868406 + 0.01) return 1;
+  MultiStartOptimizer resumed(sites, T92(alphabet, 3.), GammaDiscreteRateDistribution(4, 1.0), 2);
+  resumed.addStartingTree(*tree, "input");
+  resumed.addRandomStartingTrees(2);
+  resumed.setCheckpointFile(checkpoint, 0);
+  resumed.optimize();
+  for (size_t i = 0; i < multiStart.getNumberOfStartingPoints(); i++) {
+    if (abs(resumed.getValue(i) - multiStart.getValue(i)) > 0.000001) return 1;
+    //Branch lengths are read back exactly:
+    if (resumed.getTree(i).getBranchLengths() != multiStart.getTree(i).getBranchLengths()) return 1;
+  }
+  remove(checkpoint.c_str());
+
+  //Bootstrap by pattern reweighting, against an explicitly resampled alignment:
+  NNIHomogeneousTreeLikelihood tlBoot(*tree, sites, model.get(), rdist.get(), true, false);
+  tlBoot.initialize();
+  PatternBootstrap bootstrap(tlBoot, 2);
+  bootstrap.run(4);
+  const vector<unsigned int>& weightsBoot = bootstrap.getPatternWeights(0);
+  vector<string> seqsBoot(seqNames.size());
+  vector<bool> seen(weightsBoot.size(), false);
+  for (size_t s = 0; s < sites.getNumberOfSites(); s++) {
+    size_t p = tlBoot.getSiteIndex(s);
+    if (seen[p]) continue;
+    seen[p] = true;
+    for (size_t j = 0; j < seqNames.size(); j++)
+      seqsBoot[j].append(weightsBoot[p], sites.getSequence(seqNames[j]).getChar(s)[0]);
+  }
+  VectorSiteContainer sitesBoot(alphabet);
+  for (size_t j = 0; j < seqNames.size(); j++)
+    sitesBoot.addSequence(BasicSequence(seqNames[j], seqsBoot[j], alphabet));
+  DRHomogeneousTreeLikelihood tlCheck(bootstrap.getTree(0), sitesBoot, model.get(), rdist.get(), true, false);
+  tlCheck.initialize();
+  cout << "Bootstrap replicate:\t" << bootstrap.getValue(0) << "\t" << tlCheck.getValue() << endl;
+  if (abs(bootstrap.getValue(0) - tlCheck.getValue()) > 0.000001) return 1;
+
+  //RELL log-likelihoods on the same replicates:
+  PairedSiteLikelihoods psl;
+  psl.appendModel(tlBoot);
+  vector< vector<double> > rell = bootstrap.getRellLogLikelihoods(psl);
+  tlBoot.setPatternWeights(weightsBoot);
+  if (abs(rell[0][0] + tlBoot.getValue()) > 0.000001) return 1;
+
+  //Topology tests, against a uniformly worse model, after a round trip through the binary format:
+  vector<double> worse = psl.getLikelihoods()[0];
+  for (size_t s = 0; s < worse.size(); s++)
+    worse[s] -= 0.01;
+  psl.appendModel(worse, "worse");
+  string pslFile = "test_likelihood_psl.bin";
+  IOBinaryPairedSiteLikelihoods::write(psl, pslFile);
+  PairedSiteLikelihoods pslRead = IOBinaryPairedSiteLikelihoods::read(pslFile);
+  remove(pslFile.c_str());
+  if (pslRead.getLikelihoods() != psl.getLikelihoods() || pslRead.getModelNames() != psl.getModelNames()) return 1;
+  TopologyTests topologyTests(pslRead, 2);
+  topologyTests.setNumberOfReplicates(1000);
+  topologyTests.run();
+  cout << "Topology tests (BP, KH, SH, AU):" << endl;
+  for (size_t m = 0; m < 2; m++)
+    cout << topologyTests.getBPValues()[m] << "\t" << topologyTests.getKHPValues()[m] << "\t"
+         << topologyTests.getSHPValues()[m] << "\t" << topologyTests.getAUPValues()[m] << endl;
+  if (topologyTests.getBPValues()[0] != 1. || topologyTests.getKHPValues()[0] != 1. || topologyTests.getSHPValues()[0] != 1.) return 1;
+  if (topologyTests.getBPValues()[1] != 0. || topologyTests.getKHPValues()[1] != 0.) return 1;
+
   return 0;
 }
@@ -148,6 +148,51 @@ int main() {
         return 1;
   }
 
+  //Incremental updates of the double-recursive likelihood, against a full computation:
+  unique_ptr<SiteContainer> sitesInc(simulator.simulate(200));
+  unique_ptr<SubstitutionModelSet> modelSetInc(modelSet->clone());
+  DRNonHomogeneousTreeLikelihood tlInc(*tree, *sitesInc, modelSetInc.get(), rdist, false, false);
+  tlInc.initialize();
+  vector<string> modelParams = modelSetInc->getNodeParameters().getCommonParametersWith(tlInc.getParameters()).getParameterNames();
+  string rootParam = modelSetInc->getRootFrequenciesParameters()[0].getName();
+  unique_ptr<SubstitutionModelSet> modelSetRef(modelSet->clone());
+  DRNonHomogeneousTreeLikelihood tlRef(*tree, *sitesInc, modelSetRef.get(), rdist, false, false);
+  tlRef.initialize();
+  //Without derivatives, arrays for the upper part of the tree are only updated when needed:
+  tlInc.enableDerivatives(false);
+  tlInc.setParameterValue(modelParams.back(), tlInc.getParameterValue(modelParams.back()) * 0.8);
+  tlInc.setParameterValue("BrLen3", 0.15);
+  tlInc.setParameterValue(rootParam, 0.6);
+  tlRef.setParameters(tlInc.getParameters());
+  cout << "Incremental update:\t" << tlInc.getValue() << "\t" << tlRef.getValue() << endl;
+  if (abs(tlInc.getValue() - tlRef.getValue()) > 0.000001)
+    return 1;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    VVVdouble larrayInc, larrayRef;
+    tlInc.computeLikelihoodAtNode(ids[i], larrayInc);
+    tlRef.computeLikelihoodAtNode(ids[i], larrayRef);
+    for (size_t j = 0; j < larrayInc.size(); ++j)
+      for (size_t c = 0; c < larrayInc[j].size(); ++c)
+        for (size_t x = 0; x < larrayInc[j][c].size(); ++x)
+          if (abs(larrayInc[j][c][x] - larrayRef[j][c][x]) > 0.000001 * larrayRef[j][c][x])
+            return 1;
+  }
+  //With derivatives:
+  tlInc.enableDerivatives(true);
+  tlInc.setParameterValue(modelParams.back(), tlInc.getParameterValue(modelParams.back()) * 0.9);
+  tlInc.setParameterValue("BrLen3", 0.2);
+  tlInc.setParameterValue(modelParams.front(), tlInc.getParameterValue(modelParams.front()) * 0.9);
+  tlRef.setParameters(tlInc.getParameters());
+  if (abs(tlInc.getValue() - tlRef.getValue()) > 0.000001)
+    return 1;
+  vector<string> brLens = tlRef.getBranchLengthsParameters().getParameterNames();
+  for (size_t i = 0; i < brLens.size(); ++i) {
+    if (abs(tlInc.getFirstOrderDerivative(brLens[i]) - tlRef.getFirstOrderDerivative(brLens[i])) > 0.000001)
+      return 1;
+    if (abs(tlInc.getSecondOrderDerivative(brLens[i]) - tlRef.getSecondOrderDerivative(brLens[i])) > 0.000001)
+      return 1;
+  }
+
   //-------------
   delete tree;
   delete modelSet;
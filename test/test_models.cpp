@@ -38,6 +38,10 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include <Bpp/Phyl/Model/Nucleotide/GTR.h>
+#include <Bpp/Phyl/Model/EigenDecompositionCache.h>
+#include <Bpp/Phyl/Model/UniformizationExponential.h>
+#include <Bpp/Phyl/Model/AbstractWordSubstitutionModel.h>
+#include <Bpp/Phyl/Model/AbstractBiblioSubstitutionModel.h>
 #include <Bpp/Phyl/Model/Codon/YN98.h>
 #include <Bpp/Phyl/Model/FrequenciesSet/CodonFrequenciesSet.h>
 #include <Bpp/Seq/Alphabet/AlphabetTools.h>
@@ -49,6 +53,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Numeric/AbstractParametrizable.h>
 #include <Bpp/Numeric/Random/RandomTools.h>
 #include <iostream>
+#include <memory>
 
 using namespace bpp;
 using namespace std;
@@ -109,10 +114,112 @@ bool testModel(SubstitutionModel& model) {
   return true;
 }
 
+bool testEigenDecompositionCache(SubstitutionModel& model) {
+  EigenDecompositionCache& cache = EigenDecompositionCache::getInstance();
+  cache.clear();
+  unique_ptr<SubstitutionModel> clone1(model.clone());
+  unique_ptr<SubstitutionModel> clone2(model.clone());
+  clone1->setParameters(model.getParameters());
+  size_t nbMisses = cache.getNumberOfMisses();
+  clone2->setParameters(model.getParameters());
+  if (cache.getNumberOfMisses() != nbMisses || cache.getNumberOfHits() == 0) {
+    cerr << "ERROR: decomposition of " << model.getName() << " was not shared." << endl;
+    return false;
+  }
+
+  //Compare with a decomposition performed without the cache:
+  cache.enable(false);
+  unique_ptr<SubstitutionModel> clone3(model.clone());
+  clone3->setParameters(model.getParameters());
+  cache.enable(true);
+  const Matrix<double>& p2 = clone2->getPij_t(0.1);
+  const Matrix<double>& p3 = clone3->getPij_t(0.1);
+  for (size_t i = 0; i < model.getNumberOfStates(); ++i) {
+    for (size_t j = 0; j < model.getNumberOfStates(); ++j) {
+      if (abs(p2(i, j) - p3(i, j)) > 1e-12) {
+        cerr << "ERROR: cached decomposition of " << model.getName() << " differs." << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool testUniformization(SubstitutionModel& model) {
+  UniformizationExponential ue(model, 1e-10);
+  const SubstitutionModel* inner = &model;
+  AbstractBiblioSubstitutionModel* bsm = dynamic_cast<AbstractBiblioSubstitutionModel*>(&model);
+  if (bsm)
+    inner = &bsm->getSubstitutionModel();
+  const AbstractWordSubstitutionModel* wsm = dynamic_cast<const AbstractWordSubstitutionModel*>(inner);
+  if (wsm) {
+    //Use the sparse generator of word models:
+    const SparseGenerator& sg = wsm->getSparseGenerator();
+    if (sg.getNumberOfNonZeros() != 64 * 9) {
+      cerr << "ERROR: sparse generator of " << model.getName() << " has " << sg.getNumberOfNonZeros() << " elements." << endl;
+      return false;
+    }
+    ue.setGenerator(sg, model.getRate());
+  }
+  size_t n = model.getNumberOfStates();
+  Vdouble v(n), pv;
+  for (size_t i = 0; i < n; ++i)
+    v[i] = RandomTools::giveRandomNumberBetweenZeroAndEntry(1);
+  double t[] = {0.01, 0.5, 3.};
+  for (size_t k = 0; k < 3; ++k) {
+    ue.multiply(t[k], v, pv);
+    const Matrix<double>& p = model.getPij_t(t[k]);
+    for (size_t i = 0; i < n; ++i) {
+      double x = 0;
+      for (size_t j = 0; j < n; ++j)
+        x += p(i, j) * v[j];
+      if (abs(x - pv[i]) > 1e-8) {
+        cerr << "ERROR: uniformization for " << model.getName() << " at t=" << t[k] << ": " << pv[i] << "<>" << x << endl;
+        return false;
+      }
+    }
+  }
+
+  //Transition probabilities and their derivatives computed by the model itself:
+  AbstractSubstitutionModel* asm0 = dynamic_cast<AbstractSubstitutionModel*>(&model);
+  if (asm0) {
+    unique_ptr<AbstractSubstitutionModel> um(asm0->clone());
+    um->enableUniformization(true);
+    for (size_t k = 0; k < 3; ++k) {
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          if (abs(um->Pij_t(i, j, t[k]) - model.Pij_t(i, j, t[k])) > 1e-8
+              || abs(um->dPij_dt(i, j, t[k]) - model.dPij_dt(i, j, t[k])) > 1e-7
+              || abs(um->d2Pij_dt2(i, j, t[k]) - model.d2Pij_dt2(i, j, t[k])) > 1e-6) {
+            cerr << "ERROR: transition probabilities of " << model.getName() << " by uniformization differ at t=" << t[k] << endl;
+            return false;
+          }
+        }
+      }
+      //Products with vectors, without computing P(t):
+      VVdouble vs(2, v), pvs;
+      um->multiplyPij_t(t[k], vs, pvs);
+      const Matrix<double>& p = model.getPij_t(t[k]);
+      for (size_t i = 0; i < n; ++i) {
+        double x = 0;
+        for (size_t j = 0; j < n; ++j)
+          x += p(i, j) * v[j];
+        if (abs(x - pvs[1][i]) > 1e-8) {
+          cerr << "ERROR: product with P(t) of " << model.getName() << " by uniformization differs at t=" << t[k] << endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 int main() {
   //Nucleotide models:
   GTR gtr(&AlphabetTools::DNA_ALPHABET);
   if (!testModel(gtr)) return 1;
+  if (!testEigenDecompositionCache(gtr)) return 1;
+  if (!testUniformization(gtr)) return 1;
 
   //Codon models:
   StandardGeneticCode gc(&AlphabetTools::DNA_ALPHABET);
@@ -121,6 +228,8 @@ int main() {
   YN98 yn98(&gc, fset);
   
   if (!testModel(yn98)) return 1;
+  if (!testEigenDecompositionCache(yn98)) return 1;
+  if (!testUniformization(yn98)) return 1;
 
   delete codonAlphabet;
 
@@ -39,10 +39,17 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include <Bpp/Phyl/TreeTemplate.h>
 #include <Bpp/Phyl/TreeTemplateTools.h>
+#include <Bpp/Phyl/FrozenTree.h>
+#include <Bpp/Phyl/TreeQueryIndex.h>
+#include <Bpp/Phyl/NodeArena.h>
 #include <Bpp/Phyl/Io/Newick.h>
+#include <Bpp/Phyl/Io/NexusIoTree.h>
+#include <Bpp/Phyl/Io/BinaryTreeSet.h>
 #include <string>
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <cmath>
 
 using namespace bpp;
 using namespace std;
@@ -156,6 +163,99 @@ int main() {
   }
   cout << "Newick multiple I/O ok." << endl;
 
+  //Streaming read, skipping the first 10 trees and one tree out of three afterwards:
+  ifstream treeStream("tmp_trees.dnd");
+  size_t nbStreamed = 0;
+  bool streamOk = true;
+  tReader.readTrees(treeStream, [&](const Tree& tree) {
+    streamOk = streamOk && TreeTools::haveSameTopology(*trees[10 + 3 * nbStreamed], tree);
+    nbStreamed++;
+  }, 10, 3);
+  if (!streamOk || nbStreamed != 30) {
+    cerr << "Streaming read failed!" << endl;
+    return 1;
+  }
+  cout << "Newick streaming input ok." << endl;
+
+  //Streaming read of a Nexus file, with its translation table:
+  NexusIOTree nexus;
+  nexus.write(trees, "tmp_trees.nex");
+  ifstream nexusStream("tmp_trees.nex");
+  nbStreamed = 0;
+  streamOk = true;
+  nexus.readTrees(nexusStream, [&](const Tree& tree) {
+    streamOk = streamOk && TreeTools::haveSameTopology(*trees[10 + 3 * nbStreamed], tree);
+    nbStreamed++;
+  }, 10, 3);
+  if (!streamOk || nbStreamed != 30) {
+    cerr << "Nexus streaming read failed!" << endl;
+    return 1;
+  }
+  cout << "Nexus streaming input ok." << endl;
+
+  //Parallel read:
+  ifstream parallelStream("tmp_trees.dnd");
+  vector<Tree *> trees3;
+  tReader.read(parallelStream, trees3, 4);
+  for (unsigned int i = 0; i < 100; ++i) {
+    if (trees3.size() != 100 || !TreeTools::haveSameTopology(*trees[i], *trees3[i]))
+    {
+      cerr << "Tree " << i << " failed to be read in parallel!" << endl;
+      return 1;
+    }
+    delete trees3[i];
+  }
+  cout << "Newick parallel input ok." << endl;
+
+  //Parallel write:
+  ostringstream sequentialOut, parallelOut;
+  tWriter.write(trees, sequentialOut);
+  tWriter.write(trees, parallelOut, 4);
+  if (parallelOut.str() != sequentialOut.str()) {
+    cerr << "Parallel write differs from sequential write!" << endl;
+    return 1;
+  }
+  //With 17 digits, branch lengths are read back exactly:
+  TreeTemplate<Node> lengthTree(*dynamic_cast<TreeTemplate<Node>*>(trees[0]));
+  vector<Node*> lengthNodes = lengthTree.getNodes();
+  for (size_t i = 0; i < lengthNodes.size(); ++i)
+    if (lengthNodes[i]->hasFather())
+      lengthNodes[i]->setDistanceToFather(1. / (3. + static_cast<double>(i)));
+  ostringstream exactOut;
+  exactOut.precision(17);
+  tWriter.write(lengthTree, exactOut);
+  istringstream exactIn(exactOut.str());
+  TreeTemplate<Node>* exactTree = tReader.readNextTree(exactIn);
+  vector<Node*> exactNodes = exactTree->getNodes();
+  for (size_t i = 0; i < lengthNodes.size(); ++i) {
+    if (exactNodes.size() != lengthNodes.size() || (lengthNodes[i]->hasFather() && exactNodes[i]->getDistanceToFather() != lengthNodes[i]->getDistanceToFather())) {
+      cerr << "Branch lengths were not written exactly!" << endl;
+      return 1;
+    }
+  }
+  delete exactTree;
+  cout << "Newick parallel output ok." << endl;
+
+  //Binary tree sets, with random access:
+  BinaryTreeSet binaryWriter;
+  binaryWriter.write(trees, "tmp_trees.bin");
+  BinaryTreeSet::Reader binaryReader("tmp_trees.bin");
+  if (binaryReader.getNumberOfTrees() != 100 || binaryReader.getNameTable()->size() != leaves.size()) {
+    cerr << "Wrong binary tree set header!" << endl;
+    return 1;
+  }
+  for (unsigned int j = 0; j < 100; j += 7) {
+    unsigned int i = 99 - j; // Backward, to check random access.
+    FrozenTree* binaryTree = binaryReader.getTree(i);
+    if (!TreeTools::haveSameTopology(*trees[i], *binaryTree) || binaryTree->getNodesId() != trees[i]->getNodesId())
+    {
+      cerr << "Tree " << i << " failed to write and/or read in binary format!" << endl;
+      return 1;
+    }
+    delete binaryTree;
+  }
+  cout << "Binary tree set I/O ok." << endl;
+
   for (unsigned int i = 0; i < 100; ++i) {
     delete trees[i];
     delete trees2[i];
@@ -249,6 +349,201 @@ int main() {
   }
   cout << TreeTemplateTools::treeToParenthesis(*weird6) << endl;
   delete weird6;
- 
+
+  cout << "Testing node lookup by id after modifications:" << endl;
+  TreeTemplate<Node>* tree10 = TreeTemplateTools::getRandomTree(leaves, true);
+  tree10->resetNodesId();
+  TreeTemplateTools::dropLeaf(*tree10, "leaf0");
+  tree10->newOutGroup(tree10->getNode("leaf1"));
+  // Nodes whose ids were modified directly are searched until the index is updated:
+  TreeTemplateTools::incrementAllIds(tree10->getRootNode(), 1000);
+  if (tree10->getNode(1001)->getId() != 1001) {
+    cout << "Error, node 1001 not found before updating the index!" << endl;
+    return 1;
+  }
+  if (tree10->hasNode(1)) {
+    cout << "Error, node found with its former id 1!" << endl;
+    return 1;
+  }
+  TreeTemplateTools::incrementAllIds(*tree10, -500);
+  if (tree10->hasNode(1001) || tree10->getNodeUnchecked(501)->getId() != 501) {
+    cout << "Error, index not updated after incrementing ids!" << endl;
+    return 1;
+  }
+  vector<Node*> nodes10 = tree10->getNodes();
+  for (size_t i = 0; i < nodes10.size(); ++i) {
+    if (tree10->getNode(nodes10[i]->getId()) != nodes10[i] || tree10->getNodeUnchecked(nodes10[i]->getId()) != nodes10[i]) {
+      cout << "Error, wrong node for id " << nodes10[i]->getId() << "!" << endl;
+      return 1;
+    }
+  }
+  if (tree10->hasNode(0)) {
+    cout << "Error, node 0 should not be found!" << endl;
+    return 1;
+  }
+  // Negative and large ids are indexed too:
+  tree10->getRootNode()->setId(-1);
+  nodes10[1]->setId(1000000000);
+  tree10->updateNodeIndex();
+  if (tree10->getNodeUnchecked(-1) != tree10->getRootNode() || tree10->getNodeUnchecked(1000000000) != nodes10[1]) {
+    cout << "Error, negative or large id not indexed!" << endl;
+    return 1;
+  }
+  delete tree10;
+
+  cout << "Testing node lookup and traversals after collapsing and rerooting:" << endl;
+  TreeTemplate<Node>* tree11 = TreeTemplateTools::parenthesisToTree("((A:1,B:2)80:1,(C:1,D:1)30:2,E:1);", true);
+  int collapsedId = tree11->getRootNode()->getSon(1)->getId();
+  tree11->getPostorderNodes();
+  TreeTemplateTools::unresolveUncertainNodes(*tree11, 50.);
+  if (tree11->hasNode(collapsedId) || tree11->getPostorderNodes().size() != tree11->getNumberOfNodes()) {
+    cout << "Error, collapsed node still found!" << endl;
+    return 1;
+  }
+  TreeTemplateTools::midRoot(*tree11, TreeTemplateTools::MIDROOT_VARIANCE, true);
+  vector<Node*> nodes11 = tree11->getNodes();
+  if (tree11->getPostorderNodes().size() != nodes11.size() || tree11->getPreorderNodes().front() != tree11->getRootNode()) {
+    cout << "Error, wrong traversal after rerooting!" << endl;
+    return 1;
+  }
+  for (size_t i = 0; i < nodes11.size(); ++i) {
+    if (tree11->getNodeUnchecked(nodes11[i]->getId()) != nodes11[i]) {
+      cout << "Error, node " << nodes11[i]->getId() << " not indexed after rerooting!" << endl;
+      return 1;
+    }
+  }
+  delete tree11;
+
+  cout << "Testing a deep caterpillar tree:" << endl;
+  size_t nbDeep = 100000;
+  string deepDesc(nbDeep - 1, '(');
+  deepDesc += "L0:1";
+  for (size_t i = 1; i < nbDeep; ++i)
+    deepDesc += ",L" + TextTools::toString(i) + ":1):1";
+  deepDesc += ";";
+  TreeTemplate<Node>* deep = TreeTemplateTools::parenthesisToTree(deepDesc, false, "", false, false);
+  if (deep->getNumberOfLeaves() != nbDeep || deep->getNumberOfNodes() != 2 * nbDeep - 1) {
+    cout << "Error, deep tree has " << deep->getNumberOfNodes() << " node(s)!" << endl;
+    return 1;
+  }
+  if (deep->getPostorderNodes().size() != 2 * nbDeep - 1 || deep->getPostorderNodes().back() != deep->getRootNode()
+      || deep->getPreorderNodes().size() != 2 * nbDeep - 1 || deep->getPreorderNodes().front() != deep->getRootNode()) {
+    cout << "Error, wrong traversal of the deep tree!" << endl;
+    return 1;
+  }
+  TreeTemplate<Node>* deepCopy = deep->clone();
+  if (TreeTemplateTools::treeToParenthesis(*deepCopy) != TreeTemplateTools::treeToParenthesis(*deep)
+      || TreeTemplateTools::getDepth(*deepCopy->getRootNode()) != nbDeep - 1) {
+    cout << "Error, deep tree not copied properly!" << endl;
+    return 1;
+  }
+  delete deepCopy;
+  delete deep;
+
+  cout << "Testing frozen trees:" << endl;
+  shared_ptr<FrozenTree::NameTable> names(new FrozenTree::NameTable());
+  for (unsigned int i = 0; i < 10; ++i) {
+    TreeTemplate<Node>* tree11 = TreeTemplateTools::getRandomTree(leaves, i % 2 == 0);
+    tree11->setVoidBranchLengths(0.1 * (i + 1));
+    FrozenTree frozen(*tree11, names);
+    TreeTemplate<Node>* thawed = frozen.toTreeTemplate();
+    if (TreeTemplateTools::treeToParenthesis(*thawed) != TreeTemplateTools::treeToParenthesis(*tree11)
+        || frozen.getNodesId() != tree11->getNodesId()
+        || TreeTools::robinsonFouldsDistance(frozen, *tree11) != 0) {
+      cout << "Error, frozen tree differs from the original one!" << endl;
+      return 1;
+    }
+    DistanceMatrix* d1 = frozen.getDistanceMatrix();
+    DistanceMatrix* d2 = TreeTools::getDistanceMatrix(*tree11);
+    for (size_t j = 0; j < leaves.size(); ++j)
+      for (size_t k = 0; k < leaves.size(); ++k)
+        if (abs((*d1)(j, k) - (*d2)(j, k)) > 1e-9) {
+          cout << "Error, wrong distance between leaves " << j << " and " << k << "!" << endl;
+          return 1;
+        }
+    delete d1;
+    delete d2;
+    delete thawed;
+    delete tree11;
+  }
+  if (names->size() != leaves.size()) {
+    cout << "Error, leaf names are not shared between frozen trees!" << endl;
+    return 1;
+  }
+
+  cout << "Testing properties of frozen trees:" << endl;
+  TreeTemplate<Node>* tree14 = TreeTemplateTools::parenthesisToTree("((A:1,B:2)80:1,(C:1,D:1)95:2,E:1);", true);
+  int id14 = tree14->getRootNode()->getSon(1)->getId();
+  FrozenTree frozen14(*tree14);
+  size_t key14 = frozen14.getBranchProperties().getKey(TreeTools::BOOTSTRAP, PropertyTable::DOUBLE);
+  frozen14.setNodeProperty(id14, "Tag", BppString("x"));
+  if (frozen14.getBranchProperties().getDouble(key14, frozen14.getNodeIndex(id14)) != 95.
+      || dynamic_cast<const Number<double>*>(frozen14.getBranchProperty(id14, TreeTools::BOOTSTRAP))->getValue() != 95.
+      || frozen14.hasBranchProperty(frozen14.getRootId(), TreeTools::BOOTSTRAP)) {
+    cout << "Error, wrong bootstrap values in frozen tree!" << endl;
+    return 1;
+  }
+  TreeTemplate<Node>* thawed14 = frozen14.toTreeTemplate();
+  if (!thawed14->getRootNode()->getSon(1)->hasNodeProperty("Tag")
+      || TreeTemplateTools::treeToParenthesis(*thawed14, true) != TreeTemplateTools::treeToParenthesis(*tree14, true)) {
+    cout << "Error, properties not kept when thawing the tree!" << endl;
+    return 1;
+  }
+  frozen14.setBootstrapValue(id14, 50.);
+  tree14->setBootstrapValue(id14, 50.);
+  if (!frozen14.hasBootstrapValue(id14) || frozen14.getBootstrapValue(id14) != 50.
+      || tree14->getBootstrapValue(id14) != 50.
+      || dynamic_cast<const Number<double>*>(tree14->getBranchProperty(id14, TreeTools::BOOTSTRAP))->getValue() != 50.
+      || tree14->hasBootstrapValue(tree14->getRootId())) {
+    cout << "Error, wrong typed bootstrap values!" << endl;
+    return 1;
+  }
+  tree14->getNode(id14)->deleteBranchProperty(TreeTools::BOOTSTRAP);
+  if (tree14->hasBootstrapValue(id14)) {
+    cout << "Error, bootstrap value not removed!" << endl;
+    return 1;
+  }
+  delete thawed14;
+  delete tree14;
+
+  cout << "Testing common ancestor and distance queries:" << endl;
+  TreeTemplate<Node>* tree12 = TreeTemplateTools::getRandomTree(leaves, true);
+  tree12->setVoidBranchLengths(0.5);
+  TreeQueryIndex index12(*tree12);
+  vector<int> ids12 = tree12->getNodesId();
+  for (size_t i = 0; i < ids12.size(); i += 7) {
+    for (size_t j = 0; j < ids12.size(); j += 3) {
+      vector<int> pair12(2);
+      pair12[0] = ids12[i];
+      pair12[1] = ids12[j];
+      if (index12.getLastCommonAncestor(ids12[i], ids12[j]) != TreeTools::getLastCommonAncestor(*tree12, pair12)
+          || abs(index12.getDistanceBetweenAnyTwoNodes(ids12[i], ids12[j]) - TreeTools::getDistanceBetweenAnyTwoNodes(*tree12, ids12[i], ids12[j])) > 1e-9
+          || index12.getPathBetweenAnyTwoNodes(ids12[i], ids12[j]) != TreeTools::getPathBetweenAnyTwoNodes(*tree12, ids12[i], ids12[j])) {
+        cout << "Error, wrong query result for nodes " << ids12[i] << " and " << ids12[j] << "!" << endl;
+        return 1;
+      }
+    }
+  }
+  delete tree12;
+
+  cout << "Testing arena allocation of nodes:" << endl;
+  NodeArena arena;
+  TreeTemplate<Node>* tree13 = TreeTemplateTools::getRandomTree(leaves, true);
+  string arenaDesc = TreeTemplateTools::treeToParenthesis(*tree13);
+  delete tree13;
+  for (unsigned int i = 0; i < 3; ++i) {
+    NodeArena::Scope scope(arena);
+    tree13 = TreeTemplateTools::parenthesisToTree(arenaDesc);
+    TreeTemplate<Node>* tree13Copy = tree13->clone();
+    if (arena.getAllocatedSize() == 0
+        || TreeTemplateTools::treeToParenthesis(*tree13Copy) != arenaDesc) {
+      cout << "Error, tree not built in the arena!" << endl;
+      return 1;
+    }
+    delete tree13Copy;
+    delete tree13;
+    arena.clear();
+  }
+
   return 0;
 }